@@ -48,6 +48,7 @@ import m5
 from m5.objects import *
 from .Caches import *
 from common import ObjectList
+from common import PredictorEnv
 
 def config_cache(options, system):
     if options.external_memory_system and (options.caches or options.l2cache):
@@ -122,12 +123,14 @@ def config_cache(options, system):
         if use_pb == 1:
             print("Attaching predictor backend")
             system.pb = PredictorBackend()
+            PredictorEnv.apply_backend_env(system.pb)
             system.pb.cache_side = system.l2.mem_side
             system.pb.mem_side   = system.membus.slave
         elif use_pb == 0:
             system.l2.mem_side = system.membus.slave
         elif use_pb == 2:
             system.pb = PredictorBackend()
+            PredictorEnv.apply_backend_env(system.pb)
             system.pb.slave = system.l3.mem_side
             system.pb.master = system.membus.slave
 
@@ -198,7 +201,12 @@ def config_cache(options, system):
             # SM: Add predictor here with connections on one side to the CPU
             #     and to the L1 cache on the other side.
             print("Adding predictor frontend for cpu " + str(i))
-            system.cpu[i].pf =  PredictorFrontend()
+            system.cpu[i].pf =  PredictorFrontend(
+                hw_contexts = int(system.cpu[i].numThreads))
+            PredictorEnv.apply_frontend_env(system.cpu[i].pf)
+            # Predictions and feedback go through a channel per core
+            if hasattr(system, 'pb'):
+                system.cpu[i].pf.backend = system.pb
             
             # Set the core id for multithreading
             # system.cpu[i].pf.coreid = i
@@ -41,6 +41,7 @@ from __future__ import absolute_import
 
 import m5.objects
 from common import ObjectList
+from common import PredictorEnv
 from . import HMC
 
 def create_mem_ctrl(cls, r, i, nbr_mem_ctrls, intlv_bits, intlv_size):
@@ -70,6 +71,9 @@ def create_mem_ctrl(cls, r, i, nbr_mem_ctrls, intlv_bits, intlv_size):
         # for
         ctrl.channels = nbr_mem_ctrls
 
+        # Backend memory operation knobs still set through the environment
+        PredictorEnv.apply_dram_ctrl_env(ctrl)
+
         # If the channel bits are appearing after the column
         # bits, we need to add the appropriate number of bits
         # for the row buffer size
@@ -191,6 +195,9 @@ def config_mem(options, system):
 
             if issubclass(cls[j], m5.objects.DRAMCtrl):
                 mem_ctrl.enable_dram_powerdown = opt_dram_powerdown
+                # Each controller verifies the predictions of the backend
+                if hasattr(system, 'pb'):
+                    mem_ctrl.predictor_backend = system.pb
 
             if opt_elastic_trace_en:
                 mem_ctrl.latency = '1ns'
@@ -214,6 +214,10 @@ def addCommonOptions(parser):
                       Only used if multiple programs are specified. If true,
                       then the number of threads per cpu is same as the
                       number of programs.""")
+    parser.add_option("--smt-threads", type="int", default=1,
+                      help = """
+                      Hardware threads per cpu, the threads a single program
+                      spawns run on the spare threads (DerivO3CPU only).""")
     parser.add_option("--elastic-trace-en", action="store_true",
                       help="""Enable capture of data dependency and instruction
                       fetch traces using elastic trace probe.""")
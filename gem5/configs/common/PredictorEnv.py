@@ -0,0 +1,115 @@
+# Maps the environment variables the predictor used to read at runtime to
+# the parameters of the PredictorFrontend, PredictorBackend and DRAMCtrl
+# SimObjects. Lets the existing run scripts keep configuring the predictor
+# through the environment, the values are read once at configuration time.
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import os
+
+def _flag(val):
+    return val != "0"
+
+def _uint(val):
+    return int(val)
+
+def _writeback_trace(val):
+    # The backend used to dump to a fixed file when set to "1"
+    return "/ramdisk/nonvolatiledump.bin" if val == "1" else ""
+
+def _hex_list(val):
+    return [int(pc, 16) for pc in val.split(",") if pc.strip() != ""]
+
+def _replacement_policy(val):
+    # Name of a replacement policy SimObject, e.g. "LRURP" or "RandomRP"
+    import m5.objects
+    return getattr(m5.objects, val)()
+
+# (environment variable, parameter, conversion)
+# Flags are enabled by any value other than "0" and numbers set to "0" keep
+# their default, like the old getenv checks
+_frontend_params = [
+    ("SIZE_MULTIPLIER",                     "size_multiplier",      float),
+    ("CL_ACC_SIZE",                         "cl_acc_size",          _uint),
+    ("PATH_HISTORY_SIZE",                   "path_history_size",    _uint),
+    ("SHARED_CONTEXT_STATE",                "shared_context_state", _flag),
+    ("STALE_ENTRY_AGE_THRESHOLD",           "stale_entry_age_threshold",
+                                                                    _uint),
+    ("IHB_PATTERN_MATCH_THRESH",            "ihb_pattern_match_thresh",
+                                                                    _uint),
+    ("IHB_PATTERN_MIN_COUNT",               "ihb_pattern_min_count",_uint),
+    ("CORRECT_ADDR_PREDICTION_AGE_REWARD",
+                            "correct_addr_prediction_age_reward",   _uint),
+    ("CORRECT_DATA_PREDICTION_AGE_REWARD",
+                            "correct_data_prediction_age_reward",   _uint),
+    ("ENABLE_CONST_0_PREDICTION",           "enable_const_0_prediction",
+                                                                    _flag),
+    ("DISABLE_CONFIDENCE",                  "disable_confidence",   _flag),
+    ("DISABLE_PER_PC_CONFIDENCE",           "disable_per_pc_confidence",
+                                                                    _flag),
+    ("DISABLE_FREE_PREDICTION",             "disable_free_prediction",
+                                                                    _flag),
+    ("DISABLE_FANCY_ADDR_PRED",             "disable_fancy_addr_pred",
+                                                                    _flag),
+    ("ADDR_PREDICTOR",                      "addr_predictor",       str),
+    ("DISABLE_WHB_SEARCH",                  "disable_whb_search",   _flag),
+    ("ENABLE_VOLATILE_DUMP",                "volatile_dump",        str),
+    ("VOLATILE_DUMP_COMPRESSION",           "volatile_dump_compression",
+                                                                    str),
+    ("PC_OF_INTEREST",                      "pcs_of_interest",      _hex_list),
+]
+
+_backend_params = [
+    ("SIZE_MULTIPLIER",                     "size_multiplier",      float),
+    ("USE_PREDICTOR",                       "use_predictor",        _flag),
+    ("ENABLE_NON_VOLATILE_DUMP",            "non_volatile_dump",
+                                                        _writeback_trace),
+    ("NON_VOLATILE_DUMP_COMPRESSION",       "non_volatile_dump_compression",
+                                                                    str),
+    ("DISABLE_INVALIDATION",                "disable_invalidation", _flag),
+]
+
+_dram_ctrl_params = [
+    ("ENABLE_DW",                           "enable_dw",            _flag),
+    ("ENABLE_EV",                           "enable_ev",            _flag),
+    ("DISABLE_ADDR_PRED_PERF",              "disable_addr_pred_perf",
+                                                                    _flag),
+    ("DISABLE_DATA_PRED_PERF",              "disable_data_pred_perf",
+                                                                    _flag),
+    ("ENABLE_NON_VOLATILE_DUMP",            "non_volatile_dump",    str),
+    ("BMO_ENGINE_UNITS",                    "bmo_engine_units",     _uint),
+    # In ticks, like the latencies of txopt/param.hh
+    ("BMO_ENGINE_II",                       "bmo_engine_initiation_interval",
+                                                                    _uint),
+    ("BMO_ENGINE_QUEUE_SIZE",               "bmo_engine_queue_size",
+                                                                    _uint),
+    ("PRECOMPUTE_BUFFER_ENTRIES",           "precompute_buffer_entries",
+                                                                    _uint),
+    ("PRECOMPUTE_BUFFER_SIZE",              "precompute_buffer_size",
+                                                                    str),
+    ("PRECOMPUTE_OP_ENERGY",                "precompute_op_energy", float),
+    ("VERIFICATION_CACHE_ASSOC",            "verification_cache_assoc",
+                                                                    _uint),
+    ("VERIFICATION_CACHE_PARTITIONED",      "verification_cache_partitioned",
+                                                                    _flag),
+    ("VERIFICATION_CACHE_RP",
+                        "verification_cache_replacement_policy",
+                                                        _replacement_policy),
+]
+
+def _apply(obj, params):
+    for env, param, conv in params:
+        val = os.environ.get(env)
+        if val is None or (val == "0" and conv in (_uint, float)):
+            continue
+        setattr(obj, param, conv(val))
+
+def apply_frontend_env(pf):
+    _apply(pf, _frontend_params)
+
+def apply_backend_env(pb):
+    _apply(pb, _backend_params)
+
+def apply_dram_ctrl_env(ctrl):
+    _apply(ctrl, _dram_ctrl_params)
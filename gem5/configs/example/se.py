@@ -169,6 +169,9 @@ else:
 
 
 (CPUClass, test_mem_mode, FutureClass) = Simulation.setCPUClass(options)
+if options.smt_threads > 1:
+    assert(options.cpu_type == "DerivO3CPU")
+    numThreads = max(numThreads, options.smt_threads)
 CPUClass.numThreads = numThreads
 
 # Check -- do not allow SMT with multiple CPUs
@@ -0,0 +1,93 @@
+# Replays the traces written by a PredictorFrontend (volatile_dump) and a
+# PredictorBackend (non_volatile_dump) through a new frontend and backend,
+# without the CPU and caches that produced them. Reports the same predictor
+# statistics as the full simulation in a fraction of the time, which makes
+# it suitable for sweeping the predictor configuration. The writebacks are
+# verified at a DRAMCtrl, which reports the prediction timeliness.
+#
+# Usage:
+#   gem5.opt configs/pmweaver/pmweaver_replay.py \
+#       --store-trace dump.bin --writeback-trace nonvolatiledump.bin \
+#       --param pf.path_history_size=16 --param pb.size_multiplier=2 \
+#       --param mc.enable_ev=True
+#
+# Both traces should come from the same run. Translations are rebuilt from
+# the physical addresses stored in the store trace, so a predicted address
+# on a page the workload has not stored to yet cannot be translated.
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+
+parser = optparse.OptionParser()
+parser.add_option("--store-trace", type="string",
+                  help="Store and CLWB trace written by the frontend")
+parser.add_option("--writeback-trace", type="string", default="",
+                  help="Writeback trace written by the backend")
+parser.add_option("--always-enabled", action="store_true", default=False,
+                  help="Enable the predictor for the whole trace instead of "
+                       "the region of interest")
+parser.add_option("--page-size", type="string", default="4kB",
+                  help="Page size of the traced workload")
+parser.add_option("--mem-size", type="string", default="16GB",
+                  help="Physical memory covered by the controller, must "
+                       "include the persistent memory of the workload")
+parser.add_option("--param", action="append", default=[],
+                  help="Set a frontend (pf.<param>=<value>), backend "
+                       "(pb.<param>=<value>) or memory controller "
+                       "(mc.<param>=<value>) parameter, may be repeated")
+
+(options, args) = parser.parse_args()
+
+if args or not options.store_trace:
+    parser.print_help()
+    sys.exit(1)
+
+system = System()
+system.clk_domain = SrcClockDomain(clock = '2GHz',
+                                   voltage_domain = VoltageDomain())
+system.mem_mode = 'timing'
+system.mem_ranges = [AddrRange(options.mem_size)]
+
+system.pb = PredictorBackend(use_predictor = True)
+system.pf = PredictorFrontend(backend = system.pb)
+# Consumes the writebacks like the controller of the full simulation
+system.mc = DDR4_2400_8x8(range = system.mem_ranges[0],
+                          predictor_backend = system.pb)
+
+for param in options.param:
+    name, sep, value = param.partition("=")
+    obj, _, attr = name.partition(".")
+    if not sep or obj not in ("pf", "pb", "mc") or not attr:
+        print("Invalid parameter %s, expected pf.<param>=<value>, "
+              "pb.<param>=<value> or mc.<param>=<value>" % param)
+        sys.exit(1)
+    setattr(getattr(system, obj), attr, value)
+
+system.replay = PredictorTraceReplay(
+    frontend = system.pf, backend = system.pb, mem_ctrl = system.mc,
+    store_trace = options.store_trace,
+    writeback_trace = options.writeback_trace,
+    always_enabled = options.always_enabled,
+    page_size = options.page_size)
+
+# The replay calls into the frontend and backend directly, the ports are
+# only connected to satisfy their checks
+system.membus = SystemXBar()
+system.replay.port = system.pf.slave
+system.pf.master = system.membus.slave
+system.membus.master = system.pb.slave
+system.pb.master = system.mc.port
+system.system_port = system.membus.slave
+
+root = Root(full_system = False, system = system)
+m5.instantiate()
+
+print("Replaying %s" % options.store_trace)
+exit_event = m5.simulate()
+print("Exiting @ tick %i because %s" % (m5.curTick(), exit_event.getCause()))
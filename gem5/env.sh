@@ -5,7 +5,7 @@ export CXX=g++-5
 export USE_PREDICTOR=1
 export DISABLE_CONFIDENCE=1
 export ENABLE_NON_VOLATILE_DUMP=0
-export ENABLE_VOLATILE_DUMP="./dump.txt"
+export ENABLE_VOLATILE_DUMP="./dump.bin"
 export PC_OF_INTEREST="0x1372"
 export DISABLE_WHB_SEARCH=0
 export IHB_PATTERN_MATCH_THRESH=5
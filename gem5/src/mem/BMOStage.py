@@ -0,0 +1,35 @@
+from m5.params import *
+from m5.SimObject import SimObject
+
+# Metadata caches of DRAMCtrl a BMO stage can read
+class BMOMetadata(Enum): vals = ['counter', 'verification']
+
+# One backend memory operation applied by DRAMCtrl to the PM writes, the
+# stages of a controller form a DAG through their after lists
+class BMOStage(SimObject):
+    type = 'BMOStage'
+    cxx_header = "mem/bmo_stage.hh"
+
+    after_addr = Param.Bool(False, "Starts once the address of the write "
+                            "is known")
+    after_data = Param.Bool(False, "Starts once the data of the write is "
+                            "known")
+    after = VectorParam.BMOStage([], "Stages that must be done before this "
+                                 "one starts")
+    latency = Param.Latency("Latency of one operation")
+    repeat = Param.Unsigned(1, "Operations done back to back for every "
+                            "write")
+    metadata = VectorParam.BMOMetadata([], "Metadata caches read by the "
+                                       "stage")
+    metadata_miss_latency = Param.Latency('40ns', "Latency added by every "
+                                          "metadata cache miss")
+    units = Param.Unsigned(0, "Pipelined units of the engine, 0 for "
+                           "unlimited")
+    initiation_interval = Param.Latency('0ns', "Time a unit is busy with "
+                                        "one operation, 0 for unlimited")
+    queue_size = Param.Unsigned(0, "Operations that can wait for a unit, "
+                                "0 for unbounded, a full queue stops the "
+                                "controller from accepting PM writes")
+    result_bytes = Param.Unsigned(8, "Bytes of result kept in the "
+                                  "precomputation buffer of the controller "
+                                  "when the stage is done ahead of the write")
@@ -48,6 +48,8 @@ from m5.params import *
 from m5.proxy import *
 from m5.objects.AbstractMemory import *
 from m5.objects.QoSMemCtrl import *
+from m5.objects.BMOStage import BMOStage
+from m5.objects.ReplacementPolicies import *
 
 # Enum for memory scheduling algorithms, currently First-Come
 # First-Served and a First-Row Hit then First-Come First-Served
@@ -146,6 +148,57 @@ class DRAMCtrl(QoSMemCtrl):
     # Set to True for NVM technology
     isNVM = Param.Bool(False, "is memory NVM?")
 
+    # Backend memory operations (BMO) modelled on the PM write path
+    enable_dw = Param.Bool(False, "Enable deduplication and wear levelling")
+    enable_ev = Param.Bool(False, "Enable encryption and verification")
+    disable_addr_pred_perf = Param.Bool(False, "Ignore the early address "
+                                        "of predicted writes in the BMO "
+                                        "latency")
+    disable_data_pred_perf = Param.Bool(False, "Ignore the early data of "
+                                        "predicted writes in the BMO "
+                                        "latency")
+    bmo_stages = VectorParam.BMOStage([], "BMO stages applied to the PM "
+                                      "writes, the stages of enable_ev and "
+                                      "enable_dw are used if empty")
+    # Engines of the stages of enable_ev and enable_dw, see BMOStage
+    bmo_engine_units = Param.Unsigned(0, "Pipelined units of every BMO "
+                                      "engine, 0 for unlimited")
+    bmo_engine_initiation_interval = Param.Latency('0ns', "Time a BMO "
+                                                   "engine unit is busy with "
+                                                   "one operation")
+    bmo_engine_queue_size = Param.Unsigned(0, "Operations that can wait "
+                                           "for a BMO engine unit, 0 for "
+                                           "unbounded")
+
+    # Results of the BMOs done from the predictions of the backend, used by
+    # the matching PM write instead of redoing them
+    precompute_buffer_entries = Param.Unsigned(0, "Lines of BMO results in "
+                                               "the precomputation buffer, "
+                                               "0 disables it")
+    precompute_buffer_size = Param.MemorySize('0B', "Bytes of BMO results "
+                                              "in the precomputation buffer, "
+                                              "0 for unbounded")
+    precompute_op_energy = Param.Float(0.0, "Energy of one BMO operation "
+                                       "done ahead of a write (pJ)")
+    predictor_backend = Param.PredictorBackend(NULL, "Backend whose "
+                                               "predictions are verified "
+                                               "against the writes")
+    non_volatile_dump = Param.String("0", "Dump the PM writes seen by the "
+                                     "controller (\"1\" to enable)")
+
+    # Merkle tree node cache of the verification BMO, its size is
+    # VERIFICATION_CACHE_SIZE nodes. By default it is fully associative and
+    # replaces the least recently used node in access order.
+    verification_cache_assoc = Param.Unsigned(0, "Associativity of the "
+                                              "Merkle tree node cache, 0 "
+                                              "for fully associative")
+    verification_cache_partitioned = Param.Bool(False, "Split the sets of "
+                                                "the Merkle tree node cache "
+                                                "between the tree levels")
+    verification_cache_replacement_policy = Param.BaseReplacementPolicy(
+        NULL, "Replacement policy of the Merkle tree node cache, access "
+        "order LRU if not set")
+
     # DRAMPower provides in addition to the core power, the possibility to
     # include RD/WR termination and IO power. This calculation assumes some
     # default values. The integration of DRAMPower with gem5 does not include
@@ -41,6 +41,7 @@
 
 from m5.params import *
 from m5.objects.ClockedObject import ClockedObject
+from m5.objects.PredictorFrontend import TraceCompression, SnapshotTrigger
 
 class PredictorBackend(ClockedObject):
     type = 'PredictorBackend'
@@ -52,3 +53,20 @@ class PredictorBackend(ClockedObject):
     delay = Param.Latency('0ns', "The latency of this bridge")
     ranges = VectorParam.AddrRange([AllMemory],
                                    "Address ranges to pass through the bridge")
+    use_predictor = Param.Bool(False, "Verify the predicted writes against "
+                               "the writes to PM")
+    non_volatile_dump = Param.String("", "File to write the binary trace of "
+                                     "the PM writebacks to, empty to disable")
+    non_volatile_dump_compression = Param.TraceCompression('no_compression',
+                                        "Compression of the writeback trace")
+    disable_invalidation = Param.Bool(False, "Keep the predicted writes when "
+                                      "the result buffer is invalidated")
+    size_multiplier = Param.Float(1.0, "Scales the size of the result buffer")
+    snapshot = Param.String("", "File to write sampled snapshots of the "
+                            "result buffer to, empty to disable. Decode it "
+                            "with util/decode_pmweaver_snapshot.py")
+    snapshot_trigger = Param.SnapshotTrigger('tick_period', "Whether the "
+                                             "snapshot period is in ticks "
+                                             "or PM writes")
+    snapshot_period = Param.UInt64(1000000000, "Ticks or events between "
+                                   "snapshots")
@@ -42,6 +42,22 @@
 from m5.params import *
 from m5.objects.ClockedObject import ClockedObject
 
+# Signature of the store PC path used to index the predictor table
+class PathHashKind(Enum): vals = ['shift_xor', 'folded_history', 'rolling_poly']
+
+# Unbounded map (ideal) or set associative SRAM for the predictor table
+class PredTableOrg(Enum): vals = ['ideal', 'set_assoc']
+
+# Address predictor replacing the addresses of predicted writes
+class AddrPredictorKind(Enum):
+    vals = ['delta', 'stride', 'region', 'markov', 'tournament']
+
+# Compression of the binary store trace
+class TraceCompression(Enum): vals = ['no_compression', 'gzip']
+
+# Unit of the period between predictor state snapshots
+class SnapshotTrigger(Enum): vals = ['tick_period', 'event_period']
+
 class PredictorFrontend(ClockedObject):
     type = 'PredictorFrontend'
     cxx_header = "mem/predictor_frontend.hh"
@@ -52,3 +68,83 @@ class PredictorFrontend(ClockedObject):
     delay = Param.Latency('0ns', "The latency of this bridge")
     ranges = VectorParam.AddrRange([AllMemory],
                                    "Address ranges to pass through the bridge")
+    path_hash = Param.PathHashKind('shift_xor',
+                                   "Hash of the store PC path used to index "
+                                   "the predictor table")
+    path_hash_alias_check = Param.Bool(False, "Count path hashes produced by "
+                                       "more than one path")
+    pred_table_org = Param.PredTableOrg('ideal', "Organization of the "
+                                        "predictor table")
+    pred_table_sets = Param.Unsigned(8, "Sets of the set associative "
+                                     "predictor table, power of 2")
+    pred_table_ways = Param.Unsigned(4, "Ways of the set associative "
+                                     "predictor table")
+    pred_table_index_shift = Param.Unsigned(0, "Low bits of the path hash "
+                                            "skipped before the set index")
+    pred_table_tag_bits = Param.Unsigned(0, "Tag bits per way, 0 stores the "
+                                         "complete path hash")
+
+    size_multiplier = Param.Float(1.0, "Scales the size of the write "
+                                  "history buffer, predictor and pending "
+                                  "tables")
+    cl_acc_size = Param.Unsigned(4, "Entries in the cacheline accumulator")
+    hw_contexts = Param.Unsigned(1, "Hardware thread contexts of the core, "
+                                 "they split the cl_acc_size entries "
+                                 "unless shared_context_state is set")
+    path_history_size = Param.Unsigned(32, "Store PCs in the path history")
+    shared_context_state = Param.Bool(False, "Share one path history and "
+                                      "cacheline accumulator between the "
+                                      "hardware thread contexts")
+    stale_entry_age_threshold = Param.Unsigned(200, "Insertions after which "
+                                               "a predictor table entry is "
+                                               "stale")
+    ihb_pattern_match_thresh = Param.Unsigned(10, "Accuracy percentage "
+                                              "below which an IHB pattern is "
+                                              "disabled")
+    ihb_pattern_min_count = Param.Unsigned(50, "Predictions before the IHB "
+                                           "pattern threshold is used")
+    correct_addr_prediction_age_reward = Param.Unsigned(20, "Age removed "
+                                            "from an entry on a correct "
+                                            "address prediction")
+    correct_data_prediction_age_reward = Param.Unsigned(80, "Age removed "
+                                            "from an entry on a correct "
+                                            "data prediction")
+    enable_const_0_prediction = Param.Bool(False, "Predict chunks that were "
+                                           "always zero as constants")
+    disable_confidence = Param.Bool(False, "Evict predictor table entries "
+                                    "by age instead of confidence")
+    disable_per_pc_confidence = Param.Bool(False, "Ignore the confidence of "
+                                           "the generating PCs")
+    disable_free_prediction = Param.Bool(False, "Do not predict writes from "
+                                         "the cacheline accumulator")
+    disable_fancy_addr_pred = Param.Bool(False, "Do not replace predicted "
+                                         "addresses using the address "
+                                         "predictor")
+    addr_predictor = Param.AddrPredictorKind('delta', "Address predictor "
+                                             "used unless "
+                                             "disable_fancy_addr_pred is set")
+    disable_whb_search = Param.Bool(False, "Do not search the write history "
+                                    "buffer for pending chunks")
+    volatile_dump = Param.String("", "File to write the binary store trace "
+                                 "to, empty to disable. Decode it with "
+                                 "util/decode_pmweaver_trace.py")
+    volatile_dump_compression = Param.TraceCompression('no_compression',
+                                    "Compression of the store trace")
+    pcs_of_interest = VectorParam.Addr([], "PCs to trace")
+    snapshot = Param.String("", "File to write sampled snapshots of the "
+                            "write history buffer and predictor table to, "
+                            "empty to disable. Decode it with "
+                            "util/decode_pmweaver_snapshot.py")
+    snapshot_trigger = Param.SnapshotTrigger('tick_period', "Whether the "
+                                             "snapshot period is in ticks "
+                                             "or flushed cachelines")
+    snapshot_period = Param.UInt64(1000000000, "Ticks or events between "
+                                   "snapshots")
+    backend = Param.PredictorBackend(NULL, "Backend verifying the "
+                                     "predictions, none to drop them")
+    channel_size = Param.Unsigned(1024, "Messages buffered in each "
+                                  "direction of the channel to the backend")
+    prediction_latency = Param.Latency('0ns', "Latency of a prediction to "
+                                       "reach the backend")
+    feedback_latency = Param.Latency('0ns', "Latency of the backend "
+                                     "feedback to reach the frontend")
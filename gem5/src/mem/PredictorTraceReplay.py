@@ -0,0 +1,28 @@
+from m5.params import *
+from m5.proxy import *
+from m5.SimObject import SimObject
+
+# Drives a predictor frontend and backend from the traces they wrote during a
+# full system or SE simulation, see configs/pmweaver/pmweaver_replay.py
+class PredictorTraceReplay(SimObject):
+    type = 'PredictorTraceReplay'
+    cxx_header = "mem/predictor_trace_replay.hh"
+
+    system = Param.System(Parent.any, "System the replay belongs to")
+    frontend = Param.PredictorFrontend("Frontend fed with the store trace")
+    backend = Param.PredictorBackend("Backend fed with the writeback trace")
+    mem_ctrl = Param.DRAMCtrl(NULL, "Controller the writebacks are verified "
+                              "at, reports the prediction timeliness")
+
+    store_trace = Param.String("Store and CLWB trace of the frontend "
+                               "(volatile_dump)")
+    writeback_trace = Param.String("", "Writeback trace of the backend "
+                                   "(non_volatile_dump), empty if none")
+    page_size = Param.MemorySize('4kB', "Page size of the traced workload")
+    always_enabled = Param.Bool(False, "Enable the predictor for the whole "
+                                "trace instead of following the region of "
+                                "interest markers")
+
+    # Only used to satisfy the connection check of the frontend, the replay
+    # calls into the frontend directly
+    port = MasterPort("Connects to the slave port of the frontend")
@@ -0,0 +1,234 @@
+#include "mem/bmo_pipeline.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+
+unsigned
+BMOPipeline::addStage(const Stage &stage)
+{
+    fatal_if(find(stage.name) >= 0, "BMO stage %s added twice", stage.name);
+    fatal_if(stage.inputs == 0 && stage.after.empty(), "BMO stage %s has no "
+             "inputs", stage.name);
+    fatal_if(stage.repeat == 0, "BMO stage %s does no operation",
+             stage.name);
+    for (unsigned dep : stage.after) {
+        fatal_if(dep >= stages.size(), "BMO stage %s depends on a stage "
+                 "that is not added yet", stage.name);
+    }
+    fatal_if(stage.queueSize > 0 && !stage.limited(), "BMO stage %s has an "
+             "input queue but no limit on its throughput", stage.name);
+
+    bool data = stage.inputs & DATA;
+    for (unsigned dep : stage.after) {
+        data = data || dataDependent[dep];
+    }
+
+    stages.push_back(stage);
+    finish.push_back(0);
+    dataDependent.push_back(data);
+
+    Engine engine;
+    engine.unitFree.resize(stage.units, 0);
+    engines.push_back(engine);
+    return stages.size() - 1;
+}
+
+int
+BMOPipeline::find(const std::string &name) const
+{
+    for (unsigned i = 0; i < stages.size(); i++) {
+        if (stages[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+Tick
+BMOPipeline::readyTick(unsigned i, Tick addrGen, Tick dataGen) const
+{
+    const Stage &stage = stages[i];
+
+    Tick ready = 0;
+    if (stage.inputs & ADDR) {
+        ready = std::max(ready, addrGen);
+    }
+    if (stage.inputs & DATA) {
+        ready = std::max(ready, dataGen);
+    }
+    for (unsigned dep : stage.after) {
+        ready = std::max(ready, finish[dep]);
+    }
+    return ready;
+}
+
+Tick
+BMOPipeline::stageLatency(unsigned i, const MetadataAccess &metadata) const
+{
+    const Stage &stage = stages[i];
+    return stage.latency * stage.repeat
+           + stageMetadataMisses(i, metadata) * stage.metadataMissLatency;
+}
+
+unsigned
+BMOPipeline::stageMetadataMisses(unsigned i,
+                                 const MetadataAccess &metadata) const
+{
+    const Stage &stage = stages.at(i);
+
+    unsigned misses = 0;
+    if (stage.readsCounter && !metadata.counterCacheHit) {
+        misses++;
+    }
+    if (stage.readsVerification) {
+        misses += metadata.verificationCacheMisses;
+    }
+    return misses;
+}
+
+Tick
+BMOPipeline::finishTick(Tick addrGen, Tick dataGen,
+                        const MetadataAccess &metadata) const
+{
+    Tick result = 0;
+    for (unsigned i = 0; i < stages.size(); i++) {
+        finish[i] = readyTick(i, addrGen, dataGen)
+                    + stageLatency(i, metadata);
+        result = std::max(result, finish[i]);
+    }
+    return result;
+}
+
+Tick
+BMOPipeline::issue(Tick now, Tick addrGen, Tick dataGen,
+                   const MetadataAccess &metadata, bool addrDone)
+{
+    Tick result = 0;
+    for (unsigned i = 0; i < stages.size(); i++) {
+        const Stage &stage = stages[i];
+        Engine &engine = engines[i];
+
+        Tick ready = readyTick(i, addrGen, dataGen);
+        Tick start = ready;
+        engine.busy = 0;
+
+        if (stage.limited() && (dataDependent[i] || !addrDone)) {
+            // Drops the operations that started
+            queued(engine, now);
+
+            auto unit = std::min_element(engine.unitFree.begin(),
+                                         engine.unitFree.end());
+            start = std::max(ready, *unit);
+            engine.busy = stage.initiationInterval * stage.repeat;
+            *unit = start + engine.busy;
+
+            if (start > ready && start > now) {
+                engine.waiting.emplace_back(ready, start);
+            }
+        }
+
+        engine.queueing = start - ready;
+        finish[i] = start + stageLatency(i, metadata);
+        result = std::max(result, finish[i]);
+    }
+    return result;
+}
+
+unsigned
+BMOPipeline::queued(Engine &engine, Tick now)
+{
+    // Operations that started left the queue
+    auto started = std::remove_if(engine.waiting.begin(),
+                                  engine.waiting.end(),
+                                  [now](const std::pair<Tick, Tick> &op) {
+                                      return op.second <= now;
+                                  });
+    engine.waiting.erase(started, engine.waiting.end());
+
+    // Operations whose inputs are not known yet are not queued yet
+    return std::count_if(engine.waiting.begin(), engine.waiting.end(),
+                         [now](const std::pair<Tick, Tick> &op) {
+                             return op.first <= now;
+                         });
+}
+
+bool
+BMOPipeline::full(Tick now)
+{
+    for (unsigned i = 0; i < stages.size(); i++) {
+        if (stages[i].queueSize > 0 &&
+                queued(engines[i], now) >= stages[i].queueSize) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Tick
+BMOPipeline::queueFreeTick(Tick now)
+{
+    Tick result = MaxTick;
+    for (unsigned i = 0; i < stages.size(); i++) {
+        Engine &engine = engines[i];
+        if (stages[i].queueSize == 0 ||
+                queued(engine, now) < stages[i].queueSize) {
+            continue;
+        }
+
+        Tick stageFree = MaxTick;
+        for (const auto &op : engine.waiting) {
+            if (op.first <= now) {
+                stageFree = std::min(stageFree, op.second);
+            }
+        }
+        // Every full queue needs room
+        result = result == MaxTick ? stageFree : std::max(result, stageFree);
+    }
+    return result;
+}
+
+unsigned
+BMOPipeline::metadataMisses(const MetadataAccess &metadata) const
+{
+    // Every metadata line is read once per write, whatever the number of
+    // stages that use it
+    return (readsCounter() && !metadata.counterCacheHit)
+           + (readsVerification() ? metadata.verificationCacheMisses : 0);
+}
+
+bool
+BMOPipeline::readsCounter() const
+{
+    return std::any_of(stages.begin(), stages.end(),
+                       [](const Stage &s) { return s.readsCounter; });
+}
+
+bool
+BMOPipeline::readsVerification() const
+{
+    return std::any_of(stages.begin(), stages.end(),
+                       [](const Stage &s) { return s.readsVerification; });
+}
+
+unsigned
+BMOPipeline::resultBytes() const
+{
+    unsigned result = 0;
+    for (const Stage &stage : stages) {
+        result += stage.resultBytes;
+    }
+    return result;
+}
+
+unsigned
+BMOPipeline::operations(bool addrOnly) const
+{
+    unsigned result = 0;
+    for (unsigned i = 0; i < stages.size(); i++) {
+        if (!addrOnly || !dataDependent[i]) {
+            result += stages[i].repeat;
+        }
+    }
+    return result;
+}
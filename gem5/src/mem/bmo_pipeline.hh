@@ -0,0 +1,177 @@
+#ifndef __MEM_BMO_PIPELINE_HH__
+#define __MEM_BMO_PIPELINE_HH__
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Backend memory operations (BMOs) applied by DRAMCtrl to every PM write,
+ * as a DAG of stages. A stage starts once its inputs are known, the address
+ * or data of the write and the stages it depends on, and takes its latency
+ * once per operation plus the latency of its metadata cache misses. The
+ * write is done when every stage is done, the address and data generation
+ * times of predicted writes let stages start before the write arrives.
+ *
+ * The engine of a stage can have a limited number of pipelined units, each
+ * accepting an operation every initiation interval. Operations wait in the
+ * input queue of the engine until a unit is free, the engines serve the
+ * writes in the order they are issued.
+ */
+class BMOPipeline
+{
+  public:
+    /** Inputs of a stage that come from the write itself */
+    enum Input : uint8_t
+    {
+        ADDR = 1 << 0,
+        DATA = 1 << 1
+    };
+
+    struct Stage
+    {
+        std::string name;
+        /** Mask of Input */
+        uint8_t inputs = 0;
+        /** Stages that must be done before this one starts */
+        std::vector<unsigned> after;
+        /** Latency of one operation */
+        Tick latency = 0;
+        /** Operations done back to back for every write */
+        unsigned repeat = 1;
+        /** Metadata caches read, every miss adds metadataMissLatency */
+        bool readsCounter = false;
+        bool readsVerification = false;
+        Tick metadataMissLatency = 0;
+        /** Pipelined units of the engine, 0 for unlimited */
+        unsigned units = 0;
+        /** Time a unit is busy with one operation, 0 for unlimited */
+        Tick initiationInterval = 0;
+        /** Operations that can wait for a unit, 0 for unbounded */
+        unsigned queueSize = 0;
+        /** Bytes of result kept when the stage is done ahead of the write */
+        unsigned resultBytes = 0;
+
+        bool limited() const { return units > 0 && initiationInterval > 0; }
+    };
+
+    /** Metadata cache lookups of one write */
+    struct MetadataAccess
+    {
+        bool counterCacheHit = true;
+        unsigned verificationCacheMisses = 0;
+    };
+
+  private:
+    /** In topological order, stages only depend on earlier stages */
+    std::vector<Stage> stages;
+
+    struct Engine
+    {
+        /** Tick every unit accepts its next operation */
+        std::vector<Tick> unitFree;
+        /** Ready and start ticks of the operations waiting for a unit */
+        std::vector<std::pair<Tick, Tick>> waiting;
+        /** Busy and queueing ticks of the last write */
+        Tick busy = 0;
+        Tick queueing = 0;
+    };
+
+    std::vector<Engine> engines;
+
+    /** True for the stages that need the data, directly or not */
+    std::vector<bool> dataDependent;
+
+    /** Finish tick of every stage of the last write */
+    mutable std::vector<Tick> finish;
+
+    /** Tick the inputs of stage are known */
+    Tick readyTick(unsigned stage, Tick addrGen, Tick dataGen) const;
+
+    /** Time stage takes once started */
+    Tick stageLatency(unsigned stage, const MetadataAccess &metadata) const;
+
+    /** Operations waiting for a unit of the engine at now */
+    static unsigned queued(Engine &engine, Tick now);
+
+  public:
+    /**
+     * Appends a stage, the stages it depends on must already be added
+     * @return Index of the stage
+     */
+    unsigned addStage(const Stage &stage);
+
+    /** Index of the stage called name, -1 if there is none */
+    int find(const std::string &name) const;
+
+    /**
+     * Tick at which every stage is done for a write
+     * @param addrGen Tick the address of the write was known
+     * @param dataGen Tick the data of the write was known
+     */
+    Tick finishTick(Tick addrGen, Tick dataGen,
+                    const MetadataAccess &metadata) const;
+
+    /**
+     * Like finishTick, but the operations of the write occupy the engines
+     * and wait for a free unit
+     * @param now Tick the write is issued
+     * @param addrDone The stages that do not need the data were done ahead
+     *                 of the write, they do not occupy the engines again
+     */
+    Tick issue(Tick now, Tick addrGen, Tick dataGen,
+               const MetadataAccess &metadata, bool addrDone = false);
+
+    /** Finish tick of a stage in the last call to finishTick or issue */
+    Tick stageFinishTick(unsigned stage) const { return finish.at(stage); }
+
+    /** Ticks the units of stage were busy with the last issued write */
+    Tick stageBusyTicks(unsigned stage) const
+    {
+        return engines.at(stage).busy;
+    }
+
+    /** Ticks the last issued write waited for a unit of stage */
+    Tick stageQueueingTicks(unsigned stage) const
+    {
+        return engines.at(stage).queueing;
+    }
+
+    /** True if the input queue of an engine is full at now */
+    bool full(Tick now);
+
+    /** Earliest tick a full input queue has room again, MaxTick if none */
+    Tick queueFreeTick(Tick now);
+
+    /** Metadata reads of a write that go to memory */
+    unsigned metadataMisses(const MetadataAccess &metadata) const;
+
+    /**
+     * Metadata reads of stage that miss, a line read by several stages
+     * counts for each of them
+     */
+    unsigned stageMetadataMisses(unsigned stage,
+                                 const MetadataAccess &metadata) const;
+
+    bool readsCounter() const;
+    bool readsVerification() const;
+
+    /** True if stage needs the data of the write, directly or not */
+    bool usesData(unsigned stage) const { return dataDependent.at(stage); }
+
+    /** Bytes of results of every stage done for one write */
+    unsigned resultBytes() const;
+
+    /**
+     * Operations of every stage done for one write
+     * @param addrOnly Only count the stages that do not need the data
+     */
+    unsigned operations(bool addrOnly = false) const;
+
+    bool empty() const { return stages.empty(); }
+    const std::vector<Stage> &getStages() const { return stages; }
+};
+
+#endif // __MEM_BMO_PIPELINE_HH__
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "mem/bmo_pipeline.hh"
+
+namespace {
+
+const Tick ENC = 40000;
+const Tick HASH = 40000;
+const Tick DEDUP = 300000;
+const Tick MISS = 40000;
+const unsigned TREE_HEIGHT = 12;
+
+BMOPipeline::Stage
+stage(const std::string &name, uint8_t inputs, Tick latency)
+{
+    BMOPipeline::Stage s;
+    s.name = name;
+    s.inputs = inputs;
+    s.latency = latency;
+    s.metadataMissLatency = MISS;
+    return s;
+}
+
+/** Encryption and integrity verification */
+void
+addEV(BMOPipeline &pipeline)
+{
+    unsigned enc = pipeline.addStage(stage("encryption", BMOPipeline::ADDR,
+                                           ENC));
+
+    BMOPipeline::Stage tree = stage("tree_update", 0, HASH);
+    tree.after = {enc};
+    tree.repeat = 1 + TREE_HEIGHT;
+    tree.readsCounter = true;
+    tree.readsVerification = true;
+    pipeline.addStage(tree);
+
+    BMOPipeline::Stage mac = stage("mac", BMOPipeline::DATA, HASH);
+    mac.after = {enc};
+    pipeline.addStage(mac);
+}
+
+/** Deduplication and wear levelling */
+void
+addDW(BMOPipeline &pipeline)
+{
+    pipeline.addStage(stage("wear_levelling", BMOPipeline::ADDR, 0));
+
+    BMOPipeline::Stage dedup = stage("dedup", BMOPipeline::DATA, DEDUP);
+    dedup.readsCounter = true;
+    pipeline.addStage(dedup);
+}
+
+} // anonymous namespace
+
+TEST(BMOPipelineTest, EncryptionAndVerification)
+{
+    BMOPipeline pipeline;
+    addEV(pipeline);
+
+    for (Tick addr : {Tick(0), Tick(100000), Tick(2000000)}) {
+        for (Tick data : {Tick(0), Tick(500000), Tick(3000000)}) {
+            for (bool hit : {false, true}) {
+                for (unsigned misses : {0u, 3u}) {
+                    BMOPipeline::MetadataAccess md;
+                    md.counterCacheHit = hit;
+                    md.verificationCacheMisses = misses;
+
+                    Tick addrOnly = addr + ENC + (hit ? 0 : MISS)
+                                    + HASH * (1 + TREE_HEIGHT)
+                                    + misses * MISS;
+                    Tick dataFinish = std::max(addr + ENC, data) + HASH;
+
+                    EXPECT_EQ(std::max(addrOnly, dataFinish),
+                              pipeline.finishTick(addr, data, md));
+                    EXPECT_EQ(!hit + misses, pipeline.metadataMisses(md));
+                }
+            }
+        }
+    }
+}
+
+TEST(BMOPipelineTest, DedupAndWearLevelling)
+{
+    BMOPipeline pipeline;
+    addDW(pipeline);
+
+    BMOPipeline::MetadataAccess md;
+    md.counterCacheHit = false;
+    md.verificationCacheMisses = 5;
+
+    EXPECT_EQ(1000 + DEDUP + MISS, pipeline.finishTick(2000, 1000, md));
+    EXPECT_EQ(1u, pipeline.metadataMisses(md));
+    EXPECT_EQ(0u, pipeline.stageMetadataMisses(0, md));
+    EXPECT_EQ(1u, pipeline.stageMetadataMisses(1, md));
+    EXPECT_TRUE(pipeline.readsCounter());
+    EXPECT_FALSE(pipeline.readsVerification());
+}
+
+TEST(BMOPipelineTest, StagesCombine)
+{
+    BMOPipeline ev, dw, both;
+    addEV(ev);
+    addDW(dw);
+    addEV(both);
+    addDW(both);
+
+    BMOPipeline::MetadataAccess md;
+    md.counterCacheHit = false;
+    md.verificationCacheMisses = 2;
+
+    EXPECT_EQ(std::max(ev.finishTick(0, 900000, md),
+                       dw.finishTick(0, 900000, md)),
+              both.finishTick(0, 900000, md));
+    /* The counter line is read once for both */
+    EXPECT_EQ(3u, both.metadataMisses(md));
+    /* but it is a miss of every stage that reads it */
+    ASSERT_GE(both.find("dedup"), 0);
+    EXPECT_EQ(1u, both.stageMetadataMisses(both.find("dedup"), md));
+    EXPECT_EQ(3u, both.stageMetadataMisses(both.find("tree_update"), md));
+    EXPECT_EQ(0u, both.stageMetadataMisses(both.find("mac"), md));
+
+    int mac = both.find("mac");
+    ASSERT_GE(mac, 0);
+    EXPECT_EQ(900000 + HASH, both.stageFinishTick(mac));
+    EXPECT_EQ(-1, both.find("compression"));
+}
+
+TEST(BMOPipelineTest, UnlimitedEnginesDoNotQueue)
+{
+    BMOPipeline pipeline;
+    addEV(pipeline);
+
+    BMOPipeline::MetadataAccess md;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(pipeline.finishTick(0, 0, md),
+                  pipeline.issue(0, 0, 0, md));
+        EXPECT_EQ(0u, pipeline.stageQueueingTicks(0));
+    }
+}
+
+TEST(BMOPipelineTest, EnginesQueueOperations)
+{
+    BMOPipeline pipeline;
+    BMOPipeline::Stage hash = stage("hash", BMOPipeline::DATA, HASH);
+    hash.units = 2;
+    hash.initiationInterval = 10000;
+    hash.queueSize = 2;
+    pipeline.addStage(hash);
+
+    BMOPipeline::MetadataAccess md;
+    /* Two units take the first two writes */
+    EXPECT_EQ(HASH, pipeline.issue(0, 0, 0, md));
+    EXPECT_EQ(HASH, pipeline.issue(0, 0, 0, md));
+    EXPECT_EQ(10000u, pipeline.stageBusyTicks(0));
+    EXPECT_FALSE(pipeline.full(0));
+
+    /* The next two wait for a unit */
+    EXPECT_EQ(10000 + HASH, pipeline.issue(0, 0, 0, md));
+    EXPECT_EQ(10000u, pipeline.stageQueueingTicks(0));
+    EXPECT_EQ(10000 + HASH, pipeline.issue(0, 0, 0, md));
+    EXPECT_TRUE(pipeline.full(0));
+    EXPECT_EQ(10000u, pipeline.queueFreeTick(0));
+
+    /* They left the queue once started */
+    EXPECT_FALSE(pipeline.full(10000));
+    EXPECT_EQ(MaxTick, pipeline.queueFreeTick(10000));
+
+    /* Both units are busy until 20000, the queueing starts from the tick
+     * the data was known */
+    EXPECT_EQ(20000 + HASH, pipeline.issue(15000, 5000, 5000, md));
+    EXPECT_EQ(15000u, pipeline.stageQueueingTicks(0));
+}
+
+TEST(BMOPipelineTest, DataDependentStages)
+{
+    BMOPipeline pipeline;
+    BMOPipeline::Stage pad = stage("pad", BMOPipeline::ADDR, ENC);
+    pad.resultBytes = 64;
+    unsigned padStage = pipeline.addStage(pad);
+
+    BMOPipeline::Stage mac = stage("mac", BMOPipeline::DATA, HASH);
+    mac.after = {padStage};
+    mac.resultBytes = 8;
+    unsigned macStage = pipeline.addStage(mac);
+
+    /* Only needs the data through the MAC */
+    BMOPipeline::Stage tree = stage("tree", 0, HASH);
+    tree.after = {macStage};
+    tree.repeat = 1 + TREE_HEIGHT;
+    unsigned treeStage = pipeline.addStage(tree);
+
+    EXPECT_FALSE(pipeline.usesData(padStage));
+    EXPECT_TRUE(pipeline.usesData(macStage));
+    EXPECT_TRUE(pipeline.usesData(treeStage));
+    EXPECT_EQ(72u, pipeline.resultBytes());
+    EXPECT_EQ(3 + TREE_HEIGHT, pipeline.operations());
+    EXPECT_EQ(1u, pipeline.operations(true));
+}
+
+TEST(BMOPipelineTest, AddressStagesDoneAhead)
+{
+    BMOPipeline pipeline;
+    BMOPipeline::Stage pad = stage("pad", BMOPipeline::ADDR, ENC);
+    pad.units = 1;
+    pad.initiationInterval = ENC;
+    pipeline.addStage(pad);
+
+    BMOPipeline::MetadataAccess md;
+    EXPECT_EQ(ENC, pipeline.issue(0, 0, 0, md));
+    EXPECT_EQ(ENC, pipeline.stageBusyTicks(0));
+
+    /* The pad is not computed again, the unit stays free */
+    EXPECT_EQ(ENC, pipeline.issue(0, 0, 0, md, true));
+    EXPECT_EQ(0u, pipeline.stageBusyTicks(0));
+    EXPECT_EQ(2 * ENC, pipeline.issue(0, 0, 0, md));
+}
@@ -0,0 +1,78 @@
+#include "mem/bmo_stage.hh"
+
+#include <unordered_map>
+
+#include "base/logging.hh"
+
+BMOStage::BMOStage(const Params *p)
+    : SimObject(p)
+{
+}
+
+namespace {
+
+/** Index of stage in pipeline, adding its dependencies first */
+unsigned
+addStage(BMOStage *stage, BMOPipeline &pipeline,
+         std::unordered_map<BMOStage *, int> &added)
+{
+    const BMOStage::Params *p = stage->params();
+
+    auto it = added.find(stage);
+    if (it != added.end()) {
+        fatal_if(it->second < 0, "BMO stage %s depends on itself",
+                 stage->name());
+        return it->second;
+    }
+    // Marks the stage as in progress to catch cycles
+    added[stage] = -1;
+
+    BMOPipeline::Stage desc;
+    desc.name = stage->name();
+    desc.inputs = (p->after_addr ? BMOPipeline::ADDR : 0)
+                  | (p->after_data ? BMOPipeline::DATA : 0);
+    for (BMOStage *dep : p->after) {
+        desc.after.push_back(addStage(dep, pipeline, added));
+    }
+    desc.latency = p->latency;
+    desc.repeat = p->repeat;
+    for (auto metadata : p->metadata) {
+        switch (metadata) {
+          case Enums::counter:
+            desc.readsCounter = true;
+            break;
+          case Enums::verification:
+            desc.readsVerification = true;
+            break;
+          default:
+            panic("Unknown BMO metadata %d", metadata);
+        }
+    }
+    desc.metadataMissLatency = p->metadata_miss_latency;
+    desc.units = p->units;
+    desc.initiationInterval = p->initiation_interval;
+    desc.queueSize = p->queue_size;
+    desc.resultBytes = p->result_bytes;
+
+    unsigned index = pipeline.addStage(desc);
+    added[stage] = index;
+    return index;
+}
+
+} // anonymous namespace
+
+void
+BMOStage::buildPipeline(const std::vector<BMOStage *> &stages,
+                        BMOPipeline &pipeline)
+{
+    std::unordered_map<BMOStage *, int> added;
+    for (BMOStage *stage : stages) {
+        addStage(stage, pipeline, added);
+    }
+}
+
+BMOStage *
+BMOStageParams::create()
+{
+    return new BMOStage(this);
+}
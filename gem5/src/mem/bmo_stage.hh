@@ -0,0 +1,36 @@
+#ifndef __MEM_BMO_STAGE_HH__
+#define __MEM_BMO_STAGE_HH__
+
+#include <vector>
+
+#include "mem/bmo_pipeline.hh"
+#include "params/BMOStage.hh"
+#include "sim/sim_object.hh"
+
+/**
+ * Configuration of one stage of the BMO pipeline of DRAMCtrl, see
+ * BMOPipeline. The stage only describes itself, DRAMCtrl evaluates the
+ * DAG of its stages.
+ */
+class BMOStage : public SimObject
+{
+  public:
+    typedef BMOStageParams Params;
+
+    BMOStage(const Params *p);
+
+    const Params *
+    params() const
+    {
+        return static_cast<const Params *>(_params);
+    }
+
+    /**
+     * Adds the stages and, before them, the stages they depend on to
+     * pipeline. A stage reached through several paths is added once.
+     */
+    static void buildPipeline(const std::vector<BMOStage *> &stages,
+                              BMOPipeline &pipeline);
+};
+
+#endif // __MEM_BMO_STAGE_HH__
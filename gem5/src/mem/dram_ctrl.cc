@@ -58,9 +58,11 @@
 #include "debug/Drain.hh"
 #include "debug/BMO.hh" 
 #include "debug/QOS.hh"
+#include "mem/bmo_stage.hh"
 #include "mem/predictor_backend.hh"
 #include "sim/system.hh"
 
+#include <algorithm>
 #include <cstdlib>
 
 #include "../helper_suyash.h"
@@ -68,80 +70,10 @@
 using namespace std;    
 using namespace Data;
 
-std::deque<CompletedWriteEntry> 
-DRAMCtrl::pendingPredictionQueue = std::deque<CompletedWriteEntry>();
 std::string DRAMCtrl::enableNonVolatileDump = "";
 std::ofstream DRAMCtrl::myFile = std::ofstream("/ramdisk/nonvolatiledump_dramctrl.txt");
 
-std::unordered_map<Addr, Tick> 
-DRAMCtrl::clwbLatency;
-
-// initialize CounterLog
-std::unordered_map<Addr, DRAMCtrl::CounterLogEntry*> DRAMCtrl::CounterLog;
-
-// Korakit: not used?
-// initialize global_counter
-uint32_t DRAMCtrl::global_counter = 0;
-//Korakit: merged into single metadata write queue?
-
-// initialize CounterWriteQueue
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::CounterWriteQueue;
-std::unordered_set<Addr> DRAMCtrl::CounterWriteQueueAddr;
-
-
-std::unordered_map<Addr, bool> DRAMCtrl::CounterAtomicWait;
-
-// Counter can be colocated with dedup.
-
-// initialize AtomicCounterWriteQueue
-bool DRAMCtrl::hasCounterCacheFlushed = true;
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::AtomicCounterWriteQueue;
-
-// initialize counter cache
-std::unordered_map<unsigned, 
-		std::unordered_map<Addr, DRAMCtrl::CounterCacheEntry*> > DRAMCtrl::CounterCache = std::unordered_map<unsigned, std::unordered_map<Addr, DRAMCtrl::CounterCacheEntry*> >();
-
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::CounterCacheMissQueue;
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::CounterCacheEvictionQueue;
-//std::unordered_set<Addr> DRAMCtrl::CounterCacheMSHR;
-
-// deduplication read
-std::deque<DRAMCtrl::dedupReadQueueEntry*> DRAMCtrl::dedupReadQueue;
-
-// verification cache
-std::unordered_map<Addr, DRAMCtrl::VerificationCacheEntry*> DRAMCtrl::VerificationCache;
-
-std::deque<DRAMCtrl::VerificationWriteQueueEntry*> DRAMCtrl::VerificationCacheMissQueue;
-std::deque<DRAMCtrl::VerificationWriteQueueEntry*> DRAMCtrl::VerificationCacheEvictionQueue;
-std::unordered_set<Addr> DRAMCtrl::VerificationCacheMSHR;
-
-
-///////////////////////////
-
-std::unordered_set<Addr> DRAMCtrl::TXOptAddrBuffer;
-std::unordered_map<std::string, opt_record> DRAMCtrl::TXOptBuffer; 
-std::unordered_map<Addr, std::string> DRAMCtrl::TXOptPmemToOptAddrMap;
-std::unordered_map<Addr, bool> DRAMCtrl::TXOptFlush2Write;
 int TXOptPmemToOptAddrMap_size_max =0;
-//std::unordered_map<Addr, uint64_t> DRAMCtrl::CounterCache;
-
-uint64_t DRAMCtrl::EvictionCnt = 0;
-//uint64_t DRAMCtrl::tot_counter_cache_read = 0;	
-//uint64_t DRAMCtrl::counter_cache_read_hit = 0;
-uint64_t DRAMCtrl::atomic_writes = 0;
-uint64_t DRAMCtrl::atomic_wait = 0;
-uint64_t DRAMCtrl::init_hit_cnt = 0;	
-uint64_t DRAMCtrl::init_cnt = 0;	
-unsigned DRAMCtrl::counter_write_length = 0;
-
-bool DRAMCtrl::hasCounterCacheInit = false;
-bool DRAMCtrl::hasVerificationCacheInit = false;
-/*
-uint64_t DRAMCtrl::TXOptWriteCnt = 0;
-uint64_t DRAMCtrl::nonTXOptWriteCnt = 0;
-uint64_t DRAMCtrl::numTXOptInstr = 0;
-uint64_t DRAMCtrl::tot_num_writes = 0;
-*/
 
 DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
     QoS::MemCtrl(p),
@@ -149,6 +81,14 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
     retryRdReq(false), retryWrReq(false),
     nextReqEvent([this]{ processNextReqEvent(); }, name()),
     respondEvent([this]{ processRespondEvent(); }, name()),
+    bmoRetryEvent([this]{ processBMORetryEvent(); }, name()),
+    isDWEnabled(p->enable_dw), isEVEnabled(p->enable_ev),
+    precomputeBuffer(p->precompute_buffer_entries,
+                     p->precompute_buffer_size),
+    precomputeOpEnergy(p->precompute_op_energy),
+    disableAddrPredPerf(p->disable_addr_pred_perf),
+    disableDataPredPerf(p->disable_data_pred_perf),
+    predictorBackend(p->predictor_backend),
     deviceSize(p->device_size),
     deviceBusWidth(p->device_bus_width), burstLength(p->burst_length),
     deviceRowBufferSize(p->device_rowbuffer_size),
@@ -183,8 +123,16 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
     nextReqTime(0),
     stats(*this),
     activeRank(0), timeStampOffset(0),
-    lastStatsResetTick(0), enableDRAMPowerdown(p->enable_dram_powerdown)
+    lastStatsResetTick(0), enableDRAMPowerdown(p->enable_dram_powerdown),
+    VerificationCache(VERIFICATION_CACHE_SIZE, p->verification_cache_assoc,
+                      VERIFICATION_TREE_HEIGHT,
+                      p->verification_cache_partitioned,
+                      p->verification_cache_replacement_policy)
 {
+    if (predictorBackend != nullptr) {
+        predictorBackend->attachMemCtrl(this);
+    }
+
     // sanity check the ranks since we rely on bit slicing for the
     // address decoding
     fatal_if(!isPowerOf2(ranksPerChannel), "DRAM rank count of %d is not "
@@ -269,20 +217,29 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
         }
     }
     
-    isDWEnabled = get_env_val(ENABLE_DW);
-    isEVEnabled = get_env_val(ENABLE_EV);
-
     std::cerr << "isDWEnabled = " << isDWEnabled << std::endl;
     std::cerr << "isEVEnabled = " << isEVEnabled << std::endl;
 
-    if (not myFile.is_open()) {
-        char* envResult = std::getenv("ENABLE_NON_VOLATILE_DUMP");
+    if (!p->bmo_stages.empty()) {
+        BMOStage::buildPipeline(p->bmo_stages, bmoPipeline);
+    } else {
+        addBuiltinBMOStages(p);
+    }
 
-        if (envResult != nullptr) {
-            this->enableNonVolatileDump = std::string(envResult);
-        } else {
-            enableNonVolatileDump = "0";
-        }
+    if (precomputeBuffer.enabled()) {
+        fatal_if(p->precompute_buffer_size > 0 and
+                 bmoPipeline.resultBytes() > p->precompute_buffer_size,
+                 "The BMO results of a write (%dB) do not fit in the "
+                 "precomputation buffer (%dB)", bmoPipeline.resultBytes(),
+                 p->precompute_buffer_size);
+        // The buffer is what makes the early work of the predictions count
+        fatal_if(disableAddrPredPerf or disableDataPredPerf,
+                 "The precomputation buffer needs the address and data "
+                 "predictions to be used");
+    }
+
+    if (not myFile.is_open()) {
+        enableNonVolatileDump = p->non_volatile_dump;
         myFile.open("/ramdisk/nonvolatiledump_dramctrl.txt");
         std::cerr << "is open = " << myFile.is_open() << std::endl;
         std::cerr << "myfile opened at " << std::endl;
@@ -730,12 +687,15 @@ DRAMCtrl::printQs() const
 void
 DRAMCtrl::checkPendingPredictionQueue() {
     stats.pendingPredictionQueueChecks++;
-    while (!DRAMCtrl::pendingPredictionQueue.empty()) {
-        CompletedWriteEntry top = DRAMCtrl::pendingPredictionQueue.front();
+    while (!this->pendingPredictionQueue.empty()) {
+        CompletedWriteEntry &top = this->pendingPredictionQueue.front();
         /* Read the metadata caches here, the actual check for hit is done in the backend */
         DPRINTF(BMOLatency, GRN "Accessing caches for address %p" RST "\n", (void*)top.get_addr());
-        this->readCounterCache(top.get_addr());
+        bool counterCacheHit = this->readCounterCache(top.get_addr());
         this->readVerificationCache(top);
+        if (precomputeBuffer.enabled() and not bmoPipeline.empty()) {
+            this->precomputeBMOs(top, counterCacheHit);
+        }
         pendingPredictionQueue.pop_front();
     }
 
@@ -756,13 +716,83 @@ DRAMCtrl::isAddrNonVolatile(Addr addr) {
     return result;
 }
 
-Tick
-DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted) {
+void
+DRAMCtrl::addBuiltinBMOStages(const DRAMCtrlParams *p)
+{
+    fatal_if(p->bmo_engine_queue_size > 0 and
+             (p->bmo_engine_units == 0 or
+              p->bmo_engine_initiation_interval == 0),
+             "BMO engine queues need a limited engine throughput");
+
+    // Every built in stage gets the same engine
+    auto addStage = [this, p](BMOPipeline::Stage &stage) {
+        stage.units = p->bmo_engine_units;
+        stage.initiationInterval = p->bmo_engine_initiation_interval;
+        stage.queueSize = p->bmo_engine_queue_size;
+        return bmoPipeline.addStage(stage);
+    };
+
     /**
      * Annotations from the Fig 6 of
      * Liu, Sihang, et al. "Janus: optimizing memory and storage support for non-volatile memory systems." 
      * Proceedings of the 46th International Symposium on Computer Architecture. ACM, 2019.
     */
+    if (isEVEnabled) {
+        BMOPipeline::Stage encryption;
+        encryption.name = "encryption";
+        encryption.inputs = BMOPipeline::ADDR;
+        encryption.latency = ENCRYPTION_LATENCY;
+        // The ciphertext of the line
+        encryption.resultBytes = CACHELINE_SIZE;
+        unsigned encryptionStage = addStage(encryption);
+
+        // Number 1, the counter and every level of the tree are updated
+        BMOPipeline::Stage treeUpdate;
+        treeUpdate.name = "tree_update";
+        treeUpdate.after = {encryptionStage};
+        treeUpdate.latency = IV_HASH_LATENCY;
+        treeUpdate.repeat = 1 + VERIFICATION_TREE_HEIGHT;
+        treeUpdate.readsCounter = true;
+        treeUpdate.readsVerification = true;
+        treeUpdate.metadataMissLatency = METADATA_CACHE_MISS_LATENCY;
+        treeUpdate.resultBytes = verification_hash_size * treeUpdate.repeat;
+        addStage(treeUpdate);
+
+        // Number 2
+        BMOPipeline::Stage mac;
+        mac.name = "mac";
+        mac.inputs = BMOPipeline::DATA;
+        mac.after = {encryptionStage};
+        mac.latency = IV_HASH_LATENCY;
+        mac.resultBytes = verification_hash_size;
+        addStage(mac);
+    }
+
+    if (isDWEnabled) {
+        // Number 1
+        BMOPipeline::Stage wearLevelling;
+        wearLevelling.name = "wear_levelling";
+        wearLevelling.inputs = BMOPipeline::ADDR;
+        wearLevelling.latency = WEAR_LEVELLING;
+        // The remapped line address
+        wearLevelling.resultBytes = sizeof(Addr);
+        addStage(wearLevelling);
+
+        // Number 2
+        BMOPipeline::Stage dedup;
+        dedup.name = "dedup";
+        dedup.inputs = BMOPipeline::DATA;
+        dedup.latency = DE_DUP_HASH_LATENCY;
+        dedup.readsCounter = true;
+        dedup.metadataMissLatency = METADATA_CACHE_MISS_LATENCY;
+        // The outcome of the hash lookup, the line it duplicates if any
+        dedup.resultBytes = sizeof(Addr);
+        addStage(dedup);
+    }
+}
+
+Tick
+DRAMCtrl::getWriteLatency(PacketPtr pkt, const CompletedWriteEntry &completedWriteEntry, bool addrPredicted, bool dataPredicted, Tick precomputed, bool addrDone) {
     DPRINTF(BMOLatency, CYN "addrCompletionTime = %d, dataCompletionTime = %d, "
             "addrPredicted = %d, dataPredicted = %d, counterCacheHit = %d, "
             "verificationCacheHit = %d" RST "\n", 
@@ -783,10 +813,6 @@ DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry
     bool wasCounterCacheHit = pkt->counterCacheHit;
     uint64_t verficationCacheMissCount = pkt->verificationCacheMisses;
 
-    if (isEVEnabled and isDWEnabled) {
-        panic("EV and DW cannot coexist");
-    }
-
     Tick timeOfAddrGen = completedWriteEntry.get_time_of_addr_gen();
     Tick timeOfDataGen = completedWriteEntry.get_time_of_data_gen();
 
@@ -796,88 +822,45 @@ DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry
 
     /** 
      * Disable performance gain with address and data generation selectively 
-     * based on the enivronment variables */
-    if (get_env_val("DISABLE_ADDR_PRED_PERF")) {
+     * based on the controller parameters */
+    if (disableAddrPredPerf) {
         timeOfAddrGen = curTick();
     }
-    if (get_env_val("DISABLE_DATA_PRED_PERF")) {
+    if (disableDataPredPerf) {
         timeOfDataGen = curTick();
     }
 
-    if (isEVEnabled) {
-        uint64_t addrFinishTick = timeOfAddrGen
-                                    + ENCRYPTION_LATENCY
-                                    + (wasCounterCacheHit ? 0 : METADATA_CACHE_MISS_LATENCY)
-                                    + (IV_HASH_LATENCY * (1 + VERIFICATION_TREE_HEIGHT))
-                                    + (verficationCacheMissCount * METADATA_CACHE_MISS_LATENCY);
-
-        // std::cout << "Current tick = " << curTick() << " address finish tick() = " << addrFinishTick << std::endl;
-
-        Tick addrOnlyFinishTick = 0; // Number 1
-        Tick dataOnlyFinishTick = timeOfDataGen;
-
-        stats.extraMemoryAccesses += !wasCounterCacheHit + verficationCacheMissCount;
-
-        addrOnlyFinishTick = ENCRYPTION_LATENCY
-                            + (wasCounterCacheHit ? 0 : METADATA_CACHE_MISS_LATENCY)
-                            + (IV_HASH_LATENCY * (1 + VERIFICATION_TREE_HEIGHT))
-                            + (verficationCacheMissCount * METADATA_CACHE_MISS_LATENCY);
-
-        addrOnlyFinishTick += timeOfAddrGen;
-
-        Tick dataFinishTick = 0; // Number 2
-        Tick independentAddrLatency = timeOfAddrGen + ENCRYPTION_LATENCY;
+    if (not bmoPipeline.empty()) {
+        BMOPipeline::MetadataAccess metadata;
+        metadata.counterCacheHit = wasCounterCacheHit;
+        metadata.verificationCacheMisses = verficationCacheMissCount;
 
-        // std::cout << "Verifcication cache misses = " << verficationCacheMissCount << std::endl;
-
-        dataFinishTick = std::max(independentAddrLatency, dataOnlyFinishTick) + IV_HASH_LATENCY;
-
-        finishTick = std::max(addrOnlyFinishTick, dataFinishTick);
-
-        //! SM  Temporary Fix for removing address latency
-        // finishTick = completedWriteEntry.get_time_of_data_gen() + HASH_LATENCY;
-
-        // finishTick = std::max(addrOnlyFinishTick, dataFinishTick);
-        if (finishTick > curTick()) {
-            this->stats.bmoFinishAfter++;
-            result = finishTick - curTick();
+        // Only the integrity verification reports its metadata reads as
+        // extra memory accesses, the other stages have per engine counts
+        if (bmoPipeline.readsVerification()) {
+            stats.extraMemoryAccesses += bmoPipeline.metadataMisses(metadata);
+        }
+        for (unsigned i = 0; i < bmoPipeline.getStages().size(); i++) {
+            stats.bmoEngineMetadataMisses[i] +=
+                bmoPipeline.stageMetadataMisses(i, metadata);
+        }
+        if (precomputed != MaxTick) {
+            // Every result is in the precomputation buffer
+            finishTick = precomputed;
         } else {
-            this->stats.bmoFinishBefore++;
-            result = 0;
+            finishTick = issueBMOs(timeOfAddrGen, timeOfDataGen, metadata,
+                                   addrDone);
         }
-    }   
-
-    if (isDWEnabled) {
-        // std::cout << "CurTick = " << curTick() << std::endl;
-        // Number 1
-        Tick addrOnlyFinishTick = timeOfAddrGen;
-
-        // std::cout << "Address only finish tick " << addrOnlyFinishTick << std::endl;
-        Tick wearLevellingFinishTick = addrOnlyFinishTick
-                                        + WEAR_LEVELLING;
 
-        // std::cout << "data time of generation = " << timeOfDataGen;
-        // Number 2
-        Tick dataOnlyFinishTick = timeOfDataGen
-                                + DE_DUP_HASH_LATENCY
-                                + (wasCounterCacheHit ? 0 : METADATA_CACHE_MISS_LATENCY);
-        // std::cout << "dataOnlyFinishTick = " << dataOnlyFinishTick << std::endl;
-        // Number 3
-        Tick dependentFinishTick = std::max(addrOnlyFinishTick, dataOnlyFinishTick);
-
-        finishTick = std::max(dependentFinishTick, wearLevellingFinishTick);
-        // std::cout <<  "dependent = " << dependentFinishTick  << " " << "wearlevelling = " << wearLevellingFinishTick << std::endl;
         if (finishTick > curTick()) {
             this->stats.bmoFinishAfter++;
             result = finishTick - curTick();
-            // std::cout << "Result = " << result;
         } else {
             this->stats.bmoFinishBefore++;
             result = 0;
         }
-
     }
-    
+
     stats.timeliness.sample(
         (curTick() - std::max(completedWriteEntry.get_time_of_data_gen(), completedWriteEntry.get_time_of_addr_gen()))/1000
     );
@@ -888,6 +871,144 @@ DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry
 }
 
 
+Tick
+DRAMCtrl::issueBMOs(Tick addrGen, Tick dataGen,
+                    const BMOPipeline::MetadataAccess &metadata,
+                    bool addrDone)
+{
+    Tick finishTick = bmoPipeline.issue(curTick(), addrGen, dataGen,
+                                        metadata, addrDone);
+
+    for (unsigned i = 0; i < bmoPipeline.getStages().size(); i++) {
+        if (addrDone and not bmoPipeline.usesData(i)) {
+            continue;
+        }
+        stats.bmoEngineOps[i]++;
+        stats.bmoEngineBusyTicks[i] +=
+            (double)bmoPipeline.stageBusyTicks(i)
+            / std::max(1u, bmoPipeline.getStages()[i].units);
+        stats.bmoEngineQueueingTicks[i] +=
+            bmoPipeline.stageQueueingTicks(i);
+    }
+    return finishTick;
+}
+
+uint64_t
+DRAMCtrl::precomputeTag(const CompletedWriteEntry &prediction)
+{
+    // The chunks that are not predicted are not part of the results
+    const CacheLine &line = prediction.get_cacheline();
+    const ChunkMask valid = line.get_valid_mask();
+    const DataChunk *words = line.get_data_words();
+
+    uint64_t tag = 0xcbf29ce484222325ULL ^ valid;
+    for (size_t i = 0; i < DATA_CHUNK_COUNT; i++) {
+        if ((valid >> i) & 1) {
+            tag = (tag ^ words[i]) * 0x100000001b3ULL;
+        }
+    }
+    return tag;
+}
+
+void
+DRAMCtrl::precomputeBMOs(const CompletedWriteEntry &prediction,
+                         bool counterCacheHit)
+{
+    BMOPipeline::MetadataAccess metadata;
+    metadata.counterCacheHit = counterCacheHit;
+    metadata.verificationCacheMisses = prediction.verificationCacheMisses;
+
+    // The predictions compete with the writes for the engines
+    PrecomputeBuffer::Entry entry;
+    entry.addr = prediction.get_addr();
+    entry.tag = precomputeTag(prediction);
+    entry.ready = issueBMOs(prediction.get_time_of_addr_gen(),
+                            prediction.get_time_of_data_gen(), metadata);
+    entry.bytes = bmoPipeline.resultBytes();
+    entry.addrOps = bmoPipeline.operations(true);
+    entry.dataOps = bmoPipeline.operations() - entry.addrOps;
+
+    DPRINTF(BMO, "Precomputed the BMOs of %p, ready at %d\n",
+            (void*)entry.addr, entry.ready);
+    stats.precomputeOps += entry.addrOps + entry.dataOps;
+
+    std::vector<PrecomputeBuffer::Entry> evicted;
+    bool replaced;
+    bool inserted = precomputeBuffer.insert(entry, evicted, &replaced);
+    panic_if(not inserted, "BMO results of %p do not fit in the "
+             "precomputation buffer", (void*)entry.addr);
+
+    // A refreshed prediction of the same line and data is not wasted
+    if (replaced) {
+        stats.precomputeReplacements++;
+    }
+    stats.precomputeEvictions += evicted.size();
+    wastePrecomputedBMOs(evicted);
+
+    stats.precomputeOccupancy = precomputeBuffer.size();
+    stats.precomputeOccupancyBytes = precomputeBuffer.bytes();
+}
+
+Tick
+DRAMCtrl::takePrecomputedBMOs(Addr addr, CompletedWriteEntry &write,
+                              bool dataPredicted, bool &addrDone)
+{
+    // Only the results of the data that is written can be used
+    const PrecomputeBuffer::Entry *hit = dataPredicted
+            ? precomputeBuffer.find(addr, precomputeTag(write)) : nullptr;
+    const PrecomputeBuffer::Entry *addrHit = hit ? nullptr
+            : precomputeBuffer.newest(addr);
+
+    Tick ready = MaxTick;
+    addrDone = false;
+    if (hit) {
+        DPRINTF(BMO, "Using the precomputed BMOs of %p\n", (void*)addr);
+        stats.precomputeHits++;
+        ready = hit->ready;
+    } else if (addrHit) {
+        // The data was mispredicted, the results that need it are redone
+        DPRINTF(BMO, "Recomputing the data BMOs of %p\n", (void*)addr);
+        stats.precomputeAddrHits++;
+        stats.precomputeWastedOps += addrHit->dataOps;
+        addrDone = true;
+        write.set_time_of_data_gen(curTick());
+    } else {
+        // Nothing was done ahead of the write
+        stats.precomputeMisses++;
+        write.set_time_of_addr_gen(curTick());
+        write.set_time_of_data_gen(curTick());
+    }
+
+    // A line has one entry per predicted data, the others are wasted
+    const PrecomputeBuffer::Entry *used = hit ? hit : addrHit;
+    const uint64_t usedTag = used ? used->tag : 0;
+
+    std::vector<PrecomputeBuffer::Entry> removed;
+    precomputeBuffer.erase(addr, removed);
+    if (used) {
+        removed.erase(std::remove_if(removed.begin(), removed.end(),
+                                     [usedTag](const PrecomputeBuffer::Entry
+                                               &entry) {
+                                         return entry.tag == usedTag;
+                                     }),
+                      removed.end());
+    }
+    wastePrecomputedBMOs(removed);
+
+    stats.precomputeOccupancy = precomputeBuffer.size();
+    stats.precomputeOccupancyBytes = precomputeBuffer.bytes();
+    return ready;
+}
+
+void
+DRAMCtrl::wastePrecomputedBMOs(
+        const std::vector<PrecomputeBuffer::Entry> &entries)
+{
+    for (const auto &entry : entries) {
+        stats.precomputeWastedOps += entry.addrOps + entry.dataOps;
+    }
+}
+
 void
 DRAMCtrl::dumpTrace(PacketPtr pkt) {
     // std::cout << "Trying to dump pkt with size = " << pkt->getSize() << " isNonVolatileAddress = " << pkt->req->getPaddr() << std::endl;
@@ -940,11 +1061,10 @@ DRAMCtrl::dumpTrace(PacketPtr pkt) {
 }
 
 void
-DRAMCtrl::emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted) {
-    DPRINTF(BMO, "Emnulating slowdown\n");
-    std::cout << "Emulating slowdown for adddress " << (void*)pkt->req->getPaddr() 
-              << " with addrPredicted = " << addrPredicted << " datPredicted  = " 
-              << dataPredicted << std::endl;
+DRAMCtrl::emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry &completedWriteEntry, bool addrPredicted, bool dataPredicted) {
+    DPRINTF(BMO, "Emulating slowdown for address %p with addrPredicted = %d "
+            "dataPredicted = %d\n", (void*)pkt->req->getPaddr(),
+            addrPredicted, dataPredicted);
 
     stats.BMOLatencyEmulationCount++;
 
@@ -961,10 +1081,18 @@ DRAMCtrl::emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEn
         completedWriteEntry.set_time_of_data_gen(curTick());
     }
 
-    Tick bmoLatency = this->getWriteLatency(pkt, completedWriteEntry, addrPredicted, dataPredicted);
+    Tick precomputed = MaxTick;
+    bool addrDone = false;
+    if (precomputeBuffer.enabled() and not bmoPipeline.empty()) {
+        precomputed = this->takePrecomputedBMOs(pkt->req->getPaddr(),
+                                                completedWriteEntry,
+                                                dataPredicted, addrDone);
+    }
+
+    Tick bmoLatency = this->getWriteLatency(pkt, completedWriteEntry, addrPredicted, dataPredicted, precomputed, addrDone);
     /* Add the address to the clwb slowdown map */
     // std::cout << RED << "Latency = " << bmoLatency << " which had verifcication cache misses = " << pkt->verificationCacheMisses << RST << std::endl;
-    DRAMCtrl::clwbLatency[pkt->req->getPaddr()] = bmoLatency;
+    this->clwbLatency[pkt->req->getPaddr()] = bmoLatency;
 }
 
 void
@@ -1082,88 +1210,74 @@ DRAMCtrl::BMOHandleWriteRequest(PacketPtr pkt) {
 
     auto addrKey = paddr;
 
-    if (PredictorBackend::completedWrites.find(addrKey) == PredictorBackend::completedWrites.end()) {
+    if (predictorBackend == nullptr
+            or not predictorBackend->completedWrites.contains(addrKey)) {
         DPRINTF(BMO, "Address not predicted\n");
         wasAddrPredicted = false;
     }
 
-    if (PredictorBackend::completedWrites[addrKey].empty()) {
-        wasAddrPredicted = false;
-    }
-
-    CompletedWriteEntry completedWriteEntry;
+    /* Stands in for the prediction when the data was not predicted */
+    CompletedWriteEntry unpredictedEntry;
+    ResultBuffer::Node *matchedNode = nullptr;
     /* Only check the data prediction if the address was predicted */
-    auto &completedWritesForAddr_q = PredictorBackend::completedWrites[addrKey];
     if (wasAddrPredicted) {
         DPRINTF(BMO, "Address was predicted \n");
 
-        int  i = 0;
-        size_t indexToDelete = -1;
-
-        auto completedWrite_iter = completedWritesForAddr_q.rbegin();
-        while (completedWrite_iter != completedWritesForAddr_q.rend()) {
-            // std::cerr << "iter = " << i++ << ", size = " << completedWritesForAddr_q.size() << std::endl;
-            auto completedEntry = *completedWrite_iter;
-            hash_t confKey = completedWrite_iter->get_generator_hash();
+        /* Newest prediction first */
+        auto node = predictorBackend->completedWrites.newest(addrKey);
+        while (node != nullptr) {
+            const auto &completedEntry = node->entry;
             if (completedEntry.is_used() and PredictorBackend::isPktEqualCompletedEntryAddr(pkt,  completedEntry)) {
                 /* Check if the backend has already seen this entry */
                 assert(completedEntry.is_used());
                 if (PredictorBackend::isPktEqualCompletedEntry(pkt, completedEntry)) {
-		    std::cout << "Entry age = " << (curTick()-completedEntry.get_time_of_addr_gen()) << " current tick = " << curTick() << " free?=" << completedEntry.get_cacheline().get_datachunks()[0].is_free_prediction() << std::endl;
                     /* Found a predicted entry for this write */
-                    DPRINTF(BMO, "Data was predicted\n");
+                    DPRINTF(BMO, "Data was predicted, entry age = %d, free? = %d, "
+                            "predictions for the address = %d\n",
+                            curTick() - completedEntry.get_time_of_addr_gen(),
+                            completedEntry.get_cacheline().get_datachunks()[0].is_free_prediction(),
+                            predictorBackend->completedWrites.line_size(addrKey));
                     wasDataPredicted = true;
-		    std::cout << "using entry from queue of size: " << completedWritesForAddr_q.size() << std::endl;
                     /* Remove the entry from the queue so that this doesn't match again with any future writes */
-                    indexToDelete = i;
+                    matchedNode = node;
                     break;
                 }
 
             }
-            ++completedWrite_iter;
+            node = node->older;
         }
-
-        if (indexToDelete != -1) {
-            DPRINTF(BMO, "Using entry with index = %d\n", indexToDelete);
-            // std::cerr << "Deleting entry at index (match found): " << indexToDelete << std::endl;
-
-            // Suyash: Don't erase this for now and just mark it as used
-            try {
-                completedWritesForAddr_q.at(indexToDelete);
-            } catch (...) {
-                panic("Element at index %d not found", indexToDelete);
-            }
-            completedWriteEntry = completedWritesForAddr_q[indexToDelete];
-            completedWritesForAddr_q.erase(completedWritesForAddr_q.begin() + indexToDelete// ,
-					   // completedWritesForAddr_q.end()
-					   );
-            // if (completedWritesForAddr_q.empty()) {
-            //     PredictorBackend::completedWritesEntry.erase(addrKey);
-            //     PredictorBackend::comletedWritesManager.erase(addrKey);
-            // }
-            // completedWritesForAddr_q.erase( completedWritesForAddr_q.begin() + indexToDelete );
-        } 
     }
 
     if (not wasDataPredicted) {
         /* If the data was not predicted set all the details of the 
-           completedWriteEntry */
-        if (completedWritesForAddr_q.empty()) {
-            completedWriteEntry.set_time_of_addr_gen(curTick());
-            completedWriteEntry.set_time_of_data_gen(curTick());
+           unpredicted entry */
+        ResultBuffer::Node *oldest = predictorBackend == nullptr ? nullptr
+                : predictorBackend->completedWrites.oldest(addrKey);
+        if (oldest == nullptr) {
+            unpredictedEntry.set_time_of_addr_gen(curTick());
+            unpredictedEntry.set_time_of_data_gen(curTick());
         } else {
-            auto entry = completedWritesForAddr_q.front();
+            auto &entry = oldest->entry;
             // std::cout << "Adding entry with addr = " << " and genPC = " << entry.get_generator_pc_sig().first << ", " << entry.get_generator_pc_sig().first << std::endl;
-            completedWriteEntry.set_addr(entry.get_addr());
-            completedWriteEntry.set_time_of_addr_gen(entry.get_time_of_addr_gen());
+            unpredictedEntry.set_addr(entry.get_addr());
+            unpredictedEntry.set_time_of_addr_gen(entry.get_time_of_addr_gen());
         }
     }
 
-    if (PredictorBackend::addrMatches[pkt->req->getPaddr()] > 0) {
-        wasAddrPredicted = true;
+    if (predictorBackend != nullptr) {
+        auto matches = predictorBackend->addrMatches.find(paddr);
+        if (matches != predictorBackend->addrMatches.end()
+                and matches->second > 0) {
+            wasAddrPredicted = true;
+        }
     }
 
-    this->emulateBMOSlowdown(pkt, completedWriteEntry, wasAddrPredicted, wasDataPredicted);
+    if (matchedNode != nullptr) {
+        this->emulateBMOSlowdown(pkt, matchedNode->entry, wasAddrPredicted, wasDataPredicted);
+        predictorBackend->completedWrites.erase(matchedNode);
+    } else {
+        this->emulateBMOSlowdown(pkt, unpredictedEntry, wasAddrPredicted, wasDataPredicted);
+    }
 }
 
 void
@@ -1187,11 +1301,11 @@ DRAMCtrl::BMOHandleRequest(PacketPtr pkt) {
 
         // std::cout << "Reading counter cache " << std::endl;
 
-        if (isDWEnabled or isEVEnabled) {
+        if (bmoPipeline.readsCounter()) {
             this->readCounterCache(pkt);
         }
 
-        if (isEVEnabled) {
+        if (bmoPipeline.readsVerification()) {
             this->readVerificationCache(pkt);
         }
 
@@ -1200,12 +1314,12 @@ DRAMCtrl::BMOHandleRequest(PacketPtr pkt) {
             this->BMOHandleWriteRequest(pkt);
 
             // /* Write back the counter cache */
-            if (isEVEnabled or isDWEnabled) {
+            if (bmoPipeline.readsCounter()) {
                 this->writeCounterCache(pkt);
             }
             
             // /* Write back all the levels of the verification tree */
-            if (isEVEnabled) {
+            if (bmoPipeline.readsVerification()) {
                 for (int nodeLevel = 0; nodeLevel < VERIFICATION_TREE_HEIGHT; nodeLevel++) {
                     this->writeVerificationCache(pkt, nodeLevel);
                 }
@@ -1216,9 +1330,32 @@ DRAMCtrl::BMOHandleRequest(PacketPtr pkt) {
     }
 }
 
+void
+DRAMCtrl::verifyWriteback(PacketPtr pkt)
+{
+    if (PredictorBackend::predictorEnabled) {
+        this->BMOHandleRequest(pkt);
+    }
+}
+
 bool
 DRAMCtrl::recvTimingReq(PacketPtr pkt)
 {       
+    // Back-pressure from the BMO engines, refused before the BMOs of the
+    // write occupy them and before the write is marked and traced, so a
+    // retried write is traced once
+    if (PredictorBackend::predictorEnabled and pkt->isWrite()
+            and isAddrNonVolatile(pkt->req->getPaddr())
+            and bmoPipeline.full(curTick())) {
+        DPRINTF(BMO, "BMO engine queue full, not accepting\n");
+        retryWrReq = true;
+        stats.bmoEngineRetries++;
+        if (!bmoRetryEvent.scheduled()) {
+            schedule(bmoRetryEvent, bmoPipeline.queueFreeTick(curTick()));
+        }
+        return false;
+    }
+
     if (pkt->isWrite() and is_paddr_pm(pkt->req->getPaddr())) {
         if (rand() % 100 < DUP_RATE) {
             pkt->isDup = true;
@@ -1295,6 +1432,15 @@ DRAMCtrl::recvTimingReq(PacketPtr pkt)
     return true;
 }
 
+void
+DRAMCtrl::processBMORetryEvent()
+{
+    if (retryWrReq && totalWriteQueueSize < writeBufferSize) {
+        retryWrReq = false;
+        port.sendRetryReq();
+    }
+}
+
 void
 DRAMCtrl::processRespondEvent()
 {
@@ -3188,7 +3334,44 @@ DRAMCtrl::DRAMStats::DRAMStats(DRAMCtrl &_dram)
     ADD_STAT(untimelyPrediction, "untimelyPrediction"),
     ADD_STAT(bmoFinishBefore, "bmoFinishBefore"),
     ADD_STAT(bmoFinishDist, "bmoFinishDist"),
-    ADD_STAT(timeliness, "timeliness")
+    ADD_STAT(timeliness, "timeliness"),
+
+    ADD_STAT(bmoEngineOps, "Operations issued to every BMO engine"),
+    ADD_STAT(bmoEngineBusyTicks, "Ticks the units of every BMO engine were "
+             "busy, averaged over the units"),
+    ADD_STAT(bmoEngineQueueingTicks, "Ticks the operations waited for a "
+             "unit of every BMO engine"),
+    ADD_STAT(bmoEngineMetadataMisses, "Metadata reads of every BMO engine "
+             "that missed in the metadata caches"),
+    ADD_STAT(bmoEngineUtilization, "Utilization of every BMO engine (%)"),
+    ADD_STAT(bmoEngineAvgQueueingTicks, "Average ticks an operation waited "
+             "for a unit of every BMO engine"),
+    ADD_STAT(bmoEngineRetries, "PM writes refused because a BMO engine "
+             "queue was full"),
+
+    ADD_STAT(precomputeOps, "BMO operations done ahead of the writes from "
+             "the predictions"),
+    ADD_STAT(precomputeHits, "PM writes that used every precomputed BMO "
+             "result"),
+    ADD_STAT(precomputeAddrHits, "PM writes that only used the precomputed "
+             "results that do not need the data"),
+    ADD_STAT(precomputeMisses, "PM writes with no precomputed BMO result"),
+    ADD_STAT(precomputeEvictions, "Precomputed results evicted to make "
+             "room"),
+    ADD_STAT(precomputeReplacements, "Precomputed results replaced by the "
+             "results of the same prediction"),
+    ADD_STAT(precomputeWastedOps, "Precomputed BMO operations whose result "
+             "was never used"),
+    ADD_STAT(precomputeOccupancy, "Average lines in the precomputation "
+             "buffer"),
+    ADD_STAT(precomputeOccupancyBytes, "Average bytes in the precomputation "
+             "buffer"),
+    ADD_STAT(precomputeHitRate, "Fraction of the PM writes that used every "
+             "precomputed result"),
+    ADD_STAT(precomputeEnergy, "Energy of the BMOs done ahead of the "
+             "writes (pJ)"),
+    ADD_STAT(precomputeWastedEnergy, "Energy of the precomputed BMOs whose "
+             "result was never used (pJ)")
 {
 }
 
@@ -3337,6 +3520,31 @@ DRAMCtrl::DRAMStats::regStats()
     timeliness
         .init(0,10000,10000/100);
 
+    const auto &bmoStages = dram.bmoPipeline.getStages();
+    // Vectors need at least one entry
+    const size_t numBMOStages = std::max<size_t>(1, bmoStages.size());
+    bmoEngineOps.init(numBMOStages);
+    bmoEngineBusyTicks.init(numBMOStages);
+    bmoEngineQueueingTicks.init(numBMOStages);
+    bmoEngineMetadataMisses.init(numBMOStages);
+    for (size_t i = 0; i < bmoStages.size(); i++) {
+        bmoEngineOps.subname(i, bmoStages[i].name);
+        bmoEngineBusyTicks.subname(i, bmoStages[i].name);
+        bmoEngineQueueingTicks.subname(i, bmoStages[i].name);
+        bmoEngineMetadataMisses.subname(i, bmoStages[i].name);
+    }
+
+    bmoEngineUtilization = bmoEngineBusyTicks / simTicks * 100;
+    bmoEngineAvgQueueingTicks = bmoEngineQueueingTicks / bmoEngineOps;
+
+    precomputeOccupancy.precision(2);
+    precomputeOccupancyBytes.precision(2);
+    precomputeHitRate = precomputeHits /
+        (precomputeHits + precomputeAddrHits + precomputeMisses);
+    precomputeEnergy = precomputeOps * constant(dram.precomputeOpEnergy);
+    precomputeWastedEnergy = precomputeWastedOps
+                             * constant(dram.precomputeOpEnergy);
+
     std::cerr << "Inititiazed stats" << "\n";
 }
 
@@ -68,7 +68,11 @@
 #include "enums/AddrMap.hh"
 #include "enums/MemSched.hh"
 #include "enums/PageManage.hh"
+#include "mem/bmo_pipeline.hh"
 #include "mem/drampower.hh"
+#include "mem/merkle_node_cache.hh"
+#include "mem/metadata_cache.hh"
+#include "mem/precompute_buffer.hh"
 #include "mem/predictor/CompletedWriteEntry.hh"
 #include "mem/predictor/Common.hh"
 #include "mem/qos/mem_ctrl.hh"
@@ -801,8 +805,63 @@ class DRAMCtrl : public QoS::MemCtrl
     void processRespondEvent();
     EventFunctionWrapper respondEvent;
 
-    bool isDWEnabled = false; // De duplicaiton and wear levelling
-    bool isEVEnabled = false; // encryption and verification
+    /* Retries the PM writes refused while a BMO engine queue was full */
+    void processBMORetryEvent();
+    EventFunctionWrapper bmoRetryEvent;
+
+    const bool isDWEnabled; // De duplicaiton and wear levelling
+    const bool isEVEnabled; // encryption and verification
+
+    /* BMOs applied to the PM writes, empty if there are none */
+    BMOPipeline bmoPipeline;
+
+    /* Adds the stages of the enabled built in BMOs to bmoPipeline */
+    void addBuiltinBMOStages(const DRAMCtrlParams *p);
+
+    /* Results of the BMOs done from the predictions of the backend */
+    PrecomputeBuffer precomputeBuffer;
+
+    /* Energy of one BMO operation done ahead of a write (pJ) */
+    const double precomputeOpEnergy;
+
+    /**
+     * Issues the operations of a write to the BMO engines and updates their
+     * stats
+     * @return Tick every stage is done
+     */
+    Tick issueBMOs(Tick addrGen, Tick dataGen,
+                   const BMOPipeline::MetadataAccess &metadata,
+                   bool addrDone = false);
+
+    /* Does the BMOs of a prediction and keeps the results in precomputeBuffer */
+    void precomputeBMOs(const CompletedWriteEntry &prediction,
+                        bool counterCacheHit);
+
+    /**
+     * Takes the precomputed results of a PM write out of precomputeBuffer,
+     * the results of other predictions of the line are wasted
+     * @param write Prediction matching the write, its address and data
+     *              generation times are those the BMOs left to do start at
+     * @param addrDone Set if only the results that do not need the data
+     *                 could be used
+     * @return Tick the results are ready, MaxTick if the BMOs are not done
+     */
+    Tick takePrecomputedBMOs(Addr addr, CompletedWriteEntry &write,
+                             bool dataPredicted, bool &addrDone);
+
+    /* Accounts for precomputed results that are never used */
+    void wastePrecomputedBMOs(
+            const std::vector<PrecomputeBuffer::Entry> &entries);
+
+    /* Identifies the predicted data the results of a prediction are for */
+    static uint64_t precomputeTag(const CompletedWriteEntry &prediction);
+
+    /* Ignore the early address/data of predicted writes in the BMO latency */
+    const bool disableAddrPredPerf;
+    const bool disableDataPredPerf;
+
+    /* Backend whose predictions this controller verifies, may be nullptr */
+    PredictorBackend *const predictorBackend;
 
     /**
      * Check if the read queue has room for more entries
@@ -1222,6 +1281,29 @@ class DRAMCtrl : public QoS::MemCtrl
         Stats::Scalar bmoFinishBefore;
         Stats::Distribution bmoFinishDist;
         Stats::Distribution timeliness;
+
+        // BMO engines, one entry per stage
+        Stats::Vector bmoEngineOps;
+        Stats::Vector bmoEngineBusyTicks;
+        Stats::Vector bmoEngineQueueingTicks;
+        Stats::Vector bmoEngineMetadataMisses;
+        Stats::Formula bmoEngineUtilization;
+        Stats::Formula bmoEngineAvgQueueingTicks;
+        Stats::Scalar bmoEngineRetries;
+
+        // Precomputation buffer
+        Stats::Scalar precomputeOps;
+        Stats::Scalar precomputeHits;
+        Stats::Scalar precomputeAddrHits;
+        Stats::Scalar precomputeMisses;
+        Stats::Scalar precomputeEvictions;
+        Stats::Scalar precomputeReplacements;
+        Stats::Scalar precomputeWastedOps;
+        Stats::Average precomputeOccupancy;
+        Stats::Average precomputeOccupancyBytes;
+        Stats::Formula precomputeHitRate;
+        Stats::Formula precomputeEnergy;
+        Stats::Formula precomputeWastedEnergy;
     };
 
     DRAMStats stats;
@@ -1289,8 +1371,25 @@ class DRAMCtrl : public QoS::MemCtrl
      *
      */
     bool allRanksDrained() const;
-    static std::deque<CompletedWriteEntry> pendingPredictionQueue;
-    static std::unordered_map<Addr, Tick> clwbLatency;
+    std::deque<CompletedWriteEntry> pendingPredictionQueue;
+    std::unordered_map<Addr, Tick> clwbLatency;
+
+    /* BMO latency of the last CLWB to paddr, consumed by the call */
+    Tick takeClwbLatency(Addr paddr) {
+        auto latency = clwbLatency.find(paddr);
+        if (latency == clwbLatency.end()) {
+            return 0;
+        }
+        Tick result = latency->second;
+        clwbLatency.erase(latency);
+        return result;
+    }
+
+    /**
+     * Verifies the predictions against a PM writeback and runs its BMOs
+     * without accessing the DRAM, used by the trace replay
+     */
+    void verifyWriteback(PacketPtr pkt);
 
   protected:
 
@@ -1375,10 +1474,9 @@ class DRAMCtrl : public QoS::MemCtrl
 	}
 
   	// packet - number of writes: one for data and another for counter
-	// note that it is a static variable
-	static std::unordered_map<Addr, CounterLogEntry*> CounterLog;
+	std::unordered_map<Addr, CounterLogEntry*> CounterLog;
 
-	static uint32_t global_counter;
+	uint32_t global_counter = 0;
 
 	// Write queue for counters
 	// counters are not inserted to the write queue together with the data 
@@ -1401,15 +1499,15 @@ class DRAMCtrl : public QoS::MemCtrl
 		unsigned verification_pkt_count;
 	};
 	
-	static std::deque<CounterWriteQueueEntry*> CounterWriteQueue;
-  static std::deque<VerificationWriteQueueEntry*> VerificationWriteQueue;
+	std::deque<CounterWriteQueueEntry*> CounterWriteQueue;
+  std::deque<VerificationWriteQueueEntry*> VerificationWriteQueue;
 
 	// set of address of pending counter packets	
-	static std::unordered_set<Addr> CounterWriteQueueAddr;
-  static std::unordered_set<Addr> VerificationWriteQueueAddr;
+	std::unordered_set<Addr> CounterWriteQueueAddr;
+  std::unordered_set<Addr> VerificationWriteQueueAddr;
 
 	// addr map to hasDataReceived
-	static std::unordered_map<Addr, bool> CounterAtomicWait;
+	std::unordered_map<Addr, bool> CounterAtomicWait;
 //  Korakit
 //  keep enabled for non-blocking case
 #ifdef TXOPT_ENABLE
@@ -1444,8 +1542,8 @@ class DRAMCtrl : public QoS::MemCtrl
 		// }
 	}
 
-	static bool hasCounterCacheFlushed;
-	static std::deque<CounterWriteQueueEntry*> AtomicCounterWriteQueue;
+	bool hasCounterCacheFlushed = true;
+	std::deque<CounterWriteQueueEntry*> AtomicCounterWriteQueue;
 // Korakit
 // removed, never used
 /*
@@ -1468,22 +1566,6 @@ class DRAMCtrl : public QoS::MemCtrl
 		return false;
 	}
 */
-	// Counter Cache
-	// Fully associative
-	// True LRU
-	struct CounterCacheEntry {
-		Addr data_addr;
-		unsigned cnt = 0; //for LRU
-		bool dirty;
-	};
-	
-
-  struct VerificationCacheEntry {
-		Addr data_addr;
-		unsigned cnt = 0; //for LRU
-		bool dirty;
-	};
-
 	// input data address	
 	CounterWriteQueueEntry* createCounterPkt(Addr _addr) {
 		RequestPtr counter_req(new Request((_addr / 8 + COUNTER_ADDR_DIFF), 
@@ -1534,58 +1616,54 @@ class DRAMCtrl : public QoS::MemCtrl
 
 
 
-	static std::unordered_map<unsigned, 
-						std::unordered_map<Addr, CounterCacheEntry*> > CounterCache;
-	static std::deque<CounterWriteQueueEntry*> CounterCacheMissQueue;	
-	static std::deque<CounterWriteQueueEntry*> CounterCacheEvictionQueue;
-  static std::unordered_set<Addr> CounterCacheMSHR;
-  static std::unordered_map<Addr, VerificationCacheEntry*> VerificationCache;  //verification cache
-  static std::deque<VerificationWriteQueueEntry*> VerificationCacheMissQueue;
-	static std::deque<VerificationWriteQueueEntry*> VerificationCacheEvictionQueue;
-  static std::unordered_set<Addr> VerificationCacheMSHR;
-  static std::deque<dedupReadQueueEntry*> dedupReadQueue;
+	// Counter Cache
+	// NUM_WAY-way set associative, true LRU
+	static const unsigned num_sets = COUNTER_CACHE_SIZE / NUM_WAY;
+	MetadataCache CounterCache{num_sets, NUM_WAY, COUNTER_CACHE_LINE_SIZE};
+	std::deque<CounterWriteQueueEntry*> CounterCacheMissQueue;	
+	std::deque<CounterWriteQueueEntry*> CounterCacheEvictionQueue;
+  std::unordered_set<Addr> CounterCacheMSHR;
+  // Merkle tree node cache, organization set by the verification_cache_*
+  // params
+  MerkleNodeCache VerificationCache;
+  std::deque<VerificationWriteQueueEntry*> VerificationCacheMissQueue;
+	std::deque<VerificationWriteQueueEntry*> VerificationCacheEvictionQueue;
+  std::unordered_set<Addr> VerificationCacheMSHR;
+  std::deque<dedupReadQueueEntry*> dedupReadQueue;
 
   // Queue that temporarily going to hold writes before read and write operations on the caches are 
   // performed
-	static const unsigned num_sets = COUNTER_CACHE_SIZE / NUM_WAY;
 
-	static uint64_t EvictionCnt;	
+	uint64_t EvictionCnt = 0;	
 	//static uint64_t tot_counter_cache_read;	
 	//static uint64_t counter_cache_read_hit;
-	static uint64_t atomic_writes;
-	static uint64_t atomic_wait;
-
-
-	// find set
-	static unsigned getIndex(Addr _addr) {
-		unsigned index;
-		index = _addr / COUNTER_CACHE_LINE_SIZE - 
-			(_addr / COUNTER_CACHE_LINE_SIZE / num_sets) * num_sets;
-		assert(index < num_sets);
-		//DPRINTF(myflag3, "addr=%lld,index=%u\n", _addr, index);
-		return index;
+	uint64_t atomic_writes = 0;
+	uint64_t atomic_wait = 0;
+
+
+	// Inserts the counter line of _addr, a dirty victim is written back
+	MetadataCache::Line *fillCounterCache(Addr _addr, bool dirty) {
+		MetadataCache::Line evicted;
+		MetadataCache::Line *line = CounterCache.insert(_addr, dirty, evicted);
+		if (evicted.valid and evicted.dirty) {
+			EvictionCnt ++;
+			// create eviction packet
+			CounterWriteQueueEntry* evict_pkt = createCounterPkt(evicted.addr);
+			evict_pkt->counter_pkt->isCounterCacheEviction = true;
+			CounterCacheEvictionQueue.push_back(evict_pkt);
+		}
+		return line;
 	}
 
 public:
 	// Counter hash stores dedup and encryption info
-	static bool isCounterCacheHit(Addr _addr) {
-
-		unsigned index = getIndex(_addr);
-		if (CounterCache.find(index) != CounterCache.end()) {
-			if (CounterCache[index].find(_addr) != CounterCache[index].end()) {
-				return true;
-			}
-		}
-		
-		return false;
+	bool isCounterCacheHit(Addr _addr) {
+		return CounterCache.contains(_addr);
 	}
 
 
-  static bool isVerificationCacheHit(Addr _addr) {
-    if (VerificationCache.find(_addr) != VerificationCache.end()) {
-      return true;
-    }
-		return false;
+  bool isVerificationCacheHit(Addr _addr) {
+    return VerificationCache.contains(_addr);
 	}
 
   Addr dataToMTAddr(Addr dataAddr, int levelFromBottom){
@@ -1602,45 +1680,27 @@ private:
     return (dataAddr >> (levelFromBottom*3))+(1<<((VERIFICATION_TREE_HEIGHT-levelFromBottom)*3));
   }
 	
-	// return LRU for counter cache
-	Addr incrCacheCnt(Addr _addr) {
-		unsigned index = getIndex(_addr);
-		Addr LRU = -1;
-		unsigned max_cnt = 0;
-		for (auto i = CounterCache[index].begin(); 
-				i != CounterCache[index].end(); ++i) {
-
-			i->second->cnt++;
-			if (i->second->cnt > max_cnt) {
-				max_cnt = i->second->cnt;
-				LRU = i->first;
-			}
-		}
-		return LRU;
-	}
-
-  // return LRU for Verification cache
-	Addr incrVeriCacheCnt(Addr _addr) {
-		Addr LRU = -1;
-		unsigned max_cnt = 0;
-		for (auto i = VerificationCache.begin(); 
-				i != VerificationCache.end(); ++i) {
-
-			i->second->cnt++;
-			if (i->second->cnt > max_cnt) {
-				max_cnt = i->second->cnt;
-				LRU = i->first;
-			}
-		}
-		return LRU;
-	}
+  // Inserts the node MToffset of nodeLevel, a dirty victim is written back
+  MerkleNodeCache::Node *fillVerificationCache(Addr MToffset, int nodeLevel,
+                                               bool dirty) {
+    MerkleNodeCache::Victim victim;
+    MerkleNodeCache::Node *node =
+        VerificationCache.insert(MToffset, nodeLevel, dirty, victim);
+    if (victim.valid and victim.dirty) {
+      // create eviction packet
+      VerificationWriteQueueEntry* evict_pkt = createVerificationPkt(victim.key);
+      evict_pkt->verification_pkt->isVerificationCacheEviction = true;
+      VerificationCacheEvictionQueue.push_back(evict_pkt);
+    }
+    return node;
+  }
 
 
-	static bool hasCounterCacheInit;
-	static uint64_t init_cnt;
-	static uint64_t init_hit_cnt;
+	bool hasCounterCacheInit = false;
+	uint64_t init_cnt = 0;
+	uint64_t init_hit_cnt = 0;
 
-  static bool hasVerificationCacheInit;
+  bool hasVerificationCacheInit = false;
 
   bool isAddrVolatile(Addr addr);
   bool isAddrNonVolatile(Addr addr);
@@ -1648,8 +1708,8 @@ private:
   void BMOHandleRequest(PacketPtr pkt);
   void BMOHandleWriteRequest(PacketPtr pkt);
   void BMOHandleReadRequest(PacketPtr pkt);
-  Tick getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted);
-  void emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted);
+  Tick getWriteLatency(PacketPtr pkt, const CompletedWriteEntry &completedWriteEntry, bool addrPredicted, bool dataPredicted, Tick precomputed, bool addrDone);
+  void emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry &completedWriteEntry, bool addrPredicted, bool dataPredicted);
 
 	void initCounterCache(Addr max_addr) {
 		DPRINTF(myflag3, "@@ max_paddr=%llx\n", max_addr);
@@ -1668,29 +1728,9 @@ private:
 		atomic_writes = 0;
 		atomic_wait = 0;
 
-		max_addr = max_addr / COUNTER_CACHE_LINE_SIZE;
-		max_addr = max_addr * COUNTER_CACHE_LINE_SIZE;
-		for (Addr addr = 0; addr <= max_addr; addr += COUNTER_CACHE_LINE_SIZE) {
-			init_cnt++;
-			// insert to counter cache;
-			
-			bool isHit = isCounterCacheHit(addr);
-
-			Addr LRU = incrCacheCnt(addr);
-			unsigned index = getIndex(addr);
-			
-			if (!isHit) {
-				CounterCache[index][addr] = new CounterCacheEntry; 
-				CounterCache[index][addr]->dirty = false;
-				if (CounterCache[index].size() > NUM_WAY) {
-					delete CounterCache[index][LRU];
-					CounterCache[index].erase(LRU);
-				}
-			} else {
-				init_hit_cnt++;
-				CounterCache[index][addr]->cnt = 0;
-			}
-		}
+		// state left by inserting every counter line up to max_addr in
+		// order, every line is only inserted once so there are no hits
+		init_cnt += CounterCache.prefillSequential(max_addr);
 
 		hasCounterCacheInit = true;
 #ifdef TXOPT_ENABLE
@@ -1738,23 +1778,12 @@ private:
       for(int nodeLevel=0;nodeLevel<VERIFICATION_TREE_HEIGHT;nodeLevel++){
         Addr MToffset = dataToMTOffset(addr, nodeLevel);
         DPRINTF(myflag3, "@@ ---3\n");
-        bool isHit = isVerificationCacheHit(MToffset);
+        bool isHit = VerificationCache.access(MToffset, nodeLevel) != nullptr;
         DPRINTF(myflag3, "@@ ---4\n");
-        Addr LRU = incrVeriCacheCnt(MToffset);
-        
-        DPRINTF(myflag3, "@@ ---5\n");
         if (!isHit) {
-          VerificationCache[MToffset] = new VerificationCacheEntry; 
-          VerificationCache[MToffset]->dirty = false;
-          if (VerificationCache.size() > VERIFICATION_CACHE_SIZE) {
-            DPRINTF(myflag3, "@@ ---6\n");
-            delete VerificationCache[LRU];
-            VerificationCache.erase(LRU);
-            DPRINTF(myflag3, "@@ ---7\n");
-          }
-        } else {
-          //init_hit_cnt++;
-          VerificationCache[MToffset]->cnt = 0;
+          // every node is clean, nothing is written back
+          MerkleNodeCache::Victim victim;
+          VerificationCache.insert(MToffset, nodeLevel, false, victim);
         }
       }
     }
@@ -1779,14 +1808,8 @@ private:
 		_addr /= COUNTER_CACHE_LINE_SIZE;
 		_addr *= COUNTER_CACHE_LINE_SIZE;
 
-		unsigned index = getIndex(_addr);
-
-		bool isHit = isCounterCacheHit(_addr);
-		Addr CounterCacheLRU;
-		// increment existing cnt
-    if(!noUpdate){
-		  CounterCacheLRU = incrCacheCnt(_addr);
-    }
+		MetadataCache::Line *line = CounterCache.access(_addr);
+		bool isHit = line != nullptr;
 		if (!isHit) { // miss
 			RequestPtr counter_req(new Request((_addr / 8 + COUNTER_ADDR_DIFF), 
 												counter_size, Request::PHYSICAL,
@@ -1809,34 +1832,17 @@ private:
 			CounterCacheMissQueue.push_back(newCounterPacket);
 
       if(!noUpdate){
-
-        CounterCache[index][_addr] = new CounterCacheEntry;
-        CounterCache[index][_addr]->dirty = true;
-        
-        if (CounterCache[index].size() > NUM_WAY) { // evict LRU
-          if (CounterCache[index][CounterCacheLRU]->dirty) {
-            EvictionCnt ++;
-            // create eviction packet
-            CounterWriteQueueEntry* evict_pkt = createCounterPkt(CounterCacheLRU);
-            evict_pkt->counter_pkt->isCounterCacheEviction = true;
-            CounterCacheEvictionQueue.push_back(evict_pkt);
-          }
-          // eviction
-          delete CounterCache[index][CounterCacheLRU];
-          CounterCache[index].erase(CounterCacheLRU);
-          assert(CounterCache[index].size() == NUM_WAY);
-        }
+        line = fillCounterCache(_addr, true);
       }
 		} else { // hit
 			stats.totalCounterCacheReadHit++;
 			//counter_cache_read_hit++;
-			CounterCache[index][_addr]->dirty = true;
-			CounterCache[index][_addr]->cnt = 0;
+			line->dirty = true;
 			DPRINTF(myflag2, "Counter write hit, addr=%lld\n", _pkt->getAddr());
 		}
 		// if all writes are atomic, no dirty counter remains in counter cache
-		if (isCounterAtomicPkt(_pkt))
-			CounterCache[index][_addr]->dirty = false;
+		if (line != nullptr and isCounterAtomicPkt(_pkt))
+			line->dirty = false;
 		return isHit;
 	}
   
@@ -1852,8 +1858,8 @@ private:
     Addr MToffset = dataToMTOffset(_addr, nodeLevel);
     Addr MTAddr = dataToMTAddr(_addr, nodeLevel);
     DPRINTF(myflag_status, "DataAddr=%llx, MTAddr=0x%llx", _pkt->getAddr(), MTAddr);
-    bool isHit = isVerificationCacheHit(MToffset);
-    Addr VerificationCacheLRU = incrVeriCacheCnt(MToffset);
+    MerkleNodeCache::Node *node = VerificationCache.access(MToffset, nodeLevel);
+    bool isHit = node != nullptr;
 
     //handle miss/hit
     if (!isHit) { // miss
@@ -1877,27 +1883,11 @@ private:
 
       VerificationCacheMissQueue.push_back(newVerificationPacket);
 
-      VerificationCache[MToffset] = new VerificationCacheEntry;
-      VerificationCache[MToffset]->dirty = true;
-      
-      if (VerificationCache.size() > VERIFICATION_CACHE_SIZE) { // evict LRU
-        if (VerificationCache[VerificationCacheLRU]->dirty) {
-          //EvictionCnt ++;
-          // create eviction packet
-          VerificationWriteQueueEntry* evict_pkt = createVerificationPkt(VerificationCacheLRU);
-          evict_pkt->verification_pkt->isVerificationCacheEviction = true;
-          VerificationCacheEvictionQueue.push_back(evict_pkt);
-        }
-        // eviction
-        delete VerificationCache[VerificationCacheLRU];
-        VerificationCache.erase(VerificationCacheLRU);
-        assert(VerificationCache.size() == VERIFICATION_CACHE_SIZE);
-      }
+      fillVerificationCache(MToffset, nodeLevel, true);
     } else { // hit
       //totalCounterCacheReadHit++;
       //counter_cache_read_hit++;
-      VerificationCache[MToffset]->dirty = true;
-      VerificationCache[MToffset]->cnt = 0;
+      node->dirty = true;
     }
     // Korakit:
     // should not matter, we do not writethrough even for the counteratomic
@@ -1927,13 +1917,7 @@ private:
 		_addr /= COUNTER_CACHE_LINE_SIZE;
 		_addr *= COUNTER_CACHE_LINE_SIZE;
 
-		unsigned index = getIndex(_addr);
-		
-		//DPRINTF(myflag3, "index=%u, num_sets=%u, addr=%lld\n", index, num_sets, _addr);
-		bool isHit = isCounterCacheHit(_addr);
-
-		// increment existing cnt
-		Addr CounterCacheLRU = incrCacheCnt(_addr);		
+		bool isHit = CounterCache.access(_addr) != nullptr;
 
 		if (!isHit) { // miss
 			DPRINTF(myflag2, "Counter read miss, addr=%lld\n", _addr);
@@ -1957,30 +1941,11 @@ private:
 			newCounterPacket->counter_pkt_count = counter_pkt_count;
 
 			CounterCacheMissQueue.push_back(newCounterPacket);
-			CounterCache.at(index);
-			CounterCache[index][_addr] = new CounterCacheEntry;
-			CounterCache.at(index).at(_addr);
-			CounterCache[index][_addr]->dirty = false;
-			if (CounterCache[index].size() > NUM_WAY) { // evict LRU
-				if (CounterCache[index][CounterCacheLRU]->dirty) {
-			    CounterCache.at(index).at(CounterCacheLRU);
-					// create eviction packet
-					EvictionCnt ++;
-					CounterWriteQueueEntry* evict_pkt = createCounterPkt(CounterCacheLRU);
-					evict_pkt->counter_pkt->isCounterCacheEviction = true;
-					CounterCacheEvictionQueue.push_back(evict_pkt);
-				}
-				// eviction
-				delete CounterCache[index][CounterCacheLRU];
-        CounterCache.at(index).at(CounterCacheLRU);
-				CounterCache[index].erase(CounterCacheLRU);
-				assert(CounterCache[index].size() == NUM_WAY);
-			}
+			fillCounterCache(_addr, false);
 		} else { // hit
 			//counter_cache_read_hit++;
 			stats.totalCounterCacheReadHit++;
 			// DPRINTF(myflag2, "Counter read hit, addr=%lld\n", _pkt->getAddr());
-			CounterCache[index][_addr]->cnt = 0;
 		}
 		return isHit;
 	}
@@ -2052,9 +2017,7 @@ private:
 		//unsigned index = getIndex(_addr);
 		
 		//DPRINTF(myflag3, "index=%u, num_sets=%u, addr=%lld\n", index, num_sets, _addr);
-		bool isHit = isVerificationCacheHit(MToffset);
-		// increment existing cnt
-		Addr VerificationCacheLRU = incrVeriCacheCnt(MToffset);		
+		bool isHit = VerificationCache.access(MToffset, nodeLevel) != nullptr;
 
 		if (!isHit) { // miss
 			// printf("Verification read miss, addr=%lld\n", _addr);
@@ -2079,26 +2042,11 @@ private:
 
 			VerificationCacheMissQueue.push_back(newVerificationPacket);
 			
-			VerificationCache[MToffset] = new VerificationCacheEntry;
-			VerificationCache[MToffset]->dirty = false;
-			if (VerificationCache.size() > VERIFICATION_CACHE_SIZE) { // evict LRU
-				if (VerificationCache[VerificationCacheLRU]->dirty) {
-					// create eviction packet
-					//EvictionCnt ++;
-					VerificationWriteQueueEntry* evict_pkt = createVerificationPkt(VerificationCacheLRU);
-					evict_pkt->verification_pkt->isVerificationCacheEviction = true;
-					VerificationCacheEvictionQueue.push_back(evict_pkt);
-				}
-				// eviction
-				delete VerificationCache[VerificationCacheLRU];
-				VerificationCache.erase(VerificationCacheLRU);
-				assert(VerificationCache.size() == VERIFICATION_CACHE_SIZE);
-			}
+			fillVerificationCache(MToffset, nodeLevel, false);
 		} else { // hit
 			//counter_cache_read_hit++;
 			//totalCounterCacheReadHit++;
 			//DPRINTF(myflag2, "Counter read hit, addr=%lld\n", _pkt->getAddr());
-			VerificationCache[MToffset]->cnt = 0;
 		}
     // printf("%s:%d :: %s()\n", __FILE__, __LINE__, __FUNCTION__);
 		return isHit;
@@ -2132,25 +2080,16 @@ private:
 		// 			+ flush_vaddr - PAGE_SIZE_COMMON * (flush_vaddr / PAGE_SIZE_COMMON);
 		// }
     
-		//DPRINTF(myflag2, "flush counter cache: paddr=%llx, dirty=%d\n", 
-		//				flush_addr, CounterCache[getIndex(flush_addr)][flush_addr]->dirty);
-		for (auto i = CounterCache.begin(); i != CounterCache.end(); ++i) {
-			for (auto j = i->second.begin(); j != i->second.end(); ++j) {
-				Addr counter_pkt_addr = j->first;
-				// DPRINTF(myflag2, "flush counter cache, dirty=%d, addr=0x%llx\n", 
-															// j->second->dirty, flush_addr);
-				if (j->second->dirty && (/* (flush_vaddr == 0)
-							||  */(counter_pkt_addr / COUNTER_CACHE_LINE_SIZE 
-								== flush_addr / COUNTER_CACHE_LINE_SIZE))) {
-					CounterWriteQueue.push_back(createCounterPkt(counter_pkt_addr));
-					j->second->dirty = false;
-				}
-			}
+		// only the line of flush_addr can hold its counters
+		MetadataCache::Line *line = CounterCache.find(flush_addr);
+		if (line != nullptr and line->dirty) {
+			CounterWriteQueue.push_back(createCounterPkt(line->addr));
+			line->dirty = false;
 		}
 	}
 
 	//static unsigned counter_read_length;
-	static unsigned counter_write_length;
+	unsigned counter_write_length = 0;
 
 	bool counterWriteQueueFull(unsigned request_size) {
 	  DPRINTF(myflag, "counterWriteQueue full? %d\n", counter_write_length + request_size > COUNTER_WRITE_QUEUE_SIZE);
@@ -2163,13 +2102,13 @@ private:
 			  (counter_write_length == COUNTER_WRITE_QUEUE_SIZE);
 	}
 	//Korakit: from address set to address -> opt_record map
-	static std::unordered_set<Addr> TXOptAddrBuffer;
+	std::unordered_set<Addr> TXOptAddrBuffer;
 	
-	static std::unordered_map<std::string, opt_record> TXOptBuffer;			//indexed by opt_record's address concat with segID
-	static std::unordered_map<Addr, bool> TXOptFlush2Write;
+	std::unordered_map<std::string, opt_record> TXOptBuffer;			//indexed by opt_record's address concat with segID
+	std::unordered_map<Addr, bool> TXOptFlush2Write;
 	//Korakit
 	//Map for looking up by pmem Address for the actual write.
-	static std::unordered_map<Addr, std::string> TXOptPmemToOptAddrMap;	//indexed by pmem address
+	std::unordered_map<Addr, std::string> TXOptPmemToOptAddrMap;	//indexed by pmem address
 
   
 	// Replaced by stats
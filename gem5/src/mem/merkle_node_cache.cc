@@ -0,0 +1,156 @@
+#include "mem/merkle_node_cache.hh"
+
+#include "base/logging.hh"
+#include "mem/cache/replacement_policies/base.hh"
+
+MerkleNodeCache::MerkleNodeCache(unsigned size, unsigned assoc,
+                                 unsigned levels, bool partitioned,
+                                 BaseReplacementPolicy *policy)
+    : numSets(assoc && size % assoc == 0 ? size / assoc : 1),
+      assoc(assoc ? assoc : size), levels(levels),
+      setsPerLevel(partitioned && levels ? numSets / levels : 0),
+      replacementPolicy(policy), nodes(numSets * this->assoc),
+      candidates(this->assoc), validCount(0), useCount(0)
+{
+    fatal_if(size == 0, "Merkle node cache needs at least one node");
+    fatal_if(size % this->assoc != 0, "Merkle node cache size (%d) should "
+             "be a multiple of its associativity (%d)", size, assoc);
+    fatal_if(partitioned && setsPerLevel == 0, "Merkle node cache has %d "
+             "sets, too few to partition between %d levels", numSets,
+             levels);
+
+    for (unsigned i = 0; i < nodes.size(); i++) {
+        nodes[i].setPosition(i / this->assoc, i % this->assoc);
+        if (replacementPolicy) {
+            nodes[i].replacementData = replacementPolicy->instantiateEntry();
+        }
+    }
+}
+
+unsigned
+MerkleNodeCache::setOf(Addr key, int level) const
+{
+    // Fibonacci hashing, the offsets of deep levels have no zero low bits
+    // while the offsets of the leaves are line aligned
+    const uint64_t hash = (key * 0x9E3779B97F4A7C15ULL) >> 32;
+
+    if (setsPerLevel == 0) {
+        return hash % numSets;
+    }
+
+    panic_if(level < 0 || level >= (int)levels,
+             "Merkle tree level %d out of range", level);
+    return level * setsPerLevel + hash % setsPerLevel;
+}
+
+MerkleNodeCache::Node *
+MerkleNodeCache::findInSet(Addr key, unsigned set)
+{
+    Node *way = &nodes[set * assoc];
+    for (Node *end = way + assoc; way != end; way++) {
+        if (way->valid && way->key == key) {
+            return way;
+        }
+    }
+    return nullptr;
+}
+
+void
+MerkleNodeCache::touch(Node *node)
+{
+    if (replacementPolicy) {
+        replacementPolicy->touch(node->replacementData);
+    } else {
+        node->lastUse = ++useCount;
+    }
+}
+
+MerkleNodeCache::Node *
+MerkleNodeCache::find(Addr key, int level)
+{
+    if (setsPerLevel == 0 || level >= 0) {
+        return findInSet(key, setOf(key, level));
+    }
+
+    for (int l = 0; l < (int)levels; l++) {
+        Node *node = findInSet(key, setOf(key, l));
+        if (node) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+bool
+MerkleNodeCache::contains(Addr key, int level) const
+{
+    return const_cast<MerkleNodeCache *>(this)->find(key, level) != nullptr;
+}
+
+MerkleNodeCache::Node *
+MerkleNodeCache::access(Addr key, int level)
+{
+    Node *node = find(key, level);
+    if (node) {
+        touch(node);
+    }
+    return node;
+}
+
+MerkleNodeCache::Node *
+MerkleNodeCache::insert(Addr key, int level, bool dirty, Victim &victim)
+{
+    panic_if(contains(key, level), "Merkle tree node %#x of level %d is "
+             "already cached", key, level);
+
+    const unsigned set = setOf(key, level);
+    Node *node = nullptr;
+    for (unsigned way = 0; way < assoc; way++) {
+        Node &candidate = nodes[set * assoc + way];
+        if (!candidate.valid) {
+            node = &candidate;
+            break;
+        }
+        candidates[way] = &candidate;
+    }
+    if (!node && replacementPolicy) {
+        node = static_cast<Node *>(replacementPolicy->getVictim(candidates));
+    } else if (!node) {
+        node = static_cast<Node *>(candidates[0]);
+        for (ReplaceableEntry *candidate : candidates) {
+            if (static_cast<Node *>(candidate)->lastUse < node->lastUse) {
+                node = static_cast<Node *>(candidate);
+            }
+        }
+    }
+
+    victim.key = node->key;
+    victim.valid = node->valid;
+    victim.dirty = node->dirty;
+    if (!node->valid) {
+        validCount++;
+    }
+
+    node->key = key;
+    node->valid = true;
+    node->dirty = dirty;
+    if (replacementPolicy) {
+        replacementPolicy->reset(node->replacementData);
+    } else {
+        node->lastUse = ++useCount;
+    }
+    return node;
+}
+
+void
+MerkleNodeCache::clear()
+{
+    for (Node &node : nodes) {
+        node.valid = false;
+        node.dirty = false;
+        if (replacementPolicy) {
+            replacementPolicy->invalidate(node.replacementData);
+        }
+    }
+    validCount = 0;
+}
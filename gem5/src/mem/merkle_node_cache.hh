@@ -0,0 +1,105 @@
+#ifndef __MEM_MERKLE_NODE_CACHE_HH__
+#define __MEM_MERKLE_NODE_CACHE_HH__
+
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/cache/replacement_policies/replaceable_entry.hh"
+
+class BaseReplacementPolicy;
+
+/**
+ * Set associative cache of the Merkle tree nodes used by the encryption
+ * and verification BMOs of DRAMCtrl. Only tags and state are modelled.
+ *
+ * Nodes are identified by their offset in the tree, the set is picked by
+ * hashing the offset as the offsets of the different levels do not share
+ * an alignment. The sets can be partitioned between the tree levels so
+ * that the nodes of one level never evict the nodes of another, sets left
+ * over by the partitioning are unused. Victims are chosen among the ways
+ * of the set, invalid ways first, by a gem5 replacement policy or, without
+ * one, in access order like the fully associative map the cache replaced.
+ */
+class MerkleNodeCache
+{
+  public:
+    struct Node : public ReplaceableEntry
+    {
+        Addr key = 0;
+        bool valid = false;
+        bool dirty = false;
+        /** Access of the last touch, used without a replacement policy */
+        uint64_t lastUse = 0;
+    };
+
+    /** Node replaced by an insertion */
+    struct Victim
+    {
+        Addr key = 0;
+        bool valid = false;
+        bool dirty = false;
+    };
+
+  private:
+    const unsigned numSets;
+    const unsigned assoc;
+    const unsigned levels;
+
+    /** Sets of each level when partitioned, 0 if sets are shared */
+    const unsigned setsPerLevel;
+
+    BaseReplacementPolicy *const replacementPolicy;
+
+    std::vector<Node> nodes;
+    std::vector<ReplaceableEntry *> candidates;
+    unsigned validCount;
+    uint64_t useCount;
+
+    Node *findInSet(Addr key, unsigned set);
+
+    /** Makes node the most recently used of its set */
+    void touch(Node *node);
+
+  public:
+    /**
+     * @param size Number of nodes cached
+     * @param assoc Ways per set, 0 when fully associative
+     * @param levels Levels of the tree
+     * @param partitioned Give every level its own sets
+     * @param policy Replacement policy picking the victims, nullptr for
+     *               the least recently used node in access order
+     */
+    MerkleNodeCache(unsigned size, unsigned assoc, unsigned levels,
+                    bool partitioned, BaseReplacementPolicy *policy);
+
+    /**
+     * Node of key at level, nullptr on a miss, the policy is not updated.
+     * A negative level looks key up in the sets of every level.
+     */
+    Node *find(Addr key, int level);
+
+    bool contains(Addr key, int level = -1) const;
+
+    /** Looks up key at level and touches it, nullptr on a miss */
+    Node *access(Addr key, int level);
+
+    /**
+     * Inserts the node key of level, key must not be cached
+     * @param victim Node replaced, invalid if an invalid way was used
+     * @return The inserted node
+     */
+    Node *insert(Addr key, int level, bool dirty, Victim &victim);
+
+    /** Invalidates every node */
+    void clear();
+
+    /** Set of key at level, the first set of the level when partitioned */
+    unsigned setOf(Addr key, int level) const;
+
+    unsigned size() const { return validCount; }
+    unsigned capacity() const { return nodes.size(); }
+    unsigned sets() const { return numSets; }
+    unsigned ways() const { return assoc; }
+};
+
+#endif // __MEM_MERKLE_NODE_CACHE_HH__
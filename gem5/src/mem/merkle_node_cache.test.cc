@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mem/cache/replacement_policies/lru_rp.hh"
+#include "mem/merkle_node_cache.hh"
+#include "params/LRURP.hh"
+#include "sim/eventq.hh"
+
+// The replacement policies are SimObjects, these are the only parts of the
+// simulator their code refers to
+std::set<std::string> version_tags;
+
+void
+exitSimLoop(const std::string &message, int exit_code, Tick when,
+            Tick repeat, bool serialize)
+{
+}
+
+namespace {
+
+const unsigned LEVELS = 3;
+const Addr NODE = 64;
+
+/** First n node keys of level that map to set */
+std::vector<Addr>
+keysInSet(const MerkleNodeCache &cache, unsigned set, int level, unsigned n)
+{
+    std::vector<Addr> keys;
+    for (Addr key = NODE; keys.size() < n; key += NODE) {
+        if (cache.setOf(key, level) == set) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+class MerkleNodeCacheTest : public ::testing::Test
+{
+  protected:
+    LRURPParams params;
+    LRURP *lru;
+
+    void
+    SetUp() override
+    {
+        curEventQueue(getEventQueue(0));
+        curEventQueue()->setCurTick(0);
+        params.name = "lru";
+        params.eventq_index = 0;
+        lru = new LRURP(&params);
+    }
+
+    void TearDown() override { delete lru; }
+
+    /** LRURP orders by tick, every step of a test is a new tick */
+    void step() { curEventQueue()->setCurTick(curTick() + 1); }
+};
+
+} // anonymous namespace
+
+TEST_F(MerkleNodeCacheTest, DefaultIsFullyAssociative)
+{
+    MerkleNodeCache cache(16, 0, LEVELS, false, nullptr);
+    MerkleNodeCache::Victim victim;
+
+    EXPECT_EQ(1u, cache.sets());
+    EXPECT_EQ(16u, cache.ways());
+    EXPECT_EQ(16u, cache.capacity());
+
+    // Any 16 nodes fit, whatever their level
+    for (Addr key = NODE; key <= 16 * NODE; key += NODE) {
+        cache.insert(key, key % LEVELS, false, victim);
+        EXPECT_FALSE(victim.valid);
+    }
+    EXPECT_EQ(16u, cache.size());
+}
+
+TEST_F(MerkleNodeCacheTest, AccessOrderWithoutPolicy)
+{
+    MerkleNodeCache cache(4, 0, LEVELS, false, nullptr);
+    MerkleNodeCache::Victim victim;
+
+    // All in the same tick, the order of the accesses still counts
+    for (Addr key = NODE; key <= 4 * NODE; key += NODE) {
+        cache.insert(key, 0, false, victim);
+    }
+    ASSERT_NE(nullptr, cache.access(NODE, 0));
+    ASSERT_NE(nullptr, cache.find(2 * NODE, 0));
+
+    cache.insert(5 * NODE, 0, false, victim);
+    ASSERT_TRUE(victim.valid);
+    EXPECT_EQ(2 * NODE, victim.key);
+
+    cache.insert(6 * NODE, 0, false, victim);
+    EXPECT_EQ(3 * NODE, victim.key);
+    EXPECT_TRUE(cache.contains(NODE));
+}
+
+TEST_F(MerkleNodeCacheTest, SetIndexing)
+{
+    MerkleNodeCache cache(16, 4, LEVELS, false, lru);
+    MerkleNodeCache::Victim victim;
+
+    EXPECT_EQ(4u, cache.sets());
+    EXPECT_EQ(4u, cache.ways());
+
+    // Shared sets, the level does not change the set
+    for (Addr key = NODE; key <= 64 * NODE; key += NODE) {
+        EXPECT_LT(cache.setOf(key, -1), 4u);
+        EXPECT_EQ(cache.setOf(key, -1), cache.setOf(key, 2));
+    }
+
+    // A full set does not take the ways of the others
+    for (Addr key : keysInSet(cache, 1, 0, 8)) {
+        cache.insert(key, 0, false, victim);
+        step();
+    }
+    std::vector<Addr> other = keysInSet(cache, 2, 0, 1);
+    cache.insert(other[0], 0, false, victim);
+    EXPECT_FALSE(victim.valid);
+    EXPECT_EQ(5u, cache.size());
+}
+
+TEST_F(MerkleNodeCacheTest, PartitionedLevels)
+{
+    MerkleNodeCache cache(24, 2, LEVELS, true, lru);
+    MerkleNodeCache::Victim victim;
+
+    // 12 sets, 4 for each level
+    for (Addr key = NODE; key <= 64 * NODE; key += NODE) {
+        for (int level = 0; level < (int)LEVELS; level++) {
+            EXPECT_GE(cache.setOf(key, level), level * 4u);
+            EXPECT_LT(cache.setOf(key, level), level * 4u + 4);
+        }
+    }
+
+    // Fill the 4 sets of level 1
+    std::vector<Addr> level1;
+    for (unsigned set = 4; set < 8; set++) {
+        for (Addr key : keysInSet(cache, set, 1, 2)) {
+            cache.insert(key, 1, false, victim);
+            EXPECT_FALSE(victim.valid);
+            level1.push_back(key);
+            step();
+        }
+    }
+    EXPECT_EQ(8u, cache.size());
+
+    // Filling the sets of level 0 never evicts a node of level 1
+    for (Addr key = 100 * NODE; key < 140 * NODE; key += NODE) {
+        cache.insert(key, 0, false, victim);
+        step();
+    }
+    for (Addr key : level1) {
+        EXPECT_TRUE(cache.contains(key, 1));
+        EXPECT_TRUE(cache.contains(key));
+        EXPECT_FALSE(cache.contains(key, 2));
+    }
+    EXPECT_EQ(16u, cache.size());
+}
+
+TEST_F(MerkleNodeCacheTest, VictimFromPolicy)
+{
+    MerkleNodeCache cache(8, 4, LEVELS, false, lru);
+    MerkleNodeCache::Victim victim;
+    std::vector<Addr> keys = keysInSet(cache, 0, 0, 6);
+
+    for (unsigned i = 0; i < 4; i++) {
+        cache.insert(keys[i], 0, false, victim);
+        step();
+    }
+
+    // Touching the oldest node makes the second one the LRU victim
+    ASSERT_NE(nullptr, cache.access(keys[0], 0));
+    step();
+    cache.insert(keys[4], 0, false, victim);
+    ASSERT_TRUE(victim.valid);
+    EXPECT_EQ(keys[1], victim.key);
+    step();
+
+    // find does not touch the node
+    ASSERT_NE(nullptr, cache.find(keys[2], 0));
+    step();
+    cache.insert(keys[5], 0, false, victim);
+    EXPECT_EQ(keys[2], victim.key);
+}
+
+TEST_F(MerkleNodeCacheTest, DirtyVictims)
+{
+    MerkleNodeCache cache(2, 2, LEVELS, false, lru);
+    MerkleNodeCache::Victim victim;
+    std::vector<Addr> keys = keysInSet(cache, 0, 0, 4);
+
+    cache.insert(keys[0], 0, true, victim);
+    step();
+    cache.insert(keys[1], 0, false, victim);
+    step();
+
+    cache.insert(keys[2], 0, false, victim);
+    ASSERT_TRUE(victim.valid);
+    EXPECT_EQ(keys[0], victim.key);
+    EXPECT_TRUE(victim.dirty);
+    step();
+
+    cache.insert(keys[3], 0, true, victim);
+    EXPECT_EQ(keys[1], victim.key);
+    EXPECT_FALSE(victim.dirty);
+
+    // Nothing is written back after a clear
+    cache.clear();
+    EXPECT_EQ(0u, cache.size());
+    cache.insert(keys[0], 0, false, victim);
+    EXPECT_FALSE(victim.valid);
+}
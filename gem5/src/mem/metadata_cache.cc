@@ -0,0 +1,133 @@
+#include "mem/metadata_cache.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+
+MetadataCache::MetadataCache(unsigned sets, unsigned assoc, Addr lineSize)
+    : numSets(sets), assoc(assoc), lineSize(lineSize),
+      lines(sets * assoc), ranks(sets * assoc), validCount(0)
+{
+    fatal_if(sets == 0, "Metadata cache needs at least one set");
+    fatal_if(assoc == 0 || assoc > 256, "Metadata cache associativity (%d) "
+             "should be between 1 and 256", assoc);
+    fatal_if(lineSize == 0 || (lineSize & (lineSize - 1)) != 0,
+             "Metadata cache line size (%d) should be a power of 2",
+             lineSize);
+    clear();
+}
+
+void
+MetadataCache::promote(unsigned way)
+{
+    const unsigned begin = way - way % assoc;
+    const uint8_t rank = ranks[way];
+
+    for (unsigned other = begin; other < begin + assoc; other++) {
+        if (ranks[other] < rank) {
+            ranks[other]++;
+        }
+    }
+    ranks[way] = 0;
+}
+
+MetadataCache::Line *
+MetadataCache::find(Addr addr)
+{
+    const Addr line = lineOf(addr);
+    const unsigned begin = firstWay(addr);
+
+    for (unsigned way = begin; way < begin + assoc; way++) {
+        if (lines[way].valid && lines[way].addr == line) {
+            return &lines[way];
+        }
+    }
+    return nullptr;
+}
+
+bool
+MetadataCache::contains(Addr addr) const
+{
+    return const_cast<MetadataCache *>(this)->find(addr) != nullptr;
+}
+
+MetadataCache::Line *
+MetadataCache::access(Addr addr)
+{
+    Line *line = find(addr);
+    if (line) {
+        promote(line - lines.data());
+    }
+    return line;
+}
+
+MetadataCache::Line *
+MetadataCache::insert(Addr addr, bool dirty, Line &evicted)
+{
+    panic_if(contains(addr), "Inserting %#x twice into the metadata cache",
+             addr);
+
+    const unsigned begin = firstWay(addr);
+    unsigned victim = begin;
+    for (unsigned way = begin; way < begin + assoc; way++) {
+        if (!lines[way].valid) {
+            victim = way;
+            break;
+        }
+        if (ranks[way] > ranks[victim]) {
+            victim = way;
+        }
+    }
+
+    evicted = lines[victim];
+    if (!evicted.valid) {
+        validCount++;
+    }
+
+    Line &line = lines[victim];
+    line.addr = lineOf(addr);
+    line.valid = true;
+    line.dirty = dirty;
+    promote(victim);
+    return &line;
+}
+
+void
+MetadataCache::clear()
+{
+    for (unsigned way = 0; way < lines.size(); way++) {
+        lines[way] = Line();
+        ranks[way] = way % assoc;
+    }
+    validCount = 0;
+}
+
+uint64_t
+MetadataCache::prefillSequential(Addr maxAddr)
+{
+    clear();
+
+    // Lines 0 .. lastLine map round robin to the sets
+    const uint64_t lastLine = maxAddr / lineSize;
+    for (unsigned set = 0; set < numSets && set <= lastLine; set++) {
+        const uint64_t count = (lastLine - set) / numSets + 1;
+        const unsigned filled = std::min<uint64_t>(count, assoc);
+        const unsigned begin = set * assoc;
+
+        // The most recently inserted line of the set has rank 0
+        for (unsigned i = 0; i < filled; i++) {
+            const uint64_t k = count - filled + i;
+            Line &line = lines[begin + i];
+            line.addr = (k * numSets + set) * lineSize;
+            line.valid = true;
+            line.dirty = false;
+            ranks[begin + i] = filled - 1 - i;
+        }
+        for (unsigned i = filled; i < assoc; i++) {
+            ranks[begin + i] = i;
+        }
+        validCount += filled;
+    }
+
+    return lastLine + 1;
+}
@@ -0,0 +1,102 @@
+#ifndef __MEM_METADATA_CACHE_HH__
+#define __MEM_METADATA_CACHE_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Set associative cache of memory controller metadata (encryption counters
+ * and integrity tree nodes), only the tags and state are modelled.
+ *
+ * Tags, state and LRU ranks are kept in flat arrays of sets x ways. Every
+ * set keeps a true LRU stack as one rank per way, 0 is the most recently
+ * used way and ways - 1 the victim. With 16 ways a rank fits in 4 bits.
+ * Lookups, insertions and LRU updates only touch the ways of one set.
+ */
+class MetadataCache
+{
+  public:
+    struct Line
+    {
+        Addr addr = 0;
+        bool valid = false;
+        bool dirty = false;
+    };
+
+  private:
+    const unsigned numSets;
+    const unsigned assoc;
+    const Addr lineSize;
+
+    std::vector<Line> lines;
+    std::vector<uint8_t> ranks;
+    unsigned validCount;
+
+    unsigned firstWay(Addr addr) const { return setOf(addr) * assoc; }
+
+    /** Makes the way the most recently used of its set */
+    void promote(unsigned way);
+
+  public:
+    /**
+     * @param sets Number of sets
+     * @param assoc Ways per set, at most 256
+     * @param lineSize Bytes covered by a line, a power of two
+     */
+    MetadataCache(unsigned sets, unsigned assoc, Addr lineSize);
+
+    /** Set of the line holding addr */
+    unsigned setOf(Addr addr) const { return (addr / lineSize) % numSets; }
+
+    /** Start of the line holding addr */
+    Addr lineOf(Addr addr) const { return addr & ~(lineSize - 1); }
+
+    /** Line holding addr, nullptr on a miss, the LRU stack is not updated */
+    Line *find(Addr addr);
+
+    bool contains(Addr addr) const;
+
+    /** Looks up addr and makes it the most recently used line of its set */
+    Line *access(Addr addr);
+
+    /**
+     * Inserts the line holding addr as the most recently used line, addr
+     * must not be cached. An invalid way is used if the set has one,
+     * otherwise the least recently used line is replaced.
+     * @param evicted Replaced line, invalid if no line was replaced
+     * @return The inserted line
+     */
+    Line *insert(Addr addr, bool dirty, Line &evicted);
+
+    /** Invalidates every line */
+    void clear();
+
+    /**
+     * Fills the cache with the state left by inserting every line from 0 to
+     * maxAddr in address order into an empty cache, without walking the
+     * address range. Every set holds its last ways lines, all clean.
+     * @return Number of lines the walk would have inserted
+     */
+    uint64_t prefillSequential(Addr maxAddr);
+
+    /** Calls fn(Line&) for every valid line */
+    template <class Fn>
+    void
+    forEach(Fn fn)
+    {
+        for (Line &line : lines) {
+            if (line.valid) {
+                fn(line);
+            }
+        }
+    }
+
+    unsigned size() const { return validCount; }
+    unsigned capacity() const { return lines.size(); }
+    unsigned sets() const { return numSets; }
+    unsigned ways() const { return assoc; }
+};
+
+#endif // __MEM_METADATA_CACHE_HH__
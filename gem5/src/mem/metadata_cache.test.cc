@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "mem/metadata_cache.hh"
+
+namespace {
+
+const Addr LINE = 64;
+const size_t SETS = 4;
+const size_t WAYS = 4;
+
+/** Address of the n-th line mapping to set */
+Addr
+lineInSet(size_t set, size_t n) {
+    return (n * SETS + set) * LINE;
+}
+
+} // anonymous namespace
+
+TEST(MetadataCacheTest, HitAndMiss)
+{
+    MetadataCache cache(SETS, WAYS, LINE);
+    MetadataCache::Line evicted;
+
+    EXPECT_EQ(nullptr, cache.find(0x1000));
+    cache.insert(0x1010, true, evicted);
+    EXPECT_FALSE(evicted.valid);
+
+    /* Any address in the line hits */
+    MetadataCache::Line *line = cache.find(0x1000);
+    ASSERT_NE(nullptr, line);
+    EXPECT_EQ(0x1000u, line->addr);
+    EXPECT_TRUE(line->dirty);
+    EXPECT_TRUE(cache.contains(0x103f));
+    EXPECT_FALSE(cache.contains(0x1040));
+    EXPECT_EQ(1u, cache.size());
+}
+
+TEST(MetadataCacheTest, EvictsLeastRecentlyUsed)
+{
+    MetadataCache cache(SETS, WAYS, LINE);
+    MetadataCache::Line evicted;
+
+    for (size_t n = 0; n < WAYS; n++) {
+        cache.insert(lineInSet(1, n), n == 0, evicted);
+        EXPECT_FALSE(evicted.valid);
+    }
+
+    /* Line 0 becomes the most recently used, line 1 is the victim */
+    ASSERT_NE(nullptr, cache.access(lineInSet(1, 0)));
+    cache.insert(lineInSet(1, WAYS), false, evicted);
+    EXPECT_TRUE(evicted.valid);
+    EXPECT_EQ(lineInSet(1, 1), evicted.addr);
+    EXPECT_FALSE(evicted.dirty);
+
+    cache.insert(lineInSet(1, WAYS + 1), false, evicted);
+    EXPECT_EQ(lineInSet(1, 2), evicted.addr);
+
+    /* The dirty state is kept until the line is evicted */
+    cache.insert(lineInSet(1, WAYS + 2), false, evicted);
+    cache.insert(lineInSet(1, WAYS + 3), false, evicted);
+    EXPECT_EQ(lineInSet(1, 0), evicted.addr);
+    EXPECT_TRUE(evicted.dirty);
+}
+
+TEST(MetadataCacheTest, SetsAreIndependent)
+{
+    MetadataCache cache(SETS, WAYS, LINE);
+    MetadataCache::Line evicted;
+
+    for (size_t n = 0; n < 3 * WAYS; n++) {
+        cache.insert(lineInSet(2, n), false, evicted);
+    }
+    cache.insert(lineInSet(3, 0), false, evicted);
+    EXPECT_FALSE(evicted.valid);
+
+    EXPECT_EQ(WAYS + 1, cache.size());
+    EXPECT_TRUE(cache.contains(lineInSet(3, 0)));
+    for (size_t n = 2 * WAYS; n < 3 * WAYS; n++) {
+        EXPECT_TRUE(cache.contains(lineInSet(2, n)));
+    }
+}
+
+TEST(MetadataCacheTest, FindDoesNotUpdateLRU)
+{
+    MetadataCache cache(1, 2, LINE);
+    MetadataCache::Line evicted;
+
+    cache.insert(0, false, evicted);
+    cache.insert(LINE, false, evicted);
+    ASSERT_NE(nullptr, cache.find(0));
+    cache.insert(2 * LINE, false, evicted);
+    EXPECT_EQ(0u, evicted.addr);
+}
+
+TEST(MetadataCacheTest, PrefillMatchesSequentialWalk)
+{
+    for (Addr max : {Addr(0), 3 * LINE, 17 * LINE + 5, 40 * LINE}) {
+        MetadataCache walked(SETS, WAYS, LINE);
+        MetadataCache::Line evicted;
+        uint64_t count = 0;
+        for (Addr addr = 0; addr <= max; addr += LINE) {
+            walked.insert(addr, false, evicted);
+            count++;
+        }
+
+        MetadataCache prefilled(SETS, WAYS, LINE);
+        EXPECT_EQ(count, prefilled.prefillSequential(max));
+        EXPECT_EQ(walked.size(), prefilled.size());
+
+        std::set<Addr> walkedLines, prefilledLines;
+        walked.forEach([&](MetadataCache::Line &line) {
+            walkedLines.insert(line.addr);
+        });
+        prefilled.forEach([&](MetadataCache::Line &line) {
+            EXPECT_FALSE(line.dirty);
+            prefilledLines.insert(line.addr);
+        });
+        EXPECT_EQ(walkedLines, prefilledLines);
+
+        /* Both evict in the same order */
+        for (Addr addr = max + LINE; addr <= max + 2 * SETS * WAYS * LINE;
+             addr += LINE) {
+            MetadataCache::Line a, b;
+            walked.insert(addr, false, a);
+            prefilled.insert(addr, false, b);
+            EXPECT_EQ(a.valid, b.valid);
+            EXPECT_EQ(a.addr, b.addr);
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#include "mem/precompute_buffer.hh"
+
+#include <iterator>
+
+PrecomputeBuffer::PrecomputeBuffer(unsigned maxEntries, unsigned maxBytes)
+    : maxEntries(maxEntries), maxBytes(maxBytes), usedBytes(0)
+{
+}
+
+void
+PrecomputeBuffer::remove(std::list<Entry>::iterator it)
+{
+    auto range = index.equal_range(it->addr);
+    for (auto i = range.first; i != range.second; i++) {
+        if (i->second == it) {
+            index.erase(i);
+            break;
+        }
+    }
+    usedBytes -= it->bytes;
+    entries.erase(it);
+}
+
+bool
+PrecomputeBuffer::insert(const Entry &entry, std::vector<Entry> &evicted,
+                         bool *replaced)
+{
+    if (replaced) {
+        *replaced = false;
+    }
+    if (!enabled() || (maxBytes > 0 && entry.bytes > maxBytes)) {
+        return false;
+    }
+
+    // The same prediction again, the new results replace the old ones
+    auto range = index.equal_range(entry.addr);
+    for (auto i = range.first; i != range.second; i++) {
+        if (i->second->tag == entry.tag) {
+            remove(i->second);
+            if (replaced) {
+                *replaced = true;
+            }
+            break;
+        }
+    }
+
+    while (entries.size() >= maxEntries ||
+           (maxBytes > 0 && usedBytes + entry.bytes > maxBytes)) {
+        evicted.push_back(entries.front());
+        remove(entries.begin());
+    }
+
+    entries.push_back(entry);
+    index.emplace(entry.addr, std::prev(entries.end()));
+    usedBytes += entry.bytes;
+    return true;
+}
+
+const PrecomputeBuffer::Entry *
+PrecomputeBuffer::find(Addr addr, uint64_t tag) const
+{
+    auto range = index.equal_range(addr);
+    for (auto i = range.first; i != range.second; i++) {
+        if (i->second->tag == tag) {
+            return &*i->second;
+        }
+    }
+    return nullptr;
+}
+
+const PrecomputeBuffer::Entry *
+PrecomputeBuffer::newest(Addr addr) const
+{
+    if (index.count(addr) == 0) {
+        return nullptr;
+    }
+    for (auto it = entries.rbegin(); it != entries.rend(); it++) {
+        if (it->addr == addr) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+void
+PrecomputeBuffer::erase(Addr addr, std::vector<Entry> &removed)
+{
+    auto range = index.equal_range(addr);
+    std::vector<std::list<Entry>::iterator> its;
+    for (auto i = range.first; i != range.second; i++) {
+        its.push_back(i->second);
+    }
+    for (auto it : its) {
+        removed.push_back(*it);
+        remove(it);
+    }
+}
+
+void
+PrecomputeBuffer::clear()
+{
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+}
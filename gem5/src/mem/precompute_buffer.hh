@@ -0,0 +1,85 @@
+#ifndef __MEM_PRECOMPUTE_BUFFER_HH__
+#define __MEM_PRECOMPUTE_BUFFER_HH__
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Results of the BMOs done ahead of a PM write from a prediction of the
+ * backend: the ciphertext, the MAC and tree update partial results, the
+ * dedup lookup outcome. Every entry is for a line and a predicted data,
+ * the buffer is bounded both in entries and in bytes and evicts its oldest
+ * entries to make room.
+ */
+class PrecomputeBuffer
+{
+  public:
+    struct Entry
+    {
+        Addr addr = 0;
+        /** Identifies the predicted data the results were computed from */
+        uint64_t tag = 0;
+        /** Tick the results are ready */
+        Tick ready = 0;
+        unsigned bytes = 0;
+        /** Operations done for the results that only need the address */
+        unsigned addrOps = 0;
+        /** Operations done for the results that need the data */
+        unsigned dataOps = 0;
+    };
+
+  private:
+    const unsigned maxEntries;
+    const unsigned maxBytes;
+
+    /** Oldest entry first */
+    std::list<Entry> entries;
+    std::unordered_multimap<Addr, std::list<Entry>::iterator> index;
+    unsigned usedBytes;
+
+    void remove(std::list<Entry>::iterator it);
+
+  public:
+    /**
+     * @param maxEntries Entries of the buffer, 0 disables it
+     * @param maxBytes Bytes of results the buffer holds, 0 for unbounded
+     */
+    PrecomputeBuffer(unsigned maxEntries, unsigned maxBytes);
+
+    bool enabled() const { return maxEntries > 0; }
+
+    /**
+     * Adds the results of a prediction, replacing the results of the same
+     * line and data and evicting the oldest entries until they fit
+     * @param evicted The entries removed to make room are appended, the
+     *        replaced results of the same prediction are not
+     * @param replaced Set to true if results of the same line and data
+     *        were replaced
+     * @return False if the results are larger than the buffer
+     */
+    bool insert(const Entry &entry, std::vector<Entry> &evicted,
+                bool *replaced = nullptr);
+
+    /** Results of line addr computed from the data tag, nullptr if none */
+    const Entry *find(Addr addr, uint64_t tag) const;
+
+    /** Newest results of line addr, nullptr if none */
+    const Entry *newest(Addr addr) const;
+
+    /**
+     * Removes every result of line addr
+     * @param removed The removed entries are appended
+     */
+    void erase(Addr addr, std::vector<Entry> &removed);
+
+    void clear();
+
+    unsigned size() const { return entries.size(); }
+    unsigned bytes() const { return usedBytes; }
+};
+
+#endif // __MEM_PRECOMPUTE_BUFFER_HH__
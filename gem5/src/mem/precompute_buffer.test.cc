@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "mem/precompute_buffer.hh"
+
+namespace {
+
+PrecomputeBuffer::Entry
+entry(Addr addr, uint64_t tag, unsigned bytes = 64)
+{
+    PrecomputeBuffer::Entry e;
+    e.addr = addr;
+    e.tag = tag;
+    e.bytes = bytes;
+    e.addrOps = 1;
+    e.dataOps = 2;
+    return e;
+}
+
+} // anonymous namespace
+
+TEST(PrecomputeBufferTest, Disabled)
+{
+    PrecomputeBuffer buffer(0, 0);
+    std::vector<PrecomputeBuffer::Entry> evicted;
+
+    EXPECT_FALSE(buffer.enabled());
+    EXPECT_FALSE(buffer.insert(entry(0x40, 1), evicted));
+    EXPECT_EQ(nullptr, buffer.find(0x40, 1));
+    EXPECT_EQ(0u, buffer.size());
+}
+
+TEST(PrecomputeBufferTest, FindsLineAndData)
+{
+    PrecomputeBuffer buffer(4, 0);
+    std::vector<PrecomputeBuffer::Entry> evicted;
+
+    EXPECT_TRUE(buffer.insert(entry(0x40, 1), evicted));
+    EXPECT_TRUE(buffer.insert(entry(0x40, 2), evicted));
+    EXPECT_TRUE(evicted.empty());
+
+    ASSERT_NE(nullptr, buffer.find(0x40, 1));
+    EXPECT_EQ(nullptr, buffer.find(0x40, 3));
+    EXPECT_EQ(nullptr, buffer.find(0x80, 1));
+    ASSERT_NE(nullptr, buffer.newest(0x40));
+    EXPECT_EQ(2u, buffer.newest(0x40)->tag);
+
+    std::vector<PrecomputeBuffer::Entry> removed;
+    buffer.erase(0x40, removed);
+    EXPECT_EQ(2u, removed.size());
+    EXPECT_EQ(0u, buffer.size());
+    EXPECT_EQ(0u, buffer.bytes());
+    EXPECT_EQ(nullptr, buffer.newest(0x40));
+}
+
+TEST(PrecomputeBufferTest, EvictsOldestEntries)
+{
+    PrecomputeBuffer buffer(2, 0);
+    std::vector<PrecomputeBuffer::Entry> evicted;
+
+    buffer.insert(entry(0x40, 1), evicted);
+    buffer.insert(entry(0x80, 1), evicted);
+    buffer.insert(entry(0xc0, 1), evicted);
+
+    ASSERT_EQ(1u, evicted.size());
+    EXPECT_EQ(0x40u, evicted[0].addr);
+    EXPECT_EQ(nullptr, buffer.find(0x40, 1));
+    EXPECT_NE(nullptr, buffer.find(0xc0, 1));
+    EXPECT_EQ(2u, buffer.size());
+}
+
+TEST(PrecomputeBufferTest, EvictsForBytes)
+{
+    PrecomputeBuffer buffer(8, 128);
+    std::vector<PrecomputeBuffer::Entry> evicted;
+
+    buffer.insert(entry(0x40, 1, 64), evicted);
+    buffer.insert(entry(0x80, 1, 32), evicted);
+    EXPECT_TRUE(evicted.empty());
+
+    /* Needs the room of the oldest entry */
+    buffer.insert(entry(0xc0, 1, 64), evicted);
+    ASSERT_EQ(1u, evicted.size());
+    EXPECT_EQ(0x40u, evicted[0].addr);
+    EXPECT_EQ(96u, buffer.bytes());
+
+    /* Never fits */
+    EXPECT_FALSE(buffer.insert(entry(0x100, 1, 256), evicted));
+    EXPECT_EQ(1u, evicted.size());
+}
+
+TEST(PrecomputeBufferTest, SamePredictionReplaces)
+{
+    PrecomputeBuffer buffer(2, 0);
+    std::vector<PrecomputeBuffer::Entry> evicted;
+
+    buffer.insert(entry(0x40, 1), evicted);
+    buffer.insert(entry(0x80, 1), evicted);
+
+    /* Making room is not a replacement */
+    bool replaced = true;
+    buffer.insert(entry(0xc0, 1), evicted, &replaced);
+    EXPECT_FALSE(replaced);
+    ASSERT_EQ(1u, evicted.size());
+    evicted.clear();
+
+    PrecomputeBuffer::Entry again = entry(0xc0, 1);
+    again.ready = 1000;
+    buffer.insert(again, evicted, &replaced);
+
+    /* The old results are replaced, not evicted, the other line stays */
+    EXPECT_TRUE(replaced);
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(2u, buffer.size());
+    EXPECT_NE(nullptr, buffer.find(0x80, 1));
+    ASSERT_NE(nullptr, buffer.find(0xc0, 1));
+    EXPECT_EQ(1000u, buffer.find(0xc0, 1)->ready);
+}
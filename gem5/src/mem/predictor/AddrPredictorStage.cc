@@ -0,0 +1,244 @@
+#include "mem/predictor/AddrPredictorStage.hh"
+
+#include <sstream>
+
+#include "base/logging.hh"
+
+namespace {
+
+/* Replaces the way with the lowest value of rank */
+template <class Way, class Rank>
+Way *
+pick_lowest(Way *begin, Way *end, Rank rank) {
+    Way *victim = begin;
+    for (Way *way = begin; way != end; way++) {
+        if (rank(way->value) < rank(victim->value)) {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+} // anonymous namespace
+
+void
+StrideAddrPredictor::train(PC_t pc, Addr_t addr) {
+    Entry *entry = this->table.find(pc);
+    if (entry == nullptr) {
+        Entry newEntry;
+        newEntry.lastAddr = addr;
+
+        bool evicted;
+        this->table.insert(pc, newEntry,
+            [](SetAssocTable<Entry>::Way *begin,
+               SetAssocTable<Entry>::Way *end) {
+                return pick_lowest(begin, end, [](const Entry &e) {
+                    return e.confidence;
+                });
+            }, evicted);
+        return;
+    }
+
+    int64_t stride = (int64_t)(addr - entry->lastAddr);
+    if (stride != 0 and stride == entry->stride) {
+        if (entry->confidence < STRIDE_CONFIDENCE_MAX) {
+            entry->confidence++;
+        }
+    } else {
+        entry->stride = stride;
+        entry->confidence = 0;
+    }
+    entry->lastAddr = addr;
+}
+
+Addr_t
+StrideAddrPredictor::predict(PC_t pc) {
+    Entry *entry = this->table.find(pc);
+    if (entry == nullptr or entry->confidence < STRIDE_CONFIDENCE) {
+        return 0;
+    }
+    return entry->lastAddr + entry->stride;
+}
+
+unsigned
+RegionAddrPredictor::line_of(Addr_t addr) {
+    return (addr & ((1ull << REGION_SHIFT) - 1)) / CACHELINE_SIZE;
+}
+
+void
+RegionAddrPredictor::train(PC_t pc, Addr_t addr) {
+    Addr_t region = region_of(addr);
+
+    if (not this->hasLastAddr or region != this->activeRegion) {
+        /* The visit of the region left ends, its lines become the pattern */
+        Entry *previous = this->hasLastAddr
+                ? this->table.find(this->activeRegion) : nullptr;
+        if (previous != nullptr and previous->current != 0) {
+            previous->pattern = previous->current;
+            previous->current = 0;
+        }
+
+        if (this->table.find(region) == nullptr) {
+            bool evicted;
+            this->table.insert(region, Entry(),
+                [](SetAssocTable<Entry>::Way *begin,
+                   SetAssocTable<Entry>::Way *end) {
+                    /* The region with the fewest lines written back */
+                    return pick_lowest(begin, end, [](const Entry &e) {
+                        return __builtin_popcountll(e.pattern | e.current);
+                    });
+                }, evicted);
+        }
+        this->activeRegion = region;
+    }
+
+    this->table.find(region)->current |= 1ull << line_of(addr);
+    this->lastAddr = addr;
+    this->hasLastAddr = true;
+}
+
+Addr_t
+RegionAddrPredictor::predict(PC_t pc) {
+    if (not this->hasLastAddr) {
+        return 0;
+    }
+
+    Entry *entry = this->table.find(this->activeRegion);
+    if (entry == nullptr) {
+        return 0;
+    }
+
+    /* Lines of the last visit after the last line, not yet written back */
+    unsigned line = line_of(this->lastAddr);
+    uint64_t after = line == 63 ? 0 : ~0ull << (line + 1);
+    uint64_t candidates = entry->pattern & after & ~entry->current;
+    if (candidates == 0) {
+        return 0;
+    }
+
+    unsigned next = __builtin_ctzll(candidates);
+    return (this->activeRegion << REGION_SHIFT) + next * CACHELINE_SIZE;
+}
+
+void
+MarkovAddrPredictor::train(PC_t pc, Addr_t addr) {
+    if (this->hasLastAddr and this->lastAddr != addr) {
+        Entry *entry = this->table.find(this->lastAddr);
+        if (entry == nullptr) {
+            bool evicted;
+            entry = &this->table.insert(this->lastAddr, Entry(),
+                [](SetAssocTable<Entry>::Way *begin,
+                   SetAssocTable<Entry>::Way *end) {
+                    /* The least recently used line */
+                    return pick_lowest(begin, end, [](const Entry &e) {
+                        return e.lastUse;
+                    });
+                }, evicted)->value;
+        }
+        entry->next = addr;
+        entry->lastUse = ++this->useCount;
+    }
+    this->lastAddr = addr;
+    this->hasLastAddr = true;
+}
+
+Addr_t
+MarkovAddrPredictor::predict(PC_t pc) {
+    if (not this->hasLastAddr) {
+        return 0;
+    }
+    Entry *entry = this->table.find(this->lastAddr);
+    if (entry == nullptr) {
+        return 0;
+    }
+    entry->lastUse = ++this->useCount;
+    return entry->next;
+}
+
+AddrPredictorStage::AddrPredictorStage(Kind kind) : kind(kind) {
+    auto add = [this](AddrPredictorComponent *predictor) {
+        Component component;
+        component.predictor.reset(predictor);
+        this->components.push_back(std::move(component));
+    };
+
+    switch (kind) {
+    case Kind::DELTA:
+        add(new DeltaAddrPredictor());
+        break;
+    case Kind::STRIDE:
+        add(new StrideAddrPredictor());
+        break;
+    case Kind::REGION:
+        add(new RegionAddrPredictor());
+        break;
+    case Kind::MARKOV:
+        add(new MarkovAddrPredictor());
+        break;
+    case Kind::TOURNAMENT:
+        add(new StrideAddrPredictor());
+        add(new RegionAddrPredictor());
+        add(new MarkovAddrPredictor());
+        break;
+    default:
+        panic("Unknown address predictor kind %d", (int)kind);
+    }
+}
+
+void
+AddrPredictorStage::train(PC_t pc, Addr_t addr) {
+    for (Component &component : this->components) {
+        /* Scores the prediction the component would have made */
+        Addr_t predicted = component.predictor->predict(pc);
+        if (predicted == addr) {
+            if (component.confidence < META_CONFIDENCE_MAX) {
+                component.confidence++;
+            }
+        } else if (predicted != 0 and component.confidence > 0) {
+            component.confidence--;
+        }
+
+        component.predictor->train(pc, addr);
+    }
+}
+
+Addr_t
+AddrPredictorStage::predict(PC_t pc) {
+    if (this->kind != Kind::TOURNAMENT) {
+        Component &component = this->components.front();
+        Addr_t result = component.predictor->predict(pc);
+        component.chosen += result != 0;
+        return result;
+    }
+
+    Component *best = nullptr;
+    Addr_t result = 0;
+    for (Component &component : this->components) {
+        if (component.confidence < META_CONFIDENCE or
+                (best != nullptr and
+                 component.confidence <= best->confidence)) {
+            continue;
+        }
+        Addr_t predicted = component.predictor->predict(pc);
+        if (predicted != 0) {
+            best = &component;
+            result = predicted;
+        }
+    }
+
+    if (best != nullptr) {
+        best->chosen++;
+    }
+    return result;
+}
+
+std::string
+AddrPredictorStage::state_to_string() const {
+    std::stringstream result;
+    for (const Component &component : this->components) {
+        result << component.predictor->name()
+               << " confidence = " << (int)component.confidence
+               << " chosen = " << component.chosen << " ";
+    }
+    return result.str();
+}
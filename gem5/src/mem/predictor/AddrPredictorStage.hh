@@ -0,0 +1,199 @@
+#ifndef SHIFTLAB_ADDR_PREDICTOR_STAGE_H__
+#define SHIFTLAB_ADDR_PREDICTOR_STAGE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mem/predictor/AddrPredictor.hh"
+#include "mem/predictor/Declarations.hh"
+#include "mem/predictor/SetAssocTable.hh"
+
+/**
+ * One address predictor of the address prediction stage. Components are
+ * trained with the cachelines written back to PM and the PC of the store
+ * that last wrote them, and predict the line written back next.
+ */
+class AddrPredictorComponent {
+public:
+    virtual ~AddrPredictorComponent() {}
+
+    /* Learns that the aligned line addr last written by pc was written back */
+    virtual void train(PC_t pc, Addr_t addr) = 0;
+
+    /* Aligned address of the next line written back, 0 if there is none */
+    virtual Addr_t predict(PC_t pc) = 0;
+
+    virtual const char *name() const = 0;
+};
+
+/* Global Δ-address predictor, wraps AddrPredictor */
+class DeltaAddrPredictor : public AddrPredictorComponent {
+private:
+    AddrPredictor deltas;
+
+public:
+    void train(PC_t pc, Addr_t addr) override {
+        this->deltas.set_last_seen_addr(addr);
+    }
+
+    Addr_t predict(PC_t pc) override {
+        /* No delta is known before the first line */
+        if (not this->deltas.addr_q_size()) {
+            return 0;
+        }
+        return this->deltas.predict_addr();
+    }
+
+    const char *name() const override { return "delta"; }
+};
+
+/**
+ * Per-PC stride predictor, the last line and stride of each PC are kept in
+ * a set associative table. A stride is used once it repeated
+ * STRIDE_CONFIDENCE times.
+ */
+class StrideAddrPredictor : public AddrPredictorComponent {
+private:
+    static const size_t SETS = 64;
+    static const size_t WAYS = 4;
+    static const uint8_t STRIDE_CONFIDENCE = 2;
+    static const uint8_t STRIDE_CONFIDENCE_MAX = 3;
+
+    struct Entry {
+        Addr_t lastAddr = 0;
+        int64_t stride = 0;
+        uint8_t confidence = 0;
+    };
+
+    SetAssocTable<Entry> table;
+
+public:
+    StrideAddrPredictor() : table(SETS, WAYS, 0, 0) {}
+
+    void train(PC_t pc, Addr_t addr) override;
+    Addr_t predict(PC_t pc) override;
+
+    const char *name() const override { return "stride"; }
+};
+
+/**
+ * Spatial region predictor. The lines written back in a region are recorded
+ * in a bitmap while the region is active. When a region is entered again,
+ * the bitmap of its last visit predicts the next lines, in address order
+ * after the last line written back. The region with the fewest lines
+ * written back in a set is replaced.
+ */
+class RegionAddrPredictor : public AddrPredictorComponent {
+private:
+    /* 64 lines of 64 bytes, one bit per line */
+    static const unsigned REGION_SHIFT = 12;
+    static const size_t SETS = 64;
+    static const size_t WAYS = 4;
+
+    struct Entry {
+        /* Lines written back in the last visit */
+        uint64_t pattern = 0;
+        /* Lines written back in the current visit */
+        uint64_t current = 0;
+    };
+
+    SetAssocTable<Entry> table;
+    Addr_t activeRegion = 0;
+    Addr_t lastAddr = 0;
+    bool hasLastAddr = false;
+
+    static Addr_t region_of(Addr_t addr) { return addr >> REGION_SHIFT; }
+    static unsigned line_of(Addr_t addr);
+
+public:
+    RegionAddrPredictor() : table(SETS, WAYS, 0, 0) {}
+
+    void train(PC_t pc, Addr_t addr) override;
+    Addr_t predict(PC_t pc) override;
+
+    const char *name() const override { return "region"; }
+};
+
+/**
+ * First order Markov predictor over the written back lines, each line
+ * predicts the line that followed it the last time. The least recently
+ * trained or used line of a set is replaced.
+ */
+class MarkovAddrPredictor : public AddrPredictorComponent {
+private:
+    static const size_t SETS = 256;
+    static const size_t WAYS = 4;
+
+    struct Entry {
+        Addr_t next = 0;
+        /* Value of useCount when the entry was last trained or used */
+        uint64_t lastUse = 0;
+    };
+
+    SetAssocTable<Entry> table;
+    Addr_t lastAddr = 0;
+    bool hasLastAddr = false;
+    uint64_t useCount = 0;
+
+public:
+    MarkovAddrPredictor() : table(SETS, WAYS, 6, 0) {}
+
+    void train(PC_t pc, Addr_t addr) override;
+    Addr_t predict(PC_t pc) override;
+
+    const char *name() const override { return "markov"; }
+};
+
+/**
+ * Address prediction stage of the frontend. A single predictor is used
+ * directly, the tournament runs the stride, region and Markov predictors
+ * side by side. Every component has a saturating confidence counter that
+ * is raised when the component would have predicted the line written back
+ * and lowered when it would have been wrong. The component with the
+ * highest confidence at or above META_CONFIDENCE predicts.
+ */
+class AddrPredictorStage {
+public:
+    enum class Kind : uint8_t {
+        DELTA,
+        STRIDE,
+        REGION,
+        MARKOV,
+        TOURNAMENT
+    };
+
+    static const uint8_t META_CONFIDENCE = 4;
+    static const uint8_t META_CONFIDENCE_MAX = 7;
+
+private:
+    struct Component {
+        std::unique_ptr<AddrPredictorComponent> predictor;
+        uint8_t confidence = 0;
+        /* Predictions made by this component */
+        uint64_t chosen = 0;
+    };
+
+    const Kind kind;
+    std::vector<Component> components;
+
+public:
+    explicit AddrPredictorStage(Kind kind = Kind::DELTA);
+
+    /* Learns that the aligned line addr last written by pc was written back */
+    void train(PC_t pc, Addr_t addr);
+
+    /**
+     * Predicts the next line written back by pc
+     * @return Aligned address of the line, 0 if no prediction is made
+     */
+    Addr_t predict(PC_t pc);
+
+    Kind get_kind() const { return this->kind; }
+
+    std::string state_to_string() const;
+};
+
+#endif // SHIFTLAB_ADDR_PREDICTOR_STAGE_H__
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/predictor/AddrPredictorStage.hh"
+
+namespace {
+
+const PC_t PC_A = 0x400100;
+const PC_t PC_B = 0x400200;
+
+} // anonymous namespace
+
+TEST(AddrPredictorStageTest, StrideIsTrackedPerPC)
+{
+    StrideAddrPredictor stride;
+    for (Addr_t i = 0; i < 4; i++) {
+        stride.train(PC_A, 0x10000 + i * 0x80);
+        stride.train(PC_B, 0x90000 - i * 0x40);
+    }
+
+    EXPECT_EQ(0x10200u, stride.predict(PC_A));
+    EXPECT_EQ(0x90000u - 4 * 0x40, stride.predict(PC_B));
+    EXPECT_EQ(0u, stride.predict(0x400300));
+}
+
+TEST(AddrPredictorStageTest, StrideNeedsRepeats)
+{
+    StrideAddrPredictor stride;
+    stride.train(PC_A, 0x1000);
+    stride.train(PC_A, 0x1040);
+    EXPECT_EQ(0u, stride.predict(PC_A));
+
+    stride.train(PC_A, 0x1080);
+    stride.train(PC_A, 0x10c0);
+    EXPECT_EQ(0x1100u, stride.predict(PC_A));
+
+    /* A new stride starts over */
+    stride.train(PC_A, 0x5000);
+    EXPECT_EQ(0u, stride.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, RegionReplaysTheLastVisit)
+{
+    RegionAddrPredictor region;
+    const std::vector<Addr_t> visit = {0x20000, 0x20140, 0x20300};
+    for (Addr_t addr : visit) {
+        region.train(PC_A, addr);
+    }
+    /* Nothing is known about the first visit */
+    EXPECT_EQ(0u, region.predict(PC_A));
+
+    region.train(PC_A, 0x80000);
+    region.train(PC_A, 0x20000);
+    EXPECT_EQ(0x20140u, region.predict(PC_A));
+    region.train(PC_A, 0x20140);
+    EXPECT_EQ(0x20300u, region.predict(PC_A));
+    region.train(PC_A, 0x20300);
+    EXPECT_EQ(0u, region.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, MarkovPredictsTheLastSuccessor)
+{
+    MarkovAddrPredictor markov;
+    const std::vector<Addr_t> chain = {0x7000, 0x3040, 0x9980, 0x1200};
+    for (Addr_t addr : chain) {
+        markov.train(PC_A, addr);
+    }
+
+    markov.train(PC_A, 0x3040);
+    EXPECT_EQ(0x9980u, markov.predict(PC_A));
+    markov.train(PC_A, 0x9980);
+    EXPECT_EQ(0x1200u, markov.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, RegionKeepsTheMostUsedRegions)
+{
+    RegionAddrPredictor region;
+    /* Regions 0x40000 apart share a set of the 4 way table */
+    region.train(PC_A, 0x40000);
+    region.train(PC_A, 0x40040);
+    region.train(PC_A, 0x40080);
+    /* Regions with only their last line written back */
+    for (Addr_t i = 2; i <= 5; i++) {
+        region.train(PC_A, i * 0x40000 + 0xfc0);
+    }
+
+    region.train(PC_A, 0x40000);
+    EXPECT_EQ(0x40040u, region.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, MarkovReplacesTheLeastRecentLine)
+{
+    MarkovAddrPredictor markov;
+    /* Lines 0x4000 apart share a set of the 4 way table */
+    for (Addr_t i = 1; i <= 6; i++) {
+        markov.train(PC_A, i * 0x4000);
+        markov.train(PC_A, i * 0x4000 + 0x40);
+    }
+
+    /* The two oldest lines made room for the two newest */
+    markov.train(PC_A, 6 * 0x4000);
+    EXPECT_EQ(6u * 0x4000 + 0x40, markov.predict(PC_A));
+    markov.train(PC_A, 5 * 0x4000);
+    EXPECT_EQ(5u * 0x4000 + 0x40, markov.predict(PC_A));
+    markov.train(PC_A, 3 * 0x4000);
+    EXPECT_EQ(3u * 0x4000 + 0x40, markov.predict(PC_A));
+    markov.train(PC_A, 2 * 0x4000);
+    EXPECT_EQ(0u, markov.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, DeltaKeepsTheOldBehaviour)
+{
+    AddrPredictorStage stage(AddrPredictorStage::Kind::DELTA);
+    EXPECT_EQ(0u, stage.predict(PC_A));
+
+    for (Addr_t i = 1; i <= 5; i++) {
+        stage.train(PC_A, i * 0x40);
+    }
+    EXPECT_EQ(6u * 0x40, stage.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, TournamentNeedsConfidence)
+{
+    AddrPredictorStage stage(AddrPredictorStage::Kind::TOURNAMENT);
+    stage.train(PC_A, 0x1000);
+    stage.train(PC_A, 0x1040);
+    stage.train(PC_A, 0x1080);
+    stage.train(PC_A, 0x10c0);
+
+    /* The stride predictor is right, but not confident enough yet */
+    EXPECT_EQ(0u, stage.predict(PC_A));
+
+    for (Addr_t i = 4; i < 12; i++) {
+        stage.train(PC_A, 0x1000 + i * 0x40);
+    }
+    EXPECT_EQ(0x1000u + 12 * 0x40, stage.predict(PC_A));
+}
+
+TEST(AddrPredictorStageTest, TournamentPicksMarkovForIrregularChains)
+{
+    AddrPredictorStage stage(AddrPredictorStage::Kind::TOURNAMENT);
+    /* A pointer chase without a stride, revisited in the same order */
+    const std::vector<Addr_t> chain = {
+        0x7000, 0x3040, 0x9980, 0x1200, 0x5540, 0x2280, 0xa0c0, 0x6100,
+    };
+
+    for (int round = 0; round < 4; round++) {
+        for (Addr_t addr : chain) {
+            stage.train(PC_A, addr);
+        }
+    }
+
+    stage.train(PC_A, chain[0]);
+    EXPECT_EQ(chain[1], stage.predict(PC_A));
+    stage.train(PC_A, chain[1]);
+    EXPECT_EQ(chain[2], stage.predict(PC_A));
+}
@@ -4,16 +4,88 @@
 #include "mem/packet.hh"
 #include "mem/cache/base.hh"
 #include "mem/predictor/Declarations.hh"
+#include "mem/predictor/ChunkCompare.hh"
 #include "mem/predictor/ChunkInfo.hh"
 
+#include <array>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Cacheline stored as a structure of arrays: the raw data words, a bit mask 
+ * of valid chunks and one bit mask per chunk flag. Per-chunk generating PCs 
+ * and times of generation are kept in a separately allocated block which is 
+ * only created when one of them is set and is shared between copies until 
+ * written.
+ * 
+ * Chunks are accessed using get_datachunks()[i], which returns a ChunkRef 
+ * exposing the ChunkInfo interface for the chunk.
+ */
 class CacheLine {
+public:
+    static_assert(DATA_CHUNK_COUNT <= sizeof(ChunkMask)*8, 
+                  "ChunkMask cannot hold all the chunks of a cacheline");
+
+    static constexpr ChunkMask ALL_CHUNKS 
+            = (ChunkMask)((1UL << DATA_CHUNK_COUNT) - 1);
+
 private:
     /* Memory address of the cacheline */
     Addr_t addr;
     bool hasAddr = false;
 
-    /* Holds the chunks of the cacheline */
-    ChunkInfo dataChunks[DATA_CHUNK_COUNT];
+    /* Data words of the cacheline, 0 for chunks without data */
+    DataChunk data[DATA_CHUNK_COUNT] = {};
+
+    /* Chunks holding data (ChunkInfo::ChunkType::DATA) */
+    ChunkMask validMask = 0;
+
+    /* Per chunk flags, see ChunkInfo */
+    ChunkMask completeMask = 0;
+    ChunkMask freePredMask = 0;
+    ChunkMask constPredMask = 0;
+    ChunkMask const0PredMask = 0;
+    ChunkMask genPCMask = 0;
+    ChunkMask timeOfGenMask = 0;
+
+    /* Rarely set per chunk fields */
+    struct ChunkMeta {
+        PC_t generatingPC[DATA_CHUNK_COUNT];
+        Tick timeOfGen[DATA_CHUNK_COUNT];
+#ifdef DIAGNOSTICS_MATCHING_PC
+        ChunkMask matchingPCMask = 0;
+        std::deque<PC_t> matchingPCs[DATA_CHUNK_COUNT];
+#endif // DIAGNOSTICS_MATCHING_PC
+    };
+    std::shared_ptr<ChunkMeta> meta;
+
+    /* Returns the chunk metadata for writing, copying it if shared */
+    ChunkMeta &get_meta_mut() {
+        if (not this->meta) {
+            this->meta = std::make_shared<ChunkMeta>();
+        } else if (this->meta.use_count() > 1) {
+            this->meta = std::make_shared<ChunkMeta>(*this->meta);
+        }
+        return *this->meta;
+    }
+
+    static ChunkMask bit(size_t index) {
+        return (ChunkMask)(1U << index);
+    }
+
+    void set_chunk_data(size_t index, DataChunk val) {
+        assert(index < DATA_CHUNK_COUNT);
+        this->data[index] = val;
+        this->validMask |= bit(index);
+    }
+
+    static void set_bit(ChunkMask &mask, size_t index, bool val) {
+        if (val) {
+            mask |= bit(index);
+        } else {
+            mask &= ~bit(index);
+        }
+    }
 
     /** 
      * Returns the lower 32 bits of a uint64_t as uint32_t
@@ -43,18 +115,189 @@ private:
 
     bool isDirty = false;
 public:
-    friend std::ostream& operator<<(std::ostream& os, const CacheLine& dt);
+    /**
+     * Reference to a single chunk of a CacheLine, provides the ChunkInfo 
+     * interface over the structure of arrays storage of the cacheline.
+     */
+    class ChunkRef {
+    private:
+        CacheLine *line;
+        size_t index;
+
+        ChunkMask bit() const { return CacheLine::bit(this->index); }
+        bool test(ChunkMask mask) const { return mask & this->bit(); }
+    public:
+        ChunkRef(CacheLine *line, size_t index) : line(line), index(index) {
+            assert(index < DATA_CHUNK_COUNT);
+        }
 
-    CacheLine() {
-        this->timeOfCreation = curTick();
+        ChunkRef(const ChunkRef &other) = default;
+
+        /* Copies the contents of the other chunk into this chunk */
+        ChunkRef &operator=(const ChunkRef &other) {
+            CacheLine *src = other.line;
+            CacheLine *dst = this->line;
+            size_t s = other.index, d = this->index;
+
+            dst->data[d] = src->data[s];
+            set_bit(dst->validMask, d, src->validMask & CacheLine::bit(s));
+            set_bit(dst->completeMask, d, src->completeMask & CacheLine::bit(s));
+            set_bit(dst->freePredMask, d, src->freePredMask & CacheLine::bit(s));
+            set_bit(dst->constPredMask, d, src->constPredMask & CacheLine::bit(s));
+            set_bit(dst->const0PredMask, d, src->const0PredMask & CacheLine::bit(s));
+            set_bit(dst->genPCMask, d, src->genPCMask & CacheLine::bit(s));
+            set_bit(dst->timeOfGenMask, d, src->timeOfGenMask & CacheLine::bit(s));
+
+            if (src->meta and (src->genPCMask | src->timeOfGenMask) & CacheLine::bit(s)) {
+                PC_t generatingPC = src->meta->generatingPC[s];
+                Tick timeOfGen = src->meta->timeOfGen[s];
+                ChunkMeta &dstMeta = dst->get_meta_mut();
+                dstMeta.generatingPC[d] = generatingPC;
+                dstMeta.timeOfGen[d] = timeOfGen;
+            }
+#ifdef DIAGNOSTICS_MATCHING_PC
+            if (src->meta) {
+                ChunkMask matching = src->meta->matchingPCMask & CacheLine::bit(s);
+                std::deque<PC_t> matchingPCs = src->meta->matchingPCs[s];
+                ChunkMeta &dstMeta = dst->get_meta_mut();
+                set_bit(dstMeta.matchingPCMask, d, matching);
+                dstMeta.matchingPCs[d] = matchingPCs;
+            }
+#endif // DIAGNOSTICS_MATCHING_PC
+            return *this;
+        }
+
+        ChunkInfo::ChunkType get_chunk_type() const {
+            return test(line->validMask) ? ChunkInfo::ChunkType::DATA 
+                                         : ChunkInfo::ChunkType::INVALID;
+        }
+
+        /* Cachelines only hold data chunks */
+        ChunkRef &set_chunk_type(ChunkInfo::ChunkType chunkType) {
+            panic_if(chunkType != ChunkInfo::ChunkType::DATA 
+                        and chunkType != ChunkInfo::ChunkType::INVALID,
+                     "Cacheline chunks can only be of DATA or INVALID type");
+            set_bit(line->validMask, index, 
+                    chunkType == ChunkInfo::ChunkType::DATA);
+            return *this;
+        }
+
+        bool is_valid() const { return test(line->validMask); }
+        bool is_invalid() const { return not this->is_valid(); }
+
+        DataChunk get_data() const {
+            panic_if_not(this->is_valid());
+            return line->data[index];
+        }
+
+        ChunkRef &set_data(DataChunk data) {
+            panic_if_not(this->is_valid());
+            line->data[index] = data;
+            return *this;
+        }
+
+        bool has_generating_pc() const { return test(line->genPCMask); }
+
+        PC_t get_generating_pc() const {
+            panic_if_not(this->has_generating_pc());
+            return line->meta->generatingPC[index];
+        }
+
+        ChunkRef &set_generating_pc(PC_t generatingPC) {
+            line->get_meta_mut().generatingPC[index] = generatingPC;
+            line->genPCMask |= this->bit();
+            return *this;
+        }
+
+        bool has_time_of_gen() const { return test(line->timeOfGenMask); }
+
+        Tick get_time_of_gen() const {
+            panic_if_not(this->has_time_of_gen());
+            return line->meta->timeOfGen[index];
+        }
+
+        void set_time_of_gen(Tick timeOfGen) {
+            line->get_meta_mut().timeOfGen[index] = timeOfGen;
+            line->timeOfGenMask |= this->bit();
+        }
+
+        bool get_completion() const { return test(line->completeMask); }
+        void set_completion(bool isComplete) {
+            set_bit(line->completeMask, index, isComplete);
+        }
+
+        bool is_free_prediction() const { return test(line->freePredMask); }
+        void set_free_prediction() { line->freePredMask |= this->bit(); }
+
+        bool is_constant_pred() const { return test(line->constPredMask); }
+        void set_constant_pred() { line->constPredMask |= this->bit(); }
+
+        bool is_const_0_pred() const { return test(line->const0PredMask); }
+        void set_const_0_pred() { line->const0PredMask |= this->bit(); }
+        void unset_const_0_pred() { line->const0PredMask &= ~this->bit(); }
+
+    #ifdef DIAGNOSTICS_MATCHING_PC
+        bool has_matching_pcs() const {
+            return line->meta and (line->meta->matchingPCMask & this->bit());
+        }
+
+        void set_matching_pcs() {
+            line->get_meta_mut().matchingPCMask |= this->bit();
+        }
+
+        void add_matching_pc(PC_t pc) {
+            panic_if_not(has_matching_pcs());
+            line->get_meta_mut().matchingPCs[index].push_back(pc);
+        }
+
+        const std::deque<PC_t> get_matching_pc() const {
+            return line->meta->matchingPCs[index];
+        }
+    #endif // DIAGNOSTICS_MATCHING_PC
+
+        void clear() {
+            ChunkMask keep = ~this->bit();
+            line->data[index] = 0;
+            line->validMask &= keep;
+            line->completeMask &= keep;
+            line->freePredMask &= keep;
+            line->constPredMask &= keep;
+            line->const0PredMask &= keep;
+            line->genPCMask &= keep;
+            line->timeOfGenMask &= keep;
+        }
     };
 
+    /**
+     * Indexable view over all the chunks of a CacheLine.
+     */
+    class ChunkArray {
+    private:
+        CacheLine *line;
+    public:
+        ChunkArray(CacheLine *line) : line(line) {}
+
+        ChunkRef operator[](size_t index) const {
+            return ChunkRef(this->line, index);
+        }
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const CacheLine& dt);
+
+    /* Empty line, created at tick 0 until set_time_of_creation() */
+    CacheLine() = default;
+
     /* Create the cacheline from the cacheObj cache object*/
     CacheLine(Addr_t paddr, BaseCache *cacheObj) : CacheLine() {
-        CacheBlk *cacheBlk = cacheObj->tags->findBlock(paddr, false);
-        DataChunk *cacheData = nullptr;
+        this->timeOfCreation = curTick();
+
+        /* No cache when the predictor is driven without caches */
+        CacheBlk *cacheBlk = cacheObj == nullptr ? nullptr
+                : cacheObj->tags->findBlock(paddr, false);
+        static const DataChunk invalidBlkData[DATA_CHUNK_COUNT] = {};
+        const DataChunk *cacheData = nullptr;
         if (cacheBlk == nullptr or not cacheBlk->isValid()) {
-            cacheData = new DataChunk[DATA_CHUNK_COUNT];
+            cacheData = invalidBlkData;
         } else {
             cacheData = (DataChunk*)cacheBlk->data;
         }
@@ -68,9 +311,7 @@ public:
         volatile size_t offset = get_cacheline_off(paddr)/sizeof(DataChunk);
 
         /* Set the correct ChunkType of all the data chunks */
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            this->dataChunks[i].set_chunk_type(ChunkInfo::ChunkType::DATA);
-        }
+        this->validMask = ALL_CHUNKS;
 
         for (int i = 0; i < count; i++) {
             auto index = i;
@@ -78,8 +319,7 @@ public:
                 index += offset;
             }
             panic_if(index > DATA_CHUNK_COUNT, "Check alignment");
-            this->dataChunks[index].set_chunk_type(ChunkInfo::ChunkType::DATA);
-            this->dataChunks[index].set_data(cacheData[i]);
+            this->set_chunk_data(index, cacheData[i]);
         }
     }
 
@@ -87,6 +327,7 @@ public:
 
     CacheLine(const Addr_t addr, const DataChunk dataChunks[DATA_CHUNK_COUNT], 
               const size_t count, const bool alignCacheline) : CacheLine() {
+        this->timeOfCreation = curTick();
         panic_if(count > DATA_CHUNK_COUNT, "Cannot store data larger than a cache line");
 
         this->addr = addr;
@@ -95,9 +336,7 @@ public:
         volatile size_t offset = get_cacheline_off(addr)/sizeof(DataChunk);
 
         /* Set the correct ChunkType of all the data chunks */
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            this->dataChunks[i].set_chunk_type(ChunkInfo::ChunkType::DATA);
-        }
+        this->validMask = ALL_CHUNKS;
 
         for (int i = 0; i < count; i++) {
             auto index = i;
@@ -105,12 +344,12 @@ public:
                 index += offset;
             }
             panic_if(index > DATA_CHUNK_COUNT, "Check alignment");
-            this->dataChunks[index].set_chunk_type(ChunkInfo::ChunkType::DATA);
-            this->dataChunks[index].set_data(dataChunks[i]);
+            this->set_chunk_data(index, dataChunks[i]);
         }
     }
 
     CacheLine(const PacketPtr pkt, bool useVaddr = true) : CacheLine() {
+        this->timeOfCreation = curTick();
         Addr_t addr = -1;
         
         if (useVaddr) {
@@ -130,13 +369,29 @@ public:
             auto index = i+offset;
             panic_if(index > DATA_CHUNK_COUNT, "Check alignment");
 
-            this->dataChunks[index].set_chunk_type(ChunkInfo::ChunkType::DATA);
-            this->dataChunks[index].set_data(pktData[i]);
+            this->set_chunk_data(index, pktData[i]);
         }
     }
 
-    ChunkInfo* get_datachunks() const {
-        return (ChunkInfo*)dataChunks;
+    ChunkArray get_datachunks() const {
+        return ChunkArray(const_cast<CacheLine*>(this));
+    }
+
+    /**
+     * Mask and raw data accessors for comparing complete cachelines
+     */
+    ChunkMask get_valid_mask() const { return this->validMask; }
+    ChunkMask get_complete_mask() const { return this->completeMask; }
+    ChunkMask get_free_pred_mask() const { return this->freePredMask; }
+    ChunkMask get_const_pred_mask() const { return this->constPredMask; }
+    ChunkMask get_const_0_pred_mask() const { return this->const0PredMask; }
+    const DataChunk *get_data_words() const { return this->data; }
+
+    /**
+     * @return Mask of the valid chunks whose data matches words
+     */
+    ChunkMask match_mask(const DataChunk words[DATA_CHUNK_COUNT]) const {
+        return ChunkCompare::eq_mask(this->data, words) & this->validMask;
     }
 
     /** 
@@ -165,15 +420,11 @@ public:
         } 
         
         for (int i = 0; i < DATA_CHUNK_COUNT-1; i++) {
-            bool isDataChunk = (dataChunks[i].get_chunk_type() 
-                                    == ChunkInfo::ChunkType::DATA);
-            bool isNextDataChunk = (dataChunks[i+1].get_chunk_type() 
-                                    == ChunkInfo::ChunkType::DATA);
-            if (isDataChunk 
-                    and isNextDataChunk 
+            bool isDataPair = (this->validMask >> i & 0x3) == 0x3;
+            if (isDataPair 
                     /* Only algin the element at ith position */
-                    and ((uint32_t)cacheline_align(dataChunks[i].get_data()) == addrHigh) 
-                    and (dataChunks[i+1].get_data() == addrLow)) {
+                    and ((uint32_t)cacheline_align(this->data[i]) == addrHigh) 
+                    and (this->data[i+1] == addrLow)) {
                 result = i;
                 break;
             }
@@ -185,30 +436,18 @@ public:
      * Can this cacheline predict the dataChunk of a write? return the offset if 
      * possible, -1 if it isn't.
     */
-    int get_data_offset(DataChunk dataChunk) {
-        int result = -1;
-
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            bool isDataChunk = (dataChunks[i].get_chunk_type() 
-                                    == ChunkInfo::ChunkType::DATA);
-            if (isDataChunk and this->dataChunks[i].get_data() == dataChunk) {
-                result = i;
-                break;
-            }
-        }
-        return result;
+    int get_data_offset(DataChunk dataChunk) const {
+        ChunkMask matches = ChunkCompare::eq_mask(this->data, dataChunk) 
+                                & this->validMask;
+        return matches ? __builtin_ctz(matches) : -1;
     }
 
     /**
      * Returns true if all the dataChunks of this cache line have found a predictor.
      * False otherwise.
      */
-    bool are_all_complete() {
-        bool result = true;
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            result &= this->get_datachunks()[i].get_completion();
-        }
-        return result;
+    bool are_all_complete() const {
+        return this->completeMask == ALL_CHUNKS;
     }
 
     void set_addr(Addr_t addr) {
@@ -216,42 +455,35 @@ public:
         this->hasAddr = true;
     }
 
+    bool has_addr() const { return this->hasAddr; }
+
     Addr_t get_addr() const {
         assert(hasAddr);
         return this->addr;
     }
 
-    bool all_invalid() {
-        bool allInvalid = true;
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            if (this->dataChunks[i].is_valid()) {
-                allInvalid = false;
-            }
-        }
-        return allInvalid;
+    bool all_invalid() const {
+        return this->validMask == 0;
     }
 
     /**
      * Returns the index of the first valid data chunk in the cache line,
      * (size_t)-1 if no such index exists
     */
-    size_t find_first_valid_index() {
-        size_t result = -1;
-        
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            if (this->get_datachunks()[i].is_valid()) {
-                result = i;
-                break;
-            }
-        }
-
-        return result;
+    size_t find_first_valid_index() const {
+        return this->validMask ? __builtin_ctz(this->validMask) : (size_t)-1;
     }
 
     void clear() {
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            this->get_datachunks()[i].clear();
-        }
+        std::fill(this->data, this->data + DATA_CHUNK_COUNT, 0);
+        this->validMask = 0;
+        this->completeMask = 0;
+        this->freePredMask = 0;
+        this->constPredMask = 0;
+        this->const0PredMask = 0;
+        this->genPCMask = 0;
+        this->timeOfGenMask = 0;
+        this->meta.reset();
     }
 
     /**
@@ -261,13 +493,12 @@ public:
      * refers to the Tick latest tick value at which the data for one of its
      * chunk or addr was found.
     */
-    Tick get_time_of_gen() {
+    Tick get_time_of_gen() const {
         Tick result = 0;
+        ChunkMask genMask = this->validMask & this->timeOfGenMask;
         for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            if (this->dataChunks[i].is_valid() and this->dataChunks[i].has_time_of_gen()) {
-                if (result < this->dataChunks[i].get_time_of_gen()) {
-                    result = this->dataChunks[i].get_time_of_gen();
-                }
+            if ((genMask & bit(i)) and result < this->meta->timeOfGen[i]) {
+                result = this->meta->timeOfGen[i];
             }
         }
 
@@ -276,15 +507,8 @@ public:
     }
 
     bool all_zeros() const {
-        bool result = true;
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            if (this->dataChunks[i].is_valid() and this->dataChunks[i].get_data() != 0) {
-                result = false;
-                break;
-            }
-        }
-
-        return result;
+        ChunkMask zeros = ChunkCompare::eq_mask(this->data, (DataChunk)0);
+        return (~zeros & this->validMask) == 0;
     }
 
     /**
@@ -315,9 +539,9 @@ public:
      * @return Number of chunks overwritten in this object, chunks with 
      *         same value in the source and this cacheline are ignored
     */
-    size_t overwriteFrom(const CacheLine srcCacheline) {
-        ChunkInfo *srcDataChunks = srcCacheline.get_datachunks();
-        ChunkInfo *destDataChunks = this->get_datachunks();
+    size_t overwriteFrom(const CacheLine &srcCacheline) {
+        ChunkArray srcDataChunks = srcCacheline.get_datachunks();
+        ChunkArray destDataChunks = this->get_datachunks();
 
         size_t replaceCounter = 0;
 
@@ -346,8 +570,8 @@ public:
         // std::cout << "[Cacheline] Overwritting to " << destCacheline << std::endl;
         // std::cout << "[Cacheline] With " << *this << std::endl;
 
-        ChunkInfo *destDataChunks = destCacheline.get_datachunks();
-        ChunkInfo *srcDataChunks = this->get_datachunks();
+        ChunkArray destDataChunks = destCacheline.get_datachunks();
+        ChunkArray srcDataChunks = this->get_datachunks();
 
         size_t replaceCounter = 0;
 
@@ -389,13 +613,7 @@ public:
     };
 
     size_t invalid_chunk_count() const {
-        size_t invalidChunkCount = 0;
-        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-            if (this->dataChunks[i].is_invalid()) {
-                invalidChunkCount++;
-            }
-        }
-        return invalidChunkCount;
+        return DATA_CHUNK_COUNT - __builtin_popcount(this->validMask);
     }
 
     size_t valid_chunk_count() const {
@@ -0,0 +1,178 @@
+#include "mem/predictor/CachelineAccumulator.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/logging.hh"
+
+const size_t CachelineAccumulator::NO_SLOT;
+const Addr_t CachelineAccumulator::INVALID_TAG;
+
+CachelineAccumulator::CachelineAccumulator(size_t capacity, Tick retireAge,
+                                           Tick resolution,
+                                           size_t bucketCount)
+    : tags(capacity, INVALID_TAG), slots(capacity), retireAge(retireAge),
+      resolution(resolution), buckets(bucketCount) {
+    panic_if(capacity == 0, "Cacheline accumulator without slots");
+    panic_if(resolution == 0, "Timer wheel resolution must not be 0");
+    panic_if(bucketCount == 0 or (bucketCount & (bucketCount - 1)) != 0,
+             "Timer wheel bucket count %d is not a power of two",
+             bucketCount);
+
+    this->freeSlots.reserve(capacity);
+    for (size_t slot = capacity; slot > 0; slot--) {
+        this->freeSlots.push_back(slot - 1);
+    }
+}
+
+size_t
+CachelineAccumulator::find_slot(Addr_t addr) const {
+    for (size_t slot = 0; slot < this->tags.size(); slot++) {
+        if (this->tags[slot] == addr) {
+            return slot;
+        }
+    }
+    return NO_SLOT;
+}
+
+CacheLine &
+CachelineAccumulator::at(Addr_t addr) {
+    size_t slot = find_slot(addr);
+    panic_if(slot == NO_SLOT, "No accumulated line for %p", (void*)addr);
+    return this->slots[slot].line;
+}
+
+CacheLine &
+CachelineAccumulator::insert(Addr_t addr) {
+    panic_if(this->freeSlots.empty(), "Cacheline accumulator is full");
+    panic_if(addr == INVALID_TAG or contains(addr),
+             "Inserting %p twice into the cacheline accumulator",
+             (void*)addr);
+
+    size_t slot = this->freeSlots.back();
+    this->freeSlots.pop_back();
+
+    Slot &entry = this->slots[slot];
+    entry.line = CacheLine();
+    entry.older = this->newestSlot;
+    entry.newer = NO_SLOT;
+    if (this->newestSlot != NO_SLOT) {
+        this->slots[this->newestSlot].newer = slot;
+    } else {
+        this->oldestSlot = slot;
+    }
+    this->newestSlot = slot;
+
+    this->tags[slot] = addr;
+    this->count++;
+    return entry.line;
+}
+
+void
+CachelineAccumulator::unlink(size_t slot) {
+    Slot &entry = this->slots[slot];
+    if (entry.older != NO_SLOT) {
+        this->slots[entry.older].newer = entry.newer;
+    } else {
+        this->oldestSlot = entry.newer;
+    }
+    if (entry.newer != NO_SLOT) {
+        this->slots[entry.newer].older = entry.older;
+    } else {
+        this->newestSlot = entry.older;
+    }
+    entry.older = entry.newer = NO_SLOT;
+}
+
+void
+CachelineAccumulator::erase(Addr_t addr) {
+    size_t slot = find_slot(addr);
+    if (slot == NO_SLOT) {
+        return;
+    }
+
+    unschedule(slot);
+    unlink(slot);
+    this->tags[slot] = INVALID_TAG;
+    this->freeSlots.push_back(slot);
+    this->count--;
+}
+
+void
+CachelineAccumulator::unschedule(size_t slot) {
+    Slot &entry = this->slots[slot];
+    if (entry.bucket != NO_SLOT) {
+        std::vector<size_t> &bucket = this->buckets[entry.bucket];
+        auto it = std::find(bucket.begin(), bucket.end(), slot);
+        assert(it != bucket.end());
+        *it = bucket.back();
+        bucket.pop_back();
+    }
+    entry.deadline = MaxTick;
+    entry.bucket = NO_SLOT;
+}
+
+void
+CachelineAccumulator::schedule(size_t slot, Tick deadline) {
+    size_t bucket = (deadline / this->resolution) & (this->buckets.size() - 1);
+    Slot &entry = this->slots[slot];
+
+    if (entry.bucket != bucket) {
+        unschedule(slot);
+        this->buckets[bucket].push_back(slot);
+        entry.bucket = bucket;
+    }
+    entry.deadline = deadline;
+}
+
+void
+CachelineAccumulator::touch(Addr_t addr, Tick now) {
+    size_t slot = find_slot(addr);
+    panic_if(slot == NO_SLOT, "Updating %p, which is not accumulated",
+             (void*)addr);
+
+    this->slots[slot].line.set_time_of_last_update(now);
+    /* Due once the age is greater than the retire age */
+    schedule(slot, now + this->retireAge + 1);
+}
+
+void
+CachelineAccumulator::rearm(Addr_t addr, Tick now) {
+    size_t slot = find_slot(addr);
+    panic_if(slot == NO_SLOT, "Rearming %p, which is not accumulated",
+             (void*)addr);
+
+    Slot &entry = this->slots[slot];
+    if (entry.deadline == MaxTick) {
+        Tick lastUpdate = entry.line.get_time_of_last_update();
+        schedule(slot, std::max(lastUpdate + this->retireAge + 1, now));
+    }
+}
+
+void
+CachelineAccumulator::expire_bucket(size_t bucket, Tick now,
+                                    std::vector<size_t> &due) {
+    std::vector<size_t> &entries = this->buckets[bucket];
+    for (size_t i = 0; i < entries.size();) {
+        size_t slot = entries[i];
+        if (this->slots[slot].deadline <= now) {
+            this->slots[slot].deadline = MaxTick;
+            this->slots[slot].bucket = NO_SLOT;
+            entries[i] = entries.back();
+            entries.pop_back();
+            due.push_back(slot);
+        } else {
+            /* Due in a later turn of the wheel */
+            i++;
+        }
+    }
+}
+
+Tick
+CachelineAccumulator::next_deadline() const {
+    Tick result = MaxTick;
+    for (const Slot &entry : this->slots) {
+        result = std::min(result, entry.deadline);
+    }
+    return result;
+}
@@ -0,0 +1,154 @@
+#ifndef SHIFTLAB_CACHELINE_ACCUMULATOR_H__
+#define SHIFTLAB_CACHELINE_ACCUMULATOR_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/predictor/CacheLine.hh"
+#include "mem/predictor/Declarations.hh"
+
+/**
+ * Cachelines being written to PM that have not been written back yet.
+ *
+ * The accumulator has a fixed number of slots. Lookups compare the address
+ * against a small tag array, like a CAM. Lines are kept in insertion order
+ * and the oldest line is the eviction victim.
+ *
+ * A line is due for retirement once it has not been updated for more than
+ * the retire age. Deadlines are kept in a hashed timer wheel with one bucket
+ * per resolution ticks, so expiring lines only looks at the buckets that
+ * have passed, not at every line.
+ */
+class CachelineAccumulator {
+public:
+    static const size_t NO_SLOT = (size_t)-1;
+    /* Tag of a free slot, lines are cacheline aligned */
+    static const Addr_t INVALID_TAG = (Addr_t)-1;
+
+private:
+    struct Slot {
+        CacheLine line;
+        /* Insertion order, NO_SLOT at the ends */
+        size_t older = NO_SLOT;
+        size_t newer = NO_SLOT;
+        /* Retirement deadline, MaxTick if not scheduled */
+        Tick deadline = MaxTick;
+        size_t bucket = NO_SLOT;
+    };
+
+    std::vector<Addr_t> tags;
+    std::vector<Slot> slots;
+    std::vector<size_t> freeSlots;
+    size_t oldestSlot = NO_SLOT;
+    size_t newestSlot = NO_SLOT;
+    size_t count = 0;
+
+    const Tick retireAge;
+    const Tick resolution;
+    std::vector<std::vector<size_t>> buckets;
+    /* First wheel period that has not been fully expired */
+    Tick nextPeriod = 0;
+
+    size_t find_slot(Addr_t addr) const;
+    void unschedule(size_t slot);
+    void schedule(size_t slot, Tick deadline);
+    void unlink(size_t slot);
+    void expire_bucket(size_t bucket, Tick now, std::vector<size_t> &due);
+
+public:
+    /**
+     * @param capacity Number of lines
+     * @param retireAge Lines not updated for longer than this are due
+     * @param resolution Ticks covered by one bucket of the timer wheel
+     * @param bucketCount Buckets in the timer wheel, a power of two
+     */
+    CachelineAccumulator(size_t capacity, Tick retireAge, Tick resolution,
+                         size_t bucketCount = 64);
+
+    /* Line for the aligned address addr, nullptr if not present */
+    CacheLine *find(Addr_t addr) {
+        size_t slot = find_slot(addr);
+        return slot == NO_SLOT ? nullptr : &this->slots[slot].line;
+    }
+
+    bool contains(Addr_t addr) const { return find_slot(addr) != NO_SLOT; }
+
+    /* Line for addr, which must be present */
+    CacheLine &at(Addr_t addr);
+
+    /**
+     * Adds an empty line for addr as the newest line, the accumulator must
+     * not be full and addr must not be present.
+     */
+    CacheLine &insert(Addr_t addr);
+
+    /* Removes the line for addr if present */
+    void erase(Addr_t addr);
+
+    /* Aligned address of the oldest line, INVALID_TAG if empty */
+    Addr_t oldest_addr() const {
+        return this->oldestSlot == NO_SLOT ? INVALID_TAG
+                                           : this->tags[this->oldestSlot];
+    }
+
+    /* Records an update of the line for addr and restarts its retire age */
+    void touch(Addr_t addr, Tick now);
+
+    /**
+     * Makes the line for addr due again once its retire age since the last
+     * touch() expires, or at now if it already did. Lines with a pending
+     * deadline keep it.
+     */
+    void rearm(Addr_t addr, Tick now);
+
+    /**
+     * Calls fn(addr, CacheLine&) for every line whose retire age expired
+     * by now. The lines stay in the accumulator and are not due again until
+     * the next touch().
+     * @return Number of expired lines
+     */
+    template <class Fn>
+    size_t expire(Tick now, Fn fn) {
+        std::vector<size_t> due;
+        const Tick period = now / this->resolution;
+        const Tick first = this->nextPeriod;
+
+        if (period - first >= this->buckets.size()) {
+            /* A full turn of the wheel passed, every bucket is looked at */
+            for (size_t bucket = 0; bucket < this->buckets.size(); bucket++) {
+                expire_bucket(bucket, now, due);
+            }
+        } else {
+            for (Tick p = first; p <= period; p++) {
+                expire_bucket(p & (this->buckets.size() - 1), now, due);
+            }
+        }
+        /* Deadlines later in the current period stay in its bucket */
+        this->nextPeriod = period;
+
+        for (size_t slot : due) {
+            fn(this->tags[slot], this->slots[slot].line);
+        }
+        return due.size();
+    }
+
+    /* Earliest retirement deadline, MaxTick if no line is due */
+    Tick next_deadline() const;
+
+    /* Calls fn(addr, CacheLine&) from the oldest to the newest line */
+    template <class Fn>
+    void for_each(Fn fn) {
+        for (size_t slot = this->oldestSlot; slot != NO_SLOT;
+                slot = this->slots[slot].newer) {
+            fn(this->tags[slot], this->slots[slot].line);
+        }
+    }
+
+    size_t size() const { return this->count; }
+    size_t capacity() const { return this->slots.size(); }
+    bool full() const { return this->count == this->slots.size(); }
+    bool empty() const { return this->count == 0; }
+};
+
+#endif // SHIFTLAB_CACHELINE_ACCUMULATOR_H__
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/predictor/CachelineAccumulator.hh"
+
+namespace {
+
+std::vector<Addr_t>
+line_addrs(CachelineAccumulator &acc) {
+    std::vector<Addr_t> result;
+    acc.for_each([&](Addr_t addr, CacheLine &) { result.push_back(addr); });
+    return result;
+}
+
+std::vector<Addr_t>
+expired_addrs(CachelineAccumulator &acc, Tick now) {
+    std::vector<Addr_t> result;
+    acc.expire(now, [&](Addr_t addr, CacheLine &) { result.push_back(addr); });
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(CachelineAccumulatorTest, KeepsInsertionOrder)
+{
+    CachelineAccumulator acc(4, 100, 10);
+    acc.insert(0x40);
+    acc.insert(0x80);
+    acc.insert(0xc0);
+
+    EXPECT_EQ(3u, acc.size());
+    EXPECT_EQ((std::vector<Addr_t>{0x40, 0x80, 0xc0}), line_addrs(acc));
+    EXPECT_EQ(0x40u, acc.oldest_addr());
+
+    acc.erase(0x40);
+    acc.insert(0x100);
+    EXPECT_EQ((std::vector<Addr_t>{0x80, 0xc0, 0x100}), line_addrs(acc));
+    EXPECT_EQ(0x80u, acc.oldest_addr());
+}
+
+TEST(CachelineAccumulatorTest, LooksUpByTag)
+{
+    CachelineAccumulator acc(2, 100, 10);
+    acc.insert(0x40).set_dirty();
+
+    ASSERT_NE(nullptr, acc.find(0x40));
+    EXPECT_TRUE(acc.find(0x40)->is_dirty());
+    EXPECT_EQ(nullptr, acc.find(0x80));
+    EXPECT_TRUE(acc.contains(0x40));
+    EXPECT_FALSE(acc.contains(0x80));
+}
+
+TEST(CachelineAccumulatorTest, ReusesSlotsUpToCapacity)
+{
+    CachelineAccumulator acc(2, 100, 10);
+    acc.insert(0x40);
+    acc.insert(0x80);
+    EXPECT_TRUE(acc.full());
+
+    acc.erase(acc.oldest_addr());
+    EXPECT_FALSE(acc.full());
+    EXPECT_FALSE(acc.find(0x40));
+
+    /* A reused slot starts out as an empty line */
+    EXPECT_FALSE(acc.insert(0x40).is_dirty());
+    EXPECT_EQ((std::vector<Addr_t>{0x80, 0x40}), line_addrs(acc));
+
+    acc.erase(0x40);
+    acc.erase(0x80);
+    EXPECT_TRUE(acc.empty());
+    EXPECT_EQ(CachelineAccumulator::INVALID_TAG, acc.oldest_addr());
+}
+
+TEST(CachelineAccumulatorTest, ExpiresLinesOlderThanRetireAge)
+{
+    CachelineAccumulator acc(4, 100, 10);
+    acc.insert(0x40);
+    acc.insert(0x80);
+    acc.touch(0x40, 1000);
+    acc.touch(0x80, 1050);
+
+    EXPECT_EQ(1101u, acc.next_deadline());
+    EXPECT_TRUE(expired_addrs(acc, 1100).empty());
+    EXPECT_EQ((std::vector<Addr_t>{0x40}), expired_addrs(acc, 1101));
+
+    /* Expired lines are not due again until they are touched */
+    EXPECT_EQ(1151u, acc.next_deadline());
+    EXPECT_EQ((std::vector<Addr_t>{0x80}), expired_addrs(acc, 1200));
+    EXPECT_TRUE(expired_addrs(acc, 5000).empty());
+    EXPECT_EQ(MaxTick, acc.next_deadline());
+    EXPECT_EQ(1050u, acc.at(0x80).get_time_of_last_update());
+}
+
+TEST(CachelineAccumulatorTest, TouchPostponesRetirement)
+{
+    CachelineAccumulator acc(4, 100, 10);
+    acc.insert(0x40);
+    acc.touch(0x40, 1000);
+    acc.touch(0x40, 1090);
+
+    EXPECT_TRUE(expired_addrs(acc, 1150).empty());
+    EXPECT_EQ((std::vector<Addr_t>{0x40}), expired_addrs(acc, 1191));
+}
+
+TEST(CachelineAccumulatorTest, ErasedLinesDoNotExpire)
+{
+    CachelineAccumulator acc(4, 100, 10);
+    acc.insert(0x40);
+    acc.touch(0x40, 1000);
+    acc.erase(0x40);
+
+    EXPECT_EQ(MaxTick, acc.next_deadline());
+    EXPECT_TRUE(expired_addrs(acc, 2000).empty());
+}
+
+TEST(CachelineAccumulatorTest, KeepsDeadlinesBeyondOneWheelTurn)
+{
+    /* The wheel covers 4 * 10 ticks, the retire age is longer */
+    CachelineAccumulator acc(4, 100, 10, 4);
+    acc.insert(0x40);
+    acc.touch(0x40, 0);
+
+    for (Tick now = 0; now <= 100; now += 10) {
+        EXPECT_TRUE(expired_addrs(acc, now).empty()) << now;
+    }
+    EXPECT_EQ((std::vector<Addr_t>{0x40}), expired_addrs(acc, 110));
+}
+
+TEST(CachelineAccumulatorTest, RearmAfterExpiry)
+{
+    CachelineAccumulator acc(4, 100, 10);
+    acc.insert(0x40);
+    acc.touch(0x40, 1000);
+    EXPECT_EQ((std::vector<Addr_t>{0x40}), expired_addrs(acc, 1101));
+    EXPECT_EQ(MaxTick, acc.next_deadline());
+
+    /* The line was not updated since, it is due right away */
+    acc.rearm(0x40, 1500);
+    EXPECT_EQ(1500u, acc.next_deadline());
+    EXPECT_EQ((std::vector<Addr_t>{0x40}), expired_addrs(acc, 1500));
+
+    /* A pending deadline is kept */
+    acc.touch(0x40, 2000);
+    acc.rearm(0x40, 2010);
+    EXPECT_EQ(2101u, acc.next_deadline());
+
+    /* Expired before the retire age of the last update passed */
+    acc.insert(0x80);
+    acc.touch(0x80, 3000);
+    acc.erase(0x40);
+    EXPECT_EQ((std::vector<Addr_t>{0x80}), expired_addrs(acc, 3101));
+    acc.at(0x80).set_time_of_last_update(3050);
+    acc.rearm(0x80, 3102);
+    EXPECT_EQ(3151u, acc.next_deadline());
+}
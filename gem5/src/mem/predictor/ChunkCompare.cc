@@ -0,0 +1,154 @@
+#include "mem/predictor/ChunkCompare.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHUNK_COMPARE_X86__
+#include <immintrin.h>
+#endif
+
+static_assert(DATA_CHUNK_COUNT == 16, 
+              "Compare kernels assume 16 data chunks per cacheline");
+
+/*--- Scalar ---*/
+
+static ChunkMask
+eq_mask_scalar(const DataChunk *a, const DataChunk *b) {
+    ChunkMask result = 0;
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        result |= (ChunkMask)((a[i] == b[i]) << i);
+    }
+    return result;
+}
+
+static ChunkMask
+eq_val_scalar(const DataChunk *a, DataChunk val) {
+    ChunkMask result = 0;
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        result |= (ChunkMask)((a[i] == val) << i);
+    }
+    return result;
+}
+
+#ifdef CHUNK_COMPARE_X86__
+
+/*--- SSE2, 4 chunks per compare ---*/
+
+__attribute__((target("sse2"))) static ChunkMask
+eq_mask_sse2(const DataChunk *a, const DataChunk *b) {
+    ChunkMask result = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + 4*i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + 4*i));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        result |= (ChunkMask)(_mm_movemask_ps(_mm_castsi128_ps(eq)) << (4*i));
+    }
+    return result;
+}
+
+__attribute__((target("sse2"))) static ChunkMask
+eq_val_sse2(const DataChunk *a, DataChunk val) {
+    __m128i vval = _mm_set1_epi32(val);
+    ChunkMask result = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + 4*i));
+        __m128i eq = _mm_cmpeq_epi32(va, vval);
+        result |= (ChunkMask)(_mm_movemask_ps(_mm_castsi128_ps(eq)) << (4*i));
+    }
+    return result;
+}
+
+/*--- AVX2, 8 chunks per compare ---*/
+
+__attribute__((target("avx2"))) static ChunkMask
+eq_mask_avx2(const DataChunk *a, const DataChunk *b) {
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)a);
+    __m256i a1 = _mm256_loadu_si256((const __m256i*)(a + 8));
+    __m256i b0 = _mm256_loadu_si256((const __m256i*)b);
+    __m256i b1 = _mm256_loadu_si256((const __m256i*)(b + 8));
+    int lo = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a0, b0)));
+    int hi = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a1, b1)));
+    return (ChunkMask)(lo | (hi << 8));
+}
+
+__attribute__((target("avx2"))) static ChunkMask
+eq_val_avx2(const DataChunk *a, DataChunk val) {
+    __m256i vval = _mm256_set1_epi32(val);
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)a);
+    __m256i a1 = _mm256_loadu_si256((const __m256i*)(a + 8));
+    int lo = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a0, vval)));
+    int hi = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a1, vval)));
+    return (ChunkMask)(lo | (hi << 8));
+}
+
+#endif // CHUNK_COMPARE_X86__
+
+/*--- Class: ChunkCompare ---*/
+
+/* Constant initialized, the first call resolves the implementation */
+ChunkCompare::EqMaskFn ChunkCompare::eqMaskFn = ChunkCompare::resolve_eq_mask;
+ChunkCompare::EqValFn ChunkCompare::eqValFn = ChunkCompare::resolve_eq_val;
+ChunkCompare::Impl ChunkCompare::impl = ChunkCompare::Impl::SCALAR;
+
+void
+ChunkCompare::select_impl() {
+#ifdef CHUNK_COMPARE_X86__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        set_impl(Impl::AVX2);
+    } else if (__builtin_cpu_supports("sse2")) {
+        set_impl(Impl::SSE2);
+    } else {
+        set_impl(Impl::SCALAR);
+    }
+#else
+    set_impl(Impl::SCALAR);
+#endif // CHUNK_COMPARE_X86__
+}
+
+ChunkMask
+ChunkCompare::resolve_eq_mask(const DataChunk *a, const DataChunk *b) {
+    select_impl();
+    return eqMaskFn(a, b);
+}
+
+ChunkMask
+ChunkCompare::resolve_eq_val(const DataChunk *a, DataChunk val) {
+    select_impl();
+    return eqValFn(a, val);
+}
+
+void
+ChunkCompare::set_impl(Impl impl) {
+    ChunkCompare::impl = Impl::SCALAR;
+    eqMaskFn = eq_mask_scalar;
+    eqValFn = eq_val_scalar;
+
+#ifdef CHUNK_COMPARE_X86__
+    __builtin_cpu_init();
+    if (impl == Impl::AVX2 and __builtin_cpu_supports("avx2")) {
+        ChunkCompare::impl = Impl::AVX2;
+        eqMaskFn = eq_mask_avx2;
+        eqValFn = eq_val_avx2;
+    } else if (impl == Impl::SSE2 and __builtin_cpu_supports("sse2")) {
+        ChunkCompare::impl = Impl::SSE2;
+        eqMaskFn = eq_mask_sse2;
+        eqValFn = eq_val_sse2;
+    }
+#endif // CHUNK_COMPARE_X86__
+}
+
+ChunkCompare::Impl
+ChunkCompare::get_impl() {
+    if (eqMaskFn == resolve_eq_mask) {
+        select_impl();
+    }
+    return impl;
+}
+
+const char *
+ChunkCompare::get_impl_name() {
+    switch (get_impl()) {
+        case Impl::AVX2:    return "avx2";
+        case Impl::SSE2:    return "sse2";
+        default:            return "scalar";
+    }
+}
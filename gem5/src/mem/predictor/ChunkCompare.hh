@@ -0,0 +1,78 @@
+#ifndef SHIFTLAB_CHUNK_COMPARE_H__
+#define SHIFTLAB_CHUNK_COMPARE_H__
+
+#include "mem/predictor/Declarations.hh"
+
+/**
+ * Compare kernels over the DATA_CHUNK_COUNT data words of a cacheline, 
+ * returning one bit per chunk. The implementation (AVX2, SSE2 or scalar) is 
+ * selected on the first call depending on the host CPU.
+ */
+class ChunkCompare {
+public:
+    enum class Impl { SCALAR, SSE2, AVX2 };
+
+    using EqMaskFn = ChunkMask (*)(const DataChunk*, const DataChunk*);
+    using EqValFn = ChunkMask (*)(const DataChunk*, DataChunk);
+private:
+    static EqMaskFn eqMaskFn;
+    static EqValFn eqValFn;
+    static Impl impl;
+
+    /* Selects the implementation and replaces the function pointers */
+    static void select_impl();
+    static ChunkMask resolve_eq_mask(const DataChunk *a, const DataChunk *b);
+    static ChunkMask resolve_eq_val(const DataChunk *a, DataChunk val);
+public:
+    /**
+     * @return Mask with bit i set if a[i] == b[i]
+     */
+    static ChunkMask eq_mask(const DataChunk *a, const DataChunk *b) {
+        return eqMaskFn(a, b);
+    }
+
+    /**
+     * @return Mask with bit i set if a[i] == val
+     */
+    static ChunkMask eq_mask(const DataChunk *a, DataChunk val) {
+        return eqValFn(a, val);
+    }
+
+    /**
+     * Forces an implementation, falls back to scalar if the host does not 
+     * support it.
+     */
+    static void set_impl(Impl impl);
+    static Impl get_impl();
+    static const char *get_impl_name();
+};
+
+/**
+ * Result of comparing a packet with a predicted cacheline, computed once per
+ * (packet, prediction) pair and shared by all the verification checks.
+ */
+struct ChunkMatch {
+    /* Chunks whose predicted data equals the packet */
+    ChunkMask match = 0;
+    /* Chunks holding a prediction */
+    ChunkMask valid = 0;
+    /* Chunks predicted using a constant */
+    ChunkMask constant = 0;
+    /* Chunks predicted for free (from the cache) */
+    ChunkMask freePred = 0;
+
+    /* Every valid chunk matches and at least one chunk is valid */
+    bool data_equal() const {
+        return this->valid != 0 and (this->valid & ~this->match) == 0;
+    }
+
+    ChunkMask valid_match() const { return this->valid & this->match; }
+    ChunkMask valid_mismatch() const { return this->valid & ~this->match; }
+    ChunkMask valid_const() const { return this->valid & this->constant; }
+
+    size_t mismatch_count() const { 
+        return __builtin_popcount(this->valid_mismatch()); 
+    }
+};
+
+#endif // SHIFTLAB_CHUNK_COMPARE_H__
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "mem/predictor/ChunkCompare.hh"
+
+namespace {
+
+const ChunkCompare::Impl allImpls[] = {
+    ChunkCompare::Impl::SCALAR, 
+    ChunkCompare::Impl::SSE2, 
+    ChunkCompare::Impl::AVX2
+};
+
+ChunkMask
+ref_eq_mask(const DataChunk *a, const DataChunk *b) {
+    ChunkMask result = 0;
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        result |= (ChunkMask)(a[i] == b[i]) << i;
+    }
+    return result;
+}
+
+ChunkMask
+ref_eq_val(const DataChunk *a, DataChunk val) {
+    ChunkMask result = 0;
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        result |= (ChunkMask)(a[i] == val) << i;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(ChunkCompareTest, AllImplsMatchScalar)
+{
+    std::mt19937 rng(1);
+    const ChunkCompare::Impl defaultImpl = ChunkCompare::get_impl();
+
+    for (int trial = 0; trial < 10000; trial++) {
+        DataChunk a[DATA_CHUNK_COUNT], b[DATA_CHUNK_COUNT];
+        /* Small value range so both matches and mismatches are common */
+        for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+            a[i] = rng() % 4;
+            b[i] = rng() % 4;
+        }
+        for (auto impl : allImpls) {
+            ChunkCompare::set_impl(impl);
+            ASSERT_EQ(ref_eq_mask(a, b), ChunkCompare::eq_mask(a, b))
+                << ChunkCompare::get_impl_name();
+            ASSERT_EQ(ref_eq_val(a, 2), ChunkCompare::eq_mask(a, (DataChunk)2))
+                << ChunkCompare::get_impl_name();
+        }
+    }
+
+    ChunkCompare::set_impl(defaultImpl);
+}
+
+TEST(ChunkCompareTest, HighBitsAreCompared)
+{
+    DataChunk a[DATA_CHUNK_COUNT] = {}, b[DATA_CHUNK_COUNT] = {};
+    a[15] = 0x80000000u;
+
+    for (auto impl : allImpls) {
+        ChunkCompare::set_impl(impl);
+        EXPECT_EQ(0x7fff, ChunkCompare::eq_mask(a, b));
+        EXPECT_EQ(0x8000, ChunkCompare::eq_mask(a, (DataChunk)0x80000000u));
+    }
+}
+
+TEST(ChunkMatchTest, DataEqualOnlyOnValidChunks)
+{
+    ChunkMatch chunkMatch;
+    chunkMatch.match = 0x00ff;
+    chunkMatch.valid = 0x000f;
+    chunkMatch.constant = 0x0101;
+
+    EXPECT_TRUE(chunkMatch.data_equal());
+    EXPECT_EQ(0u, chunkMatch.mismatch_count());
+    EXPECT_EQ(0x0001, chunkMatch.valid_const());
+
+    chunkMatch.valid = 0x0300;
+    EXPECT_FALSE(chunkMatch.data_equal());
+    EXPECT_EQ(2u, chunkMatch.mismatch_count());
+
+    /* An entry with no valid chunk never matches */
+    chunkMatch.valid = 0;
+    EXPECT_FALSE(chunkMatch.data_equal());
+}
@@ -167,6 +167,10 @@ public:
         return *this;
     }
 
+    bool has_data() const {
+        return this->flags & Flags::HAS_DATA;
+    }
+
     DataChunk get_data() const {
         panic_if_not(this->flags & Flags::HAS_DATA);
         panic_if_not(chunkType == ChunkType::DATA);
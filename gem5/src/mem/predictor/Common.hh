@@ -53,52 +53,6 @@ inline bool is_flag_set(const uint64_t &flags, uint64_t flag) {
     return result;
 }
 
-inline bool get_env_val(std::string str) {
-    char* val = std::getenv(str.c_str());
-    bool result = false;
-    if (val != nullptr) {
-        std::string val_str = std::string(val);
-        if (val_str != "0") {
-            result = true;
-        } else {
-            result = false;
-        }
-    }
-    return result;
-}
-
-inline std::string get_env_str(std::string str, std::string defaultVal) {
-    bool exists = get_env_val(str);
-
-    std::string result;
-    if (exists) {
-        char *val = std::getenv(str.c_str());
-        panic_if(val == nullptr, "Nullptr foundn while checking for %s", str.c_str());
-
-        result = std::string(val);
-    } else {
-        result = defaultVal;
-    }
-    
-    return result;
-}
-
-inline float get_env_float(std::string str, float defaultVal) {
-    bool exists = get_env_val(str);
-
-    float result;
-    if (exists) {
-        char *val = std::getenv(str.c_str());
-        panic_if(val == nullptr, "Nullptr foundn while checking for %s", str.c_str());
-
-        result = std::stof(std::string(val));
-    } else {
-        result = defaultVal;
-    }
-    
-    return result;
-}
-
 #define LPRINT                              \
     std::cerr << __FILE__ << ":"            \
               << __LINE__ << " @ "          \
@@ -22,7 +22,8 @@ private:
         COUNTER_CACHE_HIT       = 1UL << 7,
         ORIGNAL_CACHELINE       = 1UL << 8,
         IHB_PATTERN_MATCH_INDEX = 1UL << 9,
-        TIME_OF_CREATION        = 1UL << 10
+        TIME_OF_CREATION        = 1UL << 10,
+        SOURCE                  = 1UL << 11
     };
     
     uint64_t flags = 0UL;
@@ -36,6 +37,9 @@ private:
 
     size_t ihbPatternMatchIndex;
 
+    /* Channel of the frontend that generated the prediction */
+    int source;
+
     /** 
      * Cacheline that generated the prediction entry for this prediction.
      * Useful for diagnostics .
@@ -70,7 +74,11 @@ public:
         return this->cacheline;
     }
 
-    bool has_generator_hash() {
+    const CacheLine &get_cacheline() const {
+        return this->cacheline;
+    }
+
+    bool has_generator_hash() const {
         return is_flag_set(flags, Flags::GEN_HASH);
     }
 
@@ -93,7 +101,7 @@ public:
         this->used = true;
     }
 
-    bool is_used() {
+    bool is_used() const {
         return this->used;
     }
 
@@ -179,12 +187,12 @@ public:
         return is_flag_set(flags, Flags::VERIFICATION_CACHE_HIT);
     }
 
-    void set_orig_cacheline(CacheLine orignalCacheLine) {
+    void set_orig_cacheline(const CacheLine &orignalCacheLine) {
         set_flag(flags, Flags::ORIGNAL_CACHELINE);
         this->orignalCacheLine = orignalCacheLine;
     }
 
-    CacheLine get_orig_cacheline() const {
+    const CacheLine &get_orig_cacheline() const {
         panic_if_not(is_flag_set(flags, Flags::ORIGNAL_CACHELINE));
         return this->orignalCacheLine;
     }
@@ -198,6 +206,20 @@ public:
         panic_if_not(is_flag_set(flags, Flags::IHB_PATTERN_MATCH_INDEX));
         return this->ihbPatternMatchIndex;
     }
+
+    void set_source(int source) {
+        set_flag(flags, Flags::SOURCE);
+        this->source = source;
+    }
+
+    int get_source() const {
+        panic_if_not(is_flag_set(flags, Flags::SOURCE));
+        return this->source;
+    }
+
+    bool has_source() const {
+        return is_flag_set(flags, Flags::SOURCE);
+    }
     
 };
 
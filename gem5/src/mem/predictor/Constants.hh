@@ -10,9 +10,6 @@
 #define PRED_CONF_THRESHOLD (1)
 #define PRED_CONF_INVALID (-1)
 
-#define ENABLE_DW "ENABLE_DW"
-#define ENABLE_EV "ENABLE_EV"
-
 const size_t IHB_SIZE = 5;
 
 #endif // SHIFTLAB_CONSTANTS_H__
\ No newline at end of file
@@ -113,6 +113,17 @@ typedef uint32_t DataChunk;
 const int CACHELINE_SIZE = 64; // bytes
 const size_t DATA_CHUNK_COUNT = CACHELINE_SIZE/sizeof(DataChunk);
 
+/* One bit per data chunk of a cacheline */
+typedef uint16_t ChunkMask;
+
+/* Backend tracker for a data chunk that may hold a constant value */
+struct ConstChunkLocator {
+    size_t constOffset = -1;    // Cacheline offset for locating the constant chunk
+    size_t timesFound = 0;      // Number of times the chunk was found to hold constant 
+                                // value
+    DataChunk lastData = -1;    // Last data that the backend saw
+};
+
 class Confidence {
 private:
     int64_t init;
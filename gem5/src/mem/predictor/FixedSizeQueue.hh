@@ -5,85 +5,80 @@
 #include "helper_suyash.h"
 
 #include "mem/predictor/Declarations.hh"
+#include "mem/predictor/RingBuffer.hh"
 
 #include <cassert>
-#include <deque>
 #include <unordered_map>
-
-#include <fstream>
+#include <utility>
 
 /**
+ * Fixed size queue backed by a preallocated ring, pushing to a full queue
+ * evicts the oldest element.
+ *
  * ....   ....   ....   elem   elem   elem   elem   ....   ....   ....
  *                /\                          /\
  *             back_ptr                   front_ptr
  */
 template <class T>
 class FixedSizeQueue : private DataStore<T> {
-public:
-    using T_ptr = std::unique_ptr<T>;
 private:
     size_t sz;
-    std::deque<T_ptr> queue;
-    
-    /**
-     *  By default the queue would destroy objects that have to be evicted for inserting new ones 
-     */
-    bool manageMem = true; 
+    RingBuffer<T> queue;
 
-    void manageObj(T *obj) {
-        if (manageMem) {
-            delete obj;
+    void count_insertion() {
+        /* Avoids DataStore::add_back() as it copies the element */
+        if (this->statsEnabled) {
+            this->totalInsertions->operator++();
         }
     }
-
-    /* Diagnostics info */
-    size_t dump_id;
 public: 
     /**
      * Parent constructor is called automatically.
     */
-    FixedSizeQueue(std::string parentName, size_t size) : DataStore<T>(parentName), sz(size) {
-        // this->queue.resize(size);
-    }
-    FixedSizeQueue(std::string parentName, size_t size, T initValue) : DataStore<T>(parentName), sz(size) {
-        // this->queue.resize(size);
-    }
-    FixedSizeQueue(std::string parentName) : DataStore<T>(parentName) { unimplemented__(""); }
-    ~FixedSizeQueue() {
-        while (this->queue.size()) {
-            // T *rawPtr = this->queue.front().release();
-            // manageObj(rawPtr);
-        }
-    }
-    bool push_back(T *elem) {
-        DataStore<T>::add_back(*elem);
+    FixedSizeQueue(std::string parentName, size_t size) 
+        : DataStore<T>(parentName), sz(size), queue(size) {}
+    FixedSizeQueue(std::string parentName, size_t size, T initValue) 
+        : DataStore<T>(parentName), sz(size), queue(size) {}
+    FixedSizeQueue(std::string parentName) 
+        : DataStore<T>(parentName), queue(1) { unimplemented__(""); }
+
+    /**
+     * Constructs a new element in place at the back of the queue.
+     * @return Reference to the inserted element
+     */
+    template <class... Args>
+    T &emplace_back(Args&&... args) {
+        count_insertion();
         
-        if (this->queue.size() == this->sz) {
-            // T *rawPtr = this->queue.front().release();
-            // manageObj(rawPtr);
-            this->queue.pop_front();
+        if (this->queue.full()) {
             DataStore<T>::remove();
         }
+        return this->queue.emplace_back(std::forward<Args>(args)...);
+    }
 
-        T_ptr ptr(elem);
-        this->queue.push_back(std::move(ptr));
+    bool push_back(const T &elem) {
+        this->emplace_back(elem);
         return true;
     }
 
     T &get_front() override {
-        return *this->queue.front();
+        return this->queue.front();
     }
 
     T &get() {
         DataStore<T>::get();
-        return *this->queue.front();
+        return this->queue.front();
     }
 
     T &get(size_t index) {
-        panic_if(index > this->get_size(), 
+        panic_if(index >= this->get_size(), 
                 "index %d for %s exceeds size %d", 
                 index, this->name_ds, this->get_size());
-        return *this->queue.at(index);
+        return this->queue[index];
+    }
+
+    T &back() {
+        return this->queue.back();
     }
 
     size_t get_size() override {
@@ -97,49 +92,22 @@ public:
 
     bool remove() override {
         DataStore<T>::remove();
-        // T *rawPtr = this->queue.front().release();
-        // manageObj(rawPtr);
         this->queue.pop_front();
         return true;
     }
 
-    bool is_mem_managed() {
-        return this->manageMem;
-    }
-
-    void set_manage_mem(bool manageMem) {
-        this->manageMem = manageMem;
-    }
-
     /* For C++ range based loops */
-    typename std::deque<T_ptr>::iterator  
+    typename RingBuffer<T>::iterator  
     begin()  { return this->queue.begin();    }
     
-    typename std::deque<T_ptr>::iterator  
+    typename RingBuffer<T>::iterator  
     end()    { return this->queue.end();      }
     
-    typename std::deque<T_ptr>::reverse_iterator  
+    typename RingBuffer<T>::reverse_iterator  
     rbegin() { return this->queue.rbegin();   }
     
-    typename std::deque<T_ptr>::reverse_iterator  
+    typename RingBuffer<T>::reverse_iterator  
     rend()   { return this->queue.rend();     }
-
-    void dump() {
-        // std::cout << "Dump id = " << dump_id << std::endl;
-        // return;
-        std::string dump_path = "/ramdisk/dump_" + std::to_string(dump_id);
-        std::ofstream dumpFile;
-        dumpFile.open(dump_path);
-
-        int id = 0;
-        for (auto &whb_iter : *this) {
-            dumpFile << print_ptr(5) << whb_iter->get_pc()
-                     << " : " << whb_iter->get_cacheline()
-                     << " : " << (void*)whb_iter->get_gen_tick() << std::endl;
-        }
-        dumpFile.close();
-        this->dump_id++;
-    }
 };
 // #error
 
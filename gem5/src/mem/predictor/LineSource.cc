@@ -0,0 +1,31 @@
+#include "mem/predictor/LineSource.hh"
+
+#include <algorithm>
+#include <cstring>
+
+void
+LineImage::write(Addr_t paddr, const uint8_t *data, size_t size) {
+    while (size > 0) {
+        const Addr_t lineAddr = cacheline_align(paddr);
+        const size_t offset = get_cacheline_off(paddr);
+        const size_t len = std::min(size, (size_t)CACHELINE_SIZE - offset);
+
+        /* Bytes never written read as zero */
+        auto line = this->lines.emplace(lineAddr, Line()).first;
+        std::memcpy((uint8_t*)line->second.data() + offset, data, len);
+
+        paddr += len;
+        data += len;
+        size -= len;
+    }
+}
+
+bool
+LineImage::read_line(Addr_t paddr, DataChunk data[DATA_CHUNK_COUNT]) {
+    auto line = this->lines.find(cacheline_align(paddr));
+    if (line == this->lines.end()) {
+        return false;
+    }
+    std::memcpy(data, line->second.data(), CACHELINE_SIZE);
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef SHIFTLAB_LINE_SOURCE_H__
+#define SHIFTLAB_LINE_SOURCE_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "mem/predictor/Declarations.hh"
+
+/**
+ * Supplies the current contents of the lines the frontend completes with
+ * free predictions. The L2 cache plays this role in a full simulation.
+ */
+class LineSource {
+public:
+    virtual ~LineSource() {}
+
+    /**
+     * Copies the line at the cacheline aligned paddr to data
+     * @return False if the source does not hold the line
+     */
+    virtual bool read_line(Addr_t paddr, DataChunk data[DATA_CHUNK_COUNT]) = 0;
+};
+
+/**
+ * Contents of the lines written so far, rebuilt from the stores and
+ * writebacks of a trace.
+ */
+class LineImage : public LineSource {
+private:
+    typedef std::array<DataChunk, DATA_CHUNK_COUNT> Line;
+    std::unordered_map<Addr_t, Line> lines;
+
+public:
+    /* Writes size bytes at paddr, the write may cross a line boundary */
+    void write(Addr_t paddr, const uint8_t *data, size_t size);
+
+    bool read_line(Addr_t paddr, DataChunk data[DATA_CHUNK_COUNT]) override;
+
+    size_t size() const { return this->lines.size(); }
+};
+
+#endif // SHIFTLAB_LINE_SOURCE_H__
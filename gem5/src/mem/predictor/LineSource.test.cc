@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "mem/predictor/LineSource.hh"
+
+TEST(LineImageTest, MissingLine)
+{
+    LineImage image;
+    DataChunk data[DATA_CHUNK_COUNT];
+
+    EXPECT_FALSE(image.read_line(0x1000, data));
+    EXPECT_EQ(0u, image.size());
+}
+
+TEST(LineImageTest, PartialWrites)
+{
+    LineImage image;
+    DataChunk data[DATA_CHUNK_COUNT];
+
+    const uint32_t word = 0xdeadbeef;
+    image.write(0x1008, (const uint8_t*)&word, sizeof(word));
+
+    /* Any address of the line reads it, unwritten bytes are zero */
+    ASSERT_TRUE(image.read_line(0x1030, data));
+    for (size_t i = 0; i < DATA_CHUNK_COUNT; i++) {
+        EXPECT_EQ(i == 2 ? word : 0u, data[i]);
+    }
+
+    const uint32_t other = 0x12345678;
+    image.write(0x100c, (const uint8_t*)&other, sizeof(other));
+    ASSERT_TRUE(image.read_line(0x1000, data));
+    EXPECT_EQ(word, data[2]);
+    EXPECT_EQ(other, data[3]);
+    EXPECT_EQ(1u, image.size());
+}
+
+TEST(LineImageTest, FullLineAndCrossing)
+{
+    LineImage image;
+    DataChunk data[DATA_CHUNK_COUNT];
+
+    uint8_t line[CACHELINE_SIZE];
+    for (size_t i = 0; i < CACHELINE_SIZE; i++) {
+        line[i] = i;
+    }
+    image.write(0x2000, line, CACHELINE_SIZE);
+    ASSERT_TRUE(image.read_line(0x2000, data));
+    EXPECT_EQ(0, std::memcmp(data, line, CACHELINE_SIZE));
+
+    /* The last 4 bytes of 0x2000 and the first 4 of 0x2040 */
+    const uint64_t dword = 0x1111111122222222ULL;
+    image.write(0x203c, (const uint8_t*)&dword, sizeof(dword));
+    ASSERT_TRUE(image.read_line(0x2000, data));
+    EXPECT_EQ(0x22222222u, data[DATA_CHUNK_COUNT - 1]);
+    ASSERT_TRUE(image.read_line(0x2040, data));
+    EXPECT_EQ(0x11111111u, data[0]);
+    EXPECT_EQ(2u, image.size());
+}
@@ -0,0 +1,170 @@
+#ifndef SHIFTLAB_OBJECT_POOL_H__
+#define SHIFTLAB_OBJECT_POOL_H__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Fixed capacity slab of reference counted objects. All the objects are
+ * allocated when the pool is constructed and recycled through a free list.
+ *
+ * Live objects are kept in an intrusive list ordered by allocation time so the
+ * oldest one can be found in O(1) for eviction. Every slot carries a
+ * generation that is bumped whenever the slot is released, a reference taken
+ * as (object, generation) can be checked for staleness after the object was
+ * evicted and the slot reused.
+ */
+template <class T>
+class ObjectPool {
+private:
+    static const uint32_t NONE = UINT32_MAX;
+
+    struct SlotMeta {
+        uint32_t generation = 0;
+        uint32_t refCount = 0;
+        bool live = false;
+        /* Allocation order list of the live objects */
+        uint32_t older = NONE;
+        uint32_t younger = NONE;
+    };
+
+    std::vector<T> objects;
+    std::vector<SlotMeta> meta;
+    std::vector<uint32_t> freeList;
+
+    uint32_t oldestIdx = NONE;
+    uint32_t youngestIdx = NONE;
+    size_t liveCount = 0;
+
+    uint32_t index_of(const T *obj) const {
+        assert(obj >= this->objects.data()
+                and obj < this->objects.data() + this->objects.size());
+        return obj - this->objects.data();
+    }
+
+    void unlink(uint32_t idx) {
+        SlotMeta &slot = this->meta[idx];
+        if (slot.older != NONE) {
+            this->meta[slot.older].younger = slot.younger;
+        } else {
+            this->oldestIdx = slot.younger;
+        }
+        if (slot.younger != NONE) {
+            this->meta[slot.younger].older = slot.older;
+        } else {
+            this->youngestIdx = slot.older;
+        }
+        slot.older = slot.younger = NONE;
+    }
+
+public:
+    explicit ObjectPool(size_t capacity)
+        : objects(capacity), meta(capacity) {
+        assert(capacity > 0 and capacity < NONE);
+        this->freeList.reserve(capacity);
+        /* Hand out the lowest slots first */
+        for (size_t i = capacity; i > 0; i--) {
+            this->freeList.push_back(i - 1);
+        }
+    }
+
+    /**
+     * Takes a free object, reset to its default state, with a reference
+     * count of zero.
+     * @return nullptr if the pool is exhausted
+     */
+    T *allocate() {
+        if (this->freeList.empty()) {
+            return nullptr;
+        }
+
+        uint32_t idx = this->freeList.back();
+        this->freeList.pop_back();
+
+        this->objects[idx] = T();
+
+        SlotMeta &slot = this->meta[idx];
+        slot.live = true;
+        slot.refCount = 0;
+        slot.older = this->youngestIdx;
+        slot.younger = NONE;
+        if (this->youngestIdx != NONE) {
+            this->meta[this->youngestIdx].younger = idx;
+        } else {
+            this->oldestIdx = idx;
+        }
+        this->youngestIdx = idx;
+        this->liveCount++;
+
+        return &this->objects[idx];
+    }
+
+    /**
+     * Returns the object to the pool irrespective of its reference count,
+     * outstanding references become stale.
+     */
+    void release(T *obj) {
+        uint32_t idx = index_of(obj);
+        SlotMeta &slot = this->meta[idx];
+        assert(slot.live);
+
+        unlink(idx);
+        slot.live = false;
+        slot.refCount = 0;
+        slot.generation++;
+        this->liveCount--;
+        this->freeList.push_back(idx);
+    }
+
+    void ref(T *obj) {
+        SlotMeta &slot = this->meta[index_of(obj)];
+        assert(slot.live);
+        slot.refCount++;
+    }
+
+    /**
+     * Drops a reference, the object is released when the last one is
+     * dropped.
+     * @return true if the object was released
+     */
+    bool unref(T *obj) {
+        SlotMeta &slot = this->meta[index_of(obj)];
+        assert(slot.live and slot.refCount > 0);
+        if (--slot.refCount == 0) {
+            release(obj);
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t ref_count(const T *obj) const {
+        return this->meta[index_of(obj)].refCount;
+    }
+
+    uint32_t generation(const T *obj) const {
+        return this->meta[index_of(obj)].generation;
+    }
+
+    /**
+     * @return true if obj is still the object a reference taken at
+     * generation was pointing to
+     */
+    bool is_current(const T *obj, uint32_t generation) const {
+        const SlotMeta &slot = this->meta[index_of(obj)];
+        return slot.live and slot.generation == generation;
+    }
+
+    /* Oldest live object, nullptr if none */
+    T *oldest() {
+        return this->oldestIdx == NONE
+                ? nullptr : &this->objects[this->oldestIdx];
+    }
+
+    size_t size() const { return this->liveCount; }
+    size_t capacity() const { return this->objects.size(); }
+    bool full() const { return this->freeList.empty(); }
+};
+
+#endif // SHIFTLAB_OBJECT_POOL_H__
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "mem/predictor/ObjectPool.hh"
+
+namespace {
+
+struct Payload {
+    int val = 0;
+};
+
+} // anonymous namespace
+
+TEST(ObjectPoolTest, AllocatesUpToCapacity)
+{
+    ObjectPool<Payload> pool(4);
+    std::set<Payload*> objs;
+
+    for (int i = 0; i < 4; i++) {
+        Payload *obj = pool.allocate();
+        ASSERT_NE(nullptr, obj);
+        objs.insert(obj);
+    }
+
+    EXPECT_EQ(4u, objs.size());
+    EXPECT_TRUE(pool.full());
+    EXPECT_EQ(nullptr, pool.allocate());
+}
+
+TEST(ObjectPoolTest, ReleasedSlotIsResetAndStale)
+{
+    ObjectPool<Payload> pool(1);
+
+    Payload *obj = pool.allocate();
+    obj->val = 42;
+    uint32_t gen = pool.generation(obj);
+    EXPECT_TRUE(pool.is_current(obj, gen));
+
+    pool.release(obj);
+    EXPECT_FALSE(pool.is_current(obj, gen));
+
+    Payload *reused = pool.allocate();
+    EXPECT_EQ(obj, reused);
+    EXPECT_EQ(0, reused->val);
+    EXPECT_FALSE(pool.is_current(reused, gen));
+    EXPECT_TRUE(pool.is_current(reused, pool.generation(reused)));
+}
+
+TEST(ObjectPoolTest, LastUnrefReleases)
+{
+    ObjectPool<Payload> pool(2);
+
+    Payload *obj = pool.allocate();
+    pool.ref(obj);
+    pool.ref(obj);
+    EXPECT_EQ(2u, pool.ref_count(obj));
+
+    EXPECT_FALSE(pool.unref(obj));
+    EXPECT_EQ(1u, pool.size());
+    EXPECT_TRUE(pool.unref(obj));
+    EXPECT_EQ(0u, pool.size());
+}
+
+TEST(ObjectPoolTest, OldestFollowsAllocationOrder)
+{
+    ObjectPool<Payload> pool(3);
+
+    Payload *a = pool.allocate();
+    Payload *b = pool.allocate();
+    Payload *c = pool.allocate();
+    EXPECT_EQ(a, pool.oldest());
+
+    /* Releasing from the middle keeps the order of the others */
+    pool.release(b);
+    EXPECT_EQ(a, pool.oldest());
+    pool.release(a);
+    EXPECT_EQ(c, pool.oldest());
+
+    Payload *d = pool.allocate();
+    pool.release(c);
+    EXPECT_EQ(d, pool.oldest());
+    pool.release(d);
+    EXPECT_EQ(nullptr, pool.oldest());
+}
+
+TEST(ObjectPoolTest, EvictOldestUnderChurn)
+{
+    /* Allocation never fails when the oldest is evicted on exhaustion, and 
+       the pool never grows */
+    ObjectPool<Payload> pool(8);
+
+    for (int i = 0; i < 100000; i++) {
+        if (pool.full()) {
+            pool.release(pool.oldest());
+        }
+        Payload *obj = pool.allocate();
+        ASSERT_NE(nullptr, obj);
+        pool.ref(obj);
+        /* Every other object is dropped right away */
+        if (i % 2) {
+            pool.unref(obj);
+        }
+        ASSERT_LE(pool.size(), pool.capacity());
+    }
+}
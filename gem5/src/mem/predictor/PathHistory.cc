@@ -0,0 +1,106 @@
+#include "mem/predictor/PathHistory.hh"
+
+#include "base/logging.hh"
+
+const size_t PathHistory::MAX_SHIFT_XOR_LENGTH;
+
+static hash_t
+rotl64(hash_t val, unsigned bits) {
+    bits &= 63;
+    return bits == 0 ? val : (val << bits) | (val >> (64 - bits));
+}
+
+hash_t
+PathHistory::mix(PC_t pc) {
+    /* Murmur3 64 bit finalizer */
+    hash_t result = pc;
+    result ^= result >> 33;
+    result *= 0xff51afd7ed558ccdull;
+    result ^= result >> 33;
+    result *= 0xc4ceb9fe1a85ec53ull;
+    result ^= result >> 33;
+    return result;
+}
+
+PathHistory::PathHistory(size_t length, Kind kind, unsigned seed)
+        : kind(kind), history(length) {
+    fatal_if(kind == Kind::SHIFT_XOR and length > MAX_SHIFT_XOR_LENGTH,
+             "Path history of %d PCs is too long for the shift-xor hash, "
+             "max is %d", length, MAX_SHIFT_XOR_LENGTH);
+
+    /* Any odd multiplier works, derive one per seed */
+    this->base = mix(0x9e3779b97f4a7c15ull + seed) | 1;
+    this->basePowLen = 1;
+    for (size_t i = 0; i < length; i++) {
+        this->basePowLen *= this->base;
+    }
+}
+
+void
+PathHistory::push(PC_t pc) {
+    bool evicting = this->history.full();
+    PC_t oldest = evicting ? this->history.front() : 0;
+
+    switch (this->kind) {
+    case Kind::SHIFT_XOR:
+        if (evicting) {
+            /* Every other PC moves one position towards the oldest, bit 0 is
+               clear once the oldest PC is removed */
+            this->wideHash ^= oldest;
+            this->wideHash >>= 1;
+        }
+        this->history.emplace_back(pc);
+        this->wideHash ^= (unsigned __int128)pc << (this->history.size() - 1);
+        this->hash = (hash_t)this->wideHash;
+        break;
+    case Kind::FOLDED:
+        this->history.emplace_back(pc);
+        this->hash = rotl64(this->hash, 1) ^ mix(pc);
+        if (evicting) {
+            this->hash ^= rotl64(mix(oldest), this->history.capacity());
+        }
+        break;
+    case Kind::ROLLING_POLY:
+        this->history.emplace_back(pc);
+        this->hash = this->hash * this->base + mix(pc);
+        if (evicting) {
+            this->hash -= mix(oldest) * this->basePowLen;
+        }
+        break;
+    }
+}
+
+hash_t
+PathHistory::compute_hash() const {
+    hash_t result = 0;
+    size_t size = this->history.size();
+
+    for (size_t i = 0; i < size; i++) {
+        PC_t pc = this->history[i];
+        switch (this->kind) {
+        case Kind::SHIFT_XOR:
+            result ^= pc << i;
+            break;
+        case Kind::FOLDED:
+            result ^= rotl64(mix(pc), size - 1 - i);
+            break;
+        case Kind::ROLLING_POLY:
+            result = result * this->base + mix(pc);
+            break;
+        }
+    }
+    return result;
+}
+
+const char *
+PathHistory::kind_name(Kind kind) {
+    switch (kind) {
+    case Kind::SHIFT_XOR:
+        return "shift_xor";
+    case Kind::FOLDED:
+        return "folded_history";
+    case Kind::ROLLING_POLY:
+        return "rolling_poly";
+    }
+    return "unknown";
+}
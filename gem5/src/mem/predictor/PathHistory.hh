@@ -0,0 +1,69 @@
+#ifndef SHIFTLAB_PATH_HISTORY_H__
+#define SHIFTLAB_PATH_HISTORY_H__
+
+#include "mem/predictor/Declarations.hh"
+#include "mem/predictor/RingBuffer.hh"
+
+/**
+ * History of the last N store PCs along with a signature of the path. The
+ * signature is updated incrementally on every push by adding the new PC and
+ * removing the PC that falls out of the history, so the cost per store does
+ * not depend on N.
+ *
+ * Signatures, with p_0 the oldest and p_(n-1) the newest PC in the history:
+ *  SHIFT_XOR:      XOR_i (p_i << i), the original path hash
+ *  FOLDED:         XOR_i rotl(mix(p_i), n-1-i), folded history like TAGE
+ *  ROLLING_POLY:   SUM_i mix(p_i) * B^(n-1-i) mod 2^64, Rabin-Karp style
+ */
+class PathHistory {
+public:
+    enum class Kind { SHIFT_XOR, FOLDED, ROLLING_POLY };
+
+    /* SHIFT_XOR cannot shift a PC by more than 63 bits */
+    static const size_t MAX_SHIFT_XOR_LENGTH = 64;
+
+private:
+    Kind kind;
+    RingBuffer<PC_t> history;
+
+    /**
+     * Accumulator for SHIFT_XOR, wide enough that shifting the history
+     * towards the oldest entry does not lose any bit.
+     */
+    unsigned __int128 wideHash = 0;
+    hash_t hash = 0;
+
+    /* Multiplier and B^n for ROLLING_POLY */
+    hash_t base;
+    hash_t basePowLen;
+
+    /* Spreads the bits of a PC, the low bits of PCs are mostly similar */
+    static hash_t mix(PC_t pc);
+
+public:
+    /**
+     * @param length Number of PCs in the path
+     * @param seed Selects an independent ROLLING_POLY base, used to get a
+     *             second signature for checking aliasing
+     */
+    PathHistory(size_t length, Kind kind, unsigned seed = 0);
+
+    /* Adds a PC to the path, the oldest PC is removed if the path is full */
+    void push(PC_t pc);
+
+    hash_t get_hash() const { return this->hash; }
+
+    Kind get_kind() const { return this->kind; }
+    size_t get_size() const { return this->history.size(); }
+    size_t get_max_size() const { return this->history.capacity(); }
+
+    /* PC at index, 0 is the oldest */
+    PC_t get(size_t index) const { return this->history[index]; }
+
+    /* Recomputes the signature from scratch, for verification */
+    hash_t compute_hash() const;
+
+    static const char *kind_name(Kind kind);
+};
+
+#endif // SHIFTLAB_PATH_HISTORY_H__
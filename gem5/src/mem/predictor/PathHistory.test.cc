@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+#include "mem/predictor/PathHistory.hh"
+
+namespace {
+
+const PathHistory::Kind allKinds[] = {
+    PathHistory::Kind::SHIFT_XOR,
+    PathHistory::Kind::FOLDED,
+    PathHistory::Kind::ROLLING_POLY
+};
+
+/* Store PCs of a small program, 16 distinct PCs in user space */
+PC_t
+random_pc(std::mt19937_64 &rng) {
+    return 0x400000 + (rng() % 16) * 4;
+}
+
+} // anonymous namespace
+
+TEST(PathHistoryTest, IncrementalMatchesRecompute)
+{
+    for (auto kind : allKinds) {
+        for (size_t length : {1, 4, 32, 64}) {
+            std::mt19937_64 rng(length);
+            PathHistory history(length, kind);
+
+            for (int i = 0; i < 1000; i++) {
+                /* Mix in large PCs to catch bits lost by shifting */
+                PC_t pc = (i % 3) ? random_pc(rng) : rng();
+                history.push(pc);
+                ASSERT_EQ(history.compute_hash(), history.get_hash())
+                    << PathHistory::kind_name(kind) << " length " << length;
+            }
+            EXPECT_EQ(length, history.get_size());
+        }
+    }
+}
+
+TEST(PathHistoryTest, ShiftXorMatchesOriginalHash)
+{
+    /* The original path hash XOR'd every PC shifted by its age from the
+       oldest one */
+    const size_t length = 32;
+    std::mt19937_64 rng(1);
+    std::deque<PC_t> window;
+    PathHistory history(length, PathHistory::Kind::SHIFT_XOR);
+
+    for (int i = 0; i < 1000; i++) {
+        PC_t pc = rng();
+        history.push(pc);
+        window.push_back(pc);
+        if (window.size() > length) {
+            window.pop_front();
+        }
+
+        hash_t expected = 0;
+        for (size_t j = 0; j < window.size(); j++) {
+            expected ^= window[j] << j;
+        }
+        ASSERT_EQ(expected, history.get_hash());
+    }
+}
+
+TEST(PathHistoryTest, SameWindowSameHash)
+{
+    for (auto kind : allKinds) {
+        PathHistory a(8, kind), b(8, kind);
+        /* Different prefixes that fall out of the history */
+        for (PC_t pc = 1; pc < 20; pc++) {
+            a.push(pc);
+            b.push(pc * 1000);
+        }
+        for (PC_t pc = 100; pc < 108; pc++) {
+            a.push(pc);
+            b.push(pc);
+        }
+        EXPECT_EQ(a.get_hash(), b.get_hash()) << PathHistory::kind_name(kind);
+    }
+}
+
+TEST(PathHistoryTest, AliasingRate)
+{
+    /* Counts distinct windows that map to an already seen hash, using the 
+       rolling polynomial of another base as the window identity */
+    const size_t length = 32;
+    for (auto kind : allKinds) {
+        std::mt19937_64 rng(7);
+        PathHistory history(length, kind);
+        PathHistory check(length, PathHistory::Kind::ROLLING_POLY, 1);
+        std::unordered_map<hash_t, hash_t> seen;
+        size_t aliases = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 200000; i++) {
+            PC_t pc = random_pc(rng);
+            history.push(pc);
+            check.push(pc);
+            auto it = seen.find(history.get_hash());
+            if (it == seen.end()) {
+                seen.emplace(history.get_hash(), check.get_hash());
+            } else if (it->second != check.get_hash()) {
+                aliases++;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << PathHistory::kind_name(kind) << ": " << aliases 
+                  << " aliased paths, "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                        end - start).count() << " ms" << std::endl;
+    }
+}
@@ -1,4 +1,7 @@
 #include "PendingTable.hh"
+
+#include <algorithm>
+
 #include "debug/PendingTable.hh"
 #include "debug/PredictorFrontendLogic.hh"
 #include "mem/predictor/CacheLine.hh"
@@ -6,16 +9,107 @@
 #include "mem/predictor/Declarations.hh"
 #include "helper_suyash.h"  
 
-PendingTable::PendingTable(std::string name, FixedSizeQueue<WriteHistoryBufferEntry> *whb) : 
-    DataStore<U>(name), whb(whb) {
+/* Number of parents the pool holds, scales with the PC capacity */
+static size_t
+parent_pool_capacity(size_t maxPCs, float sizeMultiplier) {
+    size_t result = maxPCs * sizeMultiplier * PendingTable::PARENTS_PER_PC;
+    return result == 0 ? 1 : result;
+}
+
+PendingTable::PendingTable(std::string name, FixedSizeQueue<WriteHistoryBufferEntry> *whb,
+                           float sizeMultiplier, bool disableWhbSearch) : 
+    DataStore<U>(name), 
+    parentPool(parent_pool_capacity(MAX_SIZE, sizeMultiplier)), whb(whb) {
         pendingVolatilePCsSize
             .name(name + ".pendingVolatilePCsSize")
             .desc("Size of pending volatile PCs")
             .init(0,1000, 1000/10);
-        SharedArea::init_size_multiplier();
-        this->MAX_SIZE *= SharedArea::sizeMultiplier;
-        this->DISABLE_WHB_SEARCH = get_env_val("DISABLE_WHB_SEARCH");
+        this->MAX_SIZE *= sizeMultiplier;
+        this->DISABLE_WHB_SEARCH = disableWhbSearch;
+
+        /* Every parent waits on at most one address and DATA_CHUNK_COUNT 
+           data chunks */
+        this->slotCapacity = this->parentPool.capacity() * (DATA_CHUNK_COUNT + 1);
+
+        size_t poolCap = this->parentPool.capacity();
+        parentOccupancy
+            .name(name + ".parentOccupancy")
+            .desc("Parents live in the pool, sampled on allocation")
+            .init(0, poolCap, std::max<size_t>(poolCap/10, 1));
+        slotOccupancy
+            .name(name + ".slotOccupancy")
+            .desc("Chunks waiting in the table, sampled on insertion")
+            .init(0, this->slotCapacity, std::max<size_t>(this->slotCapacity/10, 1));
+        parentAllocations
+            .name(name + ".parentAllocations")
+            .desc("Parents allocated from the pool");
+        parentEvictions
+            .name(name + ".parentEvictions")
+            .desc("Parents evicted from a full pool before completing");
+        pcEvictions
+            .name(name + ".pcEvictions")
+            .desc("PCs evicted along with their waiting chunks");
+        staleSlotsDropped
+            .name(name + ".staleSlotsDropped")
+            .desc("Waiting chunks dropped because their parent was evicted");
+    }
+
+PendingTableEntryParent *
+PendingTable::alloc_parent() {
+    if (this->parentPool.full()) {
+        /* The waiting chunks of the evicted parent are now stale and are 
+           dropped when their PC is looked up */
+        this->parentPool.release(this->parentPool.oldest());
+        this->parentEvictions++;
+    }
+
+    PendingTableEntryParent *parent = this->parentPool.allocate();
+    panic_if_not(parent != nullptr);
+    this->parentPool.ref(parent);
+
+    this->parentAllocations++;
+    this->parentOccupancy.sample(this->parentPool.size());
+    return parent;
+}
+
+void
+PendingTable::put_parent(PendingTableEntryParent *parent) {
+    this->parentPool.unref(parent);
+}
+
+void
+PendingTable::drop_waiting(PC_t pc) {
+    auto pcCount = this->pendingVolatilePCs.find(pc);
+    panic_if(pcCount == this->pendingVolatilePCs.end() or pcCount->second == 0, 
+             "Volatile write count violation with pc = %p", (void*)pc);
+
+    if (--pcCount->second == 0) {
+        this->pendingVolatilePCs.erase(pcCount);
+    }
+    this->slotCount--;
+}
+
+void
+PendingTable::evict_pc(PC_t pc) {
+    auto waitingEntries = this->pendingTable.find(pc);
+    if (waitingEntries != this->pendingTable.end()) {
+        for (const U &waitingEntry : waitingEntries->second) {
+            PendingTableEntryParent *parent = waitingEntry.get_parent();
+            if (this->parentPool.is_current(parent, waitingEntry.get_parent_gen())) {
+                this->parentPool.unref(parent);
+            }
+        }
+        this->slotCount -= waitingEntries->second.size();
+        this->pendingTable.erase(waitingEntries);
+    }
+    this->pendingVolatilePCs.erase(pc);
+
+    auto orderIter = std::find(this->insertionOrder.begin(), 
+                               this->insertionOrder.end(), pc);
+    if (orderIter != this->insertionOrder.end()) {
+        this->insertionOrder.erase(orderIter);
     }
+}
 
 bool 
 PendingTable::add(U elem) {
@@ -24,8 +118,14 @@ PendingTable::add(U elem) {
         
         this->pendingVolatilePCsSize.sample(this->pendingVolatilePCs.size());
 
+        /* The waiting chunk keeps its parent alive */
+        elem.set_parent_gen(this->parentPool.generation(elem.get_parent()));
+        this->parentPool.ref(elem.get_parent());
+
         this->pendingTable[elem.get_generating_pc()].push_back(elem);
         this->pendingVolatilePCs[elem.get_generating_pc()]++;
+        this->slotCount++;
+        this->slotOccupancy.sample(this->slotCount);
 
         if (std::find(this->insertionOrder.begin(),     
                     this->insertionOrder.end(),   
@@ -54,10 +154,15 @@ PendingTable::add(U elem) {
         /* If the table is at capacity, free the first entry */
         if (this->insertionOrder.size() == MAX_SIZE) {
             panic_if(this->insertionOrder.size() > MAX_SIZE, "Inconsistent size");
-            auto entryToEvict = insertionOrder.front();
-            insertionOrder.pop_front();
-            this->pendingVolatilePCs.erase(entryToEvict);
-            this->pendingTable.erase(entryToEvict);
+            this->evict_pc(insertionOrder.front());
+            this->pcEvictions++;
+        }
+
+        /* Bound the chunks, stale ones only leave when their PC is looked up */
+        while (this->slotCount > this->slotCapacity 
+                and not this->insertionOrder.empty()) {
+            this->evict_pc(insertionOrder.front());
+            this->pcEvictions++;
         }
     } else {
         // std::cout << "Insert WHB search element for PC "    
@@ -69,18 +174,18 @@ PendingTable::add(U elem) {
                 whb_riter != this->whb->rend(); 
                 whb_riter++) {
 
-            WriteHistoryBufferEntry *whb_riter_obj = whb_riter->get();
+            WriteHistoryBufferEntry *whb_riter_obj = &*whb_riter;
             size_t df_offset = whb_riter_obj->get_cacheline().find_first_valid_index()  
                                 + elem.get_data_field_offset();
             if (whb_riter_obj->get_cacheline().get_datachunks()[df_offset].is_valid()) {
-                CacheLine cl = whb_riter->get()->get_cacheline();
+                CacheLine cl = whb_riter_obj->get_cacheline();
 
                 if (cl.get_datachunks()[df_offset].get_chunk_type() == ChunkInfo::ChunkType::DATA) {
                     DataChunk data = cl.get_datachunks()[df_offset].get_data();
 
                     if (whb_riter_obj->get_pc() == elem.get_generating_pc()) {
                         if (elem.get_chunk_type() == ChunkInfo::ChunkType::DATA) {
-                            ChunkInfo *dataChunks   
+                            CacheLine::ChunkArray dataChunks   
                                 = elem.get_parent()->cacheline.get_datachunks();
                             size_t parentIndex = elem.get_parent_index();
 
@@ -126,15 +231,23 @@ PendingTable::update_entry_state(PC_t pc, const DataChunk *dataChunks,
 
     auto &waitingEntries = this->pendingTable.at(pc);
     std::deque<PendingTableEntryParent*> completedParents;
-    std::deque<size_t> completedPendingTableEntries;
     
-    size_t iter = 0;
+    /* Entries that are still waiting are compacted to the front */
+    size_t keep = 0;
     
-    for (auto waitingEntry : waitingEntries) {
+    for (size_t iter = 0; iter < waitingEntries.size(); iter++) {
+        const U waitingEntry = waitingEntries[iter];
         panic_if_not(waitingEntry.get_generating_pc() != 0);
         auto parent = waitingEntry.get_parent();
         auto dataFieldOffset = waitingEntry.get_data_field_offset();
 
+        if (not this->parentPool.is_current(parent, waitingEntry.get_parent_gen())) {
+            /* The parent was evicted, the slot was reused by another one */
+            this->drop_waiting(pc);
+            this->staleSlotsDropped++;
+            continue;
+        }
+
         /* Size of the incoming write should always be greater than the data 
            field offset, but some instructions like FXSAVE have same PC value
            for different sized stores. */
@@ -156,18 +269,6 @@ PendingTable::update_entry_state(PC_t pc, const DataChunk *dataChunks,
                 parent->cacheline.get_datachunks()[parentIndex].set_chunk_type(ChunkInfo::ChunkType::DATA);
                 parent->cacheline.get_datachunks()[parentIndex].set_data(dataFromWrite);
                 parent->cacheline.get_datachunks()[parentIndex].set_time_of_gen(timeOfWrite);
-
-                /* Erase the matched entry from the map and the filter */
-                // waitingEntries.erase(waitingEntry++);
-                this->pendingVolatilePCs[pc]--;
-
-                if (this->pendingVolatilePCs[pc] == 0) {
-                    this->pendingVolatilePCs.erase(pc);
-                }
-
-                completedPendingTableEntries.push_back(iter);
-
-                panic_if(this->pendingVolatilePCs[pc] == -1, "Volatile write count violation with pc = %p", pc);
             } else if (waitingEntry.get_chunk_type() == ChunkInfo::ChunkType::ADDR) {
                 parent->addrComplete = true;
                 parent->addr.set_chunk_type(ChunkInfo::ChunkType::ADDR);
@@ -181,35 +282,35 @@ PendingTable::update_entry_state(PC_t pc, const DataChunk *dataChunks,
 
                 parent->addr.set_target_addr(addrFromWrite);
                 parent->addr.set_time_of_gen(timeOfWrite);
-
-                /* Erase the matched entry from the map and the filter */
-                // waitingEntries.erase(waitingEntry++);
-                this->pendingVolatilePCs.at(pc)--;
-                completedPendingTableEntries.push_back(iter);
             } else {
                 panic_if_not(0);
             }
+
+            /* Erase the matched entry from the map and the filter */
+            this->drop_waiting(pc);
+            DataStore::remove();
             
             // std::cout << "Completeness = " << parent->allComplete() << std::endl;
             
             bool allComplete = parent->allComplete() == 17;
             
-            if (allComplete) {
+            if (allComplete and std::find(completedParents.begin(), 
+                                          completedParents.end(), 
+                                          parent) == completedParents.end()) {
+                /* Hand a reference to the caller */
+                this->parentPool.ref(parent);
                 completedParents.push_back(parent);
-            }       
-            iter++;
-        }   
-    }
+            }
 
-    /* Remove completed entries from the pending table */
-    while (not completedPendingTableEntries.empty()) {
-        DataStore::remove();
-        
-        auto waitingEntriesIn = waitingEntries.begin() 
-                              + completedPendingTableEntries.back();
-        waitingEntries.erase(waitingEntriesIn);
-        completedPendingTableEntries.pop_back();
+            /* Release the reference held by the waiting entry */
+            this->parentPool.unref(parent);
+        } else {
+            waitingEntries[keep++] = waitingEntry;
+        }
     }
+
+    /* Remove completed and stale entries from the pending table */
+    waitingEntries.resize(keep);
     return completedParents;
 }
 
@@ -241,7 +342,7 @@ PendingTable::get(T key) {
 bool 
 PendingTable::remove_elem(T key) {
     DataStore<U>::remove();
-    this->pendingTable.erase(key);
+    this->evict_pc(key);
     return true;
 }
 
@@ -253,6 +354,9 @@ PendingTable::get_completed_parent(PC_t pc) {
     PendingTableEntryParent *result = nullptr;
     if (pendingTableHasPC) {
         for (auto entry : pendingTable[pc]) {
+            if (not this->parentPool.is_current(entry.get_parent(), entry.get_parent_gen())) {
+                continue;
+            }
             uint64_t completeness = entry.get_parent()->allComplete();
             if (completeness == 17) {
                 result = entry.get_parent(); //this->pendingTable[pc].front().get_parent();
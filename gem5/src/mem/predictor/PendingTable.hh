@@ -12,6 +12,7 @@
 #include "mem/predictor/CacheLine.hh"
 #include "mem/predictor/ChunkInfo.hh"
 #include "mem/predictor/FixedSizeQueue.hh"
+#include "mem/predictor/ObjectPool.hh"
 #include "mem/predictor/SharedArea.hh"
 #include "mem/predictor/WriteHistoryBuffer.hh"
 
@@ -119,6 +120,11 @@ private:
      */
     int parentIndex = -1;
     bool hasParentIndex = false;
+    /**
+     * Generation of the parent's pool slot when this chunk was inserted, 
+     * the chunk is stale if the parent was evicted since.
+     */
+    uint32_t parentGen = 0;
 
 public:
     PendTableChunkInfo() : parent(nullptr), parentIndex(-1) {}
@@ -152,6 +158,14 @@ public:
         return this->hasParentIndex;
     }
 
+    uint32_t get_parent_gen() const {
+        return this->parentGen;
+    }
+
+    void set_parent_gen(uint32_t parentGen) {
+        this->parentGen = parentGen;
+    }
+
     virtual void clear() override {
         ChunkInfo::clear();
         this->parent = nullptr;
@@ -166,6 +180,12 @@ using U = PendTableChunkInfo;
 /**
  * Holds all the non-volatile writes that still haven't been generated 
  * using information from volatile writes history 
+ *
+ * Parents are taken from a fixed size pool and reference counted, every chunk
+ * waiting in the table holds a reference to its parent. A parent is returned
+ * to the pool when its last chunk leaves the table and nobody else holds it.
+ * If the pool runs out, the oldest parent is evicted and its waiting chunks
+ * are dropped lazily when their PC is looked up.
 */
 class PendingTable : DataStore<U> {
 private:
@@ -184,12 +204,51 @@ private:
     */
     std::deque<PC_t> insertionOrder;
     size_t MAX_SIZE = 256/2;
-    /* Disables searching whb for marked elements on insertions */
+
+    ObjectPool<PendingTableEntryParent> parentPool;
+    /* Number of chunks waiting across all the PCs, including stale ones */
+    size_t slotCount = 0;
+    size_t slotCapacity;
+
+    Stats::Distribution parentOccupancy;
+    Stats::Distribution slotOccupancy;
+    Stats::Scalar parentAllocations;
+    Stats::Scalar parentEvictions;
+    Stats::Scalar pcEvictions;
+    Stats::Scalar staleSlotsDropped;
+
+    /* Drops all the chunks waiting on pc along with their references */
+    void evict_pc(PC_t pc);
+
+    /* Decrements the count of chunks waiting on pc */
+    void drop_waiting(PC_t pc);
     FixedSizeQueue<WriteHistoryBufferEntry> *whb = nullptr;
 public:
+    /* Disables searching whb for marked elements on insertions */
     bool DISABLE_WHB_SEARCH = false;
 
-    PendingTable(std::string, FixedSizeQueue<WriteHistoryBufferEntry>*);
+    /* Number of parents per PC the table can hold */
+    static const size_t PARENTS_PER_PC = 8;
+
+    /**
+     * @param sizeMultiplier Scales the number of PCs and parents the table 
+     *                       holds
+     */
+    PendingTable(std::string, FixedSizeQueue<WriteHistoryBufferEntry>*,
+                 float sizeMultiplier = 1.0, bool disableWhbSearch = false);
+
+    /**
+     * Allocates a parent holding one reference for the caller, evicts the 
+     * oldest parent if the pool is exhausted. Callers should drop their 
+     * reference with put_parent() before the next allocation.
+     */
+    PendingTableEntryParent *alloc_parent();
+
+    /**
+     * Drops a reference taken by alloc_parent() or returned with a completed 
+     * parent by update_entry_state(), the parent is recycled once unused.
+     */
+    void put_parent(PendingTableEntryParent *parent);
     
     bool add(const U elem) override;
     
@@ -216,6 +275,11 @@ public:
 
     bool has_pc_waiting(PC_t pc) const;
 
+    /**
+     * Updates the chunks waiting on pc with the data of a write.
+     * @return Parents completed by this write, each one is returned once with
+     * a reference owned by the caller
+     */
     std::deque<PendingTableEntryParent*> update_entry_state(PC_t pc, const DataChunk *dataChunks, size_t size);
 
     PendingTableEntryParent* get_completed_parent(PC_t pc);
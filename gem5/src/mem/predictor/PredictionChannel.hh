@@ -0,0 +1,145 @@
+#ifndef SHIFTLAB_PREDICTION_CHANNEL_H__
+#define SHIFTLAB_PREDICTION_CHANNEL_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "base/types.hh"
+#include "mem/predictor/CompletedWriteEntry.hh"
+#include "mem/predictor/Declarations.hh"
+#include "mem/predictor/SpscRing.hh"
+
+/* Predicted write on its way from a frontend to the backend */
+struct PredictionMessage {
+    /* Tick the backend sees the prediction */
+    Tick ready = 0;
+    CompletedWriteEntry entry;
+};
+
+/* Verification result on its way from the backend to a frontend */
+struct FeedbackMessage {
+    enum class Kind : uint8_t {
+        /* A prediction of hash was verified against a PM write */
+        CORRECT_PREDICTION,
+        /* Data of a prediction of hash matched, raises the path confidence */
+        PATH_CONFIDENCE,
+        /* New confidence of the PC that generated a data chunk */
+        PC_CONFIDENCE,
+        /* New state of the constant tracker for a chunk of hash */
+        CONST_CHUNK,
+        /* BMO latency of a CLWB to paddr whose response was sent */
+        CLWB_LATENCY
+    };
+
+    /* Tick the frontend sees the feedback */
+    Tick ready = 0;
+    Kind kind = Kind::CORRECT_PREDICTION;
+
+    hash_t hash = 0;
+    bool dataPredicted = false;
+
+    PC_t pc = 0;
+    uint32_t confidence = 0;
+
+    size_t offset = 0;
+    size_t timesFound = 0;
+    DataChunk lastData = 0;
+
+    Addr paddr = 0;
+    Tick latency = 0;
+};
+
+/**
+ * Connects one frontend to the backend with a bounded ring in each
+ * direction. Messages are stamped with the tick they are visible at the
+ * other end and are only received once that tick is reached, which models
+ * the latency of the link. The ready ticks of a direction never decrease
+ * as its latency is fixed. The frontend is the only producer of
+ * predictions and the only consumer of feedback, the backend the opposite,
+ * so the two sides can run on different event queues. A producer only
+ * pushes, the consumer looks at its ring to schedule its own drain.
+ */
+class PredictionChannel {
+private:
+    const int id;
+    const Tick predictionLatency;
+    const Tick feedbackLatency;
+
+    SpscRing<PredictionMessage> predictions;
+    SpscRing<FeedbackMessage> feedback;
+
+    /* Receives every message visible at now, in send order */
+    template <class Msg, class Fn>
+    static size_t receive(SpscRing<Msg> &ring, Tick now, Fn fn) {
+        size_t count = 0;
+        for (Msg *msg = ring.front(); msg and msg->ready <= now;
+                msg = ring.front()) {
+            fn(*msg);
+            ring.pop();
+            count++;
+        }
+        return count;
+    }
+
+public:
+    PredictionChannel(int id, size_t capacity, Tick predictionLatency,
+                      Tick feedbackLatency)
+        : id(id), predictionLatency(predictionLatency),
+          feedbackLatency(feedbackLatency), predictions(capacity),
+          feedback(capacity) {}
+
+    int get_id() const { return this->id; }
+    Tick get_prediction_latency() const { return this->predictionLatency; }
+    Tick get_feedback_latency() const { return this->feedbackLatency; }
+
+    /**
+     * Frontend side, sends a prediction that reaches the backend after the
+     * prediction latency.
+     * @return false if the channel is full and the prediction is dropped
+     */
+    bool send_prediction(Tick now, const CompletedWriteEntry &entry) {
+        PredictionMessage msg;
+        msg.ready = now + this->predictionLatency;
+        msg.entry = entry;
+        return this->predictions.push(std::move(msg));
+    }
+
+    /* Frontend side, calls fn(FeedbackMessage&) for the feedback due */
+    template <class Fn>
+    size_t receive_feedback(Tick now, Fn fn) {
+        return receive(this->feedback, now, fn);
+    }
+
+    /**
+     * Backend side, sends feedback that reaches the frontend after the
+     * feedback latency. The ready tick of msg is overwritten.
+     * @return false if the channel is full and the feedback is dropped
+     */
+    bool send_feedback(Tick now, FeedbackMessage msg) {
+        msg.ready = now + this->feedbackLatency;
+        return this->feedback.push(std::move(msg));
+    }
+
+    /* Backend side, calls fn(PredictionMessage&) for the predictions due */
+    template <class Fn>
+    size_t receive_predictions(Tick now, Fn fn) {
+        return receive(this->predictions, now, fn);
+    }
+
+    /* Backend side, tick the oldest prediction is visible, MaxTick if none */
+    Tick next_prediction_tick() {
+        PredictionMessage *msg = this->predictions.front();
+        return msg ? msg->ready : MaxTick;
+    }
+
+    /* Frontend side, tick the oldest feedback is visible, MaxTick if none */
+    Tick next_feedback_tick() {
+        FeedbackMessage *msg = this->feedback.front();
+        return msg ? msg->ready : MaxTick;
+    }
+
+    size_t pending_predictions() const { return this->predictions.size(); }
+    size_t pending_feedback() const { return this->feedback.size(); }
+};
+
+#endif // SHIFTLAB_PREDICTION_CHANNEL_H__
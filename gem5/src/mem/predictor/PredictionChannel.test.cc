@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/predictor/PredictionChannel.hh"
+
+namespace {
+
+CompletedWriteEntry
+make_entry(Addr_t addr, hash_t hash) {
+    CacheLine line;
+    line.set_addr(addr);
+    return CompletedWriteEntry(addr, line, hash);
+}
+
+} // anonymous namespace
+
+TEST(PredictionChannelTest, PredictionsArriveAfterLatency)
+{
+    PredictionChannel channel(0, 8, 100, 0);
+    EXPECT_TRUE(channel.send_prediction(1000, make_entry(0x1000, 1)));
+    EXPECT_TRUE(channel.send_prediction(1050, make_entry(0x2000, 2)));
+
+    std::vector<hash_t> received;
+    auto collect = [&received](PredictionMessage &msg) {
+        received.push_back(msg.entry.get_generator_hash());
+    };
+
+    EXPECT_EQ(0u, channel.receive_predictions(1099, collect));
+    EXPECT_EQ(1u, channel.receive_predictions(1100, collect));
+    EXPECT_EQ(1u, channel.pending_predictions());
+    EXPECT_EQ(1u, channel.receive_predictions(5000, collect));
+    EXPECT_EQ((std::vector<hash_t>{1, 2}), received);
+}
+
+TEST(PredictionChannelTest, FeedbackArrivesAfterLatency)
+{
+    PredictionChannel channel(3, 8, 0, 20);
+    EXPECT_EQ(3, channel.get_id());
+
+    FeedbackMessage msg;
+    msg.kind = FeedbackMessage::Kind::PC_CONFIDENCE;
+    msg.pc = 0x400000;
+    msg.confidence = 4;
+    msg.ready = 0;
+    EXPECT_TRUE(channel.send_feedback(500, msg));
+
+    size_t seen = 0;
+    auto check = [&seen](FeedbackMessage &fb) {
+        EXPECT_EQ(FeedbackMessage::Kind::PC_CONFIDENCE, fb.kind);
+        EXPECT_EQ(0x400000u, fb.pc);
+        EXPECT_EQ(520u, fb.ready);
+        seen++;
+    };
+    EXPECT_EQ(0u, channel.receive_feedback(519, check));
+    EXPECT_EQ(1u, channel.receive_feedback(520, check));
+    EXPECT_EQ(1u, seen);
+}
+
+TEST(PredictionChannelTest, DropsWhenFull)
+{
+    PredictionChannel channel(0, 2, 0, 0);
+    EXPECT_TRUE(channel.send_prediction(0, make_entry(0x1000, 1)));
+    EXPECT_TRUE(channel.send_prediction(0, make_entry(0x1040, 2)));
+    EXPECT_FALSE(channel.send_prediction(0, make_entry(0x1080, 3)));
+    EXPECT_EQ(2u, channel.pending_predictions());
+}
+
+TEST(PredictionChannelTest, NextReadyTick)
+{
+    PredictionChannel channel(0, 8, 100, 30);
+    EXPECT_EQ(MaxTick, channel.next_prediction_tick());
+    EXPECT_EQ(MaxTick, channel.next_feedback_tick());
+
+    channel.send_prediction(1000, make_entry(0x1000, 1));
+    channel.send_prediction(1200, make_entry(0x2000, 2));
+    EXPECT_EQ(1100u, channel.next_prediction_tick());
+
+    auto ignore = [](PredictionMessage &) {};
+    channel.receive_predictions(1100, ignore);
+    EXPECT_EQ(1300u, channel.next_prediction_tick());
+    channel.receive_predictions(1300, ignore);
+    EXPECT_EQ(MaxTick, channel.next_prediction_tick());
+
+    FeedbackMessage msg;
+    msg.kind = FeedbackMessage::Kind::CLWB_LATENCY;
+    msg.paddr = 0x200000040;
+    msg.latency = 50000;
+    channel.send_feedback(400, msg);
+    EXPECT_EQ(430u, channel.next_feedback_tick());
+
+    size_t seen = 0;
+    channel.receive_feedback(430, [&seen](FeedbackMessage &fb) {
+        EXPECT_EQ(0x200000040u, fb.paddr);
+        EXPECT_EQ(50000u, fb.latency);
+        seen++;
+    });
+    EXPECT_EQ(1u, seen);
+    EXPECT_EQ(MaxTick, channel.next_feedback_tick());
+}
@@ -1,13 +1,13 @@
 #include "base/trace.hh"
 #include "debug/IHB.hh"
 #include "debug/PCFilter.hh"
+#include "debug/PredictorConfidence.hh"
 #include "debug/PredictorTable.hh"
 #include "mem/predictor/Constants.hh"
 #include "mem/predictor/Declarations.hh"
 #include "mem/predictor/LastFoundKeyEntry.hh"
 #include "mem/predictor/PredictorTable.hh"
 #include "mem/predictor/SharedArea.hh"
-#include "mem/predictor_backend.hh"
 
 #define ALL_SUYASH__
 #include "helper_suyash.h"
@@ -33,6 +33,107 @@ PredictorTable::getEvictionIndex() const {
     return result;
 }
 
+uint16_t
+PredictorTable::get_path_confidence(hash_t hash) const {
+    auto conf = this->pathConfidence.find(hash);
+    return conf == this->pathConfidence.end() ? PRED_CONFIDENCE_MAX-1
+                                              : conf->second;
+}
+
+bool
+PredictorTable::is_stale(hash_t hash, const PredictorTableEntry &entry) {
+    return entry.get_age(currentOrder) > STALE_ENTRY_AGE_THRESHOLD
+            and get_path_confidence(hash) < PRED_CONFIDENCE_MAX;
+}
+
+PredictorTableEntry *
+PredictorTable::find_entry(hash_t hash) {
+    if (not this->setAssoc) {
+        auto entry = this->predictorTable.find(hash);
+        return entry == this->predictorTable.end() ? nullptr : &entry->second;
+    }
+
+    SetAssocStore::Way *way = this->setAssocTable.find_way(hash);
+    if (way == nullptr) {
+        return nullptr;
+    }
+
+    /* Stale entries are dropped when their way is accessed instead of 
+       scanning the whole table */
+    if (this->is_stale(way->key, way->value)) {
+        this->setAssocTable.invalidate(way);
+        staleEntryDeletionCounter++;
+        return nullptr;
+    }
+
+    if (way->key != hash) {
+        partialTagAliases++;
+    }
+    return &way->value;
+}
+
+PredictorTable::SetAssocStore::Way *
+PredictorTable::pick_victim(SetAssocStore::Way *begin, 
+                            SetAssocStore::Way *end) const {
+    /* Same policy as getEvictionIndex(), restricted to the set */
+    SetAssocStore::Way *victim = begin;
+    for (SetAssocStore::Way *way = begin; way != end; way++) {
+        Age_t age = way->value.get_age(this->currentOrder);
+        Age_t victimAge = victim->value.get_age(this->currentOrder);
+        if (not disableConfidence) {
+            /* Lowest address confidence, oldest on a tie */
+            auto conf = way->value.addrConf();
+            auto victimConf = victim->value.addrConf();
+            if (conf < victimConf or (conf == victimConf and age > victimAge)) {
+                victim = way;
+            }
+        } else if (age > victimAge) {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+void
+PredictorTable::insert_entry(hash_t hash, const PredictorTableEntry &elem) {
+    if (not this->setAssoc) {
+        this->predictorTable.insert(std::make_pair(hash, elem));
+        return;
+    }
+
+    if (this->find_entry(hash) != nullptr) {
+        return;
+    }
+
+    /* Free the stale ways of the set before picking a victim */
+    auto setEnd = this->setAssocTable.set_end(hash);
+    for (auto way = this->setAssocTable.set_begin(hash); way != setEnd; way++) {
+        if (way->valid and this->is_stale(way->key, way->value)) {
+            this->setAssocTable.invalidate(way);
+            staleEntryDeletionCounter++;
+        }
+    }
+
+    bool evicted = false;
+    this->setAssocTable.insert(hash, elem, 
+        [this] (SetAssocStore::Way *begin, SetAssocStore::Way *end) {
+            return this->pick_victim(begin, end);
+        }, evicted);
+
+    if (evicted) {
+        this->capacityEvictions++;
+    }
+}
+
+void
+PredictorTable::erase_entry(hash_t hash) {
+    if (this->setAssoc) {
+        this->setAssocTable.erase(hash);
+    } else {
+        this->predictorTable.erase(hash);
+    }
+}
+
 bool 
 PredictorTable::add(PredictorTableEntry elem) {
     panic_if_not(elem.has_orig_cacheline());
@@ -46,9 +147,9 @@ PredictorTable::add(PredictorTableEntry elem) {
     /* Increment the current order */
     this->currentOrder++;
 
-    if (this->predictorTable.find(elem.get_hash()) != this->predictorTable.end()) {
-        PredictorTableEntry &potentialReplacement 
-                = this->predictorTable.at(elem.get_hash());
+    PredictorTableEntry *existingEntry = this->find_entry(elem.get_hash());
+    if (existingEntry != nullptr) {
+        PredictorTableEntry &potentialReplacement = *existingEntry;
         bool shouldReplace = false;
 
         Confidence addrConf = potentialReplacement.addrConf;
@@ -63,7 +164,7 @@ PredictorTable::add(PredictorTableEntry elem) {
         */
         if (shouldReplace) {
             this->entryReplacementCounter++;
-            this->predictorTable.insert(std::make_pair(elem.get_hash(), elem));
+            this->insert_entry(elem.get_hash(), elem);
         } else {
             this->droppedAdditions++;
             potentialReplacement.dataConf.sub(1);
@@ -71,6 +172,9 @@ PredictorTable::add(PredictorTableEntry elem) {
             /* Update the entry to handle constant 0 prediction */
             this->update_entry_for_0_pred(elem);
         }
+    } else if (this->setAssoc) {
+        /* Replacement is handled within the set */
+        this->insert_entry(elem.get_hash(), elem);
     } else {
         /* The table is at capacity */
         if (this->size + 1 > MAX_SIZE) {
@@ -91,25 +195,28 @@ PredictorTable::add(PredictorTableEntry elem) {
 bool 
 PredictorTable::contains(hash_t pc) {
     DataStore<PredictorTableEntry>::contains();
-    return this->predictorTable.find(pc) != this->predictorTable.end();
+    return this->find_entry(pc) != nullptr;
 }
 
 size_t 
 PredictorTable::get_size() {
     DataStore::get_size();
-    return this->predictorTable.size();
+    return this->setAssoc ? this->setAssocTable.size() 
+                          : this->predictorTable.size();
 }
 
 PredictorTableEntry& 
 PredictorTable::get(hash_t pc) {
     DataStore<PredictorTableEntry>::get();
-    return predictorTable.at(pc);
+    PredictorTableEntry *entry = this->find_entry(pc);
+    panic_if(entry == nullptr, "Unable to find any match for hash %p", pc);
+    return *entry;
 }
 
 bool 
 PredictorTable::remove_elem(hash_t pc) {
     DataStore<PredictorTableEntry>::remove();
-    this->predictorTable.erase(pc);
+    this->erase_entry(pc);
     return true;
 } 
 
@@ -143,36 +250,68 @@ rotl (T v, unsigned int b)
 
 hash_t 
 PredictorTable::get_path_hash() const {
-    hash_t result = 0ul;
+    /* Maintained incrementally on every push */
+    return this->pathHistory->get_hash();
+}
 
-    // auto mask_upper_32_bits = [](hash_t hash) { return (hash << 32) >> 32; };
+void
+PredictorTable::select_context(ContextID context) {
+    if (context == this->currentContext) {
+        return;
+    }
+    this->currentContext = context;
 
-    for (int i = 0; i < this->pathHistory->get_size(); i++) {
-        result = result ^ (this->pathHistory->get(i) << i);
+    auto history = this->contextHistories.find(context);
+    if (history == this->contextHistories.end()) {
+        this->add_context_history(context);
+        return;
+    }
+    this->pathHistory = history->second.path.get();
+    this->aliasCheckHistory = history->second.aliasCheck.get();
+}
+
+void
+PredictorTable::add_context_history(ContextID context) {
+    ContextHistory &history = this->contextHistories[context];
+    history.path.reset(new PathHistory(PATH_HISTORY_SIZE,
+                                       this->pathHashKind));
+    if (this->pathHashAliasCheck) {
+        /* Different kind or base than the path hash */
+        history.aliasCheck.reset(new PathHistory(
+                PATH_HISTORY_SIZE, PathHistory::Kind::ROLLING_POLY, 1));
+    }
+    this->pathHistory = history.path.get();
+    this->aliasCheckHistory = history.aliasCheck.get();
+}
+
+void
+PredictorTable::check_path_hash_alias() {
+    hash_t pathHash = this->pathHistory->get_hash();
+    hash_t checkHash = this->aliasCheckHistory->get_hash();
+
+    this->pathHashAliasChecks++;
+    auto sample = this->aliasCheckSamples.find(pathHash);
+    if (sample != this->aliasCheckSamples.end()) {
+        if (sample->second != checkHash) {
+            this->pathHashAliases++;
+        }
+    } else if (this->aliasCheckSamples.size() < ALIAS_CHECK_MAX_SAMPLES) {
+        this->aliasCheckSamples.emplace(pathHash, checkHash);
     }
-    return result;
 }
 
 PredictorTableEntry
 PredictorTable::get_with_hash(hash_t hash) {
     // std::cout << " Trying to get hash " << std::endl;
-    PredictorTableEntry result;
-    bool found = false;
-    for (auto entry :  this->predictorTable) {
-        if (entry.second.get_hash() == hash) {
-            result = entry.second;
-            found = true;
-        }
-    }
-    panic_if(not found, "Unable to find any match for hash %p", hash);
-    return result;
+    /* Entries are keyed by their hash */
+    PredictorTableEntry *entry = this->find_entry(hash);
+    panic_if(entry == nullptr, "Unable to find any match for hash %p", hash);
+    return *entry;
 }
 
 
 bool 
 PredictorTable::update_ihb(PacketPtr pkt) {
-    /* Check the shared area for updates from the backend */
-    this->check_shared_area();
     // std::cout << "Updating ihb" << std::endl;
 
     panic_if(not pkt->isWrite(), "");
@@ -182,67 +321,70 @@ PredictorTable::update_ihb(PacketPtr pkt) {
     
 
     /* If the incoming packet is smaller than 4 bytes, pad it */
-    DataChunk *paddedData = new DataChunk;
+    DataChunk paddedData = 0;
     bool useCopiedPtr = false;
     if (pkt->getSize() < 4) {
         useCopiedPtr = true;
         switch (pkt->getSize()) {
         case 1:
-            *paddedData = (DataChunk)(*pkt->getPtr<uint8_t>());
+            paddedData = (DataChunk)(*pkt->getPtr<uint8_t>());
             break;
         case 2:
-            *paddedData = (DataChunk)(*pkt->getPtr<uint16_t>());
+            paddedData = (DataChunk)(*pkt->getPtr<uint16_t>());
             break;
         }
     }
 
-    auto ptrToConstr = useCopiedPtr ? paddedData : pkt->getPtr<DataChunk>();
+    auto ptrToConstr = useCopiedPtr ? &paddedData : pkt->getPtr<DataChunk>();
 
     /* Padded data is always of 4 bytes (== 1 chunk in current implementation) */
     auto chunkCount = useCopiedPtr 
                         ? 4/sizeof(DataChunk) 
                         : pkt->getSize()/sizeof(DataChunk);
 
-    this->pathHistory->push_back(pc);
+    this->pathHistory->push(pc);
+    if (this->aliasCheckHistory) {
+        this->aliasCheckHistory->push(pc);
+        this->check_path_hash_alias();
+    }
     // std::cout << "PC added, new hash = " << this->get_path_hash() << std::endl;
     this->lastFoundHashes.clear();
 
+    hash_t pathHash = this->get_path_hash();
+
     /* Overwrite everything for the path based */
-    if (this->has_hash(this->get_path_hash())) {
-        // std::cout << GRN << "Found hash " << this->get_path_hash() << RST << std::endl;
+    if (this->has_hash(pathHash)) {
+        // std::cout << GRN << "Found hash " << pathHash << RST << std::endl;
         result = true;
-        this->lastFoundHashes.push_back(this->get_path_hash());
+        this->lastFoundHashes.push_back(pathHash);
     } else {
-        // std::cout << RED << "Did not find hash " << this->get_path_hash() << RST << std::endl;
+        // std::cout << RED << "Did not find hash " << pathHash << RST << std::endl;
     }
 
     return result;
 }
 
 void 
-PredictorTable::check_shared_area() {
-    for (auto correctPrediction : SharedArea::correctPredictions) {
-        int correctAddrPred = correctPrediction.second.first;
-        int correctDataPred = correctPrediction.second.second;
-
-        for (int i = 0; i < correctAddrPred; i++) {
-            bool wasDataPredicted = (correctDataPred - i) >= 0;
-            this->notify_correct_prediction(
-                correctPrediction.first, true, wasDataPredicted
-            );
-            
-            if (wasDataPredicted) {
-                this->correctPredictionCounter++;
-            }
-        }
+PredictorTable::notify_backend_prediction(hash_t hash, bool dataPredicted) {
+    this->notify_correct_prediction(hash, true, dataPredicted);
+    if (dataPredicted) {
+        this->correctPredictionCounter++;
     }
-    SharedArea::correctPredictions.clear();
+}
+
+void
+PredictorTable::raise_path_confidence(hash_t hash) {
+    uint16_t conf = get_path_confidence(hash);
+    this->pathConfidence[hash] = conf == PRED_CONFIDENCE_MAX ? conf : conf+1;
+    DPRINTFR(PredictorConfidence, "Path confidence of %p raised to %d\n",
+            (void*)hash, this->pathConfidence[hash]);
 }
 
 void 
 PredictorTable::tick() {
     /* cleanup if the clock overflowed */
-    if ((this->clock % CLOCK_PERIOD) == 0) {
+    /* The set associative table drops stale entries as they are accessed */
+    if ((this->clock % CLOCK_PERIOD) == 0 and not this->setAssoc) {
         // this->cleanup_low_conf_entries();
         this->cleanup_stale_entries();
         predictorTableTicks++;
@@ -257,7 +399,6 @@ PredictorTable::cleanup_stale_entries() {
     /* Find items that are stale */
     // std::cout << __FUNCTION__ << ": currentorder " << std::dec << currentOrder << std::endl;
     for (auto pt_iter : *this) {
-        PredictorBackend::initConf(pt_iter.first);
         // std::cout << "Current order " << currentOrder 
         //           << " age = " << pt_iter.second.get_age(currentOrder) 
         //           << " conf = " << PredictorBackend::confidenceTable[pt_iter.first]
@@ -269,7 +410,7 @@ PredictorTable::cleanup_stale_entries() {
         //           << " PredictorBackend::confidenceTable[pt_iter.first] < PRED_CONFIDENCE_MAX = " << (PredictorBackend::confidenceTable[pt_iter.first] < PRED_CONFIDENCE_MAX)
         //           << std::endl;
         if ((pt_iter.second.get_age(currentOrder) > STALE_ENTRY_AGE_THRESHOLD
-                and PredictorBackend::confidenceTable[pt_iter.first] < PRED_CONFIDENCE_MAX)) {
+                and get_path_confidence(pt_iter.first) < PRED_CONFIDENCE_MAX)) {
             // std::cout << "deleting entry " << (void*)pt_iter.first << std::endl;
             deletionQ.push_back(pt_iter.first);
             ages.push_back(pt_iter.second.get_age(currentOrder));
@@ -303,35 +444,9 @@ PredictorTable::cleanup_stale_entries() {
 //     }
 // }
 
-void 
-PredictorTable::dump() {
-    return;
-    // std::string dump_path = "/ramdisk/predictor_table_dump" 
-    //                              + std::to_string(dumpId);
-    // std::ofstream dumpFile;
-    // dumpFile.open(dump_path);
-    // for (auto predictorEntry : *this) {
-    //     dumpFile 
-    //         << "<" << print_ptr(16) << predictorEntry.first.first
-    //         << ", "  << print_ptr(16) << predictorEntry.first.second
-    //         << "> [" << print_ptr(16) 
-    //         << predictorEntry.second.get_addr_chunk().get_generating_pc()
-    //         << "]";
-    //     dumpFile << predictorEntry.second << std::endl;
-    // }
-    // dumpId++;
-}
-
 bool 
-PredictorTable::has_hash(hash_t hash) const {
-    bool result = false;
+PredictorTable::has_hash(hash_t hash) {
     // std::cout << "Predictor table size = " << this->predictorTable.size() << std::endl;
-    for (auto entry : this->predictorTable) {
-        // std::cout << BLU << "hash: " << entry.second.get_hash() << std::endl;
-        if (entry.second.get_hash() == hash) {
-            result =  true;
-            break;
-        }
-    }
-    return result;
+    /* Entries are keyed by their hash */
+    return this->find_entry(hash) != nullptr;
 }
@@ -8,6 +8,8 @@
 #include "mem/predictor/Declarations.hh"
 #include "mem/predictor/FixedSizeQueue.hh"
 #include "mem/predictor/LastFoundKeyEntry.hh"
+#include "mem/predictor/PathHistory.hh"
+#include "mem/predictor/SetAssocTable.hh"
 #include "mem/predictor/SharedArea.hh"
 #include "mem/predictor/SimpleFixedSizeQueue.hh"
 
@@ -20,6 +22,7 @@
 #include <string>
 #include <cstring>
 #include <deque>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -47,12 +50,6 @@ private:
     Age_t insertionOrder = 0;
     bool hasAge = false;
 
-    const std::string CORRECT_ADDR_PREDICTION_AGE_REWARD_STR = "CORRECT_ADDR_PREDICTION_AGE_REWARD";
-    const std::string CORRECT_DATA_PREDICTION_AGE_REWARD_STR = "CORRECT_DATA_PREDICTION_AGE_REWARD";
-
-    Age_t CORRECT_ADDR_PREDICTION_AGE_REWARD;
-    Age_t CORRECT_DATA_PREDICTION_AGE_REWARD;
-
     uint32_t CONF_MAX = 7;
     uint32_t CONF_MIN = 0;
     uint32_t CONF_INIT = 6;
@@ -98,10 +95,7 @@ public:
             this->dataChunks[i] = dataChunks[i];
         }
     }
-    PredictorTableEntry() {
-        CORRECT_ADDR_PREDICTION_AGE_REWARD = std::stoul(get_env_str(CORRECT_ADDR_PREDICTION_AGE_REWARD_STR, "20"));
-        CORRECT_DATA_PREDICTION_AGE_REWARD = std::stoul(get_env_str(CORRECT_DATA_PREDICTION_AGE_REWARD_STR, "80"));
-    }
+    PredictorTableEntry() {}
 
     // PredictorTableEntry(const PredictorTableEntry &pte) {
     //     this->destAddr_diag = pte.destAddr_diag;
@@ -178,14 +172,17 @@ public:
 
     /** 
      * Decrease the age of this entry since it was correctly predicted 
+     * @param addrReward Age removed for a correct address prediction
+     * @param dataReward Age removed for a correct data prediction
     */ 
-    void notify_correct_prediction(bool wasAddrPredicted, bool wasDataPredicted) { 
+    void notify_correct_prediction(bool wasAddrPredicted, bool wasDataPredicted,
+                                   Age_t addrReward, Age_t dataReward) { 
         Age_t save = this->insertionOrder;
         if (wasAddrPredicted) {
-            this->insertionOrder -= CORRECT_ADDR_PREDICTION_AGE_REWARD; 
+            this->insertionOrder -= addrReward; 
         }
         if (wasDataPredicted) {
-            this->insertionOrder -= CORRECT_DATA_PREDICTION_AGE_REWARD; 
+            this->insertionOrder -= dataReward; 
         }
         // std::cout << CYN << "Changed Age from " << save << " to " << this->insertionOrder << RST << std::endl;
     }
@@ -220,7 +217,7 @@ public:
         CacheLine result;
         for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
             ChunkInfo srcDataChunk = this->dataChunks[i];
-            ChunkInfo &tgtDataChunk = result.get_datachunks()[i];
+            CacheLine::ChunkRef tgtDataChunk = result.get_datachunks()[i];
             if (srcDataChunk.is_valid()) {
                 tgtDataChunk.set_chunk_type(ChunkInfo::ChunkType::DATA);
                 tgtDataChunk.set_data(srcDataChunk.get_generating_pc());
@@ -352,6 +349,34 @@ public:
 
 };
 
+/** Organization of the predictor table and its path hash */
+struct PredictorTableConfig {
+    PathHistory::Kind pathHashKind = PathHistory::Kind::SHIFT_XOR;
+    bool pathHashAliasCheck = false;
+
+    /**
+     * The ideal table is an unbounded map with a full scan for stale
+     * entries, the set associative table only touches one set per access.
+     */
+    bool setAssoc = false;
+    size_t sets = 8;
+    size_t ways = 4;
+    /* Low bits of the path hash skipped before the set index */
+    unsigned indexShift = 0;
+    /* Bits of the tag stored per way, 0 compares the complete hash */
+    unsigned tagBits = 0;
+
+    /* Scales the ideal table size, used for sensitivity analysis */
+    float sizeMultiplier = 1.0;
+    size_t pathHistorySize = 32;
+    Age_t staleEntryAgeThreshold = 200;
+    size_t ihbPatternMatchThresh = 10;
+    size_t ihbPatternMinCount = 50;
+    Age_t correctAddrPredictionAgeReward = 20;
+    Age_t correctDataPredictionAgeReward = 80;
+    bool const0PredEnabled = false;
+    bool disableConfidence = false;
+};
 
 class PredictorTable : DataStore<PredictorTableEntry> {
 private:
@@ -360,11 +385,42 @@ private:
     size_t MAX_SIZE = 32;
     
     std::unordered_map<hash_t, PredictorTableEntry> predictorTable;
+
+    using SetAssocStore = SetAssocTable<PredictorTableEntry>;
+    bool setAssoc = false;
+    /* Used instead of predictorTable when setAssoc is set */
+    SetAssocStore setAssocTable;
+
+    /**
+     * Entry for hash, in the set associative table stale entries in the 
+     * way are dropped on lookup.
+     * @return nullptr if not found
+     */
+    PredictorTableEntry *find_entry(hash_t hash);
+
+    /* Inserts an entry, existing entries for the hash are left untouched */
+    void insert_entry(hash_t hash, const PredictorTableEntry &elem);
+
+    void erase_entry(hash_t hash);
+
+    /**
+     * Confidence of each path hash, raised when the backend verifies the
+     * data of one of its predictions. Unknown paths start just below
+     * PRED_CONFIDENCE_MAX.
+     */
+    std::unordered_map<hash_t, uint16_t> pathConfidence;
+
+    uint16_t get_path_confidence(hash_t hash) const;
+
+    /* Entries old enough to be removed */
+    bool is_stale(hash_t hash, const PredictorTableEntry &entry);
+
+    /* Victim in a full set of the set associative table */
+    SetAssocStore::Way *pick_victim(SetAssocStore::Way *begin, 
+                                    SetAssocStore::Way *end) const;
     std::unordered_map<PC_t, size_t> pcFilter;  
     std::unordered_map<PC_t, std::deque<PCSig>> pcFilterMap;
 
-    size_t dumpId = 0;
-
     /* Holds the keys that was last found using IHB */
     std::vector<LastFoundKeyEntry> lastFoundKeys;
     std::vector<hash_t> lastFoundHashes;
@@ -381,12 +437,12 @@ private:
      * be considered to be an stale entry. Entry marked as stale can be 
      * removed at any point thereafter.
      */
-    std::string STALE_ENTRY_AGE_THRESHOLD_STR = "STALE_ENTRY_AGE_THRESHOLD";
-    std::string IHB_PATTERN_MATCH_THRESH_STR = "IHB_PATTERN_MATCH_THRESH";
-    std::string IHB_PATTERN_MIN_COUNT_STR = "IHB_PATTERN_MIN_COUNT";
-    
     Age_t STALE_ENTRY_AGE_THRESHOLD = 200;
 
+    /* Age removed from an entry on a correct address and data prediction */
+    Age_t CORRECT_ADDR_PREDICTION_AGE_REWARD = 20;
+    Age_t CORRECT_DATA_PREDICTION_AGE_REWARD = 80;
+
     /**
      * Number of insertions the predictor table will wait before triggering
      * the next scheduled events.
@@ -426,6 +482,9 @@ protected:
     Stats::Distribution pcFilterSize;
     Stats::Scalar sizeStat;
     Stats::Distribution ihbPatternMatchId;
+    Stats::Scalar pathHashAliasChecks;
+    Stats::Scalar pathHashAliases;
+    Stats::Scalar partialTagAliases;
     std::vector<size_t> ihbPatternMatchIdVec;
 
     void cleanup_low_conf_entries();
@@ -443,19 +502,55 @@ protected:
      */
     void tick();
 
-    void check_shared_area();
 
     bool const0PredEnabled = false;
 
-    const std::string ENABLE_CONST_0_PREDICTION_STR = "ENABLE_CONST_0_PREDICTION";
-    const std::string PATH_HISTORY_SIZE_STR = "PATH_HISTORY_SIZE";
     size_t PATH_HISTORY_SIZE = 4;
+
+    /**
+     * Aliasing check for the path hash, maps every sampled path hash to an
+     * independent signature of the same path. A hash seen again with a
+     * different signature was produced by a different path.
+     */
+    static const size_t ALIAS_CHECK_MAX_SAMPLES = 1 << 16;
+    PathHistory *aliasCheckHistory = nullptr;
+    std::unordered_map<hash_t, hash_t> aliasCheckSamples;
+
+    void check_path_hash_alias();
+
+    /* Path histories of a hardware thread context */
+    struct ContextHistory {
+        std::unique_ptr<PathHistory> path;
+        std::unique_ptr<PathHistory> aliasCheck;
+    };
+    /**
+     * Histories of every context seen, pathHistory and aliasCheckHistory
+     * point to the ones of the selected context
+     */
+    std::unordered_map<ContextID, ContextHistory> contextHistories;
+    ContextID currentContext = 0;
+    PathHistory::Kind pathHashKind = PathHistory::Kind::SHIFT_XOR;
+    bool pathHashAliasCheck = false;
+
+    /* Creates the empty histories of context and selects them */
+    void add_context_history(ContextID context);
 public:
-    SimpleFixedSizeQueue<PC_t> *pathHistory;
+    PathHistory *pathHistory;
+
+    /**
+     * Switches the path history to the one of context, the writes of
+     * different hardware threads do not interleave in one path.
+     */
+    void select_context(ContextID context);
 
     PCSig lastCompleteEntry;
-    PredictorTable(std::string name) 
-            : DataStore<PredictorTableEntry>(name) {
+    PredictorTable(std::string name, 
+                   const PredictorTableConfig &config = PredictorTableConfig()) 
+            : DataStore<PredictorTableEntry>(name), 
+              setAssoc(config.setAssoc),
+              setAssocTable(config.setAssoc ? config.sets : 1, 
+                            config.setAssoc ? config.ways : 1, 
+                            config.indexShift, config.tagBits) {
                 indexHistoryBuffer = new SimpleFixedSizeQueue<IHB_Entry>(IHB_SIZE);
         lowConfidenceEvictionCounter
             .name(name + ".lowConfidenceEvictionCounter")
@@ -515,22 +610,43 @@ public:
             .name(name + ".ihbPatternMatchId")
             .init(0, 10, 1)
             .desc("ihbPatternMatchId");
-
-        PATH_HISTORY_SIZE = std::stoul(get_env_str(PATH_HISTORY_SIZE_STR, "32"));
-        pathHistory = new SimpleFixedSizeQueue<PC_t>(PATH_HISTORY_SIZE);
-
-        STALE_ENTRY_AGE_THRESHOLD = std::stoul(get_env_str(STALE_ENTRY_AGE_THRESHOLD_STR, "200"));
-        IHB_PATTERN_MATCH_THRESH = std::stoul(get_env_str(IHB_PATTERN_MATCH_THRESH_STR, "10"));
-        IHB_PATTERN_MIN_COUNT = std::stoul(get_env_str(IHB_PATTERN_MIN_COUNT_STR, "50"));
-
-        const0PredEnabled = get_env_val(ENABLE_CONST_0_PREDICTION_STR);
-        disableConfidence = get_env_val("DISABLE_CONFIDENCE");
+        pathHashAliasChecks
+            .name(name + ".pathHashAliasChecks")
+            .desc("Path hashes checked for aliasing");
+        pathHashAliases
+            .name(name + ".pathHashAliases")
+            .desc("Path hashes that were produced by more than one path");
+        partialTagAliases
+            .name(name + ".partialTagAliases")
+            .desc("Set associative lookups that hit an entry of a different "
+                  "path hash with the same tag");
+
+        PATH_HISTORY_SIZE = config.pathHistorySize;
+        pathHashKind = config.pathHashKind;
+        pathHashAliasCheck = config.pathHashAliasCheck;
+        add_context_history(currentContext);
+        std::cout << "Using path hash = " 
+                  << PathHistory::kind_name(config.pathHashKind) << std::endl;
+
+        STALE_ENTRY_AGE_THRESHOLD = config.staleEntryAgeThreshold;
+        IHB_PATTERN_MATCH_THRESH = config.ihbPatternMatchThresh;
+        IHB_PATTERN_MIN_COUNT = config.ihbPatternMinCount;
+        CORRECT_ADDR_PREDICTION_AGE_REWARD = config.correctAddrPredictionAgeReward;
+        CORRECT_DATA_PREDICTION_AGE_REWARD = config.correctDataPredictionAgeReward;
+
+        const0PredEnabled = config.const0PredEnabled;
+        disableConfidence = config.disableConfidence;
 
         std::cout << "Disable confidence = " << disableConfidence << std::endl;
 
-        SharedArea::init_size_multiplier();
-        std::cout <<  "Using size mult = " << SharedArea::sizeMultiplier << std::endl;
-        this->MAX_SIZE *= SharedArea::sizeMultiplier;
+        std::cout <<  "Using size mult = " << config.sizeMultiplier << std::endl;
+        this->MAX_SIZE *= config.sizeMultiplier;
+        if (this->setAssoc) {
+            this->MAX_SIZE = this->setAssocTable.capacity();
+            std::cout << "Predictor table is " << this->setAssocTable.get_sets() 
+                      << " sets x " << this->setAssocTable.get_ways() 
+                      << " ways" << std::endl;
+        }
         this->sizeStat = this->MAX_SIZE;
         std::cout << RED << "========\n\n\n"    
                   << "Predictor table size = " 
@@ -552,7 +668,7 @@ public:
     bool remove_elem(const PredictorTableEntry entry) override { unimplemented__("") };
     bool remove_elem(hash_t pc);
 
-    /* Returns the XOR'd value of all the PCs in the path history */
+    /* Returns the signature of the PCs in the path history */
     hash_t get_path_hash() const;
 
     PredictorTableEntry& get() override { unimplemented__(""); }
@@ -599,7 +715,17 @@ public:
         return this->predictorTable.end();
     }
 
-    void dump();
+    /* Calls fn(hash, entry) for every entry of the table */
+    template <class Fn>
+    void for_each_entry(Fn fn) {
+        if (this->setAssoc) {
+            this->setAssocTable.for_each(fn);
+        } else {
+            for (auto &entry : this->predictorTable) {
+                fn(entry.first, entry.second);
+            }
+        }
+    }
 
     hash_t getEvictionIndex() const;
     
@@ -608,15 +734,22 @@ public:
      */
     void notify_correct_prediction(hash_t hash, bool addrPrediction, bool dataPrediction) {
         notifications++;
-        if (this->predictorTable.find(hash) != this->predictorTable.end()) {
-            this->predictorTable[hash].notify_confidence(addrPrediction, dataPrediction);
-        }
-
-        if (this->predictorTable.find(hash) != this->predictorTable.end()) { 
-            this->predictorTable[hash].notify_correct_prediction(addrPrediction, dataPrediction); 
+        PredictorTableEntry *entry = this->find_entry(hash);
+        if (entry) {
+            entry->notify_confidence(addrPrediction, dataPrediction);
+            entry->notify_correct_prediction(
+                    addrPrediction, dataPrediction,
+                    CORRECT_ADDR_PREDICTION_AGE_REWARD, 
+                    CORRECT_DATA_PREDICTION_AGE_REWARD); 
         }
     }
 
+    /* Applies a correct prediction of hash reported by the backend */
+    void notify_backend_prediction(hash_t hash, bool dataPredicted);
+
+    /* Raises the confidence of the path hash up to PRED_CONFIDENCE_MAX */
+    void raise_path_confidence(hash_t hash);
+
     void update_entry_for_0_pred(PredictorTableEntry elem) {
         if (const0PredEnabled) {
             update_entry_for_0_pred_handler(elem);
@@ -629,10 +762,11 @@ public:
     void update_entry_for_0_pred_handler(PredictorTableEntry elem) {
         hash_t hash = elem.get_hash();
 
-        panic_if(this->predictorTable.find(hash) == this->predictorTable.end(), 
+        PredictorTableEntry *targetEntryPtr = this->find_entry(hash);
+        panic_if(targetEntryPtr == nullptr, 
                 "%s called with a non existent pc signature", __FUNCTION__);
 
-        auto &targetEntry = this->predictorTable.at(hash);
+        auto &targetEntry = *targetEntryPtr;
         
         auto targetDataChunks = targetEntry.get_datachunks();
         auto sourceDataChunks = elem.get_datachunks();
@@ -692,7 +826,7 @@ public:
         return this->pcFilter.find(pc) != this->pcFilter.end();
     }
 
-    bool has_hash(hash_t hash) const;
+    bool has_hash(hash_t hash);
 };
 
 /* NOTE: Check FixedSizeQueue.cc for instantiation of Class specific versions of FizedSizeQueue<class> */
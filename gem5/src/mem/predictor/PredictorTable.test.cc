@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "mem/packet.hh"
+#include "mem/predictor/PathHistory.hh"
+#include "mem/predictor/PredictorTable.hh"
+#include "mem/request.hh"
+#include "sim/eventq.hh"
+
+/* Requests read curTick(), these are the parts of the simulator the
+   event queue code refers to */
+std::set<std::string> version_tags;
+
+void
+exitSimLoop(const std::string &message, int exit_code, Tick when,
+            Tick repeat, bool serialize)
+{
+}
+
+namespace {
+
+const size_t HISTORY = 4;
+const PathHistory::Kind KIND = PathHistory::Kind::SHIFT_XOR;
+
+PredictorTableConfig
+config() {
+    PredictorTableConfig result;
+    result.pathHistorySize = HISTORY;
+    result.pathHashAliasCheck = true;
+    return result;
+}
+
+/* Sends a PM store of pc through the table, as the frontend does */
+void
+store(PredictorTable &table, PC_t pc) {
+    uint64_t data = pc;
+    RequestPtr req = std::make_shared<Request>(
+            0, 0x200000000 + (pc & 0xfff) * 8, sizeof(data), 0, 0, pc, 0);
+    req->setPaddr(req->getVaddr());
+    Packet pkt(req, MemCmd::WriteReq);
+    pkt.dataStatic(&data);
+    table.update_ihb(&pkt);
+}
+
+} // anonymous namespace
+
+/* Stats are registered once per process, so there is only one table */
+TEST(PredictorTableTest, ContextPathHistories)
+{
+    curEventQueue(getEventQueue(0));
+    PredictorTable table("pt", config());
+    PathHistory thread1(HISTORY, KIND);
+    PathHistory thread2(HISTORY, KIND);
+    PathHistory shared(HISTORY, KIND);
+
+    /* The stores of two hardware threads interleave */
+    for (PC_t i = 0; i < 16; i++) {
+        table.select_context(1);
+        store(table, 0x401000 + i * 4);
+        thread1.push(0x401000 + i * 4);
+        EXPECT_EQ(thread1.get_hash(), table.get_path_hash());
+
+        table.select_context(2);
+        store(table, 0x402000 + (i % 3) * 4);
+        thread2.push(0x402000 + (i % 3) * 4);
+        EXPECT_EQ(thread2.get_hash(), table.get_path_hash());
+    }
+
+    /* Switching back continues the path of the context */
+    table.select_context(1);
+    EXPECT_EQ(thread1.get_hash(), table.get_path_hash());
+    EXPECT_NE(thread1.get_hash(), thread2.get_hash());
+
+    /* An unseen context starts with an empty history */
+    table.select_context(3);
+    EXPECT_EQ(PathHistory(HISTORY, KIND).get_hash(), table.get_path_hash());
+    EXPECT_EQ(0u, table.pathHistory->get_size());
+
+    /* With shared state both threads use one context and one path */
+    for (PC_t i = 0; i < 16; i++) {
+        store(table, 0x401000 + i * 4);
+        store(table, 0x402000 + (i % 3) * 4);
+        shared.push(0x401000 + i * 4);
+        shared.push(0x402000 + (i % 3) * 4);
+    }
+    EXPECT_EQ(shared.get_hash(), table.get_path_hash());
+    EXPECT_NE(thread1.get_hash(), table.get_path_hash());
+}
@@ -0,0 +1,66 @@
+#include "mem/predictor/ResultBuffer.hh"
+
+#include "base/logging.hh"
+
+ResultBuffer::ResultBuffer(size_t capacity) : pool(capacity) {
+    this->lines.reserve(capacity);
+}
+
+void
+ResultBuffer::resize(size_t capacity) {
+    panic_if(not this->empty(), "Resizing a result buffer in use");
+    this->pool = ObjectPool<Node>(capacity);
+    this->lines.clear();
+    this->lines.reserve(capacity);
+}
+
+ResultBuffer::Node *
+ResultBuffer::push_back(Addr_t paddr, const CompletedWriteEntry &entry) {
+    Node *node = this->pool.allocate();
+    panic_if(node == nullptr, "Result buffer is full");
+
+    node->entry = entry;
+    node->paddr = paddr;
+
+    Line &line = this->lines[paddr];
+    node->older = line.newest;
+    if (line.newest) {
+        line.newest->newer = node;
+    } else {
+        line.oldest = node;
+    }
+    line.newest = node;
+    line.size++;
+
+    if (is_free(node->entry)) {
+        this->freeCount++;
+    }
+    return node;
+}
+
+void
+ResultBuffer::erase(Node *node) {
+    auto lineIt = this->lines.find(node->paddr);
+    panic_if(lineIt == this->lines.end(), "Erasing an entry of %p that is "
+             "not in the result buffer", (void*)node->paddr);
+    Line &line = lineIt->second;
+
+    if (node->older) {
+        node->older->newer = node->newer;
+    } else {
+        line.oldest = node->newer;
+    }
+    if (node->newer) {
+        node->newer->older = node->older;
+    } else {
+        line.newest = node->older;
+    }
+    if (--line.size == 0) {
+        this->lines.erase(lineIt);
+    }
+
+    if (is_free(node->entry)) {
+        this->freeCount--;
+    }
+    this->pool.release(node);
+}
@@ -0,0 +1,105 @@
+#ifndef SHIFTLAB_RESULT_BUFFER_H__
+#define SHIFTLAB_RESULT_BUFFER_H__
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "mem/predictor/CompletedWriteEntry.hh"
+#include "mem/predictor/Declarations.hh"
+#include "mem/predictor/ObjectPool.hh"
+
+/**
+ * Predicted writes waiting to be verified against the writes to PM.
+ *
+ * Entries live in a fixed capacity pool that also keeps them in insertion
+ * order, the oldest prediction in the buffer is the eviction victim. The
+ * predictions for one physical address are chained in insertion order and
+ * the chains are indexed by the address. Occupancy counters are maintained
+ * on insertion and removal, all operations except the full iteration are
+ * constant time.
+ */
+class ResultBuffer {
+public:
+    struct Node {
+        CompletedWriteEntry entry;
+        Addr_t paddr = 0;
+        /* Predictions for the same address, nullptr at the ends */
+        Node *older = nullptr;
+        Node *newer = nullptr;
+    };
+
+private:
+    struct Line {
+        Node *oldest = nullptr;
+        Node *newest = nullptr;
+        size_t size = 0;
+    };
+
+    ObjectPool<Node> pool;
+    std::unordered_map<Addr_t, Line> lines;
+    /* Entries that are free predictions from the cacheline accumulator */
+    size_t freeCount = 0;
+
+    static bool is_free(const CompletedWriteEntry &entry) {
+        return entry.get_cacheline().get_datachunks()[0].is_free_prediction();
+    }
+
+    const Line *find_line(Addr_t paddr) const {
+        auto line = this->lines.find(paddr);
+        return line == this->lines.end() ? nullptr : &line->second;
+    }
+
+public:
+    explicit ResultBuffer(size_t capacity);
+
+    /* Changes the capacity of an empty buffer */
+    void resize(size_t capacity);
+
+    /**
+     * Appends the entry as the newest prediction for paddr, the buffer must
+     * not be full.
+     */
+    Node *push_back(Addr_t paddr, const CompletedWriteEntry &entry);
+
+    /* Removes the prediction, node is invalid on return */
+    void erase(Node *node);
+
+    /* Predictions for paddr, nullptr if there are none */
+    Node *oldest(Addr_t paddr) {
+        const Line *line = find_line(paddr);
+        return line ? line->oldest : nullptr;
+    }
+    Node *newest(Addr_t paddr) {
+        const Line *line = find_line(paddr);
+        return line ? line->newest : nullptr;
+    }
+
+    size_t line_size(Addr_t paddr) const {
+        const Line *line = find_line(paddr);
+        return line ? line->size : 0;
+    }
+
+    bool contains(Addr_t paddr) const {
+        return find_line(paddr) != nullptr;
+    }
+
+    /* Oldest prediction in the buffer, nullptr if empty */
+    Node *oldest() { return this->pool.oldest(); }
+
+    /* Calls fn(paddr, oldest) for every address with predictions */
+    template <class Fn>
+    void for_each_line(Fn fn) {
+        for (auto &line : this->lines) {
+            fn(line.first, line.second.oldest);
+        }
+    }
+
+    size_t size() const { return this->pool.size(); }
+    size_t free_size() const { return this->freeCount; }
+    size_t line_count() const { return this->lines.size(); }
+    size_t capacity() const { return this->pool.capacity(); }
+    bool full() const { return this->pool.full(); }
+    bool empty() const { return this->pool.size() == 0; }
+};
+
+#endif // SHIFTLAB_RESULT_BUFFER_H__
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/predictor/ResultBuffer.hh"
+
+namespace {
+
+CompletedWriteEntry
+make_entry(Addr_t addr, hash_t hash, bool freePrediction = false) {
+    CacheLine line;
+    line.set_addr(addr);
+    if (freePrediction) {
+        line.get_datachunks()[0].set_free_prediction();
+    }
+    return CompletedWriteEntry(addr, line, hash);
+}
+
+std::vector<hash_t>
+line_hashes(ResultBuffer &buffer, Addr_t paddr) {
+    std::vector<hash_t> result;
+    for (auto node = buffer.oldest(paddr); node; node = node->newer) {
+        result.push_back(node->entry.get_generator_hash());
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(ResultBufferTest, ChainsPredictionsPerAddress)
+{
+    ResultBuffer buffer(8);
+    buffer.push_back(0x1000, make_entry(0x1000, 1));
+    buffer.push_back(0x2000, make_entry(0x2000, 2));
+    buffer.push_back(0x1000, make_entry(0x1000, 3));
+
+    EXPECT_EQ(3u, buffer.size());
+    EXPECT_EQ(2u, buffer.line_count());
+    EXPECT_EQ(2u, buffer.line_size(0x1000));
+    EXPECT_EQ((std::vector<hash_t>{1, 3}), line_hashes(buffer, 0x1000));
+    EXPECT_EQ(3u, buffer.newest(0x1000)->entry.get_generator_hash());
+    EXPECT_EQ(nullptr, buffer.newest(0x3000));
+    EXPECT_FALSE(buffer.contains(0x3000));
+}
+
+TEST(ResultBufferTest, EraseUnlinksAndDropsEmptyLines)
+{
+    ResultBuffer buffer(8);
+    buffer.push_back(0x1000, make_entry(0x1000, 1));
+    auto middle = buffer.push_back(0x1000, make_entry(0x1000, 2));
+    buffer.push_back(0x1000, make_entry(0x1000, 3));
+    auto single = buffer.push_back(0x2000, make_entry(0x2000, 4));
+
+    buffer.erase(middle);
+    EXPECT_EQ((std::vector<hash_t>{1, 3}), line_hashes(buffer, 0x1000));
+
+    buffer.erase(single);
+    EXPECT_FALSE(buffer.contains(0x2000));
+    EXPECT_EQ(1u, buffer.line_count());
+    EXPECT_EQ(2u, buffer.size());
+}
+
+TEST(ResultBufferTest, OldestIsInsertionOrder)
+{
+    ResultBuffer buffer(3);
+    buffer.push_back(0x1000, make_entry(0x1000, 1));
+    buffer.push_back(0x2000, make_entry(0x2000, 2));
+    buffer.push_back(0x1000, make_entry(0x1000, 3));
+    EXPECT_TRUE(buffer.full());
+
+    /* Evicting the oldest makes room regardless of its address */
+    EXPECT_EQ(1u, buffer.oldest()->entry.get_generator_hash());
+    buffer.erase(buffer.oldest());
+    EXPECT_FALSE(buffer.full());
+    EXPECT_EQ(2u, buffer.oldest()->entry.get_generator_hash());
+
+    buffer.push_back(0x3000, make_entry(0x3000, 4));
+    buffer.erase(buffer.oldest());
+    EXPECT_EQ(3u, buffer.oldest()->entry.get_generator_hash());
+    EXPECT_EQ((std::vector<hash_t>{3}), line_hashes(buffer, 0x1000));
+}
+
+TEST(ResultBufferTest, CountsFreePredictions)
+{
+    ResultBuffer buffer(4);
+    auto freeEntry = buffer.push_back(0x1000, make_entry(0x1000, 1, true));
+    buffer.push_back(0x1000, make_entry(0x1000, 2));
+    buffer.push_back(0x2000, make_entry(0x2000, 3, true));
+    EXPECT_EQ(2u, buffer.free_size());
+
+    buffer.erase(freeEntry);
+    EXPECT_EQ(1u, buffer.free_size());
+    EXPECT_EQ(2u, buffer.size());
+}
+
+TEST(ResultBufferTest, Resize)
+{
+    ResultBuffer buffer(2);
+    buffer.resize(5);
+    EXPECT_EQ(5u, buffer.capacity());
+    for (int i = 0; i < 5; i++) {
+        buffer.push_back(0x1000 + i * 64, make_entry(0x1000 + i * 64, i));
+    }
+    EXPECT_TRUE(buffer.full());
+    EXPECT_EQ(5u, buffer.line_count());
+}
@@ -0,0 +1,186 @@
+#ifndef SHIFTLAB_RING_BUFFER_H__
+#define SHIFTLAB_RING_BUFFER_H__
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Fixed capacity ring over preallocated contiguous storage. Elements are
+ * constructed in place in their slot and destroyed when they are popped, no
+ * allocation happens after construction of the ring.
+ *
+ *  slot:  0      1      2      3      4      5      6      7
+ *         elem   ....   ....   ....   elem   elem   elem   elem
+ *                                     /\
+ *                                    head   (size = 5, capacity = 8)
+ */
+template <class T>
+class RingBuffer {
+private:
+    using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t cap;
+    size_t head = 0;
+    size_t count = 0;
+
+    /* Translates a logical index (0 = oldest) to a slot index */
+    size_t to_slot(size_t index) const {
+        size_t slot = this->head + index;
+        return slot >= this->cap ? slot - this->cap : slot;
+    }
+
+    T *slot_ptr(size_t slot) {
+        return reinterpret_cast<T*>(&this->slots[slot]);
+    }
+
+    const T *slot_ptr(size_t slot) const {
+        return reinterpret_cast<const T*>(&this->slots[slot]);
+    }
+
+public:
+    template <class R, class V>
+    class Iterator {
+    private:
+        R *ring;
+        size_t index;
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename std::remove_const<V>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        Iterator(R *ring, size_t index) : ring(ring), index(index) {}
+
+        reference operator*() const { return (*ring)[index]; }
+        pointer operator->() const { return &(*ring)[index]; }
+
+        Iterator &operator++() { index++; return *this; }
+        Iterator operator++(int) { Iterator it = *this; index++; return it; }
+        Iterator &operator--() { index--; return *this; }
+        Iterator operator--(int) { Iterator it = *this; index--; return it; }
+
+        bool operator==(const Iterator &other) const {
+            return ring == other.ring and index == other.index;
+        }
+        bool operator!=(const Iterator &other) const {
+            return not (*this == other);
+        }
+    };
+
+    using iterator = Iterator<RingBuffer, T>;
+    using const_iterator = Iterator<const RingBuffer, const T>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    explicit RingBuffer(size_t capacity)
+        : slots(new Slot[capacity]), cap(capacity) {
+        assert(capacity > 0);
+    }
+
+    RingBuffer(const RingBuffer &other)
+        : slots(new Slot[other.cap]), cap(other.cap) {
+        for (const T &elem : other) {
+            this->emplace_back(elem);
+        }
+    }
+
+    RingBuffer(RingBuffer &&other)
+        : slots(std::move(other.slots)), cap(other.cap),
+          head(other.head), count(other.count) {
+        other.head = 0;
+        other.count = 0;
+    }
+
+    RingBuffer &operator=(const RingBuffer &other) {
+        if (this != &other) {
+            this->clear();
+            if (this->cap != other.cap) {
+                this->slots.reset(new Slot[other.cap]);
+                this->cap = other.cap;
+            }
+            for (const T &elem : other) {
+                this->emplace_back(elem);
+            }
+        }
+        return *this;
+    }
+
+    ~RingBuffer() {
+        if (this->slots) {
+            this->clear();
+        }
+    }
+
+    /**
+     * Constructs a new element after the newest element, the oldest element
+     * is destroyed if the ring is full.
+     * @return Reference to the new element
+     */
+    template <class... Args>
+    T &emplace_back(Args&&... args) {
+        if (this->full()) {
+            this->pop_front();
+        }
+        T *elem = new (slot_ptr(to_slot(this->count)))
+                        T(std::forward<Args>(args)...);
+        this->count++;
+        return *elem;
+    }
+
+    void pop_front() {
+        assert(this->count > 0);
+        slot_ptr(this->head)->~T();
+        this->head = to_slot(1);
+        this->count--;
+    }
+
+    void clear() {
+        while (this->count) {
+            this->pop_front();
+        }
+        this->head = 0;
+    }
+
+    T &operator[](size_t index) {
+        assert(index < this->count);
+        return *slot_ptr(to_slot(index));
+    }
+
+    const T &operator[](size_t index) const {
+        assert(index < this->count);
+        return *slot_ptr(to_slot(index));
+    }
+
+    T &front() { return (*this)[0]; }
+    T &back() { return (*this)[this->count - 1]; }
+    const T &front() const { return (*this)[0]; }
+    const T &back() const { return (*this)[this->count - 1]; }
+
+    size_t size() const { return this->count; }
+    size_t capacity() const { return this->cap; }
+    bool empty() const { return this->count == 0; }
+    bool full() const { return this->count == this->cap; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, this->count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, this->count); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+};
+
+#endif // SHIFTLAB_RING_BUFFER_H__
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+
+#include "mem/predictor/RingBuffer.hh"
+#include "mem/predictor/SimpleFixedSizeQueue.hh"
+
+namespace {
+
+/* Roughly the size of a WriteHistoryBufferEntry holding a full CacheLine */
+struct WHBPayload {
+    uint64_t pc;
+    uint64_t words[190];
+
+    WHBPayload(uint64_t pc) : pc(pc) { words[0] = pc; }
+};
+
+/* Counts live objects to check construction and destruction in place */
+struct Tracked {
+    static int live;
+    int val;
+
+    Tracked(int val) : val(val) { live++; }
+    Tracked(const Tracked &other) : val(other.val) { live++; }
+    ~Tracked() { live--; }
+};
+int Tracked::live = 0;
+
+const size_t WHB_SIZE = 512;
+const size_t PUSH_COUNT = 1 << 20;
+const size_t ITER_COUNT = 256;
+
+template <class Fn>
+double
+time_ms(Fn fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // anonymous namespace
+
+/** Testing that pushing to a full ring evicts the oldest element */
+TEST(RingBufferTest, PushEvictsOldest)
+{
+    RingBuffer<int> ring(4);
+    for (int i = 0; i < 10; i++) {
+        ring.emplace_back(i);
+    }
+
+    ASSERT_TRUE(ring.full());
+    ASSERT_EQ(ring.size(), 4);
+    ASSERT_EQ(ring.front(), 6);
+    ASSERT_EQ(ring.back(), 9);
+    for (size_t i = 0; i < ring.size(); i++) {
+        ASSERT_EQ(ring[i], 6 + i);
+    }
+}
+
+/** Testing forward and reverse iteration across the wrap around point */
+TEST(RingBufferTest, IterationOrder)
+{
+    RingBuffer<int> ring(5);
+    for (int i = 0; i < 7; i++) {
+        ring.emplace_back(i);
+    }
+
+    int expected = 2;
+    for (int val : ring) {
+        ASSERT_EQ(val, expected++);
+    }
+    ASSERT_EQ(expected, 7);
+
+    for (auto riter = ring.rbegin(); riter != ring.rend(); riter++) {
+        ASSERT_EQ(*riter, --expected);
+    }
+    ASSERT_EQ(expected, 2);
+}
+
+/** Testing that elements are destroyed on eviction, pop and destruction */
+TEST(RingBufferTest, InPlaceLifetime)
+{
+    {
+        RingBuffer<Tracked> ring(3);
+        for (int i = 0; i < 5; i++) {
+            ring.emplace_back(i);
+            ASSERT_EQ(Tracked::live, ring.size());
+        }
+        ring.pop_front();
+        ASSERT_EQ(Tracked::live, 2);
+        ASSERT_EQ(ring.front().val, 3);
+    }
+    ASSERT_EQ(Tracked::live, 0);
+}
+
+/** Testing the eviction and indexing of SimpleFixedSizeQueue */
+TEST(RingBufferTest, SimpleFixedSizeQueue)
+{
+    SimpleFixedSizeQueue<uint64_t> queue(4, 0);
+    ASSERT_EQ(queue.get_size(), 4);
+
+    for (uint64_t i = 1; i <= 6; i++) {
+        queue.push_back(i);
+    }
+    ASSERT_EQ(queue.get_size(), 4);
+    ASSERT_EQ(queue.get(), 3);
+    ASSERT_EQ(queue.back(), 6);
+    ASSERT_EQ(queue.get_const(1), 4);
+
+    queue.clear();
+    ASSERT_EQ(queue.get_size(), 0);
+}
+
+/**
+ * Microbenchmark comparing the previous storage for the write history buffer
+ * (deque of unique_ptr) with the ring, for pushes and full scans.
+ */
+TEST(RingBufferTest, WHBThroughput)
+{
+    uint64_t dequeSum = 0, ringSum = 0;
+
+    std::deque<std::unique_ptr<WHBPayload>> dq;
+    double dequePush = time_ms([&]() {
+        for (size_t i = 0; i < PUSH_COUNT; i++) {
+            if (dq.size() == WHB_SIZE) {
+                dq.pop_front();
+            }
+            dq.push_back(std::unique_ptr<WHBPayload>(new WHBPayload(i)));
+        }
+    });
+    double dequeIter = time_ms([&]() {
+        for (size_t i = 0; i < ITER_COUNT; i++) {
+            for (auto &entry : dq) {
+                dequeSum += entry->pc;
+            }
+        }
+    });
+
+    RingBuffer<WHBPayload> ring(WHB_SIZE);
+    double ringPush = time_ms([&]() {
+        for (size_t i = 0; i < PUSH_COUNT; i++) {
+            ring.emplace_back(i);
+        }
+    });
+    double ringIter = time_ms([&]() {
+        for (size_t i = 0; i < ITER_COUNT; i++) {
+            for (auto &entry : ring) {
+                ringSum += entry.pc;
+            }
+        }
+    });
+
+    ASSERT_EQ(dequeSum, ringSum);
+
+    std::cout << "WHB push    (" << PUSH_COUNT << "): deque<unique_ptr> "
+              << dequePush << " ms, ring " << ringPush << " ms" << std::endl;
+    std::cout << "WHB iterate (" << ITER_COUNT * WHB_SIZE << "): "
+              << "deque<unique_ptr> " << dequeIter << " ms, ring "
+              << ringIter << " ms" << std::endl;
+}
+
+/** Microbenchmark for the path history queue */
+TEST(RingBufferTest, PathHistoryThroughput)
+{
+    const size_t historySize = 32;
+    uint64_t dequeHash = 0, ringHash = 0;
+
+    std::deque<uint64_t> dq;
+    double dequeTime = time_ms([&]() {
+        for (size_t i = 0; i < PUSH_COUNT; i++) {
+            if (dq.size() == historySize) {
+                dq.pop_front();
+            }
+            dq.push_back(i);
+            for (size_t j = 0; j < dq.size(); j++) {
+                dequeHash ^= dq.at(j) << j;
+            }
+        }
+    });
+
+    SimpleFixedSizeQueue<uint64_t> queue(historySize);
+    double ringTime = time_ms([&]() {
+        for (size_t i = 0; i < PUSH_COUNT; i++) {
+            queue.push_back(i);
+            for (size_t j = 0; j < queue.get_size(); j++) {
+                ringHash ^= queue.get(j) << j;
+            }
+        }
+    });
+
+    ASSERT_EQ(dequeHash, ringHash);
+
+    std::cout << "Path history push+hash (" << PUSH_COUNT << "): deque "
+              << dequeTime << " ms, ring " << ringTime << " ms" << std::endl;
+}
@@ -0,0 +1,161 @@
+#ifndef SHIFTLAB_SET_ASSOC_TABLE_H__
+#define SHIFTLAB_SET_ASSOC_TABLE_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "base/logging.hh"
+#include "mem/predictor/Declarations.hh"
+
+/**
+ * Set associative table indexed by a hash, models a table stored in SRAM. The
+ * set is selected using the hash bits starting at indexShift, the bits above
+ * the index form the tag. Lookups, insertions and evictions only touch the
+ * ways of a single set.
+ *
+ *  hash:  | ... unused ... | tag (tagBits) | index (log2 sets) | indexShift |
+ *
+ * With tagBits = 0 the complete hash is compared and the table never aliases,
+ * otherwise different hashes with the same index and tag share an entry like
+ * they would in hardware.
+ */
+template <class V>
+class SetAssocTable {
+public:
+    struct Way {
+        bool valid = false;
+        hash_t tag = 0;
+        /* Complete hash of the entry, kept for bookkeeping only */
+        hash_t key = 0;
+        V value;
+    };
+
+private:
+    size_t sets;
+    size_t ways;
+    unsigned indexShift;
+    unsigned indexBits = 0;
+    unsigned tagBits;
+
+    std::vector<Way> storage;
+    size_t validCount = 0;
+
+public:
+    SetAssocTable(size_t sets, size_t ways, unsigned indexShift, unsigned tagBits)
+            : sets(sets), ways(ways), indexShift(indexShift), tagBits(tagBits),
+              storage(sets * ways) {
+        fatal_if(sets == 0 or (sets & (sets - 1)) != 0,
+                 "Number of sets (%d) should be a power of 2", sets);
+        fatal_if(ways == 0, "Table needs at least one way");
+        while ((1ul << this->indexBits) < sets) {
+            this->indexBits++;
+        }
+        fatal_if(indexShift + this->indexBits + tagBits > sizeof(hash_t) * 8,
+                 "Index and tag do not fit in the hash");
+    }
+
+    size_t set_of(hash_t key) const {
+        return (key >> this->indexShift) & (this->sets - 1);
+    }
+
+    hash_t tag_of(hash_t key) const {
+        if (this->tagBits == 0) {
+            return key;
+        }
+        hash_t tag = key >> (this->indexShift + this->indexBits);
+        return this->tagBits >= sizeof(hash_t) * 8
+                ? tag : tag & ((1ull << this->tagBits) - 1);
+    }
+
+    /* First and one past the last way of the set the key maps to */
+    Way *set_begin(hash_t key) {
+        return &this->storage[set_of(key) * this->ways];
+    }
+
+    Way *set_end(hash_t key) {
+        return set_begin(key) + this->ways;
+    }
+
+    /**
+     * @return Way holding the key, nullptr on a miss
+     */
+    Way *find_way(hash_t key) {
+        hash_t tag = tag_of(key);
+        for (Way *way = set_begin(key); way != set_end(key); way++) {
+            if (way->valid and way->tag == tag) {
+                return way;
+            }
+        }
+        return nullptr;
+    }
+
+    V *find(hash_t key) {
+        Way *way = find_way(key);
+        return way ? &way->value : nullptr;
+    }
+
+    /**
+     * Inserts the value in an invalid way of the set, if the set is full the
+     * way returned by pickVictim(set_begin, set_end) is replaced.
+     * @param evicted Set to true if a valid way was replaced
+     * @return The way holding the value
+     */
+    template <class PickVictim>
+    Way *insert(hash_t key, const V &value, PickVictim pickVictim,
+                bool &evicted) {
+        Way *target = nullptr;
+        for (Way *way = set_begin(key); way != set_end(key); way++) {
+            if (not way->valid) {
+                target = way;
+                break;
+            }
+        }
+
+        evicted = target == nullptr;
+        if (evicted) {
+            target = pickVictim(set_begin(key), set_end(key));
+            panic_if(target < set_begin(key) or target >= set_end(key),
+                     "Victim is not part of the set");
+        } else {
+            this->validCount++;
+        }
+
+        target->valid = true;
+        target->tag = tag_of(key);
+        target->key = key;
+        target->value = value;
+        return target;
+    }
+
+    void invalidate(Way *way) {
+        if (way->valid) {
+            way->valid = false;
+            this->validCount--;
+        }
+    }
+
+    bool erase(hash_t key) {
+        Way *way = find_way(key);
+        if (way) {
+            invalidate(way);
+        }
+        return way != nullptr;
+    }
+
+    /* Calls fn(key, value) for every valid entry */
+    template <class Fn>
+    void for_each(Fn fn) {
+        for (Way &way : this->storage) {
+            if (way.valid) {
+                fn(way.key, way.value);
+            }
+        }
+    }
+
+    size_t size() const { return this->validCount; }
+    size_t capacity() const { return this->storage.size(); }
+    size_t get_sets() const { return this->sets; }
+    size_t get_ways() const { return this->ways; }
+};
+
+#endif // SHIFTLAB_SET_ASSOC_TABLE_H__
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "mem/predictor/SetAssocTable.hh"
+
+namespace {
+
+using Table = SetAssocTable<int>;
+
+/* Picks the way holding the smallest value */
+Table::Way *
+smallest_value(Table::Way *begin, Table::Way *end) {
+    Table::Way *victim = begin;
+    for (Table::Way *way = begin; way != end; way++) {
+        if (way->value < victim->value) {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+} // anonymous namespace
+
+TEST(SetAssocTableTest, InsertAndFind)
+{
+    Table table(4, 2, 0, 0);
+    bool evicted = true;
+
+    table.insert(0x10, 1, smallest_value, evicted);
+    EXPECT_FALSE(evicted);
+    table.insert(0x11, 2, smallest_value, evicted);
+    EXPECT_FALSE(evicted);
+
+    ASSERT_NE(nullptr, table.find(0x10));
+    EXPECT_EQ(1, *table.find(0x10));
+    EXPECT_EQ(2, *table.find(0x11));
+    EXPECT_EQ(nullptr, table.find(0x12));
+    EXPECT_EQ(2u, table.size());
+    EXPECT_EQ(8u, table.capacity());
+}
+
+TEST(SetAssocTableTest, EvictsWithinTheSet)
+{
+    Table table(4, 2, 0, 0);
+    bool evicted = false;
+
+    /* 0x0, 0x4 and 0x8 all map to set 0 */
+    table.insert(0x0, 5, smallest_value, evicted);
+    table.insert(0x4, 3, smallest_value, evicted);
+    /* Another set is not affected */
+    table.insert(0x1, 1, smallest_value, evicted);
+
+    table.insert(0x8, 7, smallest_value, evicted);
+    EXPECT_TRUE(evicted);
+    EXPECT_EQ(nullptr, table.find(0x4));
+    EXPECT_EQ(5, *table.find(0x0));
+    EXPECT_EQ(7, *table.find(0x8));
+    EXPECT_EQ(1, *table.find(0x1));
+    EXPECT_EQ(3u, table.size());
+}
+
+TEST(SetAssocTableTest, IndexShiftAndPartialTags)
+{
+    /* Index from bits [4, 6), 4 tag bits from [6, 10) */
+    Table table(4, 1, 4, 4);
+    bool evicted = false;
+
+    EXPECT_EQ(1u, table.set_of(0x10));
+    EXPECT_EQ(0x1u, table.tag_of(0x40));
+
+    table.insert(0x40, 9, smallest_value, evicted);
+
+    /* Differs only outside the index and tag, aliases with 0x40 */
+    EXPECT_NE(nullptr, table.find(0x40 | 0x400 | 0x3));
+    EXPECT_EQ(0x40u, table.find_way(0x40 | 0x400)->key);
+    /* Differs in the tag */
+    EXPECT_EQ(nullptr, table.find(0x80));
+}
+
+TEST(SetAssocTableTest, EraseAndForEach)
+{
+    Table table(2, 2, 0, 0);
+    bool evicted = false;
+
+    for (hash_t key = 0; key < 4; key++) {
+        table.insert(key, (int)key, smallest_value, evicted);
+    }
+    EXPECT_TRUE(table.erase(2));
+    EXPECT_FALSE(table.erase(2));
+
+    int sum = 0;
+    size_t count = 0;
+    table.for_each([&] (hash_t key, int &value) {
+        EXPECT_EQ((int)key, value);
+        sum += value;
+        count++;
+    });
+    EXPECT_EQ(3u, count);
+    EXPECT_EQ(0 + 1 + 3, sum);
+}
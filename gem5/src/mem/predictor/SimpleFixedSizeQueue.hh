@@ -1,36 +1,47 @@
 #ifndef SHIFTLAB_SIMPLE_FIXED_SIZE_QUEUE_H__
 #define SHIFTLAB_SIMPLE_FIXED_SIZE_QUEUE_H__
 
+#include "mem/predictor/RingBuffer.hh"
+
+#include <cassert>
+#include <cstddef>
+#include <ostream>
+#include <utility>
+
 template <class T>
 class SimpleFixedSizeQueue {
 private:
     size_t sz;
-    std::deque<T> queue;
+    RingBuffer<T> queue;
 
 public:
 
     /**
      * Parent constructor is called automatically.
     */
-    SimpleFixedSizeQueue(size_t size) : sz(size) {
-        // this->queue.resize(size);
-    }
+    SimpleFixedSizeQueue(size_t size) : sz(size), queue(size) {}
 
-    SimpleFixedSizeQueue(size_t size, T initValue) : sz(size) {
-        this->queue.resize(size);
-        std::fill(this->queue.begin(), this->queue.end(), initValue);
+    SimpleFixedSizeQueue(size_t size, T initValue) : sz(size), queue(size) {
+        for (size_t i = 0; i < size; i++) {
+            this->queue.emplace_back(initValue);
+        }
     }
 
-    bool push_back(T elem) {
+    bool push_back(const T &elem) {
         assert(this->queue.size() <= this->sz);
-        if (this->queue.size() == this->sz) {
-            this->queue.pop_front();
-        }
-
-        this->queue.push_back(elem);
+        this->queue.emplace_back(elem);
         return true;
     }
 
+    /**
+     * Constructs a new element in place, the oldest element is evicted if 
+     * the queue is full.
+     */
+    template <class... Args>
+    T &emplace_back(Args&&... args) {
+        return this->queue.emplace_back(std::forward<Args>(args)...);
+    }
+
     T &back() {
         return this->queue.back();
     }
@@ -40,11 +51,13 @@ public:
     }
 
     T get(size_t index) const {
-        return this->queue.at(index);
+        assert(index < this->queue.size());
+        return this->queue[index];
     }
 
     T get_const(size_t index) const {
-        return this->queue.at(index);
+        assert(index < this->queue.size());
+        return this->queue[index];
     }
 
     size_t get_size() const {
@@ -63,15 +76,12 @@ public:
     }
 
     void clear() {
-        while (this->get_size()) {
-            // std::cout << "size: " << this->queue.size() << " " << this->get_size() << "\n";
-            this->remove();
-        }
+        this->queue.clear();
     }
 
     /* For C++ range based loops */
-    typename std::deque<T>::iterator begin() { return this->queue.begin(); }
-    typename std::deque<T>::iterator end() { return this->queue.end(); }
+    typename RingBuffer<T>::iterator begin() { return this->queue.begin(); }
+    typename RingBuffer<T>::iterator end() { return this->queue.end(); }
 
     
     friend std::ostream& operator<<(std::ostream& os, const SimpleFixedSizeQueue& dt);
@@ -0,0 +1,104 @@
+#include "mem/predictor/SnapshotWriter.hh"
+
+#include "base/logging.hh"
+
+const char SnapshotWriter::MAGIC[8] = {'P', 'M', 'W', 'S', 'N', 'A', 'P', 0};
+const uint32_t SnapshotWriter::VERSION;
+const size_t SnapshotWriter::HEADER_SIZE;
+const size_t SnapshotWriter::SECTION_HEADER_SIZE;
+const size_t SnapshotWriter::BUFFER_SIZE;
+
+SnapshotWriter::SnapshotWriter(const std::string &path, Trigger trigger,
+                               uint64_t period)
+        : buffer(BUFFER_SIZE), trigger(trigger), period(period) {
+    fatal_if(period == 0, "Snapshot period of %s cannot be 0", path);
+
+    this->file = std::fopen(path.c_str(), "wb");
+    fatal_if(this->file == nullptr, "Unable to open snapshot file %s", path);
+    std::setvbuf(this->file, this->buffer.data(), _IOFBF,
+                 this->buffer.size());
+
+    put_bytes(MAGIC, sizeof(MAGIC));
+    put(VERSION);
+    put((uint32_t)0);
+
+    /* The first event starts the period */
+    this->next = trigger == Trigger::TICKS ? 0 : 1;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    close();
+}
+
+bool
+SnapshotWriter::due(Tick now) {
+    if (this->trigger == Trigger::TICKS) {
+        if (now < this->next) {
+            return false;
+        }
+        /* Periods without events are skipped */
+        this->next = now - now % this->period + this->period;
+    } else {
+        if (--this->next != 0) {
+            return false;
+        }
+        this->next = this->period;
+    }
+    this->snapshotCount++;
+    return true;
+}
+
+void
+SnapshotWriter::begin_section(Section section, Tick tick, uint32_t count,
+                              uint32_t entrySize) {
+    panic_if(this->sectionLeft != 0, "Previous snapshot section is missing "
+             "%d bytes", this->sectionLeft);
+
+    put((uint32_t)section);
+    put(count);
+    put(entrySize);
+    put((uint32_t)0);
+    put((uint64_t)tick);
+    this->sectionLeft = (uint64_t)count * entrySize;
+}
+
+void
+SnapshotWriter::put(uint64_t val) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = val >> (8 * i);
+    }
+    put_bytes(bytes, sizeof(bytes));
+}
+
+void
+SnapshotWriter::put(uint32_t val) {
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = val >> (8 * i);
+    }
+    put_bytes(bytes, sizeof(bytes));
+}
+
+void
+SnapshotWriter::put_bytes(const void *src, size_t len) {
+    panic_if(this->file == nullptr, "Write to a closed snapshot file");
+
+    /* Section headers are written with no section open */
+    if (this->sectionLeft != 0) {
+        panic_if(len > this->sectionLeft, "Snapshot section overflow");
+        this->sectionLeft -= len;
+    }
+    fatal_if(std::fwrite(src, 1, len, this->file) != len,
+             "Unable to write snapshot");
+}
+
+void
+SnapshotWriter::close() {
+    if (this->file == nullptr) {
+        return;
+    }
+    panic_if(this->sectionLeft != 0, "Snapshot closed in a section");
+    std::fclose(this->file);
+    this->file = nullptr;
+}
@@ -0,0 +1,98 @@
+#ifndef SHIFTLAB_SNAPSHOT_WRITER_H__
+#define SHIFTLAB_SNAPSHOT_WRITER_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Sampled binary snapshots of the predictor state, replaces the text dumps
+ * that were written on every event. Each component keeps one file open for
+ * the complete simulation and asks the writer on every event if a snapshot
+ * is due, the period is either a number of ticks or a number of events.
+ *
+ * The file starts with a 16 byte header (the magic, a 32 bit version and 32
+ * reserved bits) followed by sections, all little endian:
+ *  u32     section id, see Section
+ *  u32     entry count
+ *  u32     entry size in bytes
+ *  u32     reserved
+ *  u64     tick of the snapshot
+ *  u8[]    count * size bytes of entries
+ *
+ * A snapshot is the group of sections with the same tick. Readers skip
+ * sections they do not know using the entry size. Decode with
+ * util/decode_pmweaver_snapshot.py.
+ */
+class SnapshotWriter {
+public:
+    enum class Trigger { TICKS, EVENTS };
+
+    enum class Section : uint32_t {
+        /* pc, gen tick, line addr, valid mask (u64), data (16 x u32) */
+        WRITE_HISTORY_BUFFER = 1,
+        /* hash, target addr, addr conf, data conf (u32), valid mask (u64),
+           data (16 x u32) */
+        PREDICTOR_TABLE = 2,
+        /* paddr, predictions (u32), free predictions (u32) */
+        RESULT_BUFFER = 3,
+        /* hash, count (u64), counts since the previous snapshot */
+        HASH_COUNTS = 4,
+    };
+
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 1;
+    static const size_t HEADER_SIZE = 16;
+    static const size_t SECTION_HEADER_SIZE = 24;
+
+    /* The stdio buffer, snapshots only reach the file when it is full */
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+private:
+    FILE *file = nullptr;
+    std::vector<char> buffer;
+
+    const Trigger trigger;
+    const uint64_t period;
+    /* Tick of the next snapshot or events left until it */
+    uint64_t next = 0;
+
+    /* Section being written */
+    uint64_t sectionLeft = 0;
+    uint64_t snapshotCount = 0;
+
+    void put_bytes(const void *src, size_t len);
+
+public:
+    SnapshotWriter(const std::string &path, Trigger trigger, uint64_t period);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter &) = delete;
+    SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+    /**
+     * Counts an event at tick now.
+     * @return True if the caller should write a snapshot
+     */
+    bool due(Tick now);
+
+    /**
+     * Starts a section of count entries of entrySize bytes, filled with
+     * put(). The previous section must be complete.
+     */
+    void begin_section(Section section, Tick tick, uint32_t count,
+                       uint32_t entrySize);
+
+    void put(uint64_t val);
+    void put(uint32_t val);
+
+    /* Writes out the buffered snapshots and closes the file, idempotent */
+    void close();
+
+    uint64_t get_snapshot_count() const { return this->snapshotCount; }
+};
+
+#endif // SHIFTLAB_SNAPSHOT_WRITER_H__
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mem/predictor/SnapshotWriter.hh"
+
+namespace {
+
+std::string
+temp_path(const char *suffix) {
+    return std::string("/tmp/pmweaver_snapshot_test_")
+            + std::to_string(getpid()) + suffix;
+}
+
+std::vector<uint8_t>
+read_file(const std::string &path) {
+    std::vector<uint8_t> result;
+    FILE *file = std::fopen(path.c_str(), "rb");
+    int c;
+    while ((c = std::fgetc(file)) != EOF) {
+        result.push_back(c);
+    }
+    std::fclose(file);
+    return result;
+}
+
+uint64_t
+get_le(const std::vector<uint8_t> &bytes, size_t pos, size_t len) {
+    uint64_t val = 0;
+    for (size_t i = 0; i < len; i++) {
+        val |= (uint64_t)bytes[pos + i] << (8 * i);
+    }
+    return val;
+}
+
+} // anonymous namespace
+
+TEST(SnapshotWriterTest, TickPeriod)
+{
+    std::string path = temp_path(".ticks");
+    SnapshotWriter writer(path, SnapshotWriter::Trigger::TICKS, 1000);
+
+    /* First event, then once per period, idle periods are skipped */
+    EXPECT_TRUE(writer.due(10));
+    EXPECT_FALSE(writer.due(999));
+    EXPECT_TRUE(writer.due(1000));
+    EXPECT_FALSE(writer.due(1500));
+    EXPECT_TRUE(writer.due(5200));
+    EXPECT_FALSE(writer.due(5999));
+    EXPECT_TRUE(writer.due(6000));
+    EXPECT_EQ(4u, writer.get_snapshot_count());
+
+    writer.close();
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotWriterTest, EventPeriod)
+{
+    std::string path = temp_path(".events");
+    SnapshotWriter writer(path, SnapshotWriter::Trigger::EVENTS, 3);
+
+    std::vector<bool> expected = {true, false, false, true, false, false,
+                                  true};
+    for (bool exp : expected) {
+        EXPECT_EQ(exp, writer.due(0));
+    }
+    EXPECT_EQ(3u, writer.get_snapshot_count());
+
+    writer.close();
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotWriterTest, SectionLayout)
+{
+    std::string path = temp_path(".layout");
+    {
+        SnapshotWriter writer(path, SnapshotWriter::Trigger::EVENTS, 1);
+        writer.begin_section(SnapshotWriter::Section::HASH_COUNTS, 42, 2, 16);
+        writer.put((uint64_t)0xdeadbeef);
+        writer.put((uint64_t)7);
+        writer.put((uint64_t)0x1234);
+        writer.put((uint64_t)1);
+        writer.begin_section(SnapshotWriter::Section::RESULT_BUFFER, 42, 0,
+                             16);
+    }
+
+    auto bytes = read_file(path);
+    ASSERT_EQ(SnapshotWriter::HEADER_SIZE
+                + 2 * SnapshotWriter::SECTION_HEADER_SIZE + 2 * 16,
+              bytes.size());
+    EXPECT_EQ(0, std::memcmp(bytes.data(), SnapshotWriter::MAGIC, 8));
+    EXPECT_EQ(SnapshotWriter::VERSION, get_le(bytes, 8, 4));
+
+    size_t pos = SnapshotWriter::HEADER_SIZE;
+    EXPECT_EQ((uint64_t)SnapshotWriter::Section::HASH_COUNTS,
+              get_le(bytes, pos, 4));
+    EXPECT_EQ(2u, get_le(bytes, pos + 4, 4));
+    EXPECT_EQ(16u, get_le(bytes, pos + 8, 4));
+    EXPECT_EQ(42u, get_le(bytes, pos + 16, 8));
+    pos += SnapshotWriter::SECTION_HEADER_SIZE;
+    EXPECT_EQ(0xdeadbeefu, get_le(bytes, pos, 8));
+    EXPECT_EQ(7u, get_le(bytes, pos + 8, 8));
+    pos += 2 * 16;
+    EXPECT_EQ((uint64_t)SnapshotWriter::Section::RESULT_BUFFER,
+              get_le(bytes, pos, 4));
+    EXPECT_EQ(0u, get_le(bytes, pos + 4, 4));
+
+    std::remove(path.c_str());
+}
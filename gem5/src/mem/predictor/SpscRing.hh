@@ -0,0 +1,90 @@
+#ifndef SHIFTLAB_SPSC_RING_H__
+#define SHIFTLAB_SPSC_RING_H__
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * Bounded lock-free ring for exactly one producer and one consumer thread.
+ * The producer only writes the tail and the consumer only writes the head,
+ * a slot is published by the release store of the index that hands it to
+ * the other side. Capacity is rounded up to a power of two, slots are
+ * preallocated and reused by assignment.
+ */
+template <class T>
+class SpscRing {
+private:
+    /* Keeps the producer and consumer indices on separate cache lines */
+    static const size_t INDEX_ALIGN = 64;
+
+    std::unique_ptr<T[]> slots;
+    size_t mask;
+
+    /* Next slot to pop, written by the consumer */
+    alignas(INDEX_ALIGN) std::atomic<size_t> head;
+    /* Next slot to push, written by the producer */
+    alignas(INDEX_ALIGN) std::atomic<size_t> tail;
+
+    static size_t round_up(size_t capacity) {
+        size_t result = 1;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    explicit SpscRing(size_t capacity)
+        : slots(new T[round_up(capacity)]), mask(round_up(capacity) - 1),
+          head(0), tail(0) {
+        assert(capacity > 0);
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * Producer side, appends val unless the ring is full.
+     * @return false if the ring was full, val is not consumed
+     */
+    template <class V>
+    bool push(V &&val) {
+        const size_t t = this->tail.load(std::memory_order_relaxed);
+        if (t - this->head.load(std::memory_order_acquire) > this->mask) {
+            return false;
+        }
+        this->slots[t & this->mask] = std::forward<V>(val);
+        this->tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer side, oldest element or nullptr if the ring is empty */
+    T *front() {
+        const size_t h = this->head.load(std::memory_order_relaxed);
+        if (h == this->tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &this->slots[h & this->mask];
+    }
+
+    /* Consumer side, releases the slot returned by front() */
+    void pop() {
+        const size_t h = this->head.load(std::memory_order_relaxed);
+        assert(h != this->tail.load(std::memory_order_relaxed));
+        this->head.store(h + 1, std::memory_order_release);
+    }
+
+    /* Exact only when called from the producer or the consumer */
+    size_t size() const {
+        return this->tail.load(std::memory_order_acquire)
+                - this->head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return this->mask + 1; }
+    bool empty() const { return this->size() == 0; }
+};
+
+#endif // SHIFTLAB_SPSC_RING_H__
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "mem/predictor/SpscRing.hh"
+
+TEST(SpscRingTest, RoundsCapacityUp)
+{
+    SpscRing<int> ring(5);
+    EXPECT_EQ(8u, ring.capacity());
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(nullptr, ring.front());
+}
+
+TEST(SpscRingTest, FifoAcrossWrapAround)
+{
+    SpscRing<int> ring(4);
+    int next = 0;
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 3; i++) {
+            EXPECT_TRUE(ring.push(round * 3 + i));
+        }
+        for (int i = 0; i < 3; i++) {
+            ASSERT_NE(nullptr, ring.front());
+            EXPECT_EQ(next++, *ring.front());
+            ring.pop();
+        }
+    }
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, RejectsWhenFull)
+{
+    SpscRing<int> ring(2);
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_FALSE(ring.push(3));
+    EXPECT_EQ(2u, ring.size());
+
+    ring.pop();
+    EXPECT_TRUE(ring.push(3));
+    EXPECT_EQ(2, *ring.front());
+}
+
+TEST(SpscRingTest, ProducerAndConsumerThreads)
+{
+    const uint64_t count = 1 << 20;
+    SpscRing<uint64_t> ring(64);
+
+    std::thread producer([&ring, count] {
+        for (uint64_t i = 0; i < count; i++) {
+            while (not ring.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    while (expected < count) {
+        uint64_t *val = ring.front();
+        if (val == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(expected, *val);
+        ring.pop();
+        expected++;
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,141 @@
+#include "mem/predictor/TraceFormat.hh"
+
+#include "base/logging.hh"
+
+using namespace TraceFormat;
+
+size_t
+TraceCodec::encode(const TraceRecord &record, uint8_t *out) {
+    panic_if(record.hasData and record.size > MAX_DATA_SIZE,
+             "Trace record data of %d bytes is too large", record.size);
+
+    uint8_t flags = (uint8_t)record.kind << KIND_SHIFT;
+    if (record.isClwb) {
+        flags |= FLAG_CLWB;
+    }
+    if (record.persistent) {
+        flags |= FLAG_PERSISTENT;
+    }
+    if (record.hasData) {
+        flags |= FLAG_HAS_DATA;
+    }
+    switch (record.size) {
+    case 4:
+        flags |= SIZE_4;
+        break;
+    case 8:
+        flags |= SIZE_8;
+        break;
+    case 64:
+        flags |= SIZE_64;
+        break;
+    default:
+        flags |= SIZE_EXPLICIT;
+        break;
+    }
+
+    size_t len = 0;
+    out[len++] = flags;
+    len += put_varint(out + len, zigzag(record.pc - this->lastPC));
+    len += put_varint(out + len, zigzag(record.addr - this->lastAddr));
+    len += put_varint(out + len, zigzag(record.paddr - this->lastPaddr));
+    if ((flags & SIZE_CLASS_MASK) == SIZE_EXPLICIT) {
+        len += put_varint(out + len, record.size);
+    }
+    len += put_varint(out + len, zigzag(record.tick - this->lastTick));
+    len += put_varint(out + len, zigzag(record.contextId));
+    if (record.hasData) {
+        std::memcpy(out + len, record.data, record.size);
+        len += record.size;
+    }
+
+    this->lastPC = record.pc;
+    this->lastAddr = record.addr;
+    this->lastPaddr = record.paddr;
+    this->lastTick = record.tick;
+    return len;
+}
+
+size_t
+TraceCodec::decode(const uint8_t *in, size_t avail, TraceRecord &record) {
+    if (avail == 0) {
+        return 0;
+    }
+
+    size_t len = 0;
+    uint8_t flags = in[len++];
+    uint64_t val;
+    size_t used;
+
+    if (not (used = get_varint(in + len, avail - len, val))) {
+        return 0;
+    }
+    len += used;
+    record.pc = this->lastPC + unzigzag(val);
+
+    if (not (used = get_varint(in + len, avail - len, val))) {
+        return 0;
+    }
+    len += used;
+    record.addr = this->lastAddr + unzigzag(val);
+
+    if (not (used = get_varint(in + len, avail - len, val))) {
+        return 0;
+    }
+    len += used;
+    record.paddr = this->lastPaddr + unzigzag(val);
+
+    switch (flags & SIZE_CLASS_MASK) {
+    case SIZE_4:
+        record.size = 4;
+        break;
+    case SIZE_8:
+        record.size = 8;
+        break;
+    case SIZE_64:
+        record.size = 64;
+        break;
+    default:
+        if (not (used = get_varint(in + len, avail - len, val))) {
+            return 0;
+        }
+        len += used;
+        record.size = val;
+        break;
+    }
+
+    if (not (used = get_varint(in + len, avail - len, val))) {
+        return 0;
+    }
+    len += used;
+    record.tick = this->lastTick + unzigzag(val);
+
+    if (not (used = get_varint(in + len, avail - len, val))) {
+        return 0;
+    }
+    len += used;
+    record.contextId = unzigzag(val);
+
+    uint8_t kind = (flags & KIND_MASK) >> KIND_SHIFT;
+    panic_if(kind > (uint8_t)TraceRecord::Kind::ROI_END,
+             "Corrupt trace, unknown record kind %d", kind);
+    record.kind = (TraceRecord::Kind)kind;
+    record.isClwb = flags & FLAG_CLWB;
+    record.persistent = flags & FLAG_PERSISTENT;
+    record.hasData = flags & FLAG_HAS_DATA;
+    if (record.hasData) {
+        panic_if(record.size > MAX_DATA_SIZE,
+                 "Corrupt trace, record data of %d bytes", record.size);
+        if (avail - len < record.size) {
+            return 0;
+        }
+        std::memcpy(record.data, in + len, record.size);
+        len += record.size;
+    }
+
+    this->lastPC = record.pc;
+    this->lastAddr = record.addr;
+    this->lastPaddr = record.paddr;
+    this->lastTick = record.tick;
+    return len;
+}
@@ -0,0 +1,155 @@
+#ifndef SHIFTLAB_TRACE_FORMAT_H__
+#define SHIFTLAB_TRACE_FORMAT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "base/types.hh"
+
+/**
+ * Binary store trace written by the predictor frontend and backend, read back
+ * by the decoder in util/decode_pmweaver_trace.py and the trace replay.
+ *
+ * The file starts with a 16 byte header (the magic, a 32 bit version and 32
+ * reserved bits, little endian) followed by the records. The complete file
+ * may be gzip compressed.
+ *
+ * Record layout:
+ *  u8      flags, see FLAG_*, the size class and the record kind
+ *  varint  zigzag(pc - previous pc)
+ *  varint  zigzag(addr - previous addr)
+ *  varint  zigzag(paddr - previous paddr)
+ *  varint  size, only if the size class is SIZE_EXPLICIT
+ *  varint  zigzag(tick - previous tick)
+ *  varint  zigzag(context id), -1 if the request had none
+ *  u8[]    size bytes of data, only if FLAG_HAS_DATA is set
+ *
+ * Deltas are taken against the previous record in the file and start at 0,
+ * the first record stores absolute values. Marker records (the region of
+ * interest boundaries) use the same layout. Version 3 added the context
+ * id.
+ */
+
+namespace TraceFormat {
+
+const char MAGIC[8] = {'P', 'M', 'W', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t VERSION = 3;
+const size_t HEADER_SIZE = 16;
+
+/* Largest store the trace can carry data for, a complete cacheline */
+const size_t MAX_DATA_SIZE = 64;
+
+/* Upper bound on the encoded size of one record */
+const size_t MAX_RECORD_SIZE = 1 + 10 + 10 + 10 + 5 + 10 + 5
+                               + MAX_DATA_SIZE;
+
+const uint8_t FLAG_CLWB         = 1 << 0;
+const uint8_t FLAG_PERSISTENT   = 1 << 1;
+const uint8_t FLAG_HAS_DATA     = 1 << 2;
+
+const unsigned SIZE_CLASS_SHIFT = 3;
+const uint8_t SIZE_CLASS_MASK   = 3 << SIZE_CLASS_SHIFT;
+const uint8_t SIZE_4            = 0 << SIZE_CLASS_SHIFT;
+const uint8_t SIZE_8            = 1 << SIZE_CLASS_SHIFT;
+const uint8_t SIZE_64           = 2 << SIZE_CLASS_SHIFT;
+const uint8_t SIZE_EXPLICIT     = 3 << SIZE_CLASS_SHIFT;
+
+const unsigned KIND_SHIFT       = 5;
+const uint8_t KIND_MASK         = 3 << KIND_SHIFT;
+
+inline uint64_t zigzag(int64_t val) {
+    return ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+}
+
+inline int64_t unzigzag(uint64_t val) {
+    return (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+}
+
+/** @return Number of bytes written to out, at most 10 */
+inline size_t put_varint(uint8_t *out, uint64_t val) {
+    size_t len = 0;
+    while (val >= 0x80) {
+        out[len++] = (uint8_t)val | 0x80;
+        val >>= 7;
+    }
+    out[len++] = (uint8_t)val;
+    return len;
+}
+
+/**
+ * @return Number of bytes consumed, 0 if the varint is truncated or longer
+ *         than 10 bytes
+ */
+inline size_t get_varint(const uint8_t *in, size_t avail, uint64_t &val) {
+    val = 0;
+    for (size_t i = 0; i < avail and i < 10; i++) {
+        val |= (uint64_t)(in[i] & 0x7f) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace TraceFormat
+
+/**
+ * One store or CLWB seen by the predictor, or a marker.
+ */
+struct TraceRecord {
+    enum class Kind : uint8_t {
+        ACCESS = 0,
+        /* The predictor was enabled or disabled by the workload */
+        ROI_BEGIN = 1,
+        ROI_END = 2,
+    };
+
+    Kind kind = Kind::ACCESS;
+    bool isClwb = false;
+    /* Address is in persistent memory */
+    bool persistent = false;
+    bool hasData = false;
+
+    Addr pc = 0;
+    /* Virtual address if known, physical address otherwise */
+    Addr addr = 0;
+    Addr paddr = 0;
+    uint32_t size = 0;
+    Tick tick = 0;
+    /* Hardware thread context of the request */
+    ContextID contextId = InvalidContextID;
+    uint8_t data[TraceFormat::MAX_DATA_SIZE];
+
+    void set_data(const uint8_t *src, size_t len) {
+        this->hasData = true;
+        std::memcpy(this->data, src, len);
+    }
+};
+
+/**
+ * Delta state shared by the encoder and the decoder, one per trace file.
+ */
+class TraceCodec {
+private:
+    Addr lastPC = 0;
+    Addr lastAddr = 0;
+    Addr lastPaddr = 0;
+    Tick lastTick = 0;
+
+public:
+    /**
+     * Encodes the record into out, which must have room for
+     * TraceFormat::MAX_RECORD_SIZE bytes.
+     * @return Number of bytes written
+     */
+    size_t encode(const TraceRecord &record, uint8_t *out);
+
+    /**
+     * Decodes one record from in.
+     * @return Number of bytes consumed, 0 if in holds a partial record
+     */
+    size_t decode(const uint8_t *in, size_t avail, TraceRecord &record);
+};
+
+#endif // SHIFTLAB_TRACE_FORMAT_H__
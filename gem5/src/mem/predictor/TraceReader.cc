@@ -0,0 +1,66 @@
+#include "mem/predictor/TraceReader.hh"
+
+#include <cstring>
+
+#include "base/logging.hh"
+
+const size_t TraceReader::BUFFER_SIZE;
+
+TraceReader::TraceReader(const std::string &path) : buffer(BUFFER_SIZE) {
+    /* gzread passes uncompressed files through */
+    this->gzfile = gzopen(path.c_str(), "rb");
+    fatal_if(this->gzfile == nullptr, "Unable to open trace %s", path);
+
+    uint8_t header[TraceFormat::HEADER_SIZE];
+    fatal_if(gzread(this->gzfile, header, sizeof(header)) != sizeof(header)
+                or std::memcmp(header, TraceFormat::MAGIC, 
+                               sizeof(TraceFormat::MAGIC)) != 0,
+             "%s is not a predictor trace", path);
+
+    uint32_t version = 0;
+    for (int i = 0; i < 4; i++) {
+        version |= (uint32_t)header[8 + i] << (8 * i);
+    }
+    fatal_if(version != TraceFormat::VERSION,
+             "Trace %s has version %d, expected %d", path, version, 
+             TraceFormat::VERSION);
+}
+
+TraceReader::~TraceReader() {
+    gzclose(this->gzfile);
+}
+
+void
+TraceReader::refill() {
+    size_t pending = this->end - this->begin;
+    std::memmove(this->buffer.data(), this->buffer.data() + this->begin, 
+                 pending);
+    this->begin = 0;
+    this->end = pending;
+
+    int len = gzread(this->gzfile, this->buffer.data() + this->end,
+                     this->buffer.size() - this->end);
+    fatal_if(len < 0, "Failed reading the trace");
+    if (len == 0) {
+        this->eof = true;
+    }
+    this->end += len;
+}
+
+bool
+TraceReader::next(TraceRecord &record) {
+    while (true) {
+        size_t len = this->codec.decode(this->buffer.data() + this->begin,
+                                        this->end - this->begin, record);
+        if (len != 0) {
+            this->begin += len;
+            return true;
+        }
+        if (this->eof) {
+            fatal_if(this->begin != this->end, "Trace ends with a partial "
+                     "record");
+            return false;
+        }
+        refill();
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef SHIFTLAB_TRACE_READER_H__
+#define SHIFTLAB_TRACE_READER_H__
+
+#include <zlib.h>
+
+#include <string>
+#include <vector>
+
+#include "mem/predictor/TraceFormat.hh"
+
+/**
+ * Reads back a trace written by TraceWriter, compressed or not.
+ */
+class TraceReader {
+private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    gzFile gzfile = nullptr;
+    TraceCodec codec;
+
+    std::vector<uint8_t> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+
+    /* Reads more of the file after the unconsumed bytes */
+    void refill();
+
+public:
+    explicit TraceReader(const std::string &path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader &) = delete;
+    TraceReader &operator=(const TraceReader &) = delete;
+
+    /**
+     * @return false once the trace is exhausted
+     */
+    bool next(TraceRecord &record);
+};
+
+#endif // SHIFTLAB_TRACE_READER_H__
@@ -0,0 +1,137 @@
+#include "mem/predictor/TraceWriter.hh"
+
+#include "base/logging.hh"
+
+const size_t TraceWriter::DEFAULT_BLOCK_SIZE;
+const size_t TraceWriter::DEFAULT_BLOCK_COUNT;
+
+TraceWriter::TraceWriter(const std::string &path, Compression compression,
+                         size_t blockSize, size_t blockCount)
+        : blocks(blockCount) {
+    fatal_if(blockCount < 2, "Trace writer needs at least two blocks");
+    fatal_if(blockSize < TraceFormat::MAX_RECORD_SIZE,
+             "Trace block of %d bytes cannot hold a record", blockSize);
+
+    for (Block &block : this->blocks) {
+        block.data.resize(blockSize);
+    }
+
+    if (compression == Compression::GZIP) {
+        /* Favour speed, the trace is written while simulating */
+        this->gzfile = gzopen(path.c_str(), "wb1");
+        fatal_if(this->gzfile == nullptr, "Unable to open trace %s", path);
+    } else {
+        this->file = std::fopen(path.c_str(), "wb");
+        fatal_if(this->file == nullptr, "Unable to open trace %s", path);
+    }
+
+    uint8_t header[TraceFormat::HEADER_SIZE] = {};
+    std::memcpy(header, TraceFormat::MAGIC, sizeof(TraceFormat::MAGIC));
+    for (int i = 0; i < 4; i++) {
+        header[8 + i] = TraceFormat::VERSION >> (8 * i);
+    }
+    write_out(header, sizeof(header));
+
+    this->flusher = std::thread(&TraceWriter::flush_loop, this);
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+void
+TraceWriter::write(const TraceRecord &record) {
+    panic_if(this->closed, "Write to a closed trace");
+
+    Block *block = &this->blocks[this->head];
+    if (block->data.size() - block->used < TraceFormat::MAX_RECORD_SIZE) {
+        submit();
+        block = &this->blocks[this->head];
+    }
+
+    size_t len = this->codec.encode(record, block->data.data() + block->used);
+    block->used += len;
+    this->encodedBytes += len;
+    this->recordCount++;
+}
+
+void
+TraceWriter::submit() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->blocks[this->head].full = true;
+    this->blockFull.notify_one();
+
+    this->head = (this->head + 1) % this->blocks.size();
+    this->blockFree.wait(lock, [this] {
+        return not this->blocks[this->head].full;
+    });
+    this->blocks[this->head].used = 0;
+}
+
+void
+TraceWriter::flush_loop() {
+    while (true) {
+        Block *block;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->blockFull.wait(lock, [this] {
+                return this->closing or this->blocks[this->tail].full;
+            });
+            /* Blocks are submitted in order, nothing left once the next one
+               is not full */
+            if (not this->blocks[this->tail].full) {
+                return;
+            }
+            block = &this->blocks[this->tail];
+        }
+
+        write_out(block->data.data(), block->used);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            block->full = false;
+            this->tail = (this->tail + 1) % this->blocks.size();
+        }
+        this->blockFree.notify_one();
+    }
+}
+
+void
+TraceWriter::write_out(const uint8_t *data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    if (this->gzfile) {
+        fatal_if(gzwrite(this->gzfile, data, len) != (int)len,
+                 "Failed writing the trace");
+    } else {
+        fatal_if(std::fwrite(data, 1, len, this->file) != len,
+                 "Failed writing the trace");
+    }
+}
+
+void
+TraceWriter::close() {
+    if (this->closed) {
+        return;
+    }
+    this->closed = true;
+
+    if (this->blocks[this->head].used != 0) {
+        submit();
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->closing = true;
+    }
+    this->blockFull.notify_one();
+    this->flusher.join();
+
+    if (this->gzfile) {
+        gzclose(this->gzfile);
+        this->gzfile = nullptr;
+    } else {
+        std::fclose(this->file);
+        this->file = nullptr;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef SHIFTLAB_TRACE_WRITER_H__
+#define SHIFTLAB_TRACE_WRITER_H__
+
+#include <zlib.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mem/predictor/TraceFormat.hh"
+
+/**
+ * Writes TraceRecords to a binary trace file without blocking the simulation
+ * on file I/O. Records are encoded into a ring of blocks, a full block is
+ * handed to a background thread that writes (and optionally compresses) it.
+ * The simulation thread only waits if every block is waiting to be written.
+ */
+class TraceWriter {
+public:
+    enum class Compression { NONE, GZIP };
+
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+    static const size_t DEFAULT_BLOCK_COUNT = 8;
+
+private:
+    struct Block {
+        std::vector<uint8_t> data;
+        size_t used = 0;
+        /* Waiting for the flush thread, owned by it while set */
+        bool full = false;
+    };
+
+    std::vector<Block> blocks;
+    /* Block being filled by the simulation thread */
+    size_t head = 0;
+    /* Next block the flush thread writes */
+    size_t tail = 0;
+
+    std::mutex mutex;
+    std::condition_variable blockFull;
+    std::condition_variable blockFree;
+    std::thread flusher;
+    bool closing = false;
+    bool closed = false;
+
+    FILE *file = nullptr;
+    gzFile gzfile = nullptr;
+
+    TraceCodec codec;
+    uint64_t recordCount = 0;
+    uint64_t encodedBytes = 0;
+
+    /* Hands the head block to the flush thread and moves to the next one */
+    void submit();
+    void flush_loop();
+    void write_out(const uint8_t *data, size_t len);
+
+public:
+    TraceWriter(const std::string &path, Compression compression,
+                size_t blockSize = DEFAULT_BLOCK_SIZE,
+                size_t blockCount = DEFAULT_BLOCK_COUNT);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    void write(const TraceRecord &record);
+
+    /* Writes out the pending records and closes the file, idempotent */
+    void close();
+
+    uint64_t get_record_count() const { return this->recordCount; }
+    /* Size of the trace before compression, without the header */
+    uint64_t get_encoded_bytes() const { return this->encodedBytes; }
+};
+
+#endif // SHIFTLAB_TRACE_WRITER_H__
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "mem/predictor/TraceReader.hh"
+#include "mem/predictor/TraceWriter.hh"
+
+namespace {
+
+std::string
+temp_path(const char *suffix) {
+    return std::string("/tmp/pmweaver_trace_test_")
+            + std::to_string(getpid()) + suffix;
+}
+
+std::vector<TraceRecord>
+make_records(size_t count) {
+    std::vector<TraceRecord> result;
+    for (size_t i = 0; i < count; i++) {
+        TraceRecord record;
+        record.pc = 0x401000 + (i % 7) * 0x10;
+        /* Jump between volatile and persistent addresses */
+        record.addr = (i % 3 == 0 ? 0x10000000000ull : 0x7ffd0000ull) + i * 8;
+        record.persistent = i % 3 == 0;
+        record.paddr = 0x200000000ull + (record.addr & 0xfffff);
+        record.tick = 1000 * i + (i % 5);
+        /* Two hardware threads, some requests without a context */
+        record.contextId = i % 5 == 4 ? InvalidContextID : i % 2;
+        if (i % 11 == 0) {
+            record.isClwb = true;
+            record.size = 1;
+        } else {
+            record.size = i % 2 == 0 ? 8 : 4;
+            uint64_t val = i * 0x9e3779b97f4a7c15ull;
+            record.set_data((const uint8_t *)&val, record.size);
+        }
+        result.push_back(record);
+    }
+    /* Cacheline sized write and a size without a size class */
+    TraceRecord line;
+    line.addr = 0x10000000040ull;
+    line.size = 64;
+    for (size_t i = 0; i < 64; i++) {
+        line.data[i] = i;
+    }
+    line.hasData = true;
+    result.push_back(line);
+
+    TraceRecord roi;
+    roi.kind = TraceRecord::Kind::ROI_END;
+    roi.tick = 4;
+    result.push_back(roi);
+
+    TraceRecord odd;
+    odd.pc = 0x1234;
+    odd.size = 2;
+    odd.tick = 5;
+    result.push_back(odd);
+    return result;
+}
+
+void
+expect_same(const TraceRecord &exp, const TraceRecord &act) {
+    EXPECT_EQ(exp.kind, act.kind);
+    EXPECT_EQ(exp.isClwb, act.isClwb);
+    EXPECT_EQ(exp.persistent, act.persistent);
+    EXPECT_EQ(exp.hasData, act.hasData);
+    EXPECT_EQ(exp.pc, act.pc);
+    EXPECT_EQ(exp.addr, act.addr);
+    EXPECT_EQ(exp.paddr, act.paddr);
+    EXPECT_EQ(exp.size, act.size);
+    EXPECT_EQ(exp.tick, act.tick);
+    EXPECT_EQ(exp.contextId, act.contextId);
+    if (exp.hasData) {
+        EXPECT_EQ(0, std::memcmp(exp.data, act.data, exp.size));
+    }
+}
+
+void
+round_trip(TraceWriter::Compression compression, const char *suffix) {
+    std::string path = temp_path(suffix);
+    auto records = make_records(5000);
+
+    {
+        /* Small blocks so the flush thread cycles through the ring */
+        TraceWriter writer(path, compression, 256, 2);
+        for (auto &record : records) {
+            writer.write(record);
+        }
+        EXPECT_EQ(records.size(), writer.get_record_count());
+    }
+
+    TraceReader reader(path);
+    TraceRecord record;
+    size_t count = 0;
+    while (reader.next(record)) {
+        ASSERT_LT(count, records.size());
+        expect_same(records[count], record);
+        count++;
+    }
+    EXPECT_EQ(records.size(), count);
+    std::remove(path.c_str());
+}
+
+} // anonymous namespace
+
+TEST(TraceWriterTest, VarintRoundTrip)
+{
+    const int64_t vals[] = {0, 1, -1, 63, -64, 1 << 20, INT64_MAX, INT64_MIN};
+    for (int64_t val : vals) {
+        uint8_t buf[10];
+        size_t len = TraceFormat::put_varint(buf, TraceFormat::zigzag(val));
+        uint64_t out;
+        EXPECT_EQ(len, TraceFormat::get_varint(buf, len, out));
+        EXPECT_EQ(val, TraceFormat::unzigzag(out));
+        /* Truncated varints are not decoded */
+        EXPECT_EQ(0u, TraceFormat::get_varint(buf, len - 1, out));
+    }
+}
+
+TEST(TraceWriterTest, RoundTripUncompressed)
+{
+    round_trip(TraceWriter::Compression::NONE, ".bin");
+}
+
+TEST(TraceWriterTest, RoundTripGzip)
+{
+    round_trip(TraceWriter::Compression::GZIP, ".bin.gz");
+}
+
+TEST(TraceWriterTest, SmallStoresEncodeCompactly)
+{
+    std::string path = temp_path(".small");
+    TraceWriter writer(path, TraceWriter::Compression::NONE);
+
+    TraceRecord record;
+    record.pc = 0x401000;
+    record.size = 8;
+    uint64_t val = 0;
+    record.set_data((const uint8_t *)&val, 8);
+    for (int i = 0; i < 100; i++) {
+        record.addr = 0x7ffd0000 + i * 8;
+        record.tick += 500;
+        writer.write(record);
+    }
+    writer.close();
+
+    /* flags + 4 one or two byte deltas + 8 data bytes, the text dump used
+       ~80 bytes per store */
+    EXPECT_LE(writer.get_encoded_bytes(), 100u * 15 + 12);
+    std::remove(path.c_str());
+}
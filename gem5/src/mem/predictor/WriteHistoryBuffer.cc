@@ -72,4 +72,62 @@ size_t WriteHistoryBufferEntry::get_size() const {
 void WriteHistoryBufferEntry::set_size(size_t size) {
     this->size = size;
     this->hasSize = true;
-}
\ No newline at end of file
+}
+
+/*--- Class: WriteHistoryBuffer ---*/
+
+void WriteHistoryBuffer::index_add(IndexList &list, uint64_t seq, int offset) {
+    /* Only the first offset of a key in an entry is indexed */
+    if (list.empty() or list.back().first != seq) {
+        list.push_back(IndexEntry(seq, offset));
+    }
+}
+
+void WriteHistoryBuffer::index_entry(const WriteHistoryBufferEntry &entry, 
+                                     uint64_t seq) {
+    CacheLine cacheline = entry.get_cacheline();
+    CacheLine::ChunkArray chunks = cacheline.get_datachunks();
+
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        if (chunks[i].get_chunk_type() != ChunkInfo::ChunkType::DATA) {
+            continue;
+        }
+        index_add(this->dataIndex[chunks[i].get_data()], seq, i);
+
+        /**
+         * Address are stored with reversed half words, see 
+         * CacheLine::get_addr_offset()
+         */
+        if (i < DATA_CHUNK_COUNT-1 
+                and chunks[i+1].get_chunk_type() == ChunkInfo::ChunkType::DATA) {
+            Addr_t addr = ((Addr_t)chunks[i+1].get_data() << 32UL) 
+                        | (uint32_t)cacheline_align(chunks[i].get_data());
+            index_add(this->addrIndex[addr], seq, i);
+        }
+    }
+}
+
+void WriteHistoryBuffer::unindex_entry(const WriteHistoryBufferEntry &entry, 
+                                       uint64_t seq) {
+    CacheLine cacheline = entry.get_cacheline();
+    CacheLine::ChunkArray chunks = cacheline.get_datachunks();
+
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        if (chunks[i].get_chunk_type() != ChunkInfo::ChunkType::DATA) {
+            continue;
+        }
+        index_remove(this->dataIndex, chunks[i].get_data(), seq);
+
+        if (i < DATA_CHUNK_COUNT-1 
+                and chunks[i+1].get_chunk_type() == ChunkInfo::ChunkType::DATA) {
+            Addr_t addr = ((Addr_t)chunks[i+1].get_data() << 32UL) 
+                        | (uint32_t)cacheline_align(chunks[i].get_data());
+            index_remove(this->addrIndex, addr, seq);
+        }
+    }
+}
+
+bool WriteHistoryBuffer::remove() {
+    unindex_entry(this->get_front(), this->nextSeq - this->get_size());
+    return Parent::remove();
+}
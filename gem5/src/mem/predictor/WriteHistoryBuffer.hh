@@ -13,6 +13,8 @@
 #include <cassert>
 #include <cstdint>
 #include <deque>
+#include <unordered_map>
+#include <utility>
 
 class WriteHistoryBufferEntry {
 private:
@@ -54,7 +56,6 @@ public:
                 panic_if(i >= DATA_CHUNK_COUNT, "Buffer overflow");
                 tempCacheline.get_datachunks()[i].set_chunk_type(ChunkInfo::ChunkType::DATA);
                 tempCacheline.get_datachunks()[i].set_data(dataChunks[i-addrOffset]);
-                tempCacheline.get_datachunks()[i].set_generating_pc(pc);
                 tempCacheline.set_addr(alignedAddr);
             }
 
@@ -91,4 +92,147 @@ public:
     void set_size(size_t size);
 };
 
+/**
+ * Write history buffer that keeps a hash index over the contents of its 
+ * entries. The index maps every data value and every cacheline address 
+ * pattern stored in the buffer to the entries holding them (oldest first), 
+ * allowing lookups without scanning the complete buffer.
+ * 
+ * Entries are identified in the index using a sequence number assigned on 
+ * insertion, the position of an entry in the buffer is its sequence number 
+ * minus the sequence number of the oldest entry.
+ */
+class WriteHistoryBuffer : public FixedSizeQueue<WriteHistoryBufferEntry> {
+public:
+    /* (sequence number, chunk offset) */
+    using IndexEntry = std::pair<uint64_t, int>;
+    using IndexList = std::deque<IndexEntry>;
+private:
+    using Parent = FixedSizeQueue<WriteHistoryBufferEntry>;
+
+    /* Data chunk value -> entries holding the value */
+    std::unordered_map<DataChunk, IndexList> dataIndex;
+
+    /* Cacheline aligned address -> entries holding the address */
+    std::unordered_map<Addr_t, IndexList> addrIndex;
+
+    /* Sequence number for the next inserted entry */
+    uint64_t nextSeq = 0;
+
+    void index_entry(const WriteHistoryBufferEntry &entry, uint64_t seq);
+    void unindex_entry(const WriteHistoryBufferEntry &entry, uint64_t seq);
+
+    static void index_add(IndexList &list, uint64_t seq, int offset);
+
+    template <class U>
+    static void index_remove(std::unordered_map<U, IndexList> &index, 
+                             U key, uint64_t seq) {
+        auto list_iter = index.find(key);
+        if (list_iter == index.end() or list_iter->second.empty() 
+                or list_iter->second.front().first != seq) {
+            return;
+        }
+        list_iter->second.pop_front();
+        if (list_iter->second.empty()) {
+            index.erase(list_iter);
+        }
+    }
+
+    size_t seq_to_index(uint64_t seq) {
+        return seq - (this->nextSeq - this->get_size());
+    }
+
+    /**
+     * Finds the oldest entry in list accepted by the filter.
+     * @return index of the entry in the buffer, -1 if none was accepted
+     */
+    template <class Filter>
+    int find_in_list(const IndexList *list, int &offset, Filter filter) {
+        if (list == nullptr) {
+            return -1;
+        }
+        for (const IndexEntry &indexEntry : *list) {
+            size_t index = seq_to_index(indexEntry.first);
+            if (filter(this->get(index))) {
+                offset = indexEntry.second;
+                return index;
+            }
+        }
+        return -1;
+    }
+
+    template <class U>
+    static const IndexList *lookup(const std::unordered_map<U, IndexList> &index, 
+                                   U key) {
+        auto list_iter = index.find(key);
+        return list_iter == index.end() ? nullptr : &list_iter->second;
+    }
+public:
+    WriteHistoryBuffer(std::string parentName, size_t size)
+        : Parent(parentName, size) {}
+
+    /**
+     * Constructs a new entry in place and adds it to the index, the oldest
+     * entry is evicted from the buffer and the index if the buffer is full.
+     */
+    template <class... Args>
+    WriteHistoryBufferEntry &emplace_back(Args&&... args) {
+        if (this->get_size() == this->get_max_size()) {
+            unindex_entry(this->get_front(), this->nextSeq - this->get_size());
+        }
+
+        uint64_t seq = this->nextSeq++;
+        WriteHistoryBufferEntry &entry 
+                = Parent::emplace_back(std::forward<Args>(args)...);
+        index_entry(entry, seq);
+        return entry;
+    }
+
+    bool push_back(const WriteHistoryBufferEntry &elem) {
+        this->emplace_back(elem);
+        return true;
+    }
+
+    bool remove() override;
+
+    /**
+     * Finds the oldest entry accepted by the filter that contains the 
+     * cacheline address of addr, results are identical to calling 
+     * CacheLine::get_addr_offset(addr) on every entry from the oldest.
+     * @param offset Set to the chunk offset of the address in the entry
+     * @return index of the entry in the buffer, -1 if not found
+     */
+    template <class Filter>
+    int find_addr(Addr_t addr, int &offset, Filter filter) {
+        return find_in_list(lookup(this->addrIndex, cacheline_align(addr)), 
+                            offset, filter);
+    }
+
+    /**
+     * Finds the oldest entry accepted by the filter that contains data, 
+     * results are identical to calling CacheLine::get_data_offset(data) on 
+     * every entry from the oldest.
+     * @param offset Set to the first chunk offset of data in the entry
+     * @return index of the entry in the buffer, -1 if not found
+     */
+    template <class Filter>
+    int find_data(DataChunk data, int &offset, Filter filter) {
+        return find_in_list(lookup(this->dataIndex, data), offset, filter);
+    }
+
+    /**
+     * Calls fn(index, offset) for every entry containing data, oldest first.
+     */
+    template <class Fn>
+    void for_each_data(DataChunk data, Fn fn) {
+        const IndexList *list = lookup(this->dataIndex, data);
+        if (list == nullptr) {
+            return;
+        }
+        for (const IndexEntry &indexEntry : *list) {
+            fn(seq_to_index(indexEntry.first), indexEntry.second);
+        }
+    }
+};
+
 #endif // SHIFTLAB_WRITE_HISTORY_BUFFER_H__
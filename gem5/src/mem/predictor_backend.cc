@@ -50,6 +50,7 @@
 
 
 
+#include "base/callback.hh"
 #include "base/trace.hh"
 #include "debug/ConstantPrediction.hh"
 #include "debug/PredictorBackendInterface.hh"
@@ -60,10 +61,11 @@
 #include "mem/predictor/Common.hh"
 #include "mem/predictor/Constants.hh"
 #include "mem/predictor/Declarations.hh"
-#include "mem/predictor/SharedArea.hh"
 #include "mem/predictor_backend.hh"
+#include "mem/predictor_frontend.hh"
 #include "params/PredictorBackend.hh"
 #include "mem/cache/cache.hh"
+#include "sim/core.hh"
 #include <type_traits>
 
 #define P_WRITE_VADDR_PADDR_COMP_MASK (0b111111111111)
@@ -95,7 +97,10 @@ PredictorBackend::PredictorBackend(Params *p)
       slavePort(p->name + ".slave", *this, masterPort,
                 ticksToCycles(p->delay), p->resp_size, p->ranges),
       masterPort(p->name + ".master", *this, slavePort,
-                 ticksToCycles(p->delay), p->req_size)
+                 ticksToCycles(p->delay), p->req_size),
+      completedWrites(1),
+      receiveEvent([this]{ receivePredictions(); scheduleReceive(); },
+                   p->name + ".receiveEvent")
 {
     
         auto parentName = p->name;
@@ -148,6 +153,12 @@ PredictorBackend::PredictorBackend(Params *p)
         resultBufferCapacityEvictions
             .name(parentName + ".resultBufferCapacityEvictions")
             .desc("Capacity eviction of the result buffer (per address).");
+        resultBufferOccupancy
+            .name(parentName + ".resultBufferOccupancy")
+            .desc("Average number of predictions in the result buffer");
+        resultBufferFreeOccupancy
+            .name(parentName + ".resultBufferFreeOccupancy")
+            .desc("Average number of free predictions in the result buffer");
         addrMatchDist
             .name(parentName + ".get_time_of_addr_gen")
             .desc("aksdjnklfjnabskldfnlkakd jlkfad jjlkf aslkdfj lkads jlkadsj fdkjjah l")
@@ -183,36 +194,58 @@ PredictorBackend::PredictorBackend(Params *p)
             .name(p->name + ".writebackDistStatMicro")
             .desc("writebackDistStat")
             .init(0, 1000, 1);
-
-        usePredictor = get_env_val("USE_PREDICTOR");
-
-        char* envResult = std::getenv("ENABLE_NON_VOLATILE_DUMP");
-    
-        if (envResult != nullptr) {
-            this->enableNonVolatileDump = std::string(envResult);
-        } else {
-            enableNonVolatileDump = "0";
+        receivedPredictions
+            .name(p->name + ".receivedPredictions")
+            .desc("Predictions received from the frontends");
+        droppedFeedback
+            .name(p->name + ".droppedFeedback")
+            .desc("Feedback messages dropped because the channel to the "
+                  "frontend was full");
+
+        usePredictor = p->use_predictor;
+        this->disableInvalidation = p->disable_invalidation;
+        if (p->non_volatile_dump != "") {
+            writebackTrace = new TraceWriter(
+                    p->non_volatile_dump,
+                    p->non_volatile_dump_compression == Enums::gzip
+                        ? TraceWriter::Compression::GZIP
+                        : TraceWriter::Compression::NONE);
+        }
+        if (p->snapshot != "") {
+            snapshot = new SnapshotWriter(
+                    p->snapshot,
+                    p->snapshot_trigger == Enums::event_period
+                        ? SnapshotWriter::Trigger::EVENTS
+                        : SnapshotWriter::Trigger::TICKS,
+                    p->snapshot_period);
+        }
+        if (writebackTrace != nullptr or snapshot != nullptr) {
+            /* The destructor is not called on exit */
+            registerExitCallback(
+                new MakeCallback<PredictorBackend,
+                                 &PredictorBackend::closeTrace>(this));
         }
-        myFile.open("/ramdisk/nonvolatiledump.txt");
-        hashStats.open("./hash.stats");
 
         std::cout << "Can't believe it's running!" << std::endl;
         std::cerr << "usePredictor = " << usePredictor << std::endl;
 
-        SharedArea::init_size_multiplier();
-        PredictorBackend::RESULT_BUFFER_MAX_SIZE *= SharedArea::sizeMultiplier;
-        PredictorBackend::MAX_COMPLETED_QUEUE_LINE_SIZE *= SharedArea::sizeMultiplier;
+        this->resultBufferMaxSize *= p->size_multiplier;
+        this->maxCompletedQueueLineSize *= p->size_multiplier;
 
-	if (PredictorBackend::MAX_COMPLETED_QUEUE_LINE_SIZE < 1) {
-	    PredictorBackend::MAX_COMPLETED_QUEUE_LINE_SIZE = 1;
-	}
+        if (this->maxCompletedQueueLineSize < 1) {
+            this->maxCompletedQueueLineSize = 1;
+        }
+        if (this->resultBufferMaxSize < 1) {
+            this->resultBufferMaxSize = 1;
+        }
+        this->completedWrites.resize(this->resultBufferMaxSize);
         
-        std::cout << "Using result buffer max size = " << PredictorBackend::RESULT_BUFFER_MAX_SIZE << std::endl;
+        std::cout << "Using chunk compare kernel = " << ChunkCompare::get_impl_name() << std::endl;
+        std::cout << "Using result buffer max size = " << this->resultBufferMaxSize << std::endl;
 
 }
 
 PredictorBackend::~PredictorBackend() {
-    this->resultBufferCapacityEvictions = PredictorBackend::capacityEvictionStatic;
 }
 
 Port &
@@ -266,6 +299,12 @@ PredictorBackend::PBMasterPort::recvTimingResp(PacketPtr pkt)
     Tick receive_delay = pkt->headerDelay + pkt->payloadDelay;
     pkt->headerDelay = pkt->payloadDelay = 0;
 
+    // The frontend that sent the CLWB waits for its BMO latency
+    if (pkt->req->isToPOC() and pkt->req->getSize() == 1
+            and pkt->req->hasPaddr()) {
+        pb.sendClwbLatency(pkt->req->getPaddr());
+    }
+
     slavePort.schedTimingResp(pkt, pb.clockEdge(delay) +
                               receive_delay);
 
@@ -280,7 +319,8 @@ PredictorBackend::PBSlavePort::recvTimingReq(PacketPtr pkt)
     }
 
 
-    pb.resultBufferCapacityEvictions = PredictorBackend::capacityEvictionStatic;
+    pb.resultBufferOccupancy = pb.completedWrites.size();
+    pb.resultBufferFreeOccupancy = pb.completedWrites.free_size();
     /* Handle the request in the predictor backend */
     pb.predictorHandleRequest(pkt);
 
@@ -547,20 +587,6 @@ PredictorBackendParams::create()
     return new PredictorBackend(this);
 }
 
-Addr
-PredictorBackend::getCompletedAddrToEvict() {
-    panic_if(completedWritesManager.empty(), "Queue empty, 🤔 ");
-
-    std::pair<Addr, Tick> oldest = *completedWritesManager.cbegin();
-    for (auto entry : completedWritesManager) {
-        if (oldest.second > entry.second) {
-            oldest.first = entry.first;     // Address
-            oldest.second = entry.second;   // Tick
-        }
-    }
-    return oldest.first;
-}
-
 void 
 PredictorBackend::addCompletedWrite(CompletedWriteEntry entry) {
     
@@ -573,165 +599,46 @@ PredictorBackend::addCompletedWrite(CompletedWriteEntry entry) {
         /* Cache hits for the meta data caches are set here while the actual access is done from the DRAMCtrl */
         Addr addr = entry.get_addr(), paddr = 0;
         EmulationPageTable::pageTableStaticObj->translate(addr, paddr);
-        PredictorBackend::addrMatches[paddr]++;
+        this->addrMatches[paddr]++;
         // paddr = getCompWriteKey(entry.get_addr());
         // std::cout << "Trying to insert addresss = " << print_ptr(16) << paddr << std::endl;
         // std::cout << "Changing address from " << (void*)entry.get_addr() << " to " << (void*)paddr << std::endl;
         entry.set_addr(paddr);
-        bool isCounterCacheHit = DRAMCtrl::isCounterCacheHit(paddr);
-        entry.set_counter_cache_hit(isCounterCacheHit);
-        bool isVerificationCacheHit = DRAMCtrl::isVerificationCacheHit(paddr);
-        entry.set_verification_cache_hit(isVerificationCacheHit);
-
-
-        DRAMCtrl::pendingPredictionQueue.push_back(entry);
-
-        // DPRINTFR(PredictorBackendLogic, "Inserting new prediction for address %p and cacheline %s\n", paddr, entry.get_cacheline().to_string());
-	completedWrites[paddr].push_back(entry);
-
-        /* Insert the entry to the manager to find the LRU order for eviction */
-        // completedWritesManager[paddr] = curTick();
-
-        /* Line has exceeded its capactiy */
-        if (completedWrites.at(paddr).size() >= PredictorBackend::MAX_COMPLETED_QUEUE_LINE_SIZE + 1) {
-            auto entryToEvict = completedWrites[paddr].front();
-
-            std::stringstream evictCl;
-            evictCl << completedWrites[paddr].front().get_cacheline();
-            // DPRINTFR(PredictorBackendLogic, "Capacity evicting cacheline with data = %s\n", evictCl.str());
-
-            completedWrites[paddr].pop_front();
-
-            /* send feedback */
-            PredictorBackend::broadcastPrediction(entryToEvict.get_generator_hash(), false, false);
-            PredictorBackend::capacityEvictionStatic++;
-            std::cout << "Evicting (╯°□°）╯︵ ┻━┻" << std::endl;
+        DRAMCtrl *memCtrl = this->findMemCtrl(paddr);
+        if (memCtrl != nullptr) {
+            entry.set_counter_cache_hit(memCtrl->isCounterCacheHit(paddr));
+            entry.set_verification_cache_hit(
+                    memCtrl->isVerificationCacheHit(paddr));
+            memCtrl->pendingPredictionQueue.push_back(entry);
         }
 
-        // /* The table has exceeded it's capacity */
-        // if (completedWrites.size() == PredictorBackend::RESULT_BUFFER_MAX_SIZE) {
-        //     /* Find the oldest entry */
-        //     Addr oldestEntry = PredictorBackend::getCompletedAddrToEvict();
-        //     panic_if(oldestEntry == 0, "Something went wrong");
-
-        //     /* Delete the entry from the table */
-        //     PredictorBackend::completedWrites.erase(oldestEntry);
+        // DPRINTFR(PredictorBackendLogic, "Inserting new prediction for address %p and cacheline %s\n", paddr, entry.get_cacheline().to_string());
 
-        //     /* Update the entry from the manager */
-        //     PredictorBackend::completedWritesManager.erase(oldestEntry);
-        // }
-        
-        /* Remove all the empty queues from the completed writes table */
-        std::deque<Addr> addrToRemove;
-        for (auto entry : completedWrites) {
-            if (entry.second.empty()) {
-                // std::cout << "Removing entry at " << entry.first << std::endl;
-                addrToRemove.push_back(entry.first);
-            }
+        /* Line is at its capacity, drop its oldest prediction */
+        if (completedWrites.line_size(paddr) >= this->maxCompletedQueueLineSize) {
+            ResultBuffer::Node *nodeToEvict = completedWrites.oldest(paddr);
+            completedWrites.erase(nodeToEvict);
+            this->resultBufferCapacityEvictions++;
+            DPRINTFR(PredictorBackendLogic, "Capacity evicting the oldest "
+                    "prediction for %p\n", (void*)paddr);
         }
 
-        for (auto addr : addrToRemove) {
-            panic_if_not(PredictorBackend::completedWrites.at(addrToRemove.front()).empty());
-            PredictorBackend::completedWrites.erase(addrToRemove.front());
-            addrToRemove.pop_front();
+        /* The table is at its capacity, drop the oldest prediction */
+        if (completedWrites.full()) {
+            ResultBuffer::Node *nodeToEvict = completedWrites.oldest();
+            DPRINTFR(PredictorBackendLogic, "Removed the oldest entry, at "
+                     "address %p\n", (void*)nodeToEvict->paddr);
+            completedWrites.erase(nodeToEvict);
+            this->resultBufferCapacityEvictions++;
         }
 
-        // printf("Write manager size is not equal to the completed write table, "
-        //      "completedWritesManger.size() = %d, completedWrites.size() = %d\n", 
-        //      completedWritesManager.size(), completedWrites.size());
-
-        // if (completedWritesManager.size() != completedWrites.size()) {
-        //     std::cout << "Printing manager" << std::endl;
-        //     for (auto entry :  completedWritesManager) {
-        //         std::cout << entry.first << std::endl;
-        //     }
-
-        //     std::cout << "Pringin completed writes" << std::endl;
-        //     for (auto entry :  completedWrites) {
-        //         std::cout << entry.first << std::endl;
-        //     }
-        // }
-
-        // panic_if(completedWritesManager.size() > PredictorBackend::RESULT_BUFFER_MAX_SIZE,  "Write manager entry count exceeded expectation.");
-        // panic_if(completedWritesManager.size() != completedWrites.size(),                   "Write manager size is not equal to the completed write table, completedWritesManger.size() = %d, completedWrites.size() = %d", completedWritesManager.size(), completedWrites.size());
-        // panic_if(completedWrites.size() > RESULT_BUFFER_MAX_SIZE,                           "Result buffer size exceeds maximum size");
-        panic_if(completedWrites.at(paddr).size() > MAX_COMPLETED_QUEUE_LINE_SIZE, "Inconsistent size");
-	
-	/* Calculate the total number of entries and perform random eviction
-	   of one of the single entry row*/
-	uint64_t totalEntries = 0;
-	uint64_t freeEntries = 0;
-	std::cout << "Current table Size = ";
-	for (auto compWriteQ : PredictorBackend::completedWrites) {
-	    totalEntries += compWriteQ.second.size();
-	    // std::cout << compWriteQ.second.size() << " age = " << double(curTick()-compWriteQ.second.front().get_time_of_addr_gen()) << ", ";
-	    
-	    for (auto write : compWriteQ.second) {
-            if (write.get_cacheline().get_datachunks()[0].is_free_prediction()) {
-                freeEntries++;
-            }
-	    }
-	    
-	}
-	PredictorBackend::resultBufferSize << " <-> " << totalEntries << std::endl;
-	PredictorBackend::resultBufferSize << " <-f-> " << freeEntries << std::endl;
-	
-	uint64_t oldestAddr = 0;
-	uint64_t oldestTick = UINT64_MAX;
-	uint64_t oldestIndex = 0;
-	if (totalEntries > RESULT_BUFFER_MAX_SIZE) {
-	    for (auto compWriteQ : PredictorBackend::completedWrites) {
-		uint64_t curIndex = 0;
-		for (auto write : compWriteQ.second) {
-
-		    if (25000000 < (curTick() - write.get_time_of_creation())
-                    and write.get_cacheline().get_datachunks()[0].is_free_prediction()) {
-
-                oldestTick = write.get_time_of_creation();
-                oldestAddr = compWriteQ.first;
-                oldestIndex = curIndex;
-		    }
-
-
-		    if (3*10000000 < (curTick() - write.get_time_of_creation())
-                    and not write.get_cacheline().get_datachunks()[0].is_free_prediction()) {
-
-                oldestTick = write.get_time_of_creation();
-                oldestAddr = compWriteQ.first;
-                oldestIndex = curIndex;
-		    }
-
-		    curIndex++;
-		}
-	    }
-	}
-	if (oldestAddr != 0) {
-	    std::cout << "Removed entry at address " << (void*)oldestAddr
-		      << (curTick() - oldestTick) << std::endl;
-	    PredictorBackend::completedWrites.erase(oldestAddr);
-        PredictorBackend::capacityEvictionStatic++;
-	}
-	
-	// std::vector<uint64_t> indexSingleEntr;
-	// if (PredictorBackend::completedWrites.size() > RESULT_BUFFER_MAX_SIZE) {
-	//     /* Find the oldest entry to delete */
-	//     for (auto compWriteQ : PredictorBackend::completedWrites) {
-	// 	if (compWriteQ.second.size() == 1) {
-	// 	    indexSingleEntr.push_back(compWriteQ.first);
-	// 	}
-	//     }
-	// }
-	// if (indexSingleEntr.size() > 0) {
-        //     panic_if(PredictorBackend::completedWrites.find(indexSingleEntr.back())
-	// 	     == PredictorBackend::completedWrites.end(), "Entry should exist");
-        //     PredictorBackend::completedWrites.erase(indexSingleEntr.back());
-	//     std::cout << "Removed entry at " << indexSingleEntr.back() << std::endl;
-	// }	    
+        completedWrites.push_back(paddr, entry);
+        panic_if(completedWrites.line_size(paddr) > this->maxCompletedQueueLineSize, "Inconsistent size");
     }
 }
 
 bool
-PredictorBackend::isPktEqualCompletedEntryAddr(PacketPtr pkt, CompletedWriteEntry completedEntry) {
+PredictorBackend::isPktEqualCompletedEntryAddr(PacketPtr pkt, const CompletedWriteEntry &completedEntry) {
     bool result;
     
     /* Addresses should already be cache line aligned */
@@ -747,48 +654,41 @@ PredictorBackend::isPktEqualCompletedEntryAddr(PacketPtr pkt, CompletedWriteEntr
     return result;
 }
 
-size_t
-PredictorBackend::getMatchingChunkCount(PacketPtr pkt, CompletedWriteEntry completedEntry) {
-    size_t result = 0;
+ChunkMatch
+PredictorBackend::compareChunks(PacketPtr pkt, const CompletedWriteEntry &completedEntry) {
+    panic_if(pkt->getSize() != CACHELINE_SIZE, 
+                "Write at the predictro backend should be "
+                "cacheline size, is the backedn connected correctly?");
 
-    DataChunk *dataChunks = pkt->getPtr<DataChunk>();
-    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-        bool is_valid = completedEntry.get_cacheline().get_datachunks()[i].is_valid();
-        if (is_valid 
-            and dataChunks[i] != completedEntry.get_cacheline().get_datachunks()[i].get_data()) {
-            result++;
-        }
-    }
-    return result;  
-}
+    ChunkMatch result;
 
-bool
-PredictorBackend::isPktEqualCompletedEntryData(PacketPtr pkt, CompletedWriteEntry completedEntry) {
-    bool result = true;
+    const CacheLine &cacheline = completedEntry.get_cacheline();
+    /* pkt obtained by eviction of a cached eviction or write back should have all 
+       its block valid. */
+    result.match = ChunkCompare::eq_mask(cacheline.get_data_words(), 
+                                         pkt->getConstPtr<DataChunk>());
+    result.valid = cacheline.get_valid_mask();
+    result.constant = cacheline.get_const_pred_mask();
+    result.freePred = cacheline.get_free_pred_mask();
 
-    DataChunk *dataChunks = pkt->getPtr<DataChunk>();
-    auto entryDataChunks = completedEntry.get_cacheline().get_datachunks();
-    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-        /* pkt obtained by eviction of a cached eviction or write back should have all 
-           its block valid. */
-        /* Match the data only if the chunk is valid */
-        if (entryDataChunks[i].is_valid()
-                and dataChunks[i] != entryDataChunks[i].get_data()) {
-            result = false;
-            break;
-        }
-    }
+    return result;
+}
 
-    if (completedEntry.get_cacheline().all_invalid()) {
-        // std::cout << "All invalid" << std::endl;
-        result = false;
-    }
+size_t
+PredictorBackend::getMatchingChunkCount(const ChunkMatch &chunkMatch) {
+    /* Counts the valid chunks that do not match */
+    return chunkMatch.mismatch_count();
+}
 
-    return result;
+bool
+PredictorBackend::isPktEqualCompletedEntryData(PacketPtr pkt, const CompletedWriteEntry &completedEntry) {
+    /* Match the data only if the chunk is valid, an all invalid entry never 
+       matches */
+    return compareChunks(pkt, completedEntry).data_equal();
 }
 
 bool
-PredictorBackend::isPktEqualCompletedEntry(PacketPtr pkt, CompletedWriteEntry completedEntry) {
+PredictorBackend::isPktEqualCompletedEntry(PacketPtr pkt, const CompletedWriteEntry &completedEntry) {
     panic_if(pkt->getSize() != CACHELINE_SIZE, 
                 "Write at the predictro backend should be "
                 "cacheline size, is the backedn connected correctly?");
@@ -798,118 +698,198 @@ PredictorBackend::isPktEqualCompletedEntry(PacketPtr pkt, CompletedWriteEntry co
     return result;
 }
 
-void 
-PredictorBackend::broadcastPrediction(hash_t hash, bool addrPredicted, bool dataPredicted) {
-    // printf("Broadcasting signature <%p, %p> to %p\n", addrPredicted, dataPredicted, &SharedArea::correctPredictions);
-    if (addrPredicted) {
-        SharedArea::correctPredictions[hash].first++;
+void
+PredictorBackend::attachMemCtrl(DRAMCtrl *memCtrl) {
+    this->memCtrls.push_back(memCtrl);
+}
+
+DRAMCtrl *
+PredictorBackend::findMemCtrl(Addr paddr) const {
+    for (DRAMCtrl *memCtrl : this->memCtrls) {
+        if (memCtrl->getAddrRange().contains(paddr)) {
+            return memCtrl;
+        }
     }
+    return nullptr;
+}
 
-    if (dataPredicted) {
-        SharedArea::correctPredictions[hash].second++;
+Tick
+PredictorBackend::takeClwbLatency(Addr paddr) {
+    DRAMCtrl *memCtrl = this->findMemCtrl(paddr);
+    return memCtrl == nullptr ? 0 : memCtrl->takeClwbLatency(paddr);
+}
+
+void
+PredictorBackend::sendClwbLatency(Addr paddr) {
+    FeedbackMessage msg;
+    msg.kind = FeedbackMessage::Kind::CLWB_LATENCY;
+    msg.paddr = paddr;
+    msg.latency = this->takeClwbLatency(paddr);
+    /* Only the frontend waiting for the CLWB keeps the latency */
+    this->broadcastFeedback(msg);
+}
+
+PredictionChannel *
+PredictorBackend::attachFrontend(PredictorFrontend *frontend, size_t capacity,
+                                 Tick predictionLatency,
+                                 Tick feedbackLatency) {
+    this->channels.emplace_back(new PredictionChannel(
+            this->channels.size(), capacity, predictionLatency,
+            feedbackLatency));
+    this->frontends.push_back(frontend);
+    return this->channels.back().get();
+}
+
+void
+PredictorBackend::scheduleReceive() {
+    Tick next = MaxTick;
+    for (auto &channel : this->channels) {
+        next = std::min(next, channel->next_prediction_tick());
+    }
+    if (next != MaxTick) {
+        scheduleReceiveAt(next);
     }
 }
 
-void 
-PredictorBackend::update_stats_for_const_pred(CompletedWriteEntry completedEntry) {
-    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-        if (completedEntry.get_cacheline().get_datachunks()[i].is_valid()
-                and completedEntry.get_cacheline().get_datachunks()[i].is_const_0_pred()) {
-            this->correctConst0Pred++;
-        }
+void
+PredictorBackend::scheduleReceiveAt(Tick when) {
+    when = std::max(when, curTick());
+    if (not receiveEvent.scheduled()) {
+        schedule(receiveEvent, when);
+    } else if (when < receiveEvent.when()) {
+        reschedule(receiveEvent, when);
     }
 }
 
+void
+PredictorBackend::wakeReceive(Tick ready) {
+    /* The frontend may run on another event queue, take the lock of ours */
+    EventQueue::ScopedMigration migrate(eventQueue());
+    this->scheduleReceiveAt(ready);
+}
 
-std::bitset<DATA_CHUNK_COUNT>
-PredictorBackend::dataChunkMatchVec(CompletedWriteEntry completedEntry, PacketPtr pkt) {
-    std::bitset<DATA_CHUNK_COUNT> result;
+void
+PredictorBackend::receivePredictions() {
+    for (auto &channel : this->channels) {
+        this->receivedPredictions += channel->receive_predictions(curTick(),
+            [this, &channel](PredictionMessage &msg) {
+                msg.entry.set_source(channel->get_id());
+                this->addCompletedWrite(msg.entry);
+            });
+    }
+}
 
-    DataChunk *dataChunks = pkt->getPtr<DataChunk>();
-    auto entryDataChunks = completedEntry.get_cacheline().get_datachunks();
-    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-        /* pkt obtained by eviction of a cached eviction or write back should have all 
-           its block valid. */
-        /* Match the data only if the chunk is valid */
-        if (entryDataChunks[i].is_valid()
-                and dataChunks[i] == entryDataChunks[i].get_data()) {
-            result.set(i);
-        }
+void
+PredictorBackend::sendFeedback(PredictionChannel &channel,
+                               const FeedbackMessage &msg) {
+    if (not channel.send_feedback(curTick(), msg)) {
+        this->droppedFeedback++;
+        return;
     }
+    this->frontends.at(channel.get_id())->wakeFeedback(
+            curTick() + channel.get_feedback_latency());
+}
 
-    return result;
+void
+PredictorBackend::broadcastFeedback(const FeedbackMessage &msg) {
+    for (auto &channel : this->channels) {
+        sendFeedback(*channel, msg);
+    }
 }
 
-std::bitset<DATA_CHUNK_COUNT>
-PredictorBackend::dataChunkConstVec(CompletedWriteEntry completedEntry) {
-    std::bitset<DATA_CHUNK_COUNT> result;
+void 
+PredictorBackend::broadcastPrediction(const CompletedWriteEntry &entry, bool addrPredicted, bool dataPredicted) {
+    /* The frontends only learn from correct predictions */
+    if (not addrPredicted or not entry.has_source()) {
+        return;
+    }
 
-    auto entryDataChunks = completedEntry.get_cacheline().get_datachunks();
+    FeedbackMessage msg;
+    msg.kind = FeedbackMessage::Kind::CORRECT_PREDICTION;
+    msg.hash = entry.get_generator_hash();
+    msg.dataPredicted = dataPredicted;
+    sendFeedback(*this->channels.at(entry.get_source()), msg);
+}
+
+void 
+PredictorBackend::update_stats_for_const_pred(const CompletedWriteEntry &completedEntry) {
     for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-        if (entryDataChunks[i].is_valid() 
-                and entryDataChunks[i].is_constant_pred()) {
-            result.set(i);
+        if (completedEntry.get_cacheline().get_datachunks()[i].is_valid()
+                and completedEntry.get_cacheline().get_datachunks()[i].is_const_0_pred()) {
+            this->correctConst0Pred++;
         }
     }
+}
 
-    return result;
+
+std::bitset<DATA_CHUNK_COUNT>
+PredictorBackend::dataChunkMatchVec(const ChunkMatch &chunkMatch) {
+    return std::bitset<DATA_CHUNK_COUNT>(chunkMatch.valid_match());
+}
+
+std::bitset<DATA_CHUNK_COUNT>
+PredictorBackend::dataChunkConstVec(const ChunkMatch &chunkMatch) {
+    return std::bitset<DATA_CHUNK_COUNT>(chunkMatch.valid_const());
 }
 
 void 
-PredictorBackend::updatePCConf(PacketPtr pkt, CompletedWriteEntry completedEntry) {
+PredictorBackend::updatePCConf(PacketPtr pkt, const CompletedWriteEntry &completedEntry, 
+                               const ChunkMatch &chunkMatch) {
     DPRINTFR(PredictorBackendLogic, RED"==== Updating confidence for incoming packet ===="RST"\n");
-    int result = 16;
 
-    DataChunk *dataChunks = pkt->getPtr<DataChunk>();
+    const DataChunk *dataChunks = pkt->getConstPtr<DataChunk>();
     auto entryDataChunks = completedEntry.get_cacheline().get_datachunks();
-    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-        /* pkt obtained by eviction of a cached eviction or write back should have all 
-           its block valid. */
-        /* Match the data only if the chunk is valid */
-        if (entryDataChunks[i].is_valid() and not entryDataChunks[i].is_free_prediction()) {
-            PC_t targetPC = entryDataChunks[i].get_generating_pc();
-            bool exists = true;
-            if (SharedArea::genPCConf.find(targetPC) == SharedArea::genPCConf.end()) {
-                SharedArea::genPCConf.insert(
-                    std::make_pair(targetPC, Confidence(6, 7, 0))
-                );
-                DPRINTFR(PredictorBackendLogic, "%lu Initialized confidence for PC %p, new value = %d\n", curTick(), (void*)targetPC, SharedArea::genPCConf.at(targetPC)());
-                exists = false;
-            } 
-            if (dataChunks[i] != entryDataChunks[i].get_data()) {
-                SharedArea::genPCConf.at(targetPC).sub(1);
-                DPRINTFR(PredictorBackendLogic, "%d %d %lu Reducing confidence for PC %p (generated %p, expected %p), new value = %d\n", 
-                        SharedArea::genPCConf.size(), exists, curTick(), 
-                        (void*)targetPC, entryDataChunks[i].get_data(), dataChunks[i], SharedArea::genPCConf.at(targetPC)());
-            } else {
-                // SharedArea::genPCConf.at(targetPC).add(1);
-                // DPRINTFR(PredictorBackendLogic, "%d %d %lu Increasing confidence for PC %p, new value = %d\n", SharedArea::genPCConf.size(), exists, curTick(),  (void*)targetPC, SharedArea::genPCConf.at(targetPC)());
+
+    /* Only the valid chunks not predicted for free have a generating PC */
+    ChunkMask pending = chunkMatch.valid & ~chunkMatch.freePred;
+    while (pending) {
+        int i = __builtin_ctz(pending);
+        pending &= pending - 1;
+        PC_t targetPC = entryDataChunks[i].get_generating_pc();
+        bool exists = true;
+        if (this->genPCConf.find(targetPC) == this->genPCConf.end()) {
+            this->genPCConf.insert(
+                std::make_pair(targetPC, Confidence(6, 7, 0))
+            );
+            DPRINTFR(PredictorBackendLogic, "%lu Initialized confidence for PC %p, new value = %d\n", curTick(), (void*)targetPC, this->genPCConf.at(targetPC)());
+            exists = false;
+        } 
+        if (not ((chunkMatch.match >> i) & 1)) {
+            Confidence &conf = this->genPCConf.at(targetPC);
+            uint32_t oldConf = conf();
+            conf.sub(1);
+            DPRINTFR(PredictorBackendLogic, "%d %d %lu Reducing confidence for PC %p (generated %p, expected %p), new value = %d\n", 
+                    this->genPCConf.size(), exists, curTick(), 
+                    (void*)targetPC, entryDataChunks[i].get_data(), dataChunks[i], conf());
+
+            /* PCs are shared by the cores, every frontend is updated */
+            if (conf() != oldConf) {
+                FeedbackMessage msg;
+                msg.kind = FeedbackMessage::Kind::PC_CONFIDENCE;
+                msg.pc = targetPC;
+                msg.confidence = conf();
+                broadcastFeedback(msg);
             }
+        } else {
+            // this->genPCConf.at(targetPC).add(1);
+            // DPRINTFR(PredictorBackendLogic, "%d %d %lu Increasing confidence for PC %p, new value = %d\n", this->genPCConf.size(), exists, curTick(),  (void*)targetPC, this->genPCConf.at(targetPC)());
         }
     }
 }
 
 void
 PredictorBackend::invalidateAllAddr() {
-    if (not get_env_val("DISABLE_INVALIDATION")) {
+    if (not this->disableInvalidation) {
         printf("Invalidating all addresses @%lld\n", curTick());
-        for (auto entry : this->completedWrites) {
-            Addr paddr = entry.first;
-            auto &completedWritesForAddr_q = this->completedWrites[paddr];
-            auto completedWrite_iter = completedWritesForAddr_q.rbegin();
-            while (completedWrite_iter != completedWritesForAddr_q.rend()) {
-                // std::cout << "correct counter = " << correctCounter++ << std::endl;
-                auto completedEntry = *completedWrite_iter;
-                if (not completedWrite_iter->is_used()) {
-                    completedWrite_iter->set_time_of_addr_gen(curTick());
+        this->completedWrites.for_each_line(
+            [&](Addr_t paddr, ResultBuffer::Node *oldest) {
+                for (auto node = oldest; node; node = node->newer) {
+                    if (not node->entry.is_used()) {
+                        node->entry.set_time_of_addr_gen(curTick());
+                    }
                 }
-                completedWrite_iter++;
-            }
-
-            if (not this->completedWrites[paddr].empty()) {
                 invalidatedPredictions++;
-            }
-        }
+            });
     }
 }
 
@@ -917,19 +897,16 @@ void
 PredictorBackend::updateConstChunks(hash_t maxDataMatchHash, Addr_t addr, PacketPtr pkt) {
     DPRINTF(ConstantPrediction,     
             "[Const] Checking constant prediction for addr = %p\n", addr);
-    std::deque<CompletedWriteEntry> completedWritesForAddr = completedWrites.at(addr);
-
-    CompletedWriteEntry targetCompletedWrite;
-    bool writeFound = false;
-    for (auto completedWrite : completedWritesForAddr) {
-        if (completedWrite.get_generator_hash() == maxDataMatchHash) {
-            targetCompletedWrite = completedWrite;
-            writeFound = true;
+    const CompletedWriteEntry *targetEntry = nullptr;
+    for (auto node = completedWrites.oldest(addr); node; node = node->newer) {
+        if (node->entry.get_generator_hash() == maxDataMatchHash) {
+            targetEntry = &node->entry;
             break;
         }
     }
 
-    if (writeFound) {
+    if (targetEntry != nullptr) {
+        const CompletedWriteEntry &targetCompletedWrite = *targetEntry;
         std::bitset<DATA_CHUNK_COUNT> validVec;
         // std::bitset<DATA_CHUNK_COUNT> pktEqualOrig;
         std::bitset<DATA_CHUNK_COUNT> pktNoEqualPred;
@@ -950,34 +927,45 @@ PredictorBackend::updateConstChunks(hash_t maxDataMatchHash, Addr_t addr, Packet
                 /* Constant prediction */
                 if (targetCompletedWrite.get_cacheline().get_datachunks()[offset].get_data() != pkt->getPtr<DataChunk>()[offset]) {
 
-                    if (SharedArea::constPredTracker.find(maxDataMatchHash) == SharedArea::constPredTracker.end()) {
-                        SharedArea::constPredTracker[maxDataMatchHash][offset];
+                    if (this->constPredTracker.find(maxDataMatchHash) == this->constPredTracker.end()) {
+                        this->constPredTracker[maxDataMatchHash][offset];
                     }
-                    if (SharedArea::constPredTracker.at(maxDataMatchHash).find(addr) 
-                            == SharedArea::constPredTracker.at(maxDataMatchHash).end()) {
-                        SharedArea::constPredTracker.at(maxDataMatchHash)[offset];
+                    if (this->constPredTracker.at(maxDataMatchHash).find(addr) 
+                            == this->constPredTracker.at(maxDataMatchHash).end()) {
+                        this->constPredTracker.at(maxDataMatchHash)[offset];
                     }
 
                     /* Increment the match count only if the last data of this block is same as the current data */
-                    if (SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).lastData == pkt->getPtr<DataChunk>()[offset]) {
+                    if (this->constPredTracker.at(maxDataMatchHash).at(offset).lastData == pkt->getPtr<DataChunk>()[offset]) {
                         DPRINTF(ConstantPrediction, 
                                 "[Const] Incrementing constant value tracker for"
                                 "with offset = %d\n", offset);
-                        SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).constOffset = offset;
-                        SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).timesFound += 1;
-                        if (SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).timesFound == 10) {
-                            SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).timesFound = 10;
+                        this->constPredTracker.at(maxDataMatchHash).at(offset).constOffset = offset;
+                        this->constPredTracker.at(maxDataMatchHash).at(offset).timesFound += 1;
+                        if (this->constPredTracker.at(maxDataMatchHash).at(offset).timesFound == 10) {
+                            this->constPredTracker.at(maxDataMatchHash).at(offset).timesFound = 10;
                         }
                     } else {
                         DPRINTF(ConstantPrediction, "[Const] Decrementing constant value tracker with offset = %d (last = %p, current = %p)\n", 
                                     offset, 
-                                    SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).lastData,
+                                    this->constPredTracker.at(maxDataMatchHash).at(offset).lastData,
                                     pkt->getPtr<DataChunk>()[offset]);
-                        if (SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).timesFound > 0) {
-                            SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).timesFound -= 1;
+                        if (this->constPredTracker.at(maxDataMatchHash).at(offset).timesFound > 0) {
+                            this->constPredTracker.at(maxDataMatchHash).at(offset).timesFound -= 1;
                         }
-                        SharedArea::constPredTracker.at(maxDataMatchHash).at(offset).lastData = pkt->getPtr<DataChunk>()[offset];
+                        this->constPredTracker.at(maxDataMatchHash).at(offset).lastData = pkt->getPtr<DataChunk>()[offset];
                     }
+
+                    /* Path hashes are shared by the cores, every frontend is updated */
+                    const ConstChunkLocator &locator 
+                            = this->constPredTracker.at(maxDataMatchHash).at(offset);
+                    FeedbackMessage msg;
+                    msg.kind = FeedbackMessage::Kind::CONST_CHUNK;
+                    msg.hash = maxDataMatchHash;
+                    msg.offset = offset;
+                    msg.timesFound = locator.timesFound;
+                    msg.lastData = locator.lastData;
+                    broadcastFeedback(msg);
                 }
             }
         }
@@ -1016,6 +1004,9 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
     // printf("Corresponding line in L1 cache: %s\n", CacheLine(paddrCL1, Cache::l1DCacheStaticObj).to_string().c_str());
 
     this->totalPWrites++;
+    if (snapshot != nullptr and snapshot->due(curTick())) {
+        this->takeSnapshot();
+    }
 
     Addr_t paddr = pkt->req->getPaddr();
     std::stringstream predStr;
@@ -1026,7 +1017,7 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
     } else {
         DPRINTF(PredictorResult, RED "No prediction for address %p found" RST "\n", pkt->getAddr());
     }
-    if (this->completedWrites.find(paddr) == this->completedWrites.end()) {
+    if (not this->completedWrites.contains(paddr)) {
         if (DTRACE(PredictorResult)) {
             predStr << "======= Not Predicted " << std::endl;
             predStr << "For addr = " << (void*)pkt->req->getPaddr() << std::endl;
@@ -1052,7 +1043,7 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
             << ", " 
             << (pkt->req->hasPaddr() ? "0d" + std::to_string(pkt->req->getPaddr()) : "INVALID" )
             << ">, completed entry size = " 
-            << PredictorBackend::completedWrites.size() 
+            << PredictorBackend::completedWrites.line_count() 
             << std::dec
             << ", request size ="
             << pkt->getSize()
@@ -1063,29 +1054,19 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
         }
     } else {
         /* Was predicted */
-        bool addrExists = this->completedWrites.find(paddr) != this->completedWrites.end();
-
-        auto emptyQueue = std::deque<CompletedWriteEntry>();
-        auto &completedWritesForAddr_q = /* addrExists ?  */this->completedWrites[paddr]/*  : emptyQueue */;
-        int  i = 0;
-
-        size_t indexToDelete = -1;
+        /* Prediction that matched the write */
+        ResultBuffer::Node *matchedNode = nullptr;
         int maxDataMatchCount = 0;
         std::bitset<DATA_CHUNK_COUNT> theoreticalMatchVector;
         hash_t maxDataMatchHash;
 
-        /**
-         *! WARN: On reversing the order of this iterator, change the corresponding 
-         *! offset calculation after this loop
-        */
-
         /* Searchn for the non-free write predictions to upodate the statistics */
         size_t nonFreeCounter = 0;
-        for (auto write_iter = completedWritesForAddr_q.rbegin(); write_iter != completedWritesForAddr_q.rend(); write_iter++) {
+        for (auto node = this->completedWrites.newest(paddr); node; node = node->older) {
             nonFreeCounter++;
-            if (isPktEqualCompletedEntry(pkt, *write_iter) 
-                    and not write_iter->get_cacheline().get_datachunks()[0].is_free_prediction()
-                    and not write_iter->is_used()) {
+            if (isPktEqualCompletedEntry(pkt, node->entry) 
+                    and not node->entry.get_cacheline().get_datachunks()[0].is_free_prediction()
+                    and not node->entry.is_used()) {
                 this->correctlyPredNonFreeWr++;
                 // std::cerr << "&& " << write_iter->get_cacheline() << std::endl;
                 // std::cerr << "&& " << CacheLine(pkt, false) << std::endl;
@@ -1095,13 +1076,13 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
         // std::cout << "Loop terminated at non free coutner value of " << nonFreeCounter << std::endl;
         
         size_t correctCounter = 0;
-        auto completedWrite_iter = completedWritesForAddr_q.rbegin();
+        /* Newest prediction first */
+        auto node = this->completedWrites.newest(paddr);
         bool sampled = false;
-        while (completedWrite_iter != completedWritesForAddr_q.rend()) {
+        while (node != nullptr) {
             // std::cout << "correct counter = " << correctCounter++ << std::endl;
-            auto completedEntry = *completedWrite_iter;
-            hash_t confKey = completedWrite_iter->get_generator_hash();
-            this->initConf(confKey);
+            const CompletedWriteEntry &completedEntry = node->entry;
+            hash_t confKey = node->entry.get_generator_hash();
             // std::cerr << "is used? " << (completedEntry.is_used() ? "true" : "false") << std::endl;
 
             if (not completedEntry.is_used()) {
@@ -1111,28 +1092,36 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
             
             if (isPktEqualCompletedEntryAddr(pkt,  completedEntry) 
                     and not completedEntry.is_used()) {
-                avgDataMatchForAddrMatch += getMatchingChunkCount(pkt, completedEntry);
+                /* Compare once, shared by all the checks on this entry */
+                const ChunkMatch chunkMatch = compareChunks(pkt, completedEntry);
+
+                avgDataMatchForAddrMatch += getMatchingChunkCount(chunkMatch);
                 predStr << GRN "======= Predicted " RST << "\n";
                 // predStr << "For addr = " << (void*)pkt->req->getPaddr() << std::endl;
-                if (isPktEqualCompletedEntry(pkt, completedEntry)) {
+                if (chunkMatch.data_equal()) {
                     correctlyPredictedPWrites++;
                     // std::cout << "Emulating: " << "Correctly predcited address andd data" << std::endl;
                     if (completedEntry.get_cacheline().get_datachunks()[0].is_free_prediction()) {
                         correctlyPredictedFreeWrites++;
                     } else {
-                        hashStats << completedEntry.get_generator_hash() << std::endl;
-                        this->broadcastPrediction(
-                            completedEntry.get_generator_hash(), true, true);
+                        if (snapshot != nullptr) {
+                            correctHashes[completedEntry.get_generator_hash()]++;
+                        }
+                        this->broadcastPrediction(completedEntry, true, true);
                     }
 
                     this->pmWriteMatchDistance.sample((curTick() - completedEntry.get_least_time_of_gen())/1000);
                     this->dataMatchDist.sample((curTick() - completedEntry.get_time_of_data_gen())/1000);
                     // std::cout << "Updating hash = " << confKey << std::endl;
-                    // std::cout << "Old value = " << confidenceTable[confKey] << std::endl;
-                    confidenceTable[confKey] = confidenceTable[confKey] == PRED_CONFIDENCE_MAX 
-                                             ? PRED_CONFIDENCE_MAX 
-                                             : confidenceTable[confKey]+1;
-                    // std::cout << "New value = " << confidenceTable[confKey] << std::endl;
+                    if (completedEntry.has_source()) {
+                        /* The path confidence is kept by its frontend */
+                        FeedbackMessage msg;
+                        msg.kind = FeedbackMessage::Kind::PATH_CONFIDENCE;
+                        msg.hash = confKey;
+                        sendFeedback(
+                            *this->channels.at(completedEntry.get_source()),
+                            msg);
+                    }
 
                     if (DTRACE(PredictorResult)) {
                         predStr << GRN << "Write Addr = " << (void*)pkt->getAddr() << std::endl
@@ -1150,20 +1139,20 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
                     }
 
                     this->update_stats_for_const_pred(completedEntry);
-                    indexToDelete = i;
+                    matchedNode = node;
                     break;
                 } else {
                     // SM: Don't send negative feedback here
                     // this->broadcastPrediction(
                     //     completedEntry.get_generator_pc_sig(), true, false);
 
-                    this->updatePCConf(pkt, completedEntry);
+                    this->updatePCConf(pkt, completedEntry, chunkMatch);
 
                     incorrectlyPredictedPWrites++;
                     std::stringstream pcSig("");
 
-                    std::bitset<DATA_CHUNK_COUNT> matchVec = dataChunkMatchVec(completedEntry, pkt);
-                    std::bitset<DATA_CHUNK_COUNT> constantVec = dataChunkConstVec(completedEntry);
+                    std::bitset<DATA_CHUNK_COUNT> matchVec = dataChunkMatchVec(chunkMatch);
+                    std::bitset<DATA_CHUNK_COUNT> constantVec = dataChunkConstVec(chunkMatch);
 
                     size_t matchCount = matchVec.count();
                     theoreticalMatchVector |= matchVec;
@@ -1198,8 +1187,7 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
                 DPRINTF(PredictorResult, "Unable to match (completedEntry.addr = %p, pkt.addr = %p), moving on\n", completedEntry.get_addr(), pkt->getAddr());
                 DPRINTF(PredictorResult, "isPktEqualCompletedEntryAddr(pkt,  completedEntry) = %d and not completedEntry.is_used() = %d\n", isPktEqualCompletedEntryAddr(pkt,  completedEntry), completedEntry.is_used());
             }
-            ++i;
-            ++completedWrite_iter;
+            node = node->older;
         }
         
         if (DTRACE(PredictorResult)) {
@@ -1231,7 +1219,8 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
         // std::cout << "[" << print_ptr(16) << paddr << "] " << "Incoming:  " << CacheLine(pkt->req->getPaddr(), pkt->getPtr<DataChunk>(), pkt->getSize()/sizeof(DataChunk), true) << std::endl;
         if (maxDataMatchHash != 0) {
             // std::cout << "Incoming: maxpc = " << vec2hexStr(maxDataMatchPC) << " with pc match vector = " << theoreticalMatchVector << std::endl;
-            for (auto pcSig : this->completedWrites.at(paddr)) {
+            for (auto pcSigNode = this->completedWrites.oldest(paddr); pcSigNode; pcSigNode = pcSigNode->newer) {
+                auto &pcSig = pcSigNode->entry;
                 // std::cout << "Incoming: trying << " << vec2hexStr(pcSig.get_generator_pc_sig()) << std::endl;
                 const size_t OFFSET = 8;
                 // std::cout << "Incoming: Comparing " 
@@ -1261,24 +1250,13 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
         
         // std::cout << "Trying to update the constant pc values" << std::endl;
         this->updateConstChunks(maxDataMatchHash, pkt->req->getPaddr(), pkt);
-        if (addrExists and not this->completedWrites.find(paddr)->second.empty()) {
-            this->addrMatchDist.sample((curTick() - completedWrites.at(paddr).front().get_time_of_addr_gen())/1000);
+        if (this->completedWrites.contains(paddr)) {
+            this->addrMatchDist.sample((curTick() - completedWrites.oldest(paddr)->entry.get_time_of_addr_gen())/1000);
         }
 
-        if (indexToDelete != -1) {
-            /**
-             *! WARN: The index calculation here should always follow the same order as the iterator
-             *!       that generates the variable `completeWrite_iter`
-            */
-            indexToDelete = completedWritesForAddr_q.size() - 1 - (completedWrite_iter - completedWritesForAddr_q.rbegin());
-            std::cout << "indexToDelete: " << indexToDelete << std::endl;
-            // predStr << "Deleting entry at index (match found): " << indexToDelete << std::endl;
-
+        if (matchedNode != nullptr) {
             // Suyash: Don't erase this for now and just mark it as used
-            completedWritesForAddr_q[indexToDelete].use();
-            // completedWrites.at(paddr).erase( completedWritesForAddr_q.begin() + indexToDelete );
-
-            // PredictorBackend::completedWritesManager.erase(addrKey);
+            matchedNode->entry.use();
         } else {
             /* No write predicted */
             dataMissPredictedPWrites++;
@@ -1286,66 +1264,75 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
     }
 }
 
-size_t 
-PredictorBackend::getConfidenceForLoc(hash_t hash) {
-    float result = -1;
-
-    if (confidenceTable.find(hash) != confidenceTable.end()) {
-        result = confidenceTable[hash];
-    }
-
-    // DPRINTFR(PredictorConfidence, 
-    //          "Returning confidence value of %f for hash <%s>\n", 
-    //          result, 
-    //          hash.c_str());
-    return result;
-}
-
 void
 PredictorBackend::dumpTrace(PacketPtr pkt) {
-    // std::cout << "Trying to dump pkt with size = " << pkt->getSize() << " isNonVolatileAddress = " << pkt->req->getPaddr() << std::endl;
-    if (enableNonVolatileDump == "1") {
+    if (writebackTrace != nullptr) {
         bool isPktWrite = pkt->isWrite();
 
         bool isClwb = pkt->req->isToPOC();
         size_t writeSize = pkt->getSize();
         auto addr =  pkt->req->getPaddr();
-        // std::cout << "Trying to dump pkt with size = " << pkt->getSize() << " isNonVolatileAddress = " << isAddrNonVolatile(addr) << std::endl;
 
         bool useWriteForTrace = isPktWrite 
                                 and (writeSize == 64);
 
         if (useWriteForTrace or isClwb) {
-            std::string locType = "P";
-            std::string opType = writeSize == 1 ? "C" : "W"; // CLWB and write operations
-            std::string data = "";
-
-            /* Convert the data to hex string of appropriate size */
-            std::stringstream ss;
+            TraceRecord record;
+            record.persistent = true;
+            record.addr = addr;
+            record.paddr = addr;
+            record.size = writeSize;
+            record.tick = curTick();
             if (writeSize == 64) {
-                ss << "0x0";
-                for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-                    ss << std::hex << std::setw(8) << std::setfill('0') << pkt->getPtr<uint32_t>()[i];
-                }
+                record.set_data(pkt->getConstPtr<uint8_t>(), writeSize);
             } else if (writeSize == 1) {
-                ss << "0x0";
+                record.isClwb = true;
                 panic_if(not isClwb, "Non 64 byte cacheline eviction, size = %s", writeSize);
             } else {
                 panic("Non 64 byte cacheline eviction, size = %s", writeSize);
             }
+            writebackTrace->write(record);
+        }       
+    }
+}
 
-            data = ss.str();
+void
+PredictorBackend::closeTrace() {
+    if (writebackTrace != nullptr) {
+        writebackTrace->close();
+    }
+    if (snapshot != nullptr) {
+        snapshot->close();
+    }
+}
 
-            myFile << "@" << print_ptr(16) << 0x0                   // Write PC
-                << " " << locType                                   // Address type
-                << " " << opType                                    // C for clwb and W for write
-                << " " << print_ptr(16) << pkt->req->getPaddr()     // write address
-                << " " << print_ptr(1) << writeSize                 // write size in hex
-                << " " << data                                      // data
-                << " " << print_ptr(16) << curTick()                // Tick
-                << std::endl;
-        }       
+void
+PredictorBackend::takeSnapshot() {
+    const Tick now = curTick();
+
+    snapshot->begin_section(SnapshotWriter::Section::RESULT_BUFFER, now,
+                            completedWrites.line_count(), 8 + 2 * 4);
+    completedWrites.for_each_line(
+        [&](Addr_t paddr, ResultBuffer::Node *oldest) {
+            uint32_t entries = 0, freeEntries = 0;
+            for (auto node = oldest; node; node = node->newer) {
+                entries++;
+                if (node->entry.get_cacheline().get_datachunks()[0].is_free_prediction()) {
+                    freeEntries++;
+                }
+            }
+            snapshot->put((uint64_t)paddr);
+            snapshot->put(entries);
+            snapshot->put(freeEntries);
+        });
+
+    snapshot->begin_section(SnapshotWriter::Section::HASH_COUNTS, now,
+                            correctHashes.size(), 2 * 8);
+    for (auto &hashCount : correctHashes) {
+        snapshot->put((uint64_t)hashCount.first);
+        snapshot->put(hashCount.second);
     }
+    correctHashes.clear();
 }
 
 void 
@@ -1354,6 +1341,9 @@ PredictorBackend::predictorHandleRequest(PacketPtr pkt) {
         return;
     }
 
+    /* Predictions that reached the backend by now are verified first */
+    this->receivePredictions();
+
     this->dumpTrace(pkt);
     bool isClwb = pkt->req->isToPOC() and pkt->req->getSize() == 1;
     Addr_t addr = pkt->getAddr();
@@ -1389,47 +1379,11 @@ PredictorBackend::predictorHandleRequest(PacketPtr pkt) {
 
 }
 
-void PredictorBackend::initConf(hash_t hash)  {
-    if (confidenceTable.find(hash) == confidenceTable.end()) {
-        confidenceTable[hash] = PRED_CONFIDENCE_MAX-1;
-        std::cout << "Initializing hash " << (void*)hash 
-                  << " to value " << confidenceTable[hash] 
-                  << std::endl;
-    }
-}
-
-PredictorBackend::CompletedWrites_Q 
-PredictorBackend::completedWrites = PredictorBackend::CompletedWrites_Q();
-
-PredictorBackend::ConfTable_t
-PredictorBackend::confidenceTable = PredictorBackend::ConfTable_t();
-
 bool
 PredictorBackend::predictorEnabled = false;
 
-bool
-PredictorBackend::usePredictor = false;
-
-uint64_t
-PredictorBackend::capacityEvictionStatic = 0;
-
-std::unordered_map<Addr_t, Tick>
-PredictorBackend::completedWritesManager;
-
-/* Limits the maximum number of prediction entries for an address **/
-int
-PredictorBackend::MAX_COMPLETED_QUEUE_LINE_SIZE = // 8*
-				     4;
-/* Limits the total size of the result buffer table */
-size_t
-PredictorBackend::RESULT_BUFFER_MAX_SIZE = 256;
 Addr_t 
 PredictorBackend::getCompWriteKey(Addr_t addr) {
     return addr&P_WRITE_VADDR_PADDR_COMP_MASK;
 }
 
-std::unordered_map<PC_t, int>
-PredictorBackend::addrMatches;
-
-std::ofstream
-PredictorBackend::resultBufferSize = std::ofstream("./resultBufferSize.dat");
@@ -52,12 +52,18 @@
 #define SHIFTLAB_PREDICTOR_BACKEND_H__
 
 #include <deque>
+#include <vector>
 
 #include "base/types.hh"
 #include "mem/predictor/CacheLine.hh"
+#include "mem/predictor/ChunkCompare.hh"
 #include "mem/predictor/Constants.hh"
 #include "mem/predictor/Declarations.hh"
 #include "mem/predictor/CompletedWriteEntry.hh"
+#include "mem/predictor/PredictionChannel.hh"
+#include "mem/predictor/ResultBuffer.hh"
+#include "mem/predictor/SnapshotWriter.hh"
+#include "mem/predictor/TraceWriter.hh"
 #include "mem/port.hh"
 #include "params/PredictorBackend.hh"
 #include "debug/PredictorBackend.hh"
@@ -66,6 +72,8 @@
 
 #include <fstream>
 
+class DRAMCtrl;
+class PredictorFrontend;
 
 /**
  * A bridge is used to interface two different crossbars (or in general a
@@ -82,20 +90,45 @@
  */
 class PredictorBackend : public ClockedObject
 {
-  public:
-    /* Written in a hurry, sorry 😢*/
-    using CompletedWrites_Q = std::unordered_map<Addr_t, std::deque<CompletedWriteEntry>>;
-    using CTKey_t = hash_t;
-    using CTValue_t = uint16_t;
-    using ConfTable_t = std::unordered_map<CTKey_t, CTValue_t>;
-    std::ofstream myFile;
-    static ConfTable_t confidenceTable;
-    static std::ofstream resultBufferSize;
   protected:
-    static uint64_t capacityEvictionStatic;
-    std::string enableNonVolatileDump = "0";
+    /* Writeback and CLWB trace, nullptr if disabled */
+    TraceWriter *writebackTrace = nullptr;
+    /* Sampled result buffer snapshots, nullptr if disabled */
+    SnapshotWriter *snapshot = nullptr;
+    /* Path hashes of the correct predictions since the last snapshot */
+    std::unordered_map<hash_t, uint64_t> correctHashes;
+    /* Keeps the predicted writes when the result buffer is invalidated */
+    bool disableInvalidation = false;
+    /* One channel per attached frontend, indexed by the channel id */
+    std::vector<std::unique_ptr<PredictionChannel>> channels;
+    /* Frontend at the other end of every channel */
+    std::vector<PredictorFrontend *> frontends;
+
+    /* Schedules receiveEvent for the earliest prediction in the channels */
+    void scheduleReceive();
+
+    /* Schedules receiveEvent at when unless it is scheduled earlier */
+    void scheduleReceiveAt(Tick when);
+
+    /* Memory controllers that verify the predictions of this backend */
+    std::vector<DRAMCtrl *> memCtrls;
+
+    /* Limits the maximum number of prediction entries for an address */
+    size_t maxCompletedQueueLineSize = 4;
+    /* Limits the total size of the result buffer table */
+    size_t resultBufferMaxSize = 256;
+
+    /* Confidence of the PCs that generated a data chunk */
+    std::unordered_map<PC_t, Confidence> genPCConf;
+
+    /**
+     * Table that keeps track of the PC signature that have chunks which can
+     * be potentially be constant value fields.
+     */
+    std::unordered_map<hash_t,
+                       std::unordered_map<size_t, ConstChunkLocator> // = <offset, locator>
+                       > constPredTracker;
 
-    static int MAX_COMPLETED_QUEUE_LINE_SIZE;
     /**
      * A deferred packet stores a packet along with its scheduled
      * transmission time
@@ -353,21 +386,34 @@ class PredictorBackend : public ClockedObject
     Stats::Distribution addrPmWriteMatchDistance;
     Stats::Scalar correctConst0Pred;
     Stats::Scalar resultBufferCapacityEvictions;
+    Stats::Average resultBufferOccupancy;
+    Stats::Average resultBufferFreeOccupancy;
     Stats::Distribution addrMatchDist;
     Stats::Distribution dataMatchDist;
     Stats::Distribution ihbPatternMatchIndex;
     Stats::Scalar validChunks;
     Stats::Distribution writebackDistStat;
     Stats::Distribution writebackDistStatMicro;
+    Stats::Scalar receivedPredictions;
+    Stats::Scalar droppedFeedback;
 
-    std::ofstream hashStats;
+    /* Sends msg to the frontend of the channel, counts it if dropped */
+    void sendFeedback(PredictionChannel &channel, const FeedbackMessage &msg);
+    /* Sends msg to every attached frontend */
+    void broadcastFeedback(const FeedbackMessage &msg);
 
-    static size_t RESULT_BUFFER_MAX_SIZE;
+    /* Memory controller responsible for paddr, nullptr if none attached */
+    DRAMCtrl *findMemCtrl(Addr paddr) const;
 
   public:
-    static bool usePredictor;
-    static CompletedWrites_Q completedWrites;
-    static std::unordered_map<Addr_t, Tick> completedWritesManager;
+    bool usePredictor = false;
+    /* Predicted writes waiting for their write to PM */
+    ResultBuffer completedWrites;
+    /* Number of predictions made for each physical address */
+    std::unordered_map<Addr_t, int> addrMatches;
+
+    /* Receives the predictions at the ready tick of the oldest one */
+    EventFunctionWrapper receiveEvent;
 
     Port &getPort(const std::string &if_name,
                   PortID idx=InvalidPortID) override;
@@ -385,36 +431,80 @@ class PredictorBackend : public ClockedObject
     void handleNonVolatileWrite(PacketPtr pkt);
     void dumpTrace(PacketPtr pkt);
 
+    /* Flushes the writeback trace and the snapshots, called on exit */
+    void closeTrace();
+
+    /* Writes the result buffer and correctHashes */
+    void takeSnapshot();
+
     /* For finding distance between a write and a writeback request */
     std::unordered_map<Addr_t, Tick> writebackDistMap;
 
     /**
-     * Broadcasts information about a prediction to all the predictor
-     * frontends using SharedArea.
-    */
-    static void broadcastPrediction(hash_t hash, bool addrPredicted, bool dataPredicted);
+     * Connects a frontend to this backend, the returned channel is owned by
+     * the backend and carries the predictions and the feedback of that
+     * frontend.
+     * @param capacity Messages buffered in each direction
+     * @param predictionLatency Ticks for a prediction to reach the backend
+     * @param feedbackLatency Ticks for feedback to reach the frontend
+     */
+    PredictionChannel *attachFrontend(PredictorFrontend *frontend,
+                                      size_t capacity, Tick predictionLatency,
+                                      Tick feedbackLatency);
+
+    /* Moves the predictions that reached the backend to the result buffer */
+    void receivePredictions();
+
+    /**
+     * Wakes the backend up to receive a prediction sent by a frontend that
+     * is visible at ready. Safe to call from the event queue of the
+     * frontend, the channels are not looked at.
+     */
+    void wakeReceive(Tick ready);
 
-    static void addCompletedWrite(CompletedWriteEntry entry);
+    /**
+     * Sends the BMO latency of a CLWB to paddr to the frontends, called
+     * when its response goes up
+     */
+    void sendClwbLatency(Addr paddr);
 
     /**
-     * Caclulates the confidence for an NVM address based on the previous writes.
-     * Works with both Virtual and Physical address
+     * Sends the result of a prediction to the frontend that generated it.
     */
-    static size_t getConfidenceForLoc(hash_t hash);
-
-    static bool isPktEqualCompletedEntryAddr(PacketPtr pkt, CompletedWriteEntry completedEntry);
-    static bool isPktEqualCompletedEntryData(PacketPtr pkt, CompletedWriteEntry completedEntry);
-    static bool isPktEqualCompletedEntry(PacketPtr pkt, CompletedWriteEntry completedEntry);
-    static void updatePCConf(PacketPtr pkt, CompletedWriteEntry completedEntry);
-    size_t getMatchingChunkCount(PacketPtr pkt, CompletedWriteEntry completedEntry);
-    static void initConf(hash_t hash);
+    void broadcastPrediction(const CompletedWriteEntry &entry, bool addrPredicted, bool dataPredicted);
+
+    /**
+     * Connects a memory controller to this backend, its metadata caches are
+     * looked up for the predictions of the addresses it serves.
+     */
+    void attachMemCtrl(DRAMCtrl *memCtrl);
+
+    /**
+     * Backend memory operation latency of the last CLWB to paddr, 0 if none
+     * is pending. The latency is consumed by the call.
+     */
+    Tick takeClwbLatency(Addr paddr);
+
+    void addCompletedWrite(CompletedWriteEntry entry);
+
+    static bool isPktEqualCompletedEntryAddr(PacketPtr pkt, const CompletedWriteEntry &completedEntry);
+    static bool isPktEqualCompletedEntryData(PacketPtr pkt, const CompletedWriteEntry &completedEntry);
+    static bool isPktEqualCompletedEntry(PacketPtr pkt, const CompletedWriteEntry &completedEntry);
+
+    /**
+     * Compares the packet data with the predicted cacheline of the entry,
+     * the result is shared by the verification checks below so the
+     * comparison runs once per (packet, entry) pair.
+     */
+    static ChunkMatch compareChunks(PacketPtr pkt, const CompletedWriteEntry &completedEntry);
+    void updatePCConf(PacketPtr pkt, const CompletedWriteEntry &completedEntry, const ChunkMatch &chunkMatch);
+    size_t getMatchingChunkCount(const ChunkMatch &chunkMatch);
+    /* Region of interest, shared by every predictor in the system */
     static bool predictorEnabled;
-    void update_stats_for_const_pred(CompletedWriteEntry completedEntry);
-    static Addr getCompletedAddrToEvict();
+    void update_stats_for_const_pred(const CompletedWriteEntry &completedEntry);
     void invalidateAllAddr();
-    static std::unordered_map<PC_t, int> addrMatches;
-    std::bitset<DATA_CHUNK_COUNT> dataChunkMatchVec(CompletedWriteEntry completedEntry, PacketPtr ptr);
-    std::bitset<DATA_CHUNK_COUNT> dataChunkConstVec(CompletedWriteEntry completedEntry);
+    std::bitset<DATA_CHUNK_COUNT> dataChunkMatchVec(const ChunkMatch &chunkMatch);
+    std::bitset<DATA_CHUNK_COUNT> dataChunkConstVec(const ChunkMatch &chunkMatch);
     
     void updateConstChunks(hash_t maxDataMatchHash, Addr_t addr, PacketPtr pkt);
 };
@@ -50,6 +50,7 @@
 
 #include "predictor_frontend.hh"
 
+#include "base/callback.hh"
 #include "base/trace.hh"
 #include "debug/PredictorFrontend.hh"
 #include "debug/PredictorFrontendInterface.hh"
@@ -64,13 +65,13 @@
 #include "params/Bridge.hh"
 #include "mem/page_table.hh"
 #include "mem/dram_ctrl.hh"
+#include "sim/core.hh"
 #include <memory>
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 
-std::vector<Addr> addrOfInterest = {0x11e0, 0x11e7, 0x16fc};
-
 PredictorFrontend::PFSlavePort::PFSlavePort(const std::string& _name,
                                          PredictorFrontend& _pf,
                                          PFMasterPort& _masterPort,
@@ -93,17 +94,81 @@ PredictorFrontend::PFMasterPort::PFMasterPort(const std::string& _name,
 {
 }
 
+static PathHistory::Kind
+toPathHistoryKind(Enums::PathHashKind kind) {
+    switch (kind) {
+    case Enums::shift_xor:
+        return PathHistory::Kind::SHIFT_XOR;
+    case Enums::folded_history:
+        return PathHistory::Kind::FOLDED;
+    case Enums::rolling_poly:
+        return PathHistory::Kind::ROLLING_POLY;
+    default:
+        panic("Unknown path hash kind %d", (int)kind);
+    }
+}
+
+static AddrPredictorStage::Kind
+toAddrPredictorKind(Enums::AddrPredictorKind kind) {
+    switch (kind) {
+    case Enums::delta:
+        return AddrPredictorStage::Kind::DELTA;
+    case Enums::stride:
+        return AddrPredictorStage::Kind::STRIDE;
+    case Enums::region:
+        return AddrPredictorStage::Kind::REGION;
+    case Enums::markov:
+        return AddrPredictorStage::Kind::MARKOV;
+    case Enums::tournament:
+        return AddrPredictorStage::Kind::TOURNAMENT;
+    default:
+        panic("Unknown address predictor kind %d", (int)kind);
+    }
+}
+
+static PredictorTableConfig
+toPredictorTableConfig(const PredictorFrontendParams *p) {
+    PredictorTableConfig config;
+    config.pathHashKind = toPathHistoryKind(p->path_hash);
+    config.pathHashAliasCheck = p->path_hash_alias_check;
+    config.setAssoc = p->pred_table_org == Enums::set_assoc;
+    config.sets = p->pred_table_sets;
+    config.ways = p->pred_table_ways;
+    config.indexShift = p->pred_table_index_shift;
+    config.tagBits = p->pred_table_tag_bits;
+    config.sizeMultiplier = p->size_multiplier;
+    config.pathHistorySize = p->path_history_size;
+    config.staleEntryAgeThreshold = p->stale_entry_age_threshold;
+    config.ihbPatternMatchThresh = p->ihb_pattern_match_thresh;
+    config.ihbPatternMinCount = p->ihb_pattern_min_count;
+    config.correctAddrPredictionAgeReward = 
+            p->correct_addr_prediction_age_reward;
+    config.correctDataPredictionAgeReward = 
+            p->correct_data_prediction_age_reward;
+    config.const0PredEnabled = p->enable_const_0_prediction;
+    config.disableConfidence = p->disable_confidence;
+    return config;
+}
+
 PredictorFrontend::PredictorFrontend(Params *p)
     : ClockedObject(p),
+      addrPredictor(toAddrPredictorKind(p->addr_predictor)),
       slavePort(p->name + ".slave", *this, masterPort,
                 ticksToCycles(p->delay), p->resp_size, p->ranges),
       masterPort(p->name + ".master", *this, slavePort,
                  ticksToCycles(p->delay), p->req_size),
       writeHistoryBuffer(p->name + ".whb", 
-                 512*SharedArea::sizeMultiplier),
-                //!  1024*SharedArea::sizeMultiplier),
-      predictorTable(p->name + ".pred_t"),
-      pendingTable(p->name + ".pend_t", &this->writeHistoryBuffer)
+                 512*p->size_multiplier),
+                //!  1024*p->size_multiplier),
+      predictorTable(p->name + ".pred_t", toPredictorTableConfig(p)),
+      pendingTable(p->name + ".pend_t", &this->writeHistoryBuffer,
+                   p->size_multiplier, p->disable_whb_search),
+      accRetireEvent([this]{ cachelineAccumulatorRetireTick(); },
+                     p->name + ".accRetireEvent"),
+      feedbackEvent([this]{ receiveFeedback(); scheduleFeedback(); },
+                    p->name + ".feedbackEvent"),
+      clwbTimeoutEvent([this]{ clwbTimeout(); },
+                       p->name + ".clwbTimeoutEvent")
 {
     bothAddrDataNotFound
         .name(p->name + ".bothAddrDataNotFound")
@@ -173,7 +238,8 @@ PredictorFrontend::PredictorFrontend(Params *p)
         .desc("pcAccumulatorEvictions");
     cacheLineAccumulatorSize
         .name(p->name + ".cacheLineAccumulatorSize")
-        .desc("Number of cachelines pc accumulator can hold simulataneously.");
+        .desc("Number of cachelines the accumulators of all the contexts "
+              "can hold simulataneously.");
     clwbToLastWriteDistance
         .name(p->name + ".clwbToLastWriteDistance")
         .desc("clwbToLastWriteDistance")
@@ -212,42 +278,71 @@ PredictorFrontend::PredictorFrontend(Params *p)
         .name(p->name + ".whbTimeLen")
         .desc("")
         .init(0,10,1000);
+    droppedPredictions
+        .name(p->name + ".droppedPredictions")
+        .desc("Predictions dropped because the channel to the backend was "
+              "full");
+    receivedFeedback
+        .name(p->name + ".receivedFeedback")
+        .desc("Feedback messages received from the backend");
+    duplicateRequests
+        .name(p->name + ".duplicateRequests")
+        .desc("Packets delivered again after they were accepted, not "
+              "passed to the predictor");
+    sameTickStores
+        .name(p->name + ".sameTickStores")
+        .desc("Stores accepted in the same tick as the previous request, "
+              "these were dropped by the old per-tick filter");
+    addrPredictions
+        .name(p->name + ".addrPredictions")
+        .desc("Predicted writes whose address was replaced by the address "
+              "predictor");
+
+    backend = p->backend;
+    if (backend != nullptr) {
+        channel = backend->attachFrontend(this, p->channel_size,
+                                          p->prediction_latency,
+                                          p->feedback_latency);
+    }
 
-    char* envResult = std::getenv("ENABLE_VOLATILE_DUMP");
-
-    if (envResult != nullptr) {
+    if (p->volatile_dump != "") {
         printf("Enabling volatile dump\n");
-        enableVolatileDump = std::string(envResult);
-        myFile.open(enableVolatileDump);
-    } else {
-        enableVolatileDump = "";
-        myFile.open("/std/dev/null");
+        volatileTrace = new TraceWriter(
+                p->volatile_dump, 
+                p->volatile_dump_compression == Enums::gzip 
+                    ? TraceWriter::Compression::GZIP 
+                    : TraceWriter::Compression::NONE);
+    }
+    if (p->snapshot != "") {
+        snapshot = new SnapshotWriter(
+                p->snapshot,
+                p->snapshot_trigger == Enums::event_period
+                    ? SnapshotWriter::Trigger::EVENTS
+                    : SnapshotWriter::Trigger::TICKS,
+                p->snapshot_period);
+    }
+    if (volatileTrace != nullptr or snapshot != nullptr) {
+        /* The destructor is not called on exit */
+        registerExitCallback(
+            new MakeCallback<PredictorFrontend, 
+                             &PredictorFrontend::closeTrace>(this));
     }
 
-    genHash.open("./genHash.stats");
-
-    CL_ACC_SIZE = std::stol(get_env_str("CL_ACC_SIZE", "4"));
-    disablePerPCConfidence = get_env_val("DISABLE_PER_PC_CONFIDENCE");
-    disableFreePrediction = get_env_val("DISABLE_FREE_PREDICTION");
-    disableFancyAddrPred = get_env_val("DISABLE_FANCY_ADDR_PRED");
+    CL_ACC_SIZE = p->cl_acc_size;
+    disablePerPCConfidence = p->disable_per_pc_confidence;
+    disableFreePrediction = p->disable_free_prediction;
+    disableFancyAddrPred = p->disable_fancy_addr_pred;
     std::cout << "Using cacheline accumulator size = " << CL_ACC_SIZE << std::endl;
-    cacheLineAccumulatorSize += CL_ACC_SIZE;
-
-    /* Read the PC of interest */
-    char* rawVal = std::getenv("PC_OF_INTEREST");
-    std::cout << "Raw value = " << rawVal << std::endl;
-    addrOfInterest = {};
-    if (rawVal != nullptr) {
-        std::string val_str = std::string(rawVal);
-        std::stringstream ss(val_str);
-        std::cout << "Got the string " << val_str << " for PC of interest" << std::endl;
-        while(ss.good()) {
-            std::string substr;
-            std::getline(ss, substr, ',');
-            std::cout << "Adding " << substr << " to PCs of interest" << std::endl;
-            addrOfInterest.push_back(std::stol(substr, 0 /*pos*/, 16 /*base*/));
-        }
-    }
+
+    /* The contexts split the entries, they are created when selected */
+    fatal_if(p->hw_contexts == 0, "%s needs at least one hardware thread "
+             "context", name());
+    sharedContextState = p->shared_context_state;
+    accSizePerContext = sharedContextState ? CL_ACC_SIZE
+            : std::max<size_t>(1, CL_ACC_SIZE / p->hw_contexts);
+    this->selectContext(0);
+
+    addrOfInterest = p->pcs_of_interest;
     std::cout << "PCs of interest: "  << vec2hexStr(addrOfInterest) << std::endl;
 }
 
@@ -302,27 +397,17 @@ PredictorFrontend::PFMasterPort::recvTimingResp(PacketPtr pkt)
     Tick receive_delay = pkt->headerDelay + pkt->payloadDelay;
     pkt->headerDelay = pkt->payloadDelay = 0;
 
-    Tick bmoLatency = 0;
-    bool isClwb = pkt->req->isToPOC() and pkt->req->getSize() == 1 and pkt->hasData() == false and is_vaddr_pm(pkt->req->getVaddr());
-    if (PredictorBackend::predictorEnabled and isClwb and pkt->req->getVaddr() != 0) {
-        Addr paddr = 0;
-        EmulationPageTable::pageTableStaticObj->translate(pkt->req->getVaddr(), paddr);
-        panic_if(paddr == 0, "Cannot translate %p", pkt->req->getVaddr());
-        bmoLatency = DRAMCtrl::clwbLatency[paddr];
-        // if (std::getenv("BMO_LATENCY") == nullptr) {
-        //     bmoLatency = 0;
-        // } else {
-        //     bmoLatency = 600000;
-        // }
-        DRAMCtrl::clwbLatency.erase(paddr);
-        pf.clwbResponses++;
-            // this->avgBmoLatency.sample(bmoLatency);
-        // std::cout << "[0] Sampling latency = " << bmoLatency << std::endl;
+    // the BMO latency of a PM CLWB comes back as feedback
+    if (pf.isPMClwb(pkt)) {
+        if (PredictorBackend::predictorEnabled) {
+            pf.clwbResponses++;
+        }
+        pf.respondClwb(pkt, pf.clockEdge(delay) + receive_delay);
+        return true;
     }
 
-
     slavePort.schedTimingResp(pkt, pf.clockEdge(delay) +
-                              receive_delay + bmoLatency);
+                              receive_delay);
 
     return true;
 }
@@ -345,15 +430,7 @@ PredictorFrontend::PFSlavePort::recvTimingReq(PacketPtr pkt)
     if (retryReq)
         return false;
 
-    /** For some reason recvTimingReq is called twice within the same tick value,
-     *  keeping track of the tick value prevents this.
-     */
-    if (curTick() != pf.lastPredictorTick) {
-        pf.predictorHandleRequest(pkt);
-        pf.lastPredictorTick = curTick();
-    }
 
-    
     DPRINTF(PredictorFrontendInterface, "Response queue size: %d outresp: %d\n",
             transmitList.size(), outstandingResponses);
 
@@ -384,6 +461,11 @@ PredictorFrontend::PFSlavePort::recvTimingReq(PacketPtr pkt)
         }
 
         if (!retryReq) {
+            // a rejected packet is sent again after the retry, so the
+            // predictor only sees the packet once it is accepted
+            pf.handleAcceptedRequest(pkt);
+            pf.trackClwb(pkt);
+
             // technically the packet only reaches us after the header
             // delay, and typically we also need to deserialise any
             // payload (unless the two sides of the bridge are
@@ -622,17 +704,20 @@ PredictorFrontend::updateWriteHistoryBuffer(const PacketPtr pkt) {
     assert(pkt->req->hasPC() && pkt->hasData() && pkt->isWrite());
 
     DataChunk *dataChunks = (DataChunk*)pkt->getConstPtr<uint64_t>();
-    WriteHistoryBufferEntry *whbEntry 
-            = new WriteHistoryBufferEntry(
+
+    //! Selective WHB insertion (skipping all zero lines) is disabled
+    /* Construct the entry in place, evicting the oldest if needed */
+    WriteHistoryBufferEntry &whbEntry 
+            = writeHistoryBuffer.emplace_back(
                     pkt->req->getPC(), 
                     pkt->req->getVaddr(), 
                     dataChunks, 
                     pkt->req->getSize()/sizeof(DataChunk),
                     this->predictorTable.get_path_hash());
 
-    whbEntry->destAddr_diag = (Addr_t)(pkt->req->getVaddr());
-    whbEntry->insertionTick_diag = curTick();
-    whbEntry->set_gen_tick(curTick());
+    whbEntry.destAddr_diag = (Addr_t)(pkt->req->getVaddr());
+    whbEntry.insertionTick_diag = curTick();
+    whbEntry.set_gen_tick(curTick());
 
     size_t len = pkt->req->getSize();
     size_t chunkCount = len/sizeof(DataChunk);
@@ -651,84 +736,103 @@ PredictorFrontend::updateWriteHistoryBuffer(const PacketPtr pkt) {
             // std::cout << std::hex << i << ":0x" << std::setfill('0') << std::setw(8) << data << " ";
         } /* std::cout << "\n"; */
     }
-    whbEntry->set_id(curTick());
-    whbEntry->set_size(chunkCount);
-    
-    //! Added true condition to disable selective WHB insertion 
-    if (not whbEntry->get_cacheline().all_zeros() or true) {
-        writeHistoryBuffer.push_back(whbEntry);
-    }
+    whbEntry.set_id(curTick());
+    whbEntry.set_size(chunkCount);
     return;
 }
 
 void
 PredictorFrontend::cachelineAccumulatorRetireTick() {
-    if (disableFreePrediction) {
+    /* Lines of every context age, not only of the selected one */
+    for (auto &context : this->contextAccumulators) {
+        retireAccumulatorLines(context.second);
+    }
+
+    this->scheduleAccumulatorRetire();
+}
+
+void
+PredictorFrontend::scheduleAccumulatorRetire() {
+    if (disableFreePrediction or accRetireEvent.scheduled()) {
         return;
     }
 
-    if ((curTick() - lastAccumulatorRetireTick) > ACC_RETIRE_TICK_PERIOD) {
-        lastAccumulatorRetireTick = curTick();
+    /**
+     * Updates only move a deadline later, a pending event is never late.
+     * If the line it was scheduled for was updated, the event finds nothing
+     * due and moves on to the next deadline.
+     */
+    Tick earliest = MaxTick;
+    for (auto &context : this->contextAccumulators) {
+        earliest = std::min(earliest, context.second.next_deadline());
+    }
 
-        std::deque<Addr_t> retireQueue;
+    if (earliest != MaxTick) {
+        schedule(accRetireEvent, std::max(earliest, curTick()));
+    }
+}
 
-        for (std::pair<Addr_t, CacheLine> cacheline : this->cacheLineAccumulator) {
-            Tick age = curTick() - cacheline.second.get_time_of_last_update();
-            if (age > ACC_ENTRY_RETIRE_THRESHOLD) {
-                retireQueue.push_back(cacheline.first);
-                Addr paddr;
-                EmulationPageTable::pageTableStaticObj->translate(cacheline.first, paddr);
-                // std::cout << "(tick) retiring address " << (void*)cacheline.first << " Physical address: " << (void*)paddr << " at age " << age/1000.0/1000.0 << "us" <<  std::endl;
-            }
-        }
+void
+PredictorFrontend::retireAccumulatorLines(CachelineAccumulator &accumulator) {
+    std::deque<CompletedWriteEntry> entriesToSend;
 
-        std::deque<CompletedWriteEntry> entriesToSend;
+    accumulator.expire(curTick(), [&](Addr_t addr, CacheLine &line) {
+        Addr paddr = 0;
 
-        for (Addr_t addr : retireQueue) {
-            Addr paddr = 0;
+        /* Cache uses physical address */
+        if (EmulationPageTable::pageTableStaticObj->translate(addr, paddr)
+                and line.is_dirty()) { 
+            /* Lookup the physical address, a missing line reads as zero */
+            DataChunk lineData[DATA_CHUNK_COUNT] = {};
+            this->readLine(paddr, lineData);
+            CacheLine cacheData = CacheLine(paddr, lineData,
+                                            DATA_CHUNK_COUNT, false);
 
-            /* Cache uses physical address */
-            if (EmulationPageTable::pageTableStaticObj->translate(addr, paddr)
-                    and this->cacheLineAccumulator[addr].is_dirty()) { 
-                /* Lookup the physical address */
-                // CacheLine l1CacheLine = CacheLine(paddr,  Cache::l1DCacheStaticObj);
-                CacheLine cacheData = CacheLine(paddr,  Cache::l2CacheStaticObj);
-                CacheLine accumulatedCacheLine = this->cacheLineAccumulator.at(addr);
+            cacheData.overwriteFrom(line);
+            DPRINTF(CacheLineAccumulatorRetire, "<+> %p new         : %s\n", paddr, cacheData.to_string());
 
-                // DPRINTF(CacheLineAccumulatorRetire, "<+> %p l1 : %s\n", paddr, l1CacheLine.to_string());
-                // DPRINTF(CacheLineAccumulatorRetire, "<+> %p accumulator : %s\n", paddr, accumulatedCacheLine.to_string());
-                // DPRINTF(CacheLineAccumulatorRetire, "<+> %p cadchedata  : %s\n", paddr, cacheData.to_string());
+            /* Set all the datachunks as free predictions */
+            for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+                cacheData.get_datachunks()[i].set_free_prediction();
+            }
 
-                cacheData.overwriteFrom(accumulatedCacheLine);
-                DPRINTF(CacheLineAccumulatorRetire, "<+> %p new         : %s\n", paddr, cacheData.to_string());
+            /* Entry is ready to send to the backend */
+            entriesToSend.push_back(CompletedWriteEntry(addr, cacheData, hash_t("Free write")));
 
-                /* Set all the datachunks as free predictions */
-                for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-                    cacheData.get_datachunks()[i].set_free_prediction();
-                }
+            entriesToSend.back().set_time_of_addr_gen(curTick());
+            entriesToSend.back().set_time_of_data_gen(curTick());
+            entriesToSend.back().set_time_of_creation(curTick());
+            entriesToSend.back().set_orig_cacheline(cacheData);
 
-                /* Entry is ready to send to the backend */
-                entriesToSend.push_back(CompletedWriteEntry(addr, cacheData, hash_t("Free write")));
+            /* Set the accumulator entry as clean */
+            line.set_clean();
+        }
+    });
 
-                entriesToSend.back().set_time_of_addr_gen(curTick());
-                entriesToSend.back().set_time_of_data_gen(curTick());
-                entriesToSend.back().set_time_of_creation(curTick());
-                entriesToSend.back().set_orig_cacheline(cacheData);
+    for (auto &completedWrite : entriesToSend) {
+        this->freePredictions++;
+        this->predictedWriteCount++;
+        this->sendToBackend(completedWrite);
+    }
+}
 
-                // std::cout << "Retiring with cacheline: " << cacheData.to_string().c_str()  << std::endl;
+bool
+PredictorFrontend::readLine(Addr paddr, DataChunk data[DATA_CHUNK_COUNT]) {
+    if (this->lineSource != nullptr) {
+        return this->lineSource->read_line(cacheline_align(paddr), data);
+    }
 
-                /* Set the accumulator entry as clean */
-                this->cacheLineAccumulator[addr].set_clean();
-            } else {
-                // std::cout << "Unable to retire address " << (void*)addr << " clacc dirty? " << this->cacheLineAccumulator[addr].is_dirty() << std::endl;
-            }
-        }
-        for (auto completedWrite : entriesToSend) {
-            this->freePredictions++;
-            this->predictedWriteCount++;
-            PredictorBackend::addCompletedWrite(completedWrite);
-        }
+    /* No L2 when the predictor is driven without caches */
+    if (Cache::l2CacheStaticObj == nullptr) {
+        return false;
     }
+    CacheBlk *blk = Cache::l2CacheStaticObj->tags->findBlock(
+            cacheline_align(paddr), false);
+    if (blk == nullptr or not blk->isValid()) {
+        return false;
+    }
+    std::memcpy(data, blk->data, CACHELINE_SIZE);
+    return true;
 }
 
 void PredictorFrontend::SendCacheLineToBackend(CacheLine cacheline) {
@@ -738,9 +842,8 @@ void PredictorFrontend::SendCacheLineToBackend(CacheLine cacheline) {
     /* Cache uses physical address */
     if (EmulationPageTable::pageTableStaticObj->translate(addr, paddr)) {
         /* Lookup the physical address */
-        CacheBlk *blk = Cache::l2CacheStaticObj->tags->findBlock(paddr, false);
-        if (blk != nullptr) {
-            DataChunk *data = (DataChunk*)blk;
+        DataChunk data[DATA_CHUNK_COUNT];
+        if (this->readLine(paddr, data)) {
             
             // std::cout << "addr = " << addr << " | ";
             // for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
@@ -770,87 +873,96 @@ void PredictorFrontend::SendCacheLineToBackend(CacheLine cacheline) {
             entryToSend.set_time_of_creation(curTick());
             entryToSend.set_orig_cacheline(cacheData);
 
-            PredictorBackend::addCompletedWrite(entryToSend);
+            this->sendToBackend(entryToSend);
         }
     }
 }
 
+void
+PredictorFrontend::selectContext(ContextID context) {
+    if (this->sharedContextState) {
+        context = 0;
+    }
+    if (context == InvalidContextID or context == this->currentContext) {
+        return;
+    }
+    this->currentContext = context;
+
+    auto accumulator = this->contextAccumulators.find(context);
+    if (accumulator == this->contextAccumulators.end()) {
+        accumulator = this->contextAccumulators.emplace(context,
+                CachelineAccumulator(accSizePerContext,
+                                     ACC_ENTRY_RETIRE_THRESHOLD,
+                                     ACC_RETIRE_TICK_PERIOD)).first;
+        this->cacheLineAccumulatorSize += accSizePerContext;
+    }
+    this->cacheLineAccumulator = &accumulator->second;
+    this->predictorTable.select_context(context);
+}
+
 void
 PredictorFrontend::manageCachelineAcc(PacketPtr pkt) {
     Addr cachelineAddr = cacheline_align(pkt->req->getVaddr());
-    bool exists = true;
-    if (this->cacheLineAccumulator.find(cachelineAddr) == this->cacheLineAccumulator.end()) {
-        exists = false;
-    }
+    CacheLine *line = this->cacheLineAccumulator->find(cachelineAddr);
 
-    this->cacheLineAccumulator[cachelineAddr];
-    this->cacheLineAccumulator[cachelineAddr].set_dirty();
-    // std::cout << "Setting cacheline accumulator entry for address " << (void*)cachelineAddr << " to dirty" << std::endl;
+    if (line == nullptr) {
+        /* The oldest line makes room for the new one */
+        if (this->cacheLineAccumulator->full()) {
+            this->evictOldestAccLine(pkt);
+        }
 
-    if (not exists) {
-        // std::cout << "[CL Accumulator] Adding new entry for address " << (void*)cachelineAddr << " aligned = " << (void*)cacheline_align(cachelineAddr) << " at tick " << curTick() << " pc value = " << (void*)this->lastWritePCToAddr[cachelineAddr] <<  std::endl;
-        this->cacheLineAccumulator[cachelineAddr].set_addr(pkt->req->getVaddr());
-        this->cacheLineAccumulator[cachelineAddr].set_time_of_creation(curTick());
-        this->cacheLineAccumulator[cachelineAddr].set_time_of_last_update(curTick());
+        line = &this->cacheLineAccumulator->insert(cachelineAddr);
+        line->set_addr(pkt->req->getVaddr());
+        line->set_time_of_creation(curTick());
+        this->cacheLineAccumulator->touch(cachelineAddr, curTick());
     }
-
-    Tick oldestTimeOfGen = -1;
-    size_t addrOfOldestTimeOfGen = -1;
+    if (not line->is_dirty()) {
+        /* Stores smaller than a chunk do not touch a retired line */
+        this->cacheLineAccumulator->rearm(cachelineAddr, curTick());
+    }
+    line->set_dirty();
 
     DPRINTF(CacheLineAccumulator,
             "Cacheline accumulator entries: [ ");
     if (DTRACE(CacheLineAccumulator)) {
-        for (std::pair<Addr, CacheLine> pair : this->cacheLineAccumulator) {
-            DPRINTF(CacheLineAccumulator, "%p ", (void*)pair.first);
-        }
+        this->cacheLineAccumulator->for_each([this](Addr_t addr, CacheLine &) {
+            DPRINTF(CacheLineAccumulator, "%p ", (void*)addr);
+        });
     }
     DPRINTF(CacheLineAccumulator,
         "]\n");
+}
 
-    /* If the current accumulator size is greater than the maximum limit, find the oldest entry */
-    if (this->cacheLineAccumulator.size() > CL_ACC_SIZE) {
-        for (std::pair<Addr, CacheLine> potAddr : this->cacheLineAccumulator) {
-            Tick toc = this->cacheLineAccumulator.at(potAddr.first).get_time_of_creation();
-            if (toc < oldestTimeOfGen) {
-                oldestTimeOfGen = toc;
-                addrOfOldestTimeOfGen = potAddr.first;
-            }
-        }
-    }
+void
+PredictorFrontend::evictOldestAccLine(PacketPtr pkt) {
+    Addr_t addrOfOldestTimeOfGen = this->cacheLineAccumulator->oldest_addr();
+    panic_if(addrOfOldestTimeOfGen == CachelineAccumulator::INVALID_TAG,
+             "Unable to delete any entry from the cacheline accumulator");
 
-    /* Delete the oldest found accumulator entry */
-    if (oldestTimeOfGen != -1) {
-        DPRINTF(CacheLineAccumulator, 
-                "Deleting entry from the CL accumulator, created at %lu with aligned address %p\n", 
-                oldestTimeOfGen, addrOfOldestTimeOfGen);
-        DPRINTF(CacheLineAccumulator,
-                "[CL Accumulator] Deleting entry from the CL accumulator, "
-                "created at %lu with aligned address %p, age %lu and last "
-                "write to at %lu kTicks ago, clAcc.size = %d\n", 
-                oldestTimeOfGen, addrOfOldestTimeOfGen, curTick() - oldestTimeOfGen, 
-                (curTick() - this->lastWriteTickToAddr[pkt->req->getVaddr()])/1000, 
-                this->cacheLineAccumulator.size());
-        this->pcAccumulatorEvictions++;
-
-        /* Collect the statistics on the age of this entry */
-        panic_if_not(this->lastWriteTickToAddr.find(addrOfOldestTimeOfGen) 
-                        != this->lastWriteTickToAddr.end());
-        this->clEvicKiloTicksSinceLastWrite.sample(
-            (curTick() - this->lastWriteTickToAddr[pkt->req->getVaddr()])/1000
-        );
-        
-        panic_if(addrOfOldestTimeOfGen == -1, "Incorrect execution state");
-        
-        /* Any evicted lines goes to the backend as a prediction */
-        PredictorFrontend::SendCacheLineToBackend(this->cacheLineAccumulator[addrOfOldestTimeOfGen]);
-        DPRINTF(CacheLineAccumulator, "[Not found] Unable to find CLWB for cacheline %s\n", 
-                this->cacheLineAccumulator.at(addrOfOldestTimeOfGen).to_string().c_str()); 
-        this->cacheLineAccumulator.erase(addrOfOldestTimeOfGen);
-    } 
-    
-    if (oldestTimeOfGen == -1 and this->cacheLineAccumulator.size() > CL_ACC_SIZE) {
-        panic("Unable to delete any entry from the cacheline accumulator");
-    }
+    const CacheLine &oldest = this->cacheLineAccumulator->at(addrOfOldestTimeOfGen);
+    Tick oldestTimeOfGen = oldest.get_time_of_creation();
+
+    DPRINTF(CacheLineAccumulator,
+            "[CL Accumulator] Deleting entry from the CL accumulator, "
+            "created at %lu with aligned address %p, age %lu and last "
+            "write to at %lu kTicks ago, clAcc.size = %d\n", 
+            oldestTimeOfGen, addrOfOldestTimeOfGen, curTick() - oldestTimeOfGen, 
+            (curTick() - this->lastWriteTickToAddr[pkt->req->getVaddr()])/1000, 
+            this->cacheLineAccumulator->size());
+    this->pcAccumulatorEvictions++;
+
+    /* Collect the statistics on the age of this entry */
+    panic_if_not(this->lastWriteTickToAddr.find(addrOfOldestTimeOfGen) 
+                    != this->lastWriteTickToAddr.end());
+    this->clEvicKiloTicksSinceLastWrite.sample(
+        (curTick() - this->lastWriteTickToAddr[pkt->req->getVaddr()])/1000
+    );
+
+    /* Any evicted lines goes to the backend as a prediction */
+    this->SendCacheLineToBackend(oldest);
+    DPRINTF(CacheLineAccumulator, "[Not found] Unable to find CLWB for cacheline %s\n", 
+            oldest.to_string().c_str()); 
+    this->cacheLineAccumulator->erase(addrOfOldestTimeOfGen);
 }
 
 void
@@ -860,8 +972,21 @@ PredictorFrontend::handleNonVolatileWrite(const PacketPtr pkt, bool isClwb /* =
         this->clwbCountInclInv++;
         this->addrChangesBwClwb.sample(this->addrChangesSinceClwb);
         this->addrChangesSinceClwb = 0;
-        if (this->cacheLineAccumulator.find(cachelineAddr) != this->cacheLineAccumulator.end()
-                and not this->cacheLineAccumulator.at(cachelineAddr).all_invalid() ) {
+        /**
+         * The line may have been written by another thread of the core, its
+         * history processes the CLWB and the current context is restored
+         */
+        ContextID previousContext = this->currentContext;
+        if (not this->cacheLineAccumulator->contains(cachelineAddr)) {
+            for (auto &context : this->contextAccumulators) {
+                if (context.second.contains(cachelineAddr)) {
+                    this->selectContext(context.first);
+                    break;
+                }
+            }
+        }
+        if (this->cacheLineAccumulator->contains(cachelineAddr)
+                and not this->cacheLineAccumulator->at(cachelineAddr).all_invalid() ) {
             this->clwbCount++;
             DPRINTF(PredictorFrontendLogic, 
                     URED "Found a clwb -> %s (%s, isClwb = %d)" RST "\n", 
@@ -875,19 +1000,19 @@ PredictorFrontend::handleNonVolatileWrite(const PacketPtr pkt, bool isClwb /* =
                     (void*)cachelineAddr);
             
             this->invChunkCountSampler.sample(
-                this->cacheLineAccumulator.at(cachelineAddr).invalid_chunk_count()
+                this->cacheLineAccumulator->at(cachelineAddr).invalid_chunk_count()
             );
 
-            this->cacheLineAccumulator.erase(cachelineAddr);
-            panic_if_not(cacheLineAccumulator.find(cachelineAddr) == cacheLineAccumulator.end());
-            /* FIXME: Change the flow of thie function */
-            return;
+            this->cacheLineAccumulator->erase(cachelineAddr);
+            panic_if_not(not cacheLineAccumulator->contains(cachelineAddr));
         } else {
-            /* This clwb does nothing, return */
+            /* This clwb does nothing */
             DPRINTF(PredictorFrontendLogic, 
                     "Cacheline accumulator was invalid when the clwb was found.\n");
-            return;
         }
+        this->selectContext(previousContext);
+        /* FIXME: Change the flow of thie function */
+        return;
     } else {
         this->pmStores++;
 
@@ -898,9 +1023,6 @@ PredictorFrontend::handleNonVolatileWrite(const PacketPtr pkt, bool isClwb /* =
             this->addrChangesSinceClwb++;
         }
 
-        /* Handle all the free prediction stuff */
-        this->cachelineAccumulatorRetireTick();
-
         /**
          * Add an entry to the cacheline accumulator only if the incoming request is not a clwb
          * Check if this new accesss would evict an existing line in the PC accumulator
@@ -947,10 +1069,10 @@ PredictorFrontend::handleNonVolatileWrite(const PacketPtr pkt, bool isClwb /* =
         //         cacheline_align(this->lastNVWriteAddr), 
         //         cacheline_align(vAddr()));
         /* If this address is not repeated, process the write and clear the dataChunk values */
-    //     if ( (not isNVAddrRepeated)/*  or this->cacheLineAccumulator.are_all_complete() */) {
+    //     if ( (not isNVAddrRepeated)/*  or this->cacheLineAccumulator->are_all_complete() */) {
     //             /*         if (not isNVAddrRepeated) {
     //                         std::cout << "\nAddress different" << std::endl;
-    //                     } else if (this->cacheLineAccumulator.are_all_complete()) {
+    //                     } else if (this->cacheLineAccumulator->are_all_complete()) {
     //                         std::cout << "\nAll complete" << std::endl;
     //                     }
     //  */
@@ -958,17 +1080,17 @@ PredictorFrontend::handleNonVolatileWrite(const PacketPtr pkt, bool isClwb /* =
 
     //         DPRINTF(PredictorFrontendLogic, "Unrepeated address found\n");
     //         /* Process the last accumulated cache line only if it was valid */
-    //         if ( not wasLastNVAddrInvalid and not this->cacheLineAccumulator[cachelineAddr].all_invalid()) {
+    //         if ( not wasLastNVAddrInvalid and not (*this->cacheLineAccumulator)[cachelineAddr].all_invalid()) {
     //             // std::cout << "Last NV address was not invalid" << std::endl;
     //             DPRINTF(PredictorFrontendLogic,"Processing last accumulated cache line @ %p\n", (void*)vAddr());
     //             this->PMAddrChanges++;
     //             this->addrChangesSinceClwb++;
     //         } else {
-    //             DPRINTF(PredictorFrontendLogic, "Unable to flush, allInvalid? %d\n", this->cacheLineAccumulator[cachelineAddr].all_invalid());
+    //             DPRINTF(PredictorFrontendLogic, "Unable to flush, allInvalid? %d\n", (*this->cacheLineAccumulator)[cachelineAddr].all_invalid());
     //         }
 
     //         this->lastNVWriteAddr = destAddr;
-    //         this->cacheLineAccumulator.clear();
+    //         this->cacheLineAccumulator->clear();
     //     }
 
         /* Write data from the current write to the writes accumulator */
@@ -980,14 +1102,19 @@ PredictorFrontend::handleNonVolatileWrite(const PacketPtr pkt, bool isClwb /* =
             size_t cacheChunkIndex = chunkIndex + i;
 
             assert(cacheChunkIndex < DATA_CHUNK_COUNT);
-            ChunkInfo &chunk = this->cacheLineAccumulator.at(cachelineAddr)
+            CacheLine::ChunkRef chunk = this->cacheLineAccumulator->at(cachelineAddr)
                                     .get_datachunks()[cacheChunkIndex];
             chunk.set_chunk_type(ChunkType::DATA);
             chunk.set_data(dataChunks[i]);
             chunk.set_generating_pc(pc);
             chunk.set_completion(true);
-            this->cacheLineAccumulator.at(cachelineAddr).set_time_of_last_update(curTick());
         }
+        if (dataLen >= sizeof(DataChunk)) {
+            this->cacheLineAccumulator->touch(cachelineAddr, curTick());
+        }
+
+        /* Handle all the free prediction stuff */
+        this->scheduleAccumulatorRetire();
     }
 
     DPRINTF(PredictorFrontendLogic, 
@@ -1047,193 +1174,196 @@ PredictorFrontend::processLastAccLine(Addr addr) {
 
     this->pmAccumulatorFlushes++;
     using pcQueueEntry_t = PCQueue::pcQueueEntry_t;
-    panic_if(this->cacheLineAccumulator.at(addr).all_invalid(), 
+    panic_if(this->cacheLineAccumulator->at(addr).all_invalid(), 
             "All accumulated datachunks for the cacheline are invalid for adfdr %p\n",
             addr);
 
     this->printCachedLine(addr);
-    this->addrPredictor.set_last_seen_addr(addr);
+    /* The store that last wrote the line trains the per-PC predictors */
+    auto lastWritePC = this->lastWritePCToAddr.find(addr);
+    this->addrPredictor.train(lastWritePC == this->lastWritePCToAddr.end()
+                                  ? 0 : lastWritePC->second, addr);
 
-    if (this->cacheLineAccumulator.at(addr).all_zeros()) {
+    if (this->cacheLineAccumulator->at(addr).all_zeros()) {
         this->zeroCachelines++;
     }
     
     Addr_t destAddr = addr;
-    ChunkInfo *dataChunks = this->cacheLineAccumulator.at(addr).get_datachunks();
+    CacheLine::ChunkArray dataChunks = this->cacheLineAccumulator->at(addr).get_datachunks();
 
     bool addrPredFound = false, dataPredFound = false;
 
-    std::deque<hash_t> hashQueue;
-    
     PredictorTableEntry entryToInsert;
-    Addr_t addrPC = 0;
-
-    int whb_iter_cnt = 0;
 
-    //! Disabling dump, renable if needed
-    this->writeHistoryBuffer.dump();
-    
-    /* Scan the write history buffer */
-    Tick lastTick = 0;
-
-    bool set_2 = false;
-    // std::cout << "Completion status of index = 2 -> " << entryToInsert.get_datachunks()[2].get_completion() << std::endl;
+    if (snapshot != nullptr and snapshot->due(curTick())) {
+        this->takeSnapshot();
+    }
     
     /* For finding whb index that were used */
     std::unordered_map<size_t, bool> usedWHBIndices;
-    
-    for (auto &whb_iter : this->writeHistoryBuffer) {
-        if ((
-                    SharedArea::genPCConf.find(whb_iter->get_pc()) == SharedArea::genPCConf.end()
-                    or SharedArea::genPCConf.at(whb_iter->get_pc())() >= 5 
+
+    /**
+     * Index of the oldest whb entry that generated the address or a non-zero
+     * data chunk, its path hash is used for inserting into the predictor table
+     */
+    int hashSrcIndex = -1;
+    auto updateHashSrc = [&hashSrcIndex](int whbIndex) {
+        if (hashSrcIndex == -1 or whbIndex < hashSrcIndex) {
+            hashSrcIndex = whbIndex;
+        }
+    };
+
+    /* Entries with low confidence PCs or already used are not searched */
+    auto isUsableEntry = [this](WriteHistoryBufferEntry &whbEntry) {
+        PC_t pc = whbEntry.get_pc();
+        return (
+                    pcConfidence.find(pc) == pcConfidence.end()
+                    or pcConfidence.at(pc) >= 5 
 
                     /* If confidence is disabled, this condition is always true*/
                     or disablePerPCConfidence
                 )
                 /* Do not reuse write history buffer entries */
-                and not whb_iter->is_used()) {
-            
-            panic_if(lastTick > whb_iter->get_gen_tick(), "WHB insertion order violation");
-            lastTick = whb_iter->get_gen_tick();
-            PC_t pc = whb_iter->get_pc();
-
-            /* Find address prediction only if it has not been found until now */
-            if (not addrPredFound) {
-                int addrOffset = whb_iter->get_cacheline().get_addr_offset(destAddr);
-                if (addrOffset != -1) { 
-                    /* Sample the distance at which it was found */
-                    this->pcCaptureDistance.sample(this->writeHistoryBuffer.get_size() - whb_iter_cnt);
-                    
-                    if (DTRACE(PredictorFrontendLogic)  ) {
-                        std::stringstream ss;
-                        ss << *whb_iter << std::endl;
-
-                        DPRINTF(PredictorFrontendLogic,     
-                                "\n[%d] Found a match for predicting the address"
-                                " destination = %16p "
-                                "at offset %2d of whb_entry "
-                                "(pc=%16p, whb_index=%2d, dest_addr = %16p, "
-                                "insert_T = %16p, gap %16d, is_used = %d) = %s", 
-                                whb_iter_cnt, (void*)destAddr, addrOffset, 
-                                (void*)whb_iter->get_pc(), whb_iter_cnt, 
-                                (void*)whb_iter->destAddr_diag,  
-                                (void*)whb_iter->insertionTick_diag, 
-                                curTick() - whb_iter->insertionTick_diag,
-                                whb_iter->is_used(), 
-                                ss.str().c_str());
-                    }
+                and not whbEntry.is_used();
+    };
 
-                    assert(pc != 0 && "Trying to set 0 as pc");
-                    entryToInsert.set_addr_chunk(
-                        ChunkInfo(pc, addrOffset-whb_iter->get_cacheline().find_first_valid_index(), true, ChunkInfo::ChunkType::ADDR));
-                    auto srcDataChunks = whb_iter->get_cacheline().get_datachunks();
-
-                    Addr_t destAddr = srcDataChunks[addrOffset].get_data() + (srcDataChunks[addrOffset+1].get_data()<<32UL);
-                    entryToInsert.get_addr_chunk().set_target_addr(cacheline_align(destAddr));
-                    entryToInsert.get_addr_chunk().set_gen_pc_in_tick(whb_iter->get_gen_tick());
-                    entryToInsert.get_addr_chunk().set_generating_pc(pc);
-                    // dprintf(3, "Adding pc = %p with tick %d\n", pc, curTick());
-                    hashQueue.push_back(whb_iter->get_path_hash());
-                    addrPC = whb_iter->get_pc();
-                    addrPredFound = true;
-                    usedWHBIndices[whb_iter_cnt] = true;
-                }
+    /**
+     * Probe the write history buffer index for the address, the oldest 
+     * usable entry holding the address is used for the prediction
+     */
+    int addrOffset = -1;
+    int addrWHBIndex = this->writeHistoryBuffer.find_addr(destAddr, addrOffset, 
+                                                          isUsableEntry);
+    if (addrWHBIndex != -1) {
+        auto &whbEntry = this->writeHistoryBuffer.get(addrWHBIndex);
+        PC_t pc = whbEntry.get_pc();
+
+        /* Sample the distance at which it was found */
+        this->pcCaptureDistance.sample(this->writeHistoryBuffer.get_size() - addrWHBIndex);
+        
+        if (DTRACE(PredictorFrontendLogic)  ) {
+            std::stringstream ss;
+            ss << whbEntry << std::endl;
+
+            DPRINTF(PredictorFrontendLogic,     
+                    "\n[%d] Found a match for predicting the address"
+                    " destination = %16p "
+                    "at offset %2d of whb_entry "
+                    "(pc=%16p, whb_index=%2d, dest_addr = %16p, "
+                    "insert_T = %16p, gap %16d, is_used = %d) = %s", 
+                    addrWHBIndex, (void*)destAddr, addrOffset, 
+                    (void*)whbEntry.get_pc(), addrWHBIndex, 
+                    (void*)whbEntry.destAddr_diag,  
+                    (void*)whbEntry.insertionTick_diag, 
+                    curTick() - whbEntry.insertionTick_diag,
+                    whbEntry.is_used(), 
+                    ss.str().c_str());
+        }
+
+        assert(pc != 0 && "Trying to set 0 as pc");
+        auto cacheline = whbEntry.get_cacheline();
+        entryToInsert.set_addr_chunk(
+            ChunkInfo(pc, addrOffset-cacheline.find_first_valid_index(), true, ChunkInfo::ChunkType::ADDR));
+        auto srcDataChunks = cacheline.get_datachunks();
+
+        Addr_t destAddr = srcDataChunks[addrOffset].get_data() + (srcDataChunks[addrOffset+1].get_data()<<32UL);
+        entryToInsert.get_addr_chunk().set_target_addr(cacheline_align(destAddr));
+        entryToInsert.get_addr_chunk().set_gen_pc_in_tick(whbEntry.get_gen_tick());
+        entryToInsert.get_addr_chunk().set_generating_pc(pc);
+        updateHashSrc(addrWHBIndex);
+        addrPredFound = true;
+        usedWHBIndices[addrWHBIndex] = true;
+    }
+
+    /**
+     * Probe the write history buffer index for all the data chunks of the 
+     * accumulated cacheline
+     */
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        if (dataChunks[i].is_invalid()) {
+            entryToInsert.get_datachunks()[i].set_chunk_type(ChunkInfo::ChunkType::INVALID);
+            continue;
+        }
+
+        int dataOffset = -1;
+        int dataWHBIndex = this->writeHistoryBuffer.find_data(
+                                dataChunks[i].get_data(), dataOffset, isUsableEntry);
+
+        if (dataWHBIndex != -1) { 
+            auto &whbEntry = this->writeHistoryBuffer.get(dataWHBIndex);
+            PC_t pc = whbEntry.get_pc();
+
+            /* Found a match for predicting the data */
+            dataPredFound = true;
+
+            /* Sample the distance at which this block was found */
+            this->pcCaptureDistance.sample(this->writeHistoryBuffer.get_size() - dataWHBIndex);
+            if (DTRACE(PredictorFrontendLogic) ) {
+                std::stringstream ss;
+                ss << "[" << std::setw(2) << i << "]Found a matching block, details: "
+                   << " Offset: "           << std::setw(2)     << dataOffset
+                   << " Position: "         << std::setw(2)     << i
+                   << " data: "             << print_ptr(8)     << cacheLineAccumulator->at(addr).get_datachunks()[i].get_data()
+                   << " found: "            << print_ptr(8)     << whbEntry.get_cacheline().get_datachunks()[dataOffset].get_data()
+                   << " pc: "               << print_ptr(16)    << whbEntry.get_pc()
+                   << " address: "          << print_ptr(16)    << destAddr
+                   << " whb_iter_cnt = "    << std::dec         << dataWHBIndex
+                   << " whb_id = "          << std::dec         << whbEntry.get_id()
+                   << " size = "            << std::dec         << whbEntry.get_size()
+                   << std::endl;
+                DPRINTF(PredictorFrontendLogic, ss.str().c_str());
             }
 
-            // std::cout << "missingChunks" << std::endl;
-            /* Iterate over all the data chunks of the accumulated cacheline to find entries in the current write history buffer iter */
-            for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
-                assert(set_2 == entryToInsert.get_datachunks()[2].get_completion());
-                /* Process this block only if it is valid and not already found */
-                if (dataChunks[i].is_valid() 
-                        /* If this block is not already predicted */
-                        and not entryToInsert.get_datachunks()[i].get_completion()) {
-                    int dataOffset = whb_iter->get_cacheline().get_data_offset(dataChunks[i].get_data());   
-                    bool useVal = dataOffset != -1;
-
-                    if (useVal) { 
-                        /* Found a match for predicting the data */
-                        dataPredFound = true;
-
-                        /* Sample the distance at which this block was found */
-                        this->pcCaptureDistance.sample(this->writeHistoryBuffer.get_size() - whb_iter_cnt);
-                        if (DTRACE(PredictorFrontendLogic) ) {
-                            std::stringstream ss;
-                            ss << "[" << std::setw(2) << i << "]Found a matching block, details: "
-                               << " Offset: "           << std::setw(2)     << dataOffset
-                               << " Position: "         << std::setw(2)     << i
-                               << " data: "             << print_ptr(8)     << cacheLineAccumulator.at(addr).get_datachunks()[i].get_data()
-                               << " found: "            << print_ptr(8)     << whb_iter->get_cacheline().get_datachunks()[dataOffset].get_data()
-                               << " pc: "               << print_ptr(16)    << whb_iter->get_pc()
-                               << " address: "          << print_ptr(16)    << destAddr
-                               << " whb_iter_cnt = "    << std::dec         << whb_iter_cnt
-                               << " whb_id = "          << std::dec         << whb_iter->get_id()
-                               << " size = "            << std::dec         << whb_iter->get_size()
-                               << std::endl;
-                            DPRINTF(PredictorFrontendLogic, ss.str().c_str());
-                        }
+            auto &destDataChunk = entryToInsert.get_datachunks()[i];
 
-                        auto &destDataChunk = entryToInsert.get_datachunks()[i];
+            destDataChunk.set_chunk_type(ChunkInfo::ChunkType::DATA);
+            destDataChunk.set_completion(true);
 
-                        destDataChunk.set_chunk_type(ChunkInfo::ChunkType::DATA);
-                        destDataChunk.set_completion(true);
-                        if (i == 2) {
-                            set_2 = true;
-                        }
+            auto cacheline = whbEntry.get_cacheline();
+            auto offset = dataOffset 
+                        - cacheline.find_first_valid_index();
+            
+            panic_if(offset >= whbEntry.get_size(),
+                     "Offset calculation error, offset = %d, size = %d",
+                     dataOffset, whbEntry.get_size());
+
+            destDataChunk.set_generating_pc(pc);
+            destDataChunk.set_gen_pc_in_tick(whbEntry.get_gen_tick());
+            destDataChunk.set_owner_key(destAddr);
+            destDataChunk.set_data_field_offset(offset);
+            
+            destDataChunk.set_data(dataChunks[i].get_data());
 
-                        auto cacheline = whb_iter->get_cacheline();
-                        auto offset = dataOffset 
-                                    - cacheline.find_first_valid_index();
-                        
-                        panic_if(offset >= whb_iter->get_size(),
-                                 "Offset calculation error, offset = %d, size = %d",
-                                 dataOffset, whb_iter->get_size());
-
-                        destDataChunk.set_generating_pc(pc);
-                        destDataChunk.set_gen_pc_in_tick(whb_iter->get_gen_tick());
-                        destDataChunk.set_owner_key(destAddr);
-                        destDataChunk.set_data_field_offset(offset);
-                        
-                        destDataChunk.set_data(dataChunks[i].get_data());
-
-                        assert(entryToInsert.get_datachunks()[i].is_valid());
-                        
-                        usedWHBIndices[whb_iter_cnt] = true;
-
-                        /**
-                         * ! Use for PC generation only if the value of the soruce is non-zero 
-                         * */
-                        if (dataChunks[i].get_data() != 0) { //! Fix this
-                            hashQueue.push_back(whb_iter->get_path_hash());
-                        }
-                    }
-                } else {
-                    if (dataChunks[i].is_invalid()) {
-                        entryToInsert.get_datachunks()[i].set_chunk_type(ChunkInfo::ChunkType::INVALID);
-                    }
-                }
+            assert(entryToInsert.get_datachunks()[i].is_valid());
+            
+            usedWHBIndices[dataWHBIndex] = true;
+
+            /**
+             * ! Use for PC generation only if the value of the soruce is non-zero 
+             * */
+            if (dataChunks[i].get_data() != 0) { //! Fix this
+                updateHashSrc(dataWHBIndex);
+            }
+        }
 
-                /* Update the matching PC list */
-                if (dataChunks[i].is_valid()) {
-                    int dataOffset = whb_iter->get_cacheline().get_data_offset(dataChunks[i].get_data());   
-                    bool useVal = dataOffset != -1;
-                    if (useVal) { 
-                        //! Diagnostics only:
-                        //! Adding matching pc has a significant overhead, enable only if needed
-                        #ifdef DIAGNOSTICS_MATCHING_PC
-                            std::cout << "Incoming: Setting matching pcs " << (void*)pc << std::endl;
-                            entryToInsert.get_datachunks()[i].set_matching_pcs();
-
-                            entryToInsert.get_datachunks()[i].add_matching_pc(pc);
-                        #endif // DIAGNOSTICS_MATCHING_PC
+        /* Update the matching PC list */
+        //! Diagnostics only:
+        //! Adding matching pc has a significant overhead, enable only if needed
+        #ifdef DIAGNOSTICS_MATCHING_PC
+            this->writeHistoryBuffer.for_each_data(dataChunks[i].get_data(), 
+                [&](size_t whbIndex, int dataOffset) {
+                    auto &whbEntry = this->writeHistoryBuffer.get(whbIndex);
+                    if (not isUsableEntry(whbEntry)) {
+                        return;
                     }
-                }
-            } // Data chunk iterator
-        } else {
-            DPRINTF(PredictorFrontendLogic, "Skipping pc %p\n", (void*)whb_iter->get_pc());
-        } // Check for confidence
-        whb_iter_cnt++;
-    } // whb iterator
+                    PC_t pc = whbEntry.get_pc();
+                    std::cout << "Incoming: Setting matching pcs " << (void*)pc << std::endl;
+                    entryToInsert.get_datachunks()[i].set_matching_pcs();
+
+                    entryToInsert.get_datachunks()[i].add_matching_pc(pc);
+                });
+        #endif // DIAGNOSTICS_MATCHING_PC
+    } // Data chunk iterator
 
     size_t missingChunks = 0;
     // std::cout << "missingChunks" << missingChunks << std::endl;
@@ -1262,7 +1392,7 @@ PredictorFrontend::processLastAccLine(Addr addr) {
     if (not foundAnything) {
         this->cacheLineNotInWHB++;
         // std::cout << "[Not found] Unable to find cacheline " 
-        //           << this->cacheLineAccumulator.at(destAddr) 
+        //           << this->cacheLineAccumulator->at(destAddr) 
         //           << std::endl;
         if (not addrPredFound) {
             // std::cout << "Reason: Address prediction not found for addr " 
@@ -1291,10 +1421,12 @@ PredictorFrontend::processLastAccLine(Addr addr) {
         
         /*  Diagnostics information */
         entryToInsert.destAddr_diag = cacheline_align(destAddr);
-        entryToInsert.set_original_cacheline(this->cacheLineAccumulator.at(destAddr));
+        entryToInsert.set_original_cacheline(this->cacheLineAccumulator->at(destAddr));
         this->pWritesFoundInWHB++;
-        panic_if(hashQueue.size() == 0, "Queue size cannot be zero");
-        this->addToPredictorTable(hashQueue.at(0), entryToInsert);        
+        panic_if(hashSrcIndex == -1, "No whb entry found for the hash");
+        this->addToPredictorTable(
+            this->writeHistoryBuffer.get(hashSrcIndex).get_path_hash(), 
+            entryToInsert);        
     }
 
     this->markIHBEntriesAsUsed(usedWHBIndices);
@@ -1313,23 +1445,21 @@ PredictorFrontend::addToPredictorTable(hash_t hash, PredictorTableEntry &entryTo
     //         hash.c_str(), entryToInsert.gen_pc_as_cl().to_string().c_str());
     
     this->predictorTable.add(entryToInsert);
-    this->predictorTable.dump();
 }
 
 void
 PredictorFrontend::handleConstPredictions(CompletedWriteEntry &completedWrite) {
     hash_t hash = completedWrite.get_generator_hash();
-    if (SharedArea::constPredTracker.find(hash) != SharedArea::constPredTracker.end()) {
-        for (auto offset : SharedArea::constPredTracker.at(hash)) {
+    if (constChunks.find(hash) != constChunks.end()) {
+        for (auto offset : constChunks.at(hash)) {
             if (offset.second.timesFound > 0 
                     and completedWrite.get_orig_cacheline().get_datachunks()[offset.first].is_valid()) {
                 DataChunk constData = completedWrite.get_orig_cacheline().get_datachunks()[offset.first].get_data();
                 //! Choose between keeping the orignal value or last seen value
                 // completedWrite.get_cacheline().get_datachunks()[offset.first].set_data(constData);
-                std::unordered_map<size_t, SharedArea::constChunkLocator> map = SharedArea::constPredTracker.at(hash);
                 completedWrite.get_cacheline().get_datachunks()[offset.first].set_chunk_type(ChunkInfo::ChunkType::DATA);
                 completedWrite.get_cacheline().get_datachunks()[offset.first].set_data(
-                    map.at(offset.first).lastData
+                    offset.second.lastData
                 );
                 completedWrite.get_cacheline().get_datachunks()[offset.first].set_constant_pred();
                 DPRINTF(PredictorFrontendLogic, "Setting constant value of prediction of address %p at offset %d to value %p, triggered by counter value = %d\n", completedWrite.get_addr(), offset.first, constData, offset.second.timesFound);
@@ -1338,6 +1468,175 @@ PredictorFrontend::handleConstPredictions(CompletedWriteEntry &completedWrite) {
     }
 }
 
+void
+PredictorFrontend::sendToBackend(const CompletedWriteEntry &entry) {
+    if (channel != nullptr and not channel->send_prediction(curTick(), entry)) {
+        DPRINTF(PredictorFrontendLogic, "Channel to the backend is full, "
+                "dropping the prediction for %p\n", (void*)entry.get_addr());
+        this->droppedPredictions++;
+        return;
+    }
+    if (channel != nullptr) {
+        backend->wakeReceive(curTick() + channel->get_prediction_latency());
+    }
+}
+
+void
+PredictorFrontend::receiveFeedback() {
+    if (channel == nullptr) {
+        return;
+    }
+    this->receivedFeedback += channel->receive_feedback(curTick(),
+        [this](FeedbackMessage &msg) {
+            switch (msg.kind) {
+            case FeedbackMessage::Kind::CORRECT_PREDICTION:
+                this->predictorTable.notify_backend_prediction(
+                        msg.hash, msg.dataPredicted);
+                break;
+            case FeedbackMessage::Kind::PATH_CONFIDENCE:
+                this->predictorTable.raise_path_confidence(msg.hash);
+                break;
+            case FeedbackMessage::Kind::PC_CONFIDENCE:
+                this->pcConfidence[msg.pc] = msg.confidence;
+                break;
+            case FeedbackMessage::Kind::CONST_CHUNK: {
+                ConstChunkLocator &locator 
+                        = this->constChunks[msg.hash][msg.offset];
+                locator.timesFound = msg.timesFound;
+                locator.lastData = msg.lastData;
+                break;
+            }
+            case FeedbackMessage::Kind::CLWB_LATENCY:
+                this->receiveClwbLatency(msg.paddr, msg.latency);
+                break;
+            }
+        });
+}
+
+void
+PredictorFrontend::scheduleFeedback() {
+    Tick next = channel == nullptr ? MaxTick : channel->next_feedback_tick();
+    if (next != MaxTick) {
+        scheduleFeedbackAt(next);
+    }
+}
+
+void
+PredictorFrontend::scheduleFeedbackAt(Tick when) {
+    when = std::max(when, curTick());
+    if (not feedbackEvent.scheduled()) {
+        schedule(feedbackEvent, when);
+    } else if (when < feedbackEvent.when()) {
+        reschedule(feedbackEvent, when);
+    }
+}
+
+void
+PredictorFrontend::wakeFeedback(Tick ready) {
+    /* The backend may run on another event queue, take the lock of ours */
+    EventQueue::ScopedMigration migrate(eventQueue());
+    this->scheduleFeedbackAt(ready);
+}
+
+bool
+PredictorFrontend::isPMClwb(const PacketPtr pkt) const {
+    return channel != nullptr and pkt->req->isToPOC()
+            and pkt->req->getSize() == 1 and not pkt->hasData()
+            and pkt->req->hasPaddr() and pkt->req->getVaddr() != 0
+            and is_vaddr_pm(pkt->req->getVaddr());
+}
+
+void
+PredictorFrontend::trackClwb(const PacketPtr pkt) {
+    if (pkt->needsResponse() and this->isPMClwb(pkt)) {
+        this->outstandingClwbs[pkt->req->getPaddr()]++;
+    }
+}
+
+void
+PredictorFrontend::respondClwb(PacketPtr pkt, Tick ready) {
+    const Addr paddr = pkt->req->getPaddr();
+    HeldClwbResponse held = {pkt, paddr, ready, MaxTick};
+
+    auto latencies = this->clwbLatencies.find(paddr);
+    if (latencies != this->clwbLatencies.end()) {
+        Tick latency = latencies->second.front();
+        latencies->second.pop_front();
+        if (latencies->second.empty()) {
+            this->clwbLatencies.erase(latencies);
+        }
+        this->sendClwbResponse(held, latency);
+        return;
+    }
+
+    /**
+     * The latency was sent before the response left the backend, it is
+     * dropped if it is not here after the feedback latency
+     */
+    held.deadline = curTick() + channel->get_feedback_latency() + 1;
+    this->heldClwbResponses.push_back(held);
+    if (not clwbTimeoutEvent.scheduled()) {
+        schedule(clwbTimeoutEvent, held.deadline);
+    }
+}
+
+void
+PredictorFrontend::receiveClwbLatency(Addr paddr, Tick latency) {
+    for (auto held = this->heldClwbResponses.begin();
+            held != this->heldClwbResponses.end(); held++) {
+        if (held->paddr == paddr) {
+            HeldClwbResponse response = *held;
+            this->heldClwbResponses.erase(held);
+            this->sendClwbResponse(response, latency);
+            return;
+        }
+    }
+
+    /* Keep the latency if the response is on its way */
+    auto outstanding = this->outstandingClwbs.find(paddr);
+    if (outstanding == this->outstandingClwbs.end()) {
+        return;
+    }
+    auto &latencies = this->clwbLatencies[paddr];
+    if (latencies.size() < outstanding->second) {
+        latencies.push_back(latency);
+    }
+}
+
+void
+PredictorFrontend::sendClwbResponse(const HeldClwbResponse &held,
+                                    Tick latency) {
+    if (not PredictorBackend::predictorEnabled) {
+        latency = 0;
+    }
+    slavePort.schedTimingResp(held.pkt,
+                              std::max(held.ready + latency, curTick()));
+
+    auto outstanding = this->outstandingClwbs.find(held.paddr);
+    if (outstanding != this->outstandingClwbs.end()
+            and --outstanding->second == 0) {
+        this->outstandingClwbs.erase(outstanding);
+        this->clwbLatencies.erase(held.paddr);
+    }
+}
+
+void
+PredictorFrontend::clwbTimeout() {
+    /* Latencies due by now release their responses first */
+    this->receiveFeedback();
+
+    while (not this->heldClwbResponses.empty()
+            and this->heldClwbResponses.front().deadline <= curTick()) {
+        HeldClwbResponse held = this->heldClwbResponses.front();
+        this->heldClwbResponses.pop_front();
+        this->sendClwbResponse(held, 0);
+    }
+
+    if (not this->heldClwbResponses.empty()) {
+        schedule(clwbTimeoutEvent, this->heldClwbResponses.front().deadline);
+    }
+}
+
 void
 PredictorFrontend::sendWritesToBackend(std::deque<PendingTableEntryParent*> &completedEntries) {
     /* Add the completed entry to  the pending table */
@@ -1367,7 +1666,8 @@ PredictorFrontend::sendWritesToBackend(std::deque<PendingTableEntryParent*> &com
         this->predictedWriteCount++;   
         std::stringstream ss;
         Addr_t paddr = -1;
-	    std::cout << "Trying to translate " << (void*)predictedWrite->addr.get_target_addr() << std::endl;
+        DPRINTF(PredictorFrontendLogic, "Trying to translate %p\n",
+                (void*)predictedWrite->addr.get_target_addr());
         EmulationPageTable::pageTableStaticObj->translate(predictedWrite->addr.get_target_addr(), paddr);
 
         std::stringstream hash;
@@ -1386,10 +1686,12 @@ PredictorFrontend::sendWritesToBackend(std::deque<PendingTableEntryParent*> &com
         /* Send the write */
         // panic_if_not(predictedWrite->has_addr());
         panic_if_not(entryToInsert.has_addr());
-        PredictorBackend::addCompletedWrite(entryToInsert);
+        this->sendToBackend(entryToInsert);
     }
-    while (!completedEntries.size()) {       
-        // delete completedEntries.front();
+
+    /* The backend holds a copy, return the parents to the pending table */
+    while (not completedEntries.empty()) {       
+        this->pendingTable.put_parent(completedEntries.front());
         completedEntries.pop_front();    
     }
 }
@@ -1436,12 +1738,13 @@ PredictorFrontend::updatePendingTable(const PacketPtr pkt) {
     bool completedWritesToSend = not predictedWrites.empty();
     if (completedWritesToSend) {
         // std::cout << "Sending write to backend" << std::endl;
-        if (this->addrPredictor.can_pred_addr() and not disableFancyAddrPred) {
+        Addr_t predictedAddr = disableFancyAddrPred
+                ? 0 : this->addrPredictor.predict(pc);
+        if (predictedAddr != 0) {
             for (auto predictedWrite : predictedWrites) {
                 Addr_t originalAddr = predictedWrite->addr.get_target_addr();                
-                predictedWrite->addr.set_target_addr(
-                    this->addrPredictor.predict_addr()
-                );
+                predictedWrite->addr.set_target_addr(predictedAddr);
+                this->addrPredictions++;
 
                 // std::cout << HBLU "Changed the address from " 
                 //           << (void*)originalAddr
@@ -1449,14 +1752,16 @@ PredictorFrontend::updatePendingTable(const PacketPtr pkt) {
                 //           << (void*)predictedWrite->addr.get_target_addr() 
                 //           << std::endl;
 
-                // std::cout << this->addrPredictor.state_to_string(true) << std::endl;
+                // std::cout << this->addrPredictor.state_to_string() << std::endl;
             }
         }
         
-        this->sendWritesToBackend(predictedWrites);
-        for (auto write : predictedWrites) {
-            genHash << write->get_generator_hash() << std::endl;
+        if (snapshot != nullptr) {
+            for (auto write : predictedWrites) {
+                generatedHashes[write->get_generator_hash()]++;
+            }
         }
+        this->sendWritesToBackend(predictedWrites);
     }
 }
 
@@ -1559,7 +1864,7 @@ PredictorFrontend::handleWrite(const PacketPtr pkt) {
                     }
                 }
 
-                PendingTableEntryParent *parent = new PendingTableEntryParent();
+                PendingTableEntryParent *parent = this->pendingTable.alloc_parent();
 
                 // std::cout << "Creating parent with address: " << parent << std::endl;
                 /* Address should always be valid */
@@ -1617,8 +1922,8 @@ PredictorFrontend::handleWrite(const PacketPtr pkt) {
                     }
                 }
 
-                // TODO: Handle memory leak here
-                /* Set the value of the data chunks using the two IHB entries */
+                /* The waiting chunks hold the parent from here on */
+                this->pendingTable.put_parent(parent);
 
             }
         }
@@ -1639,7 +1944,18 @@ PredictorFrontend::handleWrite(const PacketPtr pkt) {
 
 void
 PredictorFrontend::dumpTrace(PacketPtr pkt) {
-    if (enableVolatileDump != "") {
+    if (volatileTrace != nullptr) {
+        /* Record the region of interest so a replay enables the predictor
+           for the same stores */
+        if (traceRoiActive != PredictorBackend::predictorEnabled) {
+            traceRoiActive = PredictorBackend::predictorEnabled;
+            TraceRecord marker;
+            marker.kind = traceRoiActive ? TraceRecord::Kind::ROI_BEGIN 
+                                         : TraceRecord::Kind::ROI_END;
+            marker.tick = curTick();
+            volatileTrace->write(marker);
+        }
+
         bool isPktWrite = pkt->isWrite() and (pkt->getSize() == 8 or pkt->getSize() == 4);
 
         bool isClwb = pkt->req->isToPOC();
@@ -1649,42 +1965,129 @@ PredictorFrontend::dumpTrace(PacketPtr pkt) {
         bool useWriteForTrace = isPktWrite and (writeSize == 4 or writeSize == 8);
 
         if (useWriteForTrace or isClwb) {
-            std::string locType = is_vaddr_pm(addr) ? "P" : "V";
-            std::string opType = isClwb ? "C" : "W"; // CLWB and write operations
-            std::string data = "";
-
-            /* Convert the data to hex string of appropriate size */
-            std::stringstream ss;
-            if (writeSize == 4) {
-                ss << print_ptr(8) << *pkt->getPtr<uint32_t>();
-            } else if (writeSize == 8) {
-                ss << print_ptr(16) << *pkt->getPtr<uint64_t>();
-            } else {
-                ss << "0x0";
+            TraceRecord record;
+            record.isClwb = isClwb;
+            record.persistent = is_vaddr_pm(addr);
+            record.pc = pkt->req->getPC();
+            record.addr = addr;
+            record.paddr = pkt->req->hasPaddr() ? pkt->getAddr() : 0;
+            record.size = writeSize;
+            record.tick = curTick();
+            if (pkt->req->hasContextId()) {
+                record.contextId = pkt->req->contextId();
+            }
+            if ((writeSize == 4 or writeSize == 8) and pkt->hasData()) {
+                record.set_data(pkt->getConstPtr<uint8_t>(), writeSize);
             }
-            data = ss.str();
-
-            myFile << "@" << print_ptr(16) << pkt->req->getPC()     // Write PC
-                << " " << locType                                   // Address type
-                << " " << opType                                    // C for clwb and W for write
-                << " " << print_ptr(16) << pkt->req->getVaddr()     // write address
-                << " " << print_ptr(1) << writeSize                 // write size in hex
-                << " " << data                                      // data
-                << " " << print_ptr(16) << curTick()                // Tick
-                << std::endl;
+            volatileTrace->write(record);
         }       
     }
 }
 
+void
+PredictorFrontend::closeTrace() {
+    if (volatileTrace != nullptr) {
+        volatileTrace->close();
+    }
+    if (snapshot != nullptr) {
+        snapshot->close();
+    }
+}
+
+void
+PredictorFrontend::takeSnapshot() {
+    const Tick now = curTick();
+
+    snapshot->begin_section(SnapshotWriter::Section::WRITE_HISTORY_BUFFER,
+                            now, writeHistoryBuffer.get_size(),
+                            4 * 8 + DATA_CHUNK_COUNT * 4);
+    for (auto &entry : writeHistoryBuffer) {
+        const CacheLine &line = entry.get_cacheline();
+        snapshot->put((uint64_t)entry.get_pc());
+        snapshot->put((uint64_t)entry.get_gen_tick());
+        snapshot->put((uint64_t)(line.has_addr() ? line.get_addr() : 0));
+        snapshot->put((uint64_t)line.get_valid_mask());
+        for (size_t i = 0; i < DATA_CHUNK_COUNT; i++) {
+            snapshot->put((uint32_t)line.get_data_words()[i]);
+        }
+    }
+
+    snapshot->begin_section(SnapshotWriter::Section::PREDICTOR_TABLE,
+                            now, predictorTable.get_size(),
+                            2 * 8 + 2 * 4 + 8 + DATA_CHUNK_COUNT * 4);
+    predictorTable.for_each_entry([&](hash_t hash, PredictorTableEntry &entry) {
+        ChunkInfo &addrChunk = entry.get_addr_chunk();
+        snapshot->put((uint64_t)hash);
+        bool hasAddr = 
+                addrChunk.get_chunk_type() == ChunkInfo::ChunkType::ADDR;
+        snapshot->put((uint64_t)(hasAddr ? addrChunk.get_target_addr() : 0));
+        snapshot->put((uint32_t)entry.addrConf());
+        snapshot->put((uint32_t)entry.dataConf());
+
+        uint64_t validMask = 0;
+        ChunkInfo *chunks = entry.get_datachunks();
+        for (size_t i = 0; i < DATA_CHUNK_COUNT; i++) {
+            if (chunks[i].get_chunk_type() == ChunkInfo::ChunkType::DATA
+                    and chunks[i].has_data()) {
+                validMask |= 1ul << i;
+            }
+        }
+        snapshot->put(validMask);
+        for (size_t i = 0; i < DATA_CHUNK_COUNT; i++) {
+            snapshot->put((uint32_t)(validMask & (1ul << i)
+                                        ? chunks[i].get_data() : 0));
+        }
+    });
+
+    snapshot->begin_section(SnapshotWriter::Section::HASH_COUNTS,
+                            now, generatedHashes.size(), 2 * 8);
+    for (auto &hashCount : generatedHashes) {
+        snapshot->put((uint64_t)hashCount.first);
+        snapshot->put(hashCount.second);
+    }
+    generatedHashes.clear();
+}
+
+void
+PredictorFrontend::handleAcceptedRequest(const PacketPtr pkt) {
+    /* The same packet and request seen again in the same tick is a
+     * redelivery, different packets in one tick are separate stores */
+    if (pkt == lastHandledPkt and pkt->req.get() == lastHandledReq
+            and curTick() == lastHandledTick) {
+        DPRINTF(PredictorFrontendInterface, "Duplicate request %s addr "
+                "0x%x\n", pkt->cmdString(), pkt->getAddr());
+        this->duplicateRequests++;
+        return;
+    }
+
+    if (curTick() == lastHandledTick and pkt->isWrite()) {
+        this->sameTickStores++;
+    }
+
+    lastHandledPkt = pkt;
+    lastHandledReq = pkt->req.get();
+    lastHandledTick = curTick();
+
+    this->predictorHandleRequest(pkt);
+}
+
 void
 PredictorFrontend::predictorHandleRequest(const PacketPtr pkt) {
     this->dumpTrace(pkt);
 
     //! SUYASH
-    if (PredictorBackend::predictorEnabled == false or PredictorBackend::usePredictor == false) {
+    if (PredictorBackend::predictorEnabled == false or backend == nullptr
+            or backend->usePredictor == false) {
         return;
     }
 
+    /* Feedback is applied before the request can trigger a prediction */
+    this->receiveFeedback();
+
+    /* Path history and accumulator of the hardware thread */
+    this->selectContext(pkt->req->hasContextId() ? pkt->req->contextId()
+                                                 : InvalidContextID);
+
     this->collectPktStatistics(pkt);
     auto addr =  pkt->req->getVaddr();
 
@@ -1697,7 +2100,6 @@ PredictorFrontend::predictorHandleRequest(const PacketPtr pkt) {
                 (void*)tgtPC, curTick(), isPCInPCFilter, isPktWrite, 
                 pkt->print());
         PRINT_DATA;
-        std::cout << "isPCIn " << isPCInPCFilter << std::endl;
     }
 
     bool isClwb = is_vaddr_clwb(pkt);
@@ -1709,7 +2111,8 @@ PredictorFrontend::predictorHandleRequest(const PacketPtr pkt) {
     }
  
     if (isPCInPCFilter) {
-        std::cout << __LINE__ << " Handling write for PC of interest" << std::endl;
+        DPRINTF(PredictorFrontendLogic, "Handling write for PC in the PC "
+                "filter %p\n", (void*)tgtPC);
     }
 
     /* Handles all the logic associated with the write requests */
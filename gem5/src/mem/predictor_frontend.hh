@@ -69,10 +69,16 @@
 #include "debug/PredictorFrontendLogic.hh"
 #include "debug/CacheLineAccumulator.hh"
 
-#include "mem/predictor/AddrPredictor.hh"
+#include "mem/predictor/AddrPredictorStage.hh"
+#include "mem/predictor/CachelineAccumulator.hh"
 #include "mem/predictor/Declarations.hh"
 #include "mem/predictor/FixedSizeQueue.hh"
+#include "mem/predictor/LineSource.hh"
 #include "mem/predictor/PCQueue.hh"
+#include "mem/predictor/PredictionChannel.hh"
+#include "mem/predictor/SharedArea.hh"
+#include "mem/predictor/SnapshotWriter.hh"
+#include "mem/predictor/TraceWriter.hh"
 #include "mem/mem_object.hh"
 #include "mem/packet.hh"
 #include "mem/port.hh"
@@ -101,18 +107,47 @@
 class PredictorFrontend : public ClockedObject
 {
   private:
-    Tick lastPredictorTick = 0;
+    /* Identity of the last request passed to the predictor */
+    const Packet *lastHandledPkt = nullptr;
+    const Request *lastHandledReq = nullptr;
+    Tick lastHandledTick = MaxTick;
     size_t CL_ACC_SIZE = 4;
     // Tick ACC_RETIRE_TICK_PERIOD = 100*1000; // 100 ns
     Tick ACC_RETIRE_TICK_PERIOD = 10*1000; // 100 ns
     // Tick ACC_ENTRY_RETIRE_THRESHOLD = 500*1000; // 1000 ns
     Tick ACC_ENTRY_RETIRE_THRESHOLD = 500*1000; // 1000 ns
     bool disableFreePrediction = false;
-    AddrPredictor addrPredictor;
-  public:
-    std::ofstream myFile;
+    AddrPredictorStage addrPredictor;
+
+    /* Contents of the lines completed by free predictions, the L2 if null */
+    LineSource *lineSource = nullptr;
+
+    /**
+     * Copies the current contents of the line at paddr to data
+     * @return False if the line is not available
+     */
+    bool readLine(Addr paddr, DataChunk data[DATA_CHUNK_COUNT]);
   protected:
-    std::string enableVolatileDump = "0";
+    /* Store and CLWB trace, nullptr if disabled */
+    TraceWriter *volatileTrace = nullptr;
+    /* Predictor state last recorded in the trace */
+    bool traceRoiActive = false;
+
+    /* Sampled WHB and predictor table snapshots, nullptr if disabled */
+    SnapshotWriter *snapshot = nullptr;
+    /* Path hashes of the predicted writes since the last snapshot */
+    std::unordered_map<hash_t, uint64_t> generatedHashes;
+
+    /* Backend verifying the predictions, nullptr if none */
+    PredictorBackend *backend = nullptr;
+    /* Link to the backend, owned by the backend, nullptr if none */
+    PredictionChannel *channel = nullptr;
+    /* Confidence of the generating PCs as last reported by the backend */
+    std::unordered_map<PC_t, uint32_t> pcConfidence;
+    /* Constant chunks of each path hash as last reported by the backend */
+    std::unordered_map<hash_t,
+                       std::unordered_map<size_t, ConstChunkLocator>
+                       > constChunks;
 
     /**
      * A deferred packet stores a packet along with its scheduled
@@ -352,10 +387,33 @@ class PredictorFrontend : public ClockedObject
     /** Master port of the pf. */
     PFMasterPort masterPort;
 
-    FixedSizeQueue<WriteHistoryBufferEntry> writeHistoryBuffer;
+    WriteHistoryBuffer writeHistoryBuffer;
     PredictorTable predictorTable;
     PendingTable pendingTable;
 
+    /* Retires the accumulated lines at the earliest retirement deadline */
+    EventFunctionWrapper accRetireEvent;
+
+    /* Applies the feedback at the ready tick of the oldest message */
+    EventFunctionWrapper feedbackEvent;
+
+    /* PM CLWB response waiting for its BMO latency from the backend */
+    struct HeldClwbResponse {
+        PacketPtr pkt;
+        Addr paddr;
+        /* Tick the response is sent without the BMO latency */
+        Tick ready;
+        /* The latency was dropped if it did not arrive by then */
+        Tick deadline;
+    };
+    std::deque<HeldClwbResponse> heldClwbResponses;
+    /* PM CLWBs sent to the backend whose response did not come back */
+    std::unordered_map<Addr, unsigned> outstandingClwbs;
+    /* BMO latencies that arrived before the response of their CLWB */
+    std::unordered_map<Addr, std::deque<Tick>> clwbLatencies;
+    /* Sends the held CLWB responses whose latency never arrived */
+    EventFunctionWrapper clwbTimeoutEvent;
+
     void updateWriteHistoryBuffer(PacketPtr pkt);
 
     bool canAddToWhb(PacketPtr pkt);
@@ -364,17 +422,29 @@ class PredictorFrontend : public ClockedObject
       if (DTRACE(PredictorFrontendLogic) ) {
           std::stringstream ss;
           ss << "[" << (void*)addr << "]Cached line: ";
-          ss << this->cacheLineAccumulator[addr] << std::endl;
+          ss << this->cacheLineAccumulator->at(addr) << std::endl;
           DPRINTF(PredictorFrontendLogic, ss.str().c_str());
       }
     }
 
-    std::unordered_map<Addr, CacheLine> cacheLineAccumulator;
+    /* Cacheline accumulator of each hardware thread context */
+    std::unordered_map<ContextID, CachelineAccumulator> contextAccumulators;
+    /* Accumulator of the context selected by selectContext() */
+    CachelineAccumulator *cacheLineAccumulator = nullptr;
+    ContextID currentContext = InvalidContextID;
+    /* All contexts share the context 0 path history and accumulator */
+    bool sharedContextState = false;
+    /* Entries of the accumulator of a context, CL_ACC_SIZE when shared */
+    size_t accSizePerContext = 4;
+
+    /**
+     * Selects the path history and the cacheline accumulator of context,
+     * requests without a context keep the current selection.
+     */
+    void selectContext(ContextID context);
     size_t addrChangesSinceClwb = 0;
     Addr_t lastAlignedPMAddr = 0;
 
-    Tick lastAccumulatorRetireTick = 0;
-
     /** 
      * Collects the clwb to  last write distance information 
      * Note: Address is always aligned 
@@ -416,12 +486,17 @@ class PredictorFrontend : public ClockedObject
     Stats::Distribution whbTimeLen;
     Stats::Distribution writebackDistStat;
     Stats::Distribution writebackDistStatMicro;
-
-    std::ofstream genHash;
+    Stats::Scalar droppedPredictions;
+    Stats::Scalar receivedFeedback;
+    Stats::Scalar duplicateRequests;
+    Stats::Scalar sameTickStores;
+    Stats::Scalar addrPredictions;
   public:
     const int MAX_WHB_ENTRIES = 128;
     bool disablePerPCConfidence = false;
     bool disableFancyAddrPred = false;
+    /* Stores from these PCs are traced */
+    std::vector<Addr> addrOfInterest;
 
     Port &getPort(const std::string &if_name,
                   PortID idx=InvalidPortID) override;
@@ -431,7 +506,13 @@ class PredictorFrontend : public ClockedObject
     typedef PredictorFrontendParams Params;
 
     PredictorFrontend(Params *p);
+
+    /* Reads the lines from source instead of the L2 cache */
+    void setLineSource(LineSource *source) { lineSource = source; }
     
+    /* Passes an accepted request to the predictor unless it is a
+     * redelivery of the last one */
+    void handleAcceptedRequest(PacketPtr pkt);
     void predictorHandleRequest(PacketPtr pkt);
     void refreshPredictorTable(PacketPtr pkt);
 
@@ -461,11 +542,57 @@ class PredictorFrontend : public ClockedObject
 
     void addToPredictorTable(hash_t hash, PredictorTableEntry &entryToInsert);
     
+    /**
+     * Sends the completed parents to the backend and returns them to the 
+     * pending table, completedEntries is empty on return.
+     */
     void sendWritesToBackend(std::deque<PendingTableEntryParent*> &completedEntries);
 
+    /* Sends a prediction through the channel, counts it if dropped */
+    void sendToBackend(const CompletedWriteEntry &entry);
+
+    /* Applies the backend feedback that reached the frontend by now */
+    void receiveFeedback();
+
+    /* Schedules feedbackEvent for the oldest feedback in the channel */
+    void scheduleFeedback();
+
+    /* Schedules feedbackEvent at when unless it is scheduled earlier */
+    void scheduleFeedbackAt(Tick when);
+
+    /* PM CLWB whose response waits for the BMO latency in the feedback */
+    bool isPMClwb(const PacketPtr pkt) const;
+
+    /* Counts a PM CLWB sent to the backend */
+    void trackClwb(const PacketPtr pkt);
+
+    /**
+     * Sends the response of a PM CLWB at ready plus its BMO latency, holds
+     * the response if the latency did not arrive yet
+     */
+    void respondClwb(PacketPtr pkt, Tick ready);
+
+    /* Applies the BMO latency of a CLWB to paddr received as feedback */
+    void receiveClwbLatency(Addr paddr, Tick latency);
+
+    /* Sends the held response of a CLWB to paddr */
+    void sendClwbResponse(const HeldClwbResponse &held, Tick latency);
+
+    /* Runs as clwbTimeoutEvent */
+    void clwbTimeout();
+
     void dumpTrace(PacketPtr pkt);
 
+    /* Flushes the store trace and the snapshots, called on exit */
+    void closeTrace();
+
+    /* Writes the WHB, the predictor table and generatedHashes */
+    void takeSnapshot();
+
     void manageCachelineAcc(PacketPtr pkt);
+
+    /* Sends the oldest accumulated line to the backend and drops it */
+    void evictOldestAccLine(PacketPtr pkt);
     
     void handleConstPredictions(CompletedWriteEntry &completedWrite);
 
@@ -476,11 +603,17 @@ class PredictorFrontend : public ClockedObject
 
     /**
      * Method for retiring old entries from the accumulator to form predicted 
-     * cachelines that are send to the backend
+     * cachelines that are send to the backend, runs as accRetireEvent
     */
     void cachelineAccumulatorRetireTick(); 
 
-    static void SendCacheLineToBackend(CacheLine cacheline);
+    /* Schedules accRetireEvent for the earliest line due, if not pending */
+    void scheduleAccumulatorRetire();
+
+    /* Sends the lines of accumulator that were not updated for a while */
+    void retireAccumulatorLines(CachelineAccumulator &accumulator);
+
+    void SendCacheLineToBackend(CacheLine cacheline);
 
     /* For finding write to writeback distance */
     std::unordered_map<Addr_t, Tick> writebackDistMap;
@@ -491,6 +624,14 @@ class PredictorFrontend : public ClockedObject
      *                 indices to be marked as used
     */
     void markIHBEntriesAsUsed(std::unordered_map<size_t, bool> indices);
+
+  public:
+    /**
+     * Wakes the frontend up to apply feedback sent by the backend that is
+     * visible at ready. Safe to call from the event queue of the backend,
+     * the channel is not looked at.
+     */
+    void wakeFeedback(Tick ready);
 };
 
 
@@ -0,0 +1,211 @@
+#include "mem/predictor_trace_replay.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "mem/dram_ctrl.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
+#include "sim/sim_exit.hh"
+#include "sim/system.hh"
+
+PredictorTraceReplay::PredictorTraceReplay(const Params *p)
+    : SimObject(p),
+      port(p->name + ".port", this),
+      frontend(p->frontend),
+      backend(p->backend),
+      memCtrl(p->mem_ctrl),
+      masterId(p->system->getMasterId(this)),
+      alwaysEnabled(p->always_enabled),
+      pageSize(p->page_size),
+      pageTable(new EmulationPageTable(p->name + ".page_table", 0,
+                                       p->page_size)),
+      storeTrace(new TraceReader(p->store_trace)),
+      replayEvent([this]{ processReplayEvent(); }, name())
+{
+    if (p->writeback_trace != "") {
+        writebackTrace = new TraceReader(p->writeback_trace);
+    }
+
+    // There are no caches, free predictions read the lines from the trace
+    frontend->setLineSource(&lineImage);
+}
+
+PredictorTraceReplay::~PredictorTraceReplay()
+{
+    delete storeTrace;
+    delete writebackTrace;
+}
+
+Port &
+PredictorTraceReplay::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "port")
+        return port;
+    else
+        return SimObject::getPort(if_name, idx);
+}
+
+void
+PredictorTraceReplay::regStats()
+{
+    SimObject::regStats();
+
+    replayedStores
+        .name(name() + ".replayedStores")
+        .desc("Stores sent to the frontend");
+    replayedClwbs
+        .name(name() + ".replayedClwbs")
+        .desc("CLWBs sent to the frontend");
+    replayedWritebacks
+        .name(name() + ".replayedWritebacks")
+        .desc("Writebacks and CLWBs sent to the backend");
+    roiMarkers
+        .name(name() + ".roiMarkers")
+        .desc("Region of interest boundaries found in the store trace");
+}
+
+void
+PredictorTraceReplay::startup()
+{
+    PredictorBackend::predictorEnabled = alwaysEnabled;
+
+    hasStore = storeTrace->next(nextStore);
+    hasWriteback = writebackTrace and writebackTrace->next(nextWriteback);
+    scheduleNext();
+}
+
+void
+PredictorTraceReplay::scheduleNext()
+{
+    if (not hasStore and not hasWriteback) {
+        exitSimLoop("trace replay complete");
+        return;
+    }
+
+    Tick next = MaxTick;
+    if (hasStore) {
+        next = std::min(next, nextStore.tick);
+    }
+    if (hasWriteback) {
+        next = std::min(next, nextWriteback.tick);
+    }
+    /* Records of both traces are in tick order, the traces were written at
+       the ticks they are replayed at */
+    schedule(replayEvent, std::max(next, curTick()));
+}
+
+void
+PredictorTraceReplay::processReplayEvent()
+{
+    /* A store reaches the frontend before the writeback it causes reaches
+       the backend, stores go first on the same tick */
+    while (hasStore and nextStore.tick <= curTick()) {
+        replayStore(nextStore);
+        hasStore = storeTrace->next(nextStore);
+    }
+    while (hasWriteback and nextWriteback.tick <= curTick()) {
+        replayWriteback(nextWriteback);
+        hasWriteback = writebackTrace->next(nextWriteback);
+    }
+    scheduleNext();
+}
+
+void
+PredictorTraceReplay::mapPage(const TraceRecord &record)
+{
+    if (record.paddr == 0 or pageTable->lookup(record.addr) != nullptr) {
+        return;
+    }
+    pageTable->map(pageTable->pageAlign(record.addr),
+                   pageTable->pageAlign(record.paddr),
+                   pageSize);
+}
+
+void
+PredictorTraceReplay::replayStore(const TraceRecord &record)
+{
+    switch (record.kind) {
+    case TraceRecord::Kind::ROI_BEGIN:
+    case TraceRecord::Kind::ROI_END:
+        roiMarkers++;
+        if (not alwaysEnabled) {
+            PredictorBackend::predictorEnabled =
+                    record.kind == TraceRecord::Kind::ROI_BEGIN;
+        }
+        return;
+    case TraceRecord::Kind::ACCESS:
+        break;
+    }
+
+    mapPage(record);
+
+    Request::Flags flags = 0;
+    if (record.isClwb) {
+        flags = Request::CLEAN | Request::DST_POC | Request::CLWB;
+    }
+    /* The stores of every thread go through the path history of its
+       context, a trace without contexts uses context 0 */
+    ContextID context = record.contextId == InvalidContextID
+                        ? 0 : record.contextId;
+    auto req = std::make_shared<Request>(0, record.addr, record.size, flags,
+                                         masterId, record.pc, context);
+    req->setPaddr(record.paddr);
+
+    PacketPtr pkt = Packet::createWrite(req);
+    if (not record.isClwb) {
+        pkt->allocate();
+        if (record.hasData) {
+            pkt->setData(record.data);
+            if (record.paddr != 0) {
+                lineImage.write(record.paddr, record.data, record.size);
+            }
+        }
+        replayedStores++;
+    } else {
+        replayedClwbs++;
+    }
+
+    frontend->predictorHandleRequest(pkt);
+    delete pkt;
+}
+
+void
+PredictorTraceReplay::replayWriteback(const TraceRecord &record)
+{
+    if (record.kind != TraceRecord::Kind::ACCESS) {
+        return;
+    }
+
+    PacketPtr pkt;
+    if (record.isClwb) {
+        auto req = std::make_shared<Request>(
+                record.paddr, record.size,
+                Request::CLEAN | Request::DST_POC | Request::CLWB, masterId);
+        pkt = Packet::createWrite(req);
+    } else {
+        auto req = std::make_shared<Request>(record.paddr, record.size, 0,
+                                             masterId);
+        pkt = new Packet(req, MemCmd::WritebackDirty);
+        pkt->allocate();
+        if (record.hasData) {
+            pkt->setData(record.data);
+            lineImage.write(record.paddr, record.data, record.size);
+        }
+    }
+    replayedWritebacks++;
+
+    backend->predictorHandleRequest(pkt);
+    // The writeback reaches the controller after the backend, like in the
+    // full simulation
+    if (memCtrl) {
+        memCtrl->verifyWriteback(pkt);
+    }
+    delete pkt;
+}
+
+PredictorTraceReplay *
+PredictorTraceReplayParams::create()
+{
+    return new PredictorTraceReplay(this);
+}
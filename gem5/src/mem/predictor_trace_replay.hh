@@ -0,0 +1,105 @@
+/**
+ * @file
+ * Replays the store trace of a PredictorFrontend and the writeback trace of a
+ * PredictorBackend through fresh instances of both, without simulating the
+ * CPU and caches that produced them. Used for fast design space sweeps of the
+ * predictor configuration.
+ */
+
+#ifndef SHIFTLAB_PREDICTOR_TRACE_REPLAY_H__
+#define SHIFTLAB_PREDICTOR_TRACE_REPLAY_H__
+
+#include "base/statistics.hh"
+#include "mem/page_table.hh"
+#include "mem/port.hh"
+#include "mem/predictor/LineSource.hh"
+#include "mem/predictor/TraceReader.hh"
+#include "mem/predictor_backend.hh"
+#include "mem/predictor_frontend.hh"
+#include "params/PredictorTraceReplay.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+class DRAMCtrl;
+
+class PredictorTraceReplay : public SimObject
+{
+  private:
+    /**
+     * Never sends a packet, the frontend requires both of its ports to be
+     * connected.
+     */
+    class ReplayPort : public MasterPort
+    {
+      public:
+        ReplayPort(const std::string &name, SimObject *owner)
+            : MasterPort(name, owner) {}
+
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override {
+            panic("Trace replay port does not send requests");
+        }
+
+        void recvReqRetry() override {
+            panic("Trace replay port does not send requests");
+        }
+    };
+
+    ReplayPort port;
+
+    PredictorFrontend *frontend;
+    PredictorBackend *backend;
+    /* Verifies the predictions against the writebacks, may be nullptr */
+    DRAMCtrl *memCtrl;
+    MasterID masterId;
+    const bool alwaysEnabled;
+    const Addr pageSize;
+
+    /* Holds the translations seen in the store trace */
+    EmulationPageTable *pageTable;
+
+    /* Stands in for the L2 cache, holds the data stored so far */
+    LineImage lineImage;
+
+    TraceReader *storeTrace;
+    TraceReader *writebackTrace = nullptr;
+
+    /* Next record of each trace, valid if the has* flag is set */
+    TraceRecord nextStore;
+    TraceRecord nextWriteback;
+    bool hasStore = false;
+    bool hasWriteback = false;
+
+    EventFunctionWrapper replayEvent;
+
+    Stats::Scalar replayedStores;
+    Stats::Scalar replayedClwbs;
+    Stats::Scalar replayedWritebacks;
+    Stats::Scalar roiMarkers;
+
+    /* Replays every record due at the current tick */
+    void processReplayEvent();
+
+    /* Schedules the event for the earliest pending record, exits if none */
+    void scheduleNext();
+
+    void replayStore(const TraceRecord &record);
+    void replayWriteback(const TraceRecord &record);
+
+    /* Adds the page of the record to the page table if it is missing */
+    void mapPage(const TraceRecord &record);
+
+  public:
+    typedef PredictorTraceReplayParams Params;
+
+    PredictorTraceReplay(const Params *p);
+    ~PredictorTraceReplay();
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+    void startup() override;
+    void regStats() override;
+};
+
+#endif // SHIFTLAB_PREDICTOR_TRACE_REPLAY_H__
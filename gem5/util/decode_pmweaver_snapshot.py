@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+
+# This script prints the snapshots of the predictor state written by the
+# predictor frontend and backend (the snapshot parameter, see
+# src/mem/predictor/SnapshotWriter.hh) as text, one line per entry grouped
+# by the tick of the snapshot.
+
+from __future__ import print_function
+
+import struct
+import sys
+
+MAGIC = b"PMWSNAP\x00"
+VERSION = 1
+HEADER_SIZE = 16
+SECTION_HEADER = struct.Struct("<IIIIQ")
+
+DATA_CHUNK_COUNT = 16
+
+def whb_entry(entry):
+    pc, tick, addr, valid = struct.unpack_from("<QQQQ", entry)
+    words = struct.unpack_from("<%dI" % DATA_CHUNK_COUNT, entry, 32)
+    return "0x%016x 0x%016x 0x%016x %s" % (
+        pc, addr, tick, format_line(valid, words))
+
+def predictor_table_entry(entry):
+    hash_, addr, addr_conf, data_conf, valid = \
+        struct.unpack_from("<QQIIQ", entry)
+    words = struct.unpack_from("<%dI" % DATA_CHUNK_COUNT, entry, 32)
+    return "0x%016x 0x%016x %d %d %s" % (
+        hash_, addr, addr_conf, data_conf, format_line(valid, words))
+
+def result_buffer_entry(entry):
+    return "0x%016x %d %d" % struct.unpack_from("<QII", entry)
+
+def hash_count_entry(entry):
+    return "0x%016x %d" % struct.unpack_from("<QQ", entry)
+
+SECTIONS = {
+    1: ("write history buffer", "pc addr gen_tick data",
+        whb_entry),
+    2: ("predictor table", "hash target_addr addr_conf data_conf data",
+        predictor_table_entry),
+    3: ("result buffer", "paddr predictions free_predictions",
+        result_buffer_entry),
+    4: ("hash counts", "hash count",
+        hash_count_entry),
+}
+
+def format_line(valid, words):
+    # Chunks without data are printed as --------
+    return "".join("%08x" % word if valid & (1 << i) else "--------"
+                   for i, word in enumerate(words))
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: %s <snapshot file>" % sys.argv[0])
+        exit(-1)
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    if len(data) < HEADER_SIZE or data[:8] != MAGIC:
+        print("Unrecognized file %s" % sys.argv[1])
+        exit(-1)
+    version = struct.unpack_from("<I", data, 8)[0]
+    if version != VERSION:
+        print("Unsupported snapshot version %d" % version)
+        exit(-1)
+
+    pos = HEADER_SIZE
+    last_tick = None
+    while pos + SECTION_HEADER.size <= len(data):
+        section, count, size, _, tick = SECTION_HEADER.unpack_from(data, pos)
+        pos += SECTION_HEADER.size
+        if pos + count * size > len(data):
+            print("Snapshot ends with a partial section")
+            exit(-1)
+
+        if tick != last_tick:
+            print("==== Snapshot @ %d" % tick)
+            last_tick = tick
+
+        if section in SECTIONS:
+            name, columns, fmt = SECTIONS[section]
+            print("-- %s (%d entries): %s" % (name, count, columns))
+            for i in range(count):
+                print(fmt(data[pos + i * size:pos + (i + 1) * size]))
+        else:
+            print("-- unknown section %d (%d entries)" % (section, count))
+        pos += count * size
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,135 @@
+#!/usr/bin/env python
+
+# This script converts the binary store trace written by the predictor
+# frontend (see src/mem/predictor/TraceFormat.hh) to the text format of the
+# old ENABLE_VOLATILE_DUMP dump, one line per store or CLWB. Region of
+# interest markers are skipped.
+#
+#   @<pc> <P|V> <W|C> <address> <size> <data> <tick>
+#
+# Gzip compressed traces are detected and decompressed.
+
+from __future__ import print_function
+
+import gzip
+import struct
+import sys
+
+MAGIC = b"PMWTRACE"
+VERSION = 3
+HEADER_SIZE = 16
+
+FLAG_CLWB = 1 << 0
+FLAG_PERSISTENT = 1 << 1
+FLAG_HAS_DATA = 1 << 2
+
+SIZE_CLASS_SHIFT = 3
+SIZE_CLASS_MASK = 3 << SIZE_CLASS_SHIFT
+SIZE_CLASSES = {0: 4, 1: 8, 2: 64}
+
+KIND_SHIFT = 5
+KIND_MASK = 3 << KIND_SHIFT
+KIND_ACCESS = 0
+
+MASK64 = (1 << 64) - 1
+
+def open_trace(path):
+    with open(path, "rb") as f:
+        is_gzip = f.read(2) == b"\x1f\x8b"
+    return gzip.open(path, "rb") if is_gzip else open(path, "rb")
+
+def unzigzag(val):
+    return (val >> 1) ^ -(val & 1)
+
+class Decoder(object):
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.pos = 0
+        self.last_pc = 0
+        self.last_addr = 0
+        self.last_paddr = 0
+        self.last_tick = 0
+
+    def varint(self):
+        result = 0
+        shift = 0
+        while True:
+            if self.pos >= len(self.data):
+                raise EOFError("Trace ends with a partial record")
+            byte = self.data[self.pos]
+            self.pos += 1
+            result |= (byte & 0x7f) << shift
+            if byte & 0x80 == 0:
+                return result
+            shift += 7
+
+    def records(self):
+        while self.pos < len(self.data):
+            flags = self.data[self.pos]
+            self.pos += 1
+
+            pc = (self.last_pc + unzigzag(self.varint())) & MASK64
+            addr = (self.last_addr + unzigzag(self.varint())) & MASK64
+            paddr = (self.last_paddr + unzigzag(self.varint())) & MASK64
+            size_class = (flags & SIZE_CLASS_MASK) >> SIZE_CLASS_SHIFT
+            if size_class in SIZE_CLASSES:
+                size = SIZE_CLASSES[size_class]
+            else:
+                size = self.varint()
+            tick = (self.last_tick + unzigzag(self.varint())) & MASK64
+            # Hardware thread context, -1 if none, not in the text format
+            unzigzag(self.varint())
+
+            data = None
+            if flags & FLAG_HAS_DATA:
+                if self.pos + size > len(self.data):
+                    raise EOFError("Trace ends with a partial record")
+                data = self.data[self.pos:self.pos + size]
+                self.pos += size
+
+            self.last_pc, self.last_addr = pc, addr
+            self.last_paddr, self.last_tick = paddr, tick
+            if (flags & KIND_MASK) >> KIND_SHIFT == KIND_ACCESS:
+                yield flags, pc, addr, size, tick, data
+
+def format_data(size, data):
+    if data is None:
+        return "0x0"
+    if size == 4:
+        return "0x%08x" % struct.unpack("<I", bytes(data))[0]
+    if size == 8:
+        return "0x%016x" % struct.unpack("<Q", bytes(data))[0]
+    # Cachelines are printed as their 32 bit words
+    words = struct.unpack("<%dI" % (size // 4), bytes(data))
+    return "0x0" + "".join("%08x" % word for word in words)
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: %s <binary trace> <text output>" % sys.argv[0])
+        exit(-1)
+
+    trace = open_trace(sys.argv[1])
+    header = trace.read(HEADER_SIZE)
+    if len(header) != HEADER_SIZE or header[:8] != MAGIC:
+        print("Unrecognized file %s" % sys.argv[1])
+        exit(-1)
+
+    version = struct.unpack("<I", header[8:12])[0]
+    if version != VERSION:
+        print("Unsupported trace version %d" % version)
+        exit(-1)
+
+    decoder = Decoder(trace.read())
+    with open(sys.argv[2], "w") as out:
+        for flags, pc, addr, size, tick, data in decoder.records():
+            out.write("@0x%016x %s %s 0x%016x 0x%01x %s 0x%016x\n" % (
+                pc,
+                "P" if flags & FLAG_PERSISTENT else "V",
+                "C" if flags & FLAG_CLWB else "W",
+                addr,
+                size,
+                format_data(size, data),
+                tick))
+
+if __name__ == "__main__":
+    main()
@@ -243,30 +243,39 @@ void TATP_DB::update_subscriber_data(int threadId) {
   return;
 }
 
-subscriber_entry subscriber_table_entry_backup;
-uint64_t subscriber_table_entry_backup_valid;
+// One undo slot per thread, each thread only backs up its own update
+struct location_backup {
+  subscriber_entry entry;
+  uint64_t valid;
+} __attribute__((aligned(64)));
 
-long TATP_DB::get_sub_id() {
-    return ((long)get_random_s_id(0))/total_subscribers;
+location_backup subscriber_table_entry_backup[NUM_THREADS];
+
+long TATP_DB::get_sub_id(int threadId) {
+    return ((long)get_random_s_id(threadId))/total_subscribers;
 }
 
-void TATP_DB::backup_location(long subId) {
+void TATP_DB::backup_location(long subId, int threadId) {
+    location_backup* backup = &subscriber_table_entry_backup[threadId];
+
     /* Backup the location */
-    subscriber_table_entry_backup = subscriber_table[subId];
-    flush_caches(&subscriber_table_entry_backup, sizeof(subscriber_table_entry_backup));
+    backup->entry = subscriber_table[subId];
+    flush_caches(&backup->entry, sizeof(backup->entry));
     s_fence();
 
     /* Set the valid bit to 1 */
-    subscriber_table_entry_backup_valid = 1;
-    flush_caches(&subscriber_table_entry_backup_valid, sizeof(uint64_t));
+    backup->valid = 1;
+    flush_caches(&backup->valid, sizeof(uint64_t));
     s_fence();
 
     return;
 }
 
-void TATP_DB::discard_backup(long subId) {
-    subscriber_table_entry_backup_valid = 0;
-    flush_caches(&subscriber_table_entry_backup_valid, sizeof(uint64_t));
+void TATP_DB::discard_backup(long subId, int threadId) {
+    location_backup* backup = &subscriber_table_entry_backup[threadId];
+
+    backup->valid = 0;
+    flush_caches(&backup->valid, sizeof(uint64_t));
     s_fence();
 }
 
@@ -46,9 +46,9 @@ class TATP_DB{
     void make_upper_case_string(char* string_ptr, int num_chars);
 
     void update_subscriber_data(int threadId); // Tx: updates a random subscriber data
-    long get_sub_id();
-    void backup_location(long subId);
-    void discard_backup(long subId);
+    long get_sub_id(int threadId = 0);
+    void backup_location(long subId, int threadId = 0);
+    void discard_backup(long subId, int threadId = 0);
     void update_location(long subId, uint64_t vlr); // Tx: updates location for a random subscriber
     void insert_call_forwarding(int threadId); // Tx: Inserts into call forwarding table for a random user
     void delete_call_forwarding(int threadId); // Tx: Deletes call forwarding for a random user
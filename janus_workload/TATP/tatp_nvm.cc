@@ -25,7 +25,6 @@ This file is the TATP benchmark, performs various transactions as per the specif
 #define NUM_SUBSCRIBERS 1000	//100000
 #define NUM_OPS_PER_CS 2 
 #define NUM_OPS 3000	//10000000
-#define NUM_THREADS 1 
 
 TATP_DB* my_tatp_db;
 //#include "../DCT/rdtsc.h"
@@ -39,22 +38,16 @@ void init_db() {
 }
 
 
-void* update_locations(void* args, int coreid) {
+void* update_locations(void* args) {
   //  TraceBegin();
-#ifdef GEM5
-  m5_work_begin(coreid,0);
-#endif
   int thread_id = *((int*)args);
   for(int i=0; i<NUM_OPS/NUM_THREADS; i++) {
-    long subId = my_tatp_db->get_sub_id();
-    uint64_t vlr = my_tatp_db->get_random_vlr(0);
-    my_tatp_db->backup_location(subId);
+    long subId = my_tatp_db->get_sub_id(thread_id);
+    uint64_t vlr = my_tatp_db->get_random_vlr(thread_id);
+    my_tatp_db->backup_location(subId, thread_id);
     my_tatp_db->update_location(subId, vlr);
-    my_tatp_db->discard_backup(subId);
+    my_tatp_db->discard_backup(subId, thread_id);
   }
-#ifdef GEM5
-  m5_work_end(coreid,0);
-#endif
   //  TraceEnd();
   return NULL;
 }
@@ -80,7 +73,6 @@ int main(int argc, char* argv[]) {
   // LIU: remove output
   //std::cout<<"done with populating tables"<<std::endl;
 
-  pthread_t threads[NUM_THREADS];
   int id[NUM_THREADS];
   srand(0);
   //Korakit
@@ -95,16 +87,15 @@ int main(int argc, char* argv[]) {
 
   for(int i=0; i<NUM_THREADS; i++) {
     id[i] = i;
-    update_locations((void*)&id[i], atoi(argv[1]));
   }
 
-//Korakit
-//Not necessary for single threaded version
-/*
-  for(int i=0; i<NUM_THREADS; i++) {
-    pthread_join(threads[i], NULL);
-  }
-*/
+#ifdef GEM5
+  m5_work_begin(atoi(argv[1]),0);
+#endif
+  run_threads(update_locations, id, NUM_THREADS);
+#ifdef GEM5
+  m5_work_end(atoi(argv[1]),0);
+#endif
 
   // LIU: remove the output  
 /*
@@ -5,4 +5,4 @@ export CXX=g++-5
 export USE_PREDICTOR=1
 export DISABLE_CONFIDENCE=1
 export ENABLE_NON_VOLATILE_DUMP=0
-export ENABLE_VOLATILE_DUMP="./dump.txt"
+export ENABLE_VOLATILE_DUMP="./dump.bin"
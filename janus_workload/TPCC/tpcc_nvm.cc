@@ -23,7 +23,6 @@ This file models the TPCC benchmark.
 #include "tpcc_db.h"
 
 #define NUM_ORDERS 100	//10000000
-#define NUM_THREADS 1 
 
 #define NUM_WAREHOUSES 1
 #define NUM_ITEMS 100//10000
@@ -58,7 +57,6 @@ int main(int argc, char* argv[]) {
     initialize(i);
   }
 
-  pthread_t threads[NUM_THREADS];
   int id[NUM_THREADS];
   std::cout << "Done with init()" << std::endl;
   //  return 0;
@@ -68,8 +66,8 @@ int main(int argc, char* argv[]) {
   //  TraceBegin();
   for(int i=0; i<NUM_THREADS; i++) {
     id[i] = i;
-    new_orders((void *)&id[i]);
   }
+  run_threads(new_orders, id, NUM_THREADS);
   //  TraceEnd();
 #ifdef GEM5
   m5_work_end(atoi(argv[1]),0);
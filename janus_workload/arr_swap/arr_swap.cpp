@@ -2,43 +2,51 @@
 #include "../m5ops.h"
 //#include "/home/smahar/git/transparent_txopt/helper.h"
 
-ArraySwap* as;
+// Every thread swaps in its own slice of the array with its own backup
+ArraySwap* as[NUM_THREADS];
 unsigned size = 10000;
 unsigned num_op = 1000;
 
-unsigned g_seed = 1312515;
-char padding[48];
+// One seed per cacheline
+unsigned g_seed[NUM_THREADS * 16];
 // source: https://software.intel.com/en-us/articles/fast-random-number-generator-on-the-intel-pentiumr-4-processor/
-inline unsigned fastrand() {
-    g_seed = (179423891 * g_seed + 2038073749); 
-    return (g_seed >> 8) & 0x7FFFFFFF;
+inline unsigned fastrand(int tid) {
+    g_seed[tid * 16] = (179423891 * g_seed[tid * 16] + 2038073749); 
+    return (g_seed[tid * 16] >> 8) & 0x7FFFFFFF;
 } 
 
-void swapFunc() {
-    for (int i = 0; i < num_op; ++i) {
-	unsigned idx1 = fastrand() % size;
-	unsigned idx2 = fastrand() % size;
-	as->swap(idx1, idx2);
+void* swapFunc(void* args) {
+    int tid = *((int*)args);
+    for (int i = 0; i < num_op / NUM_THREADS; ++i) {
+	unsigned idx1 = fastrand(tid) % as[tid]->size;
+	unsigned idx2 = fastrand(tid) % as[tid]->size;
+	as[tid]->swap(idx1, idx2);
     }
+    return NULL;
 }
 
 int main(int argc, char* argv[]) {
     item_t* array = (item_t*) aligned_malloc(64UL, size * sizeof(item_t));
-    backup_t* backup = (backup_t*) aligned_malloc(64UL, 2 * sizeof(item_t));
 
     for (int i = 0; i < size; ++i) {
 	array[i].val = i;
     }
 	
-    as = (ArraySwap*)aligned_malloc(64UL, sizeof(ArraySwap));
-    // as = new ArraySwap(array, backup, size);
-    as->start = array;
-    as->backup = backup;
-    as->size = size;
+    int id[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; ++t) {
+	backup_t* backup = (backup_t*) aligned_malloc(64UL, 2 * sizeof(item_t));
+	as[t] = (ArraySwap*)aligned_malloc(64UL, sizeof(ArraySwap));
+	// as = new ArraySwap(array, backup, size);
+	as[t]->start = array + t * (size / NUM_THREADS);
+	as[t]->backup = backup;
+	as[t]->size = size / NUM_THREADS;
+	g_seed[t * 16] = 1312515 + t;
+	id[t] = t;
+    }
 
     m5_work_begin(atoi(argv[1]),0);
     // TraceBegin();
-    swapFunc();
+    run_threads(swapFunc, id, NUM_THREADS);
     // TraceEnd();
     m5_work_end(atoi(argv[1]),0);
     //fprintf(stderr, "done\n");
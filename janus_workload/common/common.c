@@ -1,5 +1,6 @@
 #include "common.h"
 #include "stdio.h"
+#include "stdlib.h"
 
 void* pmem_base_addr = NULL;
 uint64_t current_offset = 0UL;
@@ -59,3 +60,21 @@ void flush_caches(void* addr, size_t size){
 void s_fence(void){
     _mm_sfence();
 }
+
+void run_threads(void* (*fn)(void*), int* ids, int count){
+    if (count == 1) {
+        fn(&ids[0]);
+        return;
+    }
+
+    /* The main thread runs the first worker, count contexts are enough */
+    pthread_t* threads = (pthread_t*)malloc(count * sizeof(pthread_t));
+    for (int i = 1; i < count; i++) {
+        pthread_create(&threads[i], NULL, fn, &ids[i]);
+    }
+    fn(&ids[0]);
+    for (int i = 1; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
@@ -2,11 +2,17 @@
 #include <immintrin.h>
 #include <stdint.h>
 
+#include <pthread.h>
 #include <sys/mman.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 
 
+// Worker threads of the multi-threaded variants, set with make NUM_THREADS=<n>
+#ifndef NUM_THREADS
+#define NUM_THREADS 1
+#endif
+
 #ifdef GEM5
 const int MMAP_PERSISTENT = 314;
 #else
@@ -23,3 +29,7 @@ void cache_flush(void* addr, size_t size);
 void flush_caches(void* addr, size_t size);
 
 void s_fence(void);
+
+// Runs fn(&ids[i]) on count threads and waits for them, a single thread
+// runs on the caller like the single-threaded workloads always did
+void run_threads(void* (*fn)(void*), int* ids, int count);
@@ -28,15 +28,17 @@ inline unsigned fastrand() {
  
 void *opFunc(void* a) {
 	int tid = *((int*)a);
+	// Every thread inserts from its own slice of the new locations
+	hash_table_t* thread_locations = new_locations + tid * (num_op / NUM_THREADS);
 	//printf("thread %d\n", id);
-	for (int i = 0; i < num_op; ++i) {
+	for (int i = 0; i < num_op / NUM_THREADS; ++i) {
 		uint64_t num = rand() % (init_size * 2);
 		//uint64_t num = i;
 		//if (i % 2) {
 			//(new_locations[id] + i)->item.val = num;
 			item_t temp_item;
 			temp_item.val = num;
-			ht.insert(new_locations + i, &temp_item);
+			ht.insert(thread_locations + i, &temp_item);
 		//} else {
 		//	ht.erase(num);
 		//}
@@ -45,10 +47,12 @@ void *opFunc(void* a) {
 }
 
 int main (int argc, char *argv[]) {
-	int id;
+	int id[NUM_THREADS];
 
 	//printf("malloc new locations\n");
-	id = 0;
+	for (int t = 0; t < NUM_THREADS; ++t) {
+		id[t] = t;
+	}
 	new_locations = (hash_table_t*)aligned_malloc(64, sizeof(hash_table_t) * num_op);
 	//printf("new locations[%d] %lu\n", i, (uint64_t)new_locations[i]);
 	for (int j = 0; j < num_op; ++j) {
@@ -71,7 +75,10 @@ int main (int argc, char *argv[]) {
 	// initialize hash table
 	ht.start = table;
 	ht.size = SIZE;
-	//ht.locks = locks;
+	ht.locks = (pthread_mutex_t*)malloc(SIZE * sizeof(pthread_mutex_t));
+	for (int i = 0; i < SIZE; ++i) {
+		pthread_mutex_init(ht.locks + i, NULL);
+	}
 	for (int j = 0; j < init_size; ++j) {
 		(init_table + j)->item.val = j;
 		ht.init_insert(init_table + j);
@@ -80,7 +87,7 @@ int main (int argc, char *argv[]) {
 	//exit(1);
 	int coreid = atoi(argv[1]);
 	m5_work_begin(coreid,0);
-	opFunc(&id);
+	run_threads(opFunc, id, NUM_THREADS);
 	m5_work_end(coreid,0);
 	return 0;  //  opFunc((void*)(&id[0]));
 	//ht.printHashTable();
@@ -38,7 +38,8 @@ class HashTable {
 
 		void printHashTable();
 
-		//pthread_mutex_t* locks;
+		// One lock per bucket, only used by the multi-threaded variant
+		pthread_mutex_t* locks;
 		unsigned size;
 		hash_table_t* start;
 };
@@ -94,7 +95,9 @@ void HashTable::insert(hash_table_t* new_item, item_t* temp_item) {
 	uint64_t val_hash = hash(_val);
 	//printf("insert:%lu\n", val_hash);
 	//printf("lock=%lu\n", val_hash);
-	//pthread_mutex_lock(locks + val_hash);
+#if NUM_THREADS > 1
+	pthread_mutex_lock(locks + val_hash);
+#endif
 	//printf("get lock=%lu\n", val_hash);
 	hash_table_t* location = start + val_hash;
 	new_item->item = *temp_item;
@@ -126,7 +129,9 @@ void HashTable::insert(hash_table_t* new_item, item_t* temp_item) {
 		}
 	}
 	//printf("unlock=%lu\n", val_hash);
-	//pthread_mutex_unlock(locks + val_hash);
+#if NUM_THREADS > 1
+	pthread_mutex_unlock(locks + val_hash);
+#endif
 }
 
 
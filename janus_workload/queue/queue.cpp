@@ -7,24 +7,27 @@ item_t* new_locations;
 
 Queue* q;
 
-unsigned g_seed = 1312515;
+// One seed per cacheline
+unsigned g_seed[NUM_THREADS * 16];
 
 // source: https://software.intel.com/en-us/articles/fast-random-number-generator-on-the-intel-pentiumr-4-processor/
 
-inline unsigned fastrand() {
-	g_seed = (214013 * g_seed + 2531011); 
-	return (g_seed >> 16) & 0x7FFF;
+inline unsigned fastrand(int tid) {
+	g_seed[tid * 16] = (214013 * g_seed[tid * 16] + 2531011); 
+	return (g_seed[tid * 16] >> 16) & 0x7FFF;
 } 
 
 void *opFunc(void* a){
 	int tid = *((int*)a);
-	for (int i = 0; i < num_op; ++i) {
-		unsigned num = fastrand();
+	// Every thread enqueues from its own slice of the new locations
+	item_t* thread_locations = new_locations + tid * (num_op / NUM_THREADS);
+	for (int i = 0; i < num_op / NUM_THREADS; ++i) {
+		unsigned num = fastrand(tid);
 		if (num % 2) {
 			item_t temp_item;
 			temp_item.val = num;
 			//printf("enqueue,id=%d\n",id);
-			q->enqueue(new_locations + i, &temp_item, tid);
+			q->enqueue(thread_locations + i, &temp_item, tid);
 		} else {
 			//printf("dequeue,id=%d\n",id);
 			q->dequeue();
@@ -34,7 +37,7 @@ void *opFunc(void* a){
 }
 
 int main (int argc, char* argv[]) {
-	int id;
+	int id[NUM_THREADS];
 	
 	//printf("queue addr %lu\n", uint64_t(&q));
 	q = (Queue*)aligned_malloc(64, sizeof(Queue));
@@ -45,13 +48,16 @@ int main (int argc, char* argv[]) {
 	}
 
 	
-	id = 0;
+	for (int t = 0; t < NUM_THREADS; ++t) {
+		id[t] = t;
+		g_seed[t * 16] = 1312515 + t;
+	}
 	new_locations = (item_t*)aligned_malloc(64, sizeof(item_t) * num_op);
 #ifdef GEM5	
 	m5_work_begin(atoi(argv[1]),0);
 #endif
 	//	TraceBegin();
-	opFunc(&id);
+	run_threads(opFunc, id, NUM_THREADS);
 	//	TraceEnd();
 #ifdef GEM5
 
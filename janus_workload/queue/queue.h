@@ -38,10 +38,15 @@ Queue::Queue() {
 	tail = 0;
 	head = 0;
 	tailValid = 0;
+	pthread_mutex_init(&head_lock, NULL);
+	pthread_mutex_init(&tail_lock, NULL);
 }
 
 void
 Queue::enqueue(item_t* new_location, item_t* temp_item, int id) {
+#if NUM_THREADS > 1
+	pthread_mutex_lock(&tail_lock);
+#endif
 	memcpy(new_location, temp_item, sizeof(item_t));
 	((item_t*)(tail))->next = new_location;
 
@@ -51,6 +56,9 @@ Queue::enqueue(item_t* new_location, item_t* temp_item, int id) {
 	tail = (uint64_t)new_location;
 	flush_caches(&tail, sizeof(tail));
 	s_fence();
+#if NUM_THREADS > 1
+	pthread_mutex_unlock(&tail_lock);
+#endif
 }
 
 void
@@ -76,12 +84,16 @@ Queue::init_enqueue(uint64_t _val, item_t* new_location) {
 
 void
 Queue::dequeue() {
-	//pthread_mutex_lock(&head_lock);
+#if NUM_THREADS > 1
+	pthread_mutex_lock(&head_lock);
+#endif
 	item_t* victim = (item_t*)(head);
 	head = (uint64_t)(victim->next);
     flush_caches(&head, sizeof(head));
 	s_fence();
-	//pthread_mutex_unlock(&head_lock);
+#if NUM_THREADS > 1
+	pthread_mutex_unlock(&head_lock);
+#endif
 	//free(victim);
 }
 
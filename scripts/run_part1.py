@@ -29,7 +29,7 @@ default_env = {
     # "ENABLE_VOLATILE_DUMP": "1",
     "DISABLE_PER_PC_CONFIDENCE":"1",
     "DISABLE_FANCY_ADDR_PRED": "1",
-    "ENABLE_VOLATILE_DUMP": "dump.txt",
+    "ENABLE_VOLATILE_DUMP": "dump.bin",
     "LD_LIBRARY_PATH": "/usr/local/lib64",
     # "DISABLE_INVALIDATION": "1",
 }
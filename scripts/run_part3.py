@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+
+"""
+Run the multi-threaded janus workloads (make -C janus_workload mt) with
+per-context and shared predictor state. The cores are SMT, so every
+predictor frontend sees the stores of SMT_THREADS hardware contexts.
+"""
+
+from common import *
+
+JANUS_WORKLOAD = "/pmweaver_ae/janus_workload"
+
+THREAD_COUNTS = [2, 4, 8]
+# Hardware threads per core, at most 4 for DerivO3CPU
+SMT_THREADS = 2
+
+def mt_workloads(threads: int) -> List[Workload]:
+    suffix = '_' + str(threads) + 't'
+    return [
+        Workload('arr_swap' + suffix,   JANUS_WORKLOAD + '/arr_swap/arr_swap' + suffix,         '', False),
+        Workload('hashmap_ll' + suffix, JANUS_WORKLOAD + '/hash/singly_linked_hash' + suffix,   '', False),
+        Workload('queue' + suffix,      JANUS_WORKLOAD + '/queue/queue' + suffix,               '', False),
+        Workload('tatp_nvm' + suffix,   JANUS_WORKLOAD + '/TATP/tatp_nvm' + suffix,             '', False),
+        Workload('tpcc_nvm' + suffix,   JANUS_WORKLOAD + '/TPCC/tpcc_nvm' + suffix,             '', False),
+    ]
+
+default_env = {
+    "DISABLE_CONFIDENCE":"1",
+    "STALE_ENTRY_AGE_THRESHOLD":"8",
+    "PATH_HISTORY_SIZE": "32",
+    "DISABLE_PER_PC_CONFIDENCE":"1",
+    "DISABLE_FANCY_ADDR_PRED": "1",
+    "LD_LIBRARY_PATH": "/usr/local/lib64",
+}
+
+def execute_workloads(run_name: str, workloads: List[Workload], threads: int, env: Dict = {}) -> None:
+    for workload in workloads:
+        cwd = create_workload_dir(workload, run_name, 'run_comparison_mt')
+        print("Currently on the workload", workload.name, "stored at", cwd)
+        stdFwd = workload.stdFwd
+        cores = max(1, threads // SMT_THREADS)
+        gem5_args = GEM5_ARGS + ['--smt-threads=' + str(threads // cores)]
+        exec_shell(get_gem5_cmd(run_name=run_name, workload=workload, cpucount=cores, gem5_args=gem5_args, stdFwd=stdFwd), env=env, cwd=cwd)
+
+def run_bmo_predictor(threads: int) -> None:
+    env = dict(default_env)
+    env["ENABLE_DW"] = "1"
+    env["USE_PREDICTOR"] = "1"
+
+    execute_workloads('with-dw-predictor', mt_workloads(threads), threads, env)
+
+def run_bmo_predictor_shared(threads: int) -> None:
+    env = dict(default_env)
+    env["ENABLE_DW"] = "1"
+    env["USE_PREDICTOR"] = "1"
+    env["SHARED_CONTEXT_STATE"] = "1"
+
+    execute_workloads('with-dw-predictor-shared', mt_workloads(threads), threads, env)
+
+def run_bmo(threads: int) -> None:
+    env = dict(default_env)
+    env["ENABLE_DW"] = "1"
+    env["USE_PREDICTOR"] = "0"
+
+    execute_workloads('with-dw', mt_workloads(threads), threads, env)
+
+def main() -> None:
+    set_threads(HW_THREADS)
+
+    for threads in THREAD_COUNTS:
+        run_bmo(threads)
+        run_bmo_predictor(threads)
+        run_bmo_predictor_shared(threads)
+
+if __name__ == '__main__':
+    main()